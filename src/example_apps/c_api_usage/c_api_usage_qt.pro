@@ -10,6 +10,9 @@ TEMPLATE = app
 DEFINES  += TARGET_API_LIB
 QMAKE_CFLAGS += -ansi -DCOMPILE_ANSI_ONLY
 QMAKE_CXXFLAGS += -std=c++11
+# Older glibc versions need -pthread for std::thread.
+unix:!macx: QMAKE_CXXFLAGS += -pthread
+unix:!macx: QMAKE_LFLAGS += -pthread
 
 DEPENDPATH += \
 	./../../rinchi_lib/ \
@@ -37,9 +40,13 @@ SOURCES += \
 	./../../parsers/mdl_rxnfile_reader.cpp \
 	./../../parsers/mdl_rdfile_reader.cpp \
 	./../../parsers/rinchi_reader.cpp \
+	./../../parsers/inchi_auxinfo_reader.cpp \
 	./../../writers/mdl_rxnfile_writer.cpp \
 	./../../writers/mdl_rdfile_writer.cpp \
+	./../../writers/mdl_molfile_writer.cpp \
 	./../../rinchi/rinchi_reaction.cpp \
+	./../../rinchi/rinchi_inchi_cache.cpp \
+	./../../rinchi/rinchi_molecule.cpp \
 	./../../rinchi/rinchi_consts.cpp \
 	./../../rinchi_lib/rinchi_lib.cpp \
 	./c_api_usage.c \
@@ -0,0 +1,152 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "rinchi_daemon.h"
+
+/**
+  Thin client of "rinchi_cmdline /daemon": takes the same arguments as rinchi_cmdline and prints
+  the same output with the same exit code, but leaves the work to the daemon, which has the
+  InChI library loaded already. Set RINCHI_DAEMON_SOCKET if the daemon was started with /socket.
+
+  With /bulk among the arguments, the request goes to the bulk lane of the daemon: use it for
+  batch jobs, so that they do not hold up interactive users of the same daemon.
+
+  "rinchi_client /stats" prints the request count and latency percentiles of the daemon.
+
+  Needs none of the RInChI and InChI sources, so starts fast: build it with 'make rinchi_client'.
+**/
+
+int connect_to_daemon(const std::string& path)
+{
+	sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if (path.length() >= sizeof(address.sun_path)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	strcpy(address.sun_path, path.c_str());
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+		return -1;
+	if (connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+		int error = errno;
+		close(fd);
+		errno = error;
+		return -1;
+	}
+	return fd;
+}
+
+int main(int argc, char* argv[])
+{
+	signal(SIGPIPE, SIG_IGN);
+
+	std::vector<std::string> args;
+	bool bulk = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "/bulk") == 0)
+			bulk = true;
+		else
+			args.push_back(argv[i]);
+	}
+
+	std::vector<std::string> request;
+	if (args.size() == 1 && args[0] == "/stats")
+		request.push_back(rinchi_daemon::REQUEST_STATS);
+	else {
+		std::string file_text;
+		bool file_found = false;
+		if (!args.empty()) {
+			std::ifstream file (args[0].c_str(), std::ios::in | std::ios::binary);
+			if (file) {
+				std::ostringstream contents;
+				contents << file.rdbuf();
+				file_text = contents.str();
+				file_found = true;
+			}
+		}
+		request.push_back(bulk ? rinchi_daemon::REQUEST_RUN_BULK : rinchi_daemon::REQUEST_RUN);
+		request.push_back(file_text);
+		request.push_back(file_found ? "1" : "0");
+		request.insert(request.end(), args.begin(), args.end());
+	}
+
+	std::string socket_path = rinchi_daemon::default_socket_path();
+	int fd = connect_to_daemon(socket_path);
+	if (fd < 0) {
+		std::cerr << "ERROR: Cannot connect to the RInChI daemon at '" << socket_path << "': " << strerror(errno)
+			<< ". Start it with 'rinchi_cmdline /daemon'." << std::endl;
+		return 2;
+	}
+
+	// Somebody else may have put a socket at the path; do not send them the file.
+	uid_t daemon_uid;
+	if (!rinchi_daemon::peer_uid(fd, daemon_uid) || daemon_uid != getuid()) {
+		close(fd);
+		std::cerr << "ERROR: The process listening at '" << socket_path << "' is not a RInChI daemon of this user." << std::endl;
+		return 2;
+	}
+
+	std::vector<std::string> response;
+	// Read even if sending failed: a daemon refusing the connection answers without reading the request.
+	rinchi_daemon::write_message(fd, request);
+	bool ok = rinchi_daemon::read_message(fd, response) && response.size() == 3;
+	close(fd);
+	if (!ok) {
+		std::cerr << "ERROR: No valid response from the RInChI daemon at '" << socket_path << "'." << std::endl;
+		return 2;
+	}
+
+	std::cout << response[1] << std::flush;
+	std::cerr << response[2] << std::flush;
+	return std::atoi(response[0].c_str());
+}
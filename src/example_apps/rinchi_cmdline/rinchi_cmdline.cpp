@@ -37,124 +37,64 @@
 #pragma endregion
 #endif
 
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
 
+#include "rinchi_platform.h"
 #include "rinchi_utils.h"
-#include "rinchi_reaction.h"
+#include "inchi_api_intf.h"
 
-#include "rinchi_consts.h"
-#include "rinchi_reader.h"
-#include "mdl_rxnfile.h"
-#include "mdl_rxnfile_reader.h"
-#include "mdl_rdfile_reader.h"
-#include "mdl_rxnfile_writer.h"
-#include "mdl_rdfile_writer.h"
+#ifdef ON_LINUX
+	#include "rinchi_daemon.h"
+#endif
 
-bool has_parameter(const std::string& p, int argc, char* argv[])
-{
-	for (int i = 1; i < argc; i++)
-		if (rinchi::lowercase(p) == rinchi::lowercase(std::string(argv[i])))
-			return true;
+#include "rinchi_cmdline_run.h"
 
-	return false;
+#ifdef ON_LINUX
+int run_daemon(const std::vector<std::string>& args)
+{
+	try {
+		rinchi_daemon::DaemonOptions options;
+		options.socket_path = parameter_value("/socket:", args, options.socket_path);
+		options.worker_count = std::atoi(parameter_value("/threads:", args, "0").c_str());
+		options.reserved_workers = std::atoi(parameter_value("/interactive-threads:", args, rinchi::int2str((int) options.reserved_workers)).c_str());
+		options.cache_entries = std::atol(parameter_value("/cache-size:", args, rinchi::int2str((int) options.cache_entries)).c_str());
+		options.max_connections = std::atol(parameter_value("/max-connections:", args, rinchi::int2str((int) options.max_connections)).c_str());
+		// Loaded up front, so that a missing library stops the daemon rather than failing every
+		// request, and the first requests do not wait for it.
+		rinchi::load_inchi_library();
+		return rinchi_daemon::run_daemon(options, run_cmdline, std::cerr);
+	} catch (std::exception& e) {
+		std::cerr << "ERROR: " << rinchi::demangled_class_name(typeid(e).name()) << ": " << e.what() << std::endl;
+		return 2;
+	}
 }
+#endif
 
 int main(int argc, char* argv[])
 {
-	try {
-		// Adding an option that allows 2D coordinate reconstruction from RInChI strings
-		// without RAuxInfo requires linking to a 3rd party ChemInformatics toolkit.
-		if (argc < 2) {
-			std::cerr << "Usage: rinchi_cmdline <filename> <options>" << "\n"
-				<< "       <filename> may be an RXN or RD file, or a file containing an RInChI" << "\n"
-				<< "                  string optionally followed by a linefeed and RAuxInfo data." << "\n"
-				<< "       <options>" << "\n"
-				<< "            /force-equilibrium" << "\n"
-				<< "                Forces the reaction to be interpreted as an equilibrium reaction." << "\n"
-				<< "                Only relevant for RD or RXN file input." << "\n"
-				<< "            /rd or /rxn" << "\n"
-				<< "                Force output file format of reconstructed reaction file to be RD" << "\n"
-				<< "                or RXN." << "\n"
-				<< "                Only relevant for RInChI string input." << "\n"
-				<< "                If the output file format is not forced, this utility will choose" << "\n"
-				<< "                to write RD files if the reaction has agents, and RXN files if not." << "\n"
-				<< std::endl;
-			return 1;
-		}
-
-		bool option_force_equilbrium = has_parameter("/force-equilibrium", argc, argv);
-		bool option_output_rd        = has_parameter("/rd", argc, argv);
-		bool option_output_rxn       = has_parameter("/rxn", argc, argv);
-
-		if (option_output_rd && option_output_rxn)
-			throw std::runtime_error ("Only one of /rd and /rxn may be used at a time.");
-
-		const char* file_name;
-		std::string file_format;
-
-		file_name = argv[1];
-		{
-			std::ifstream test_file(file_name);
-			if (!test_file) 
-				throw std::runtime_error (std::string("File '") + file_name + "' does not exist.");
+	std::vector<std::string> args (argv + 1, argv + argc);
 
-			// Detect input file format.
-			std::string first_line;
-			rinchi::rinchi_getline(test_file, first_line);
-			if (first_line == rinchi::MDL_TAG_RXN_BEGIN)
-				file_format = "RXN";
-			else if (first_line.substr(0, rinchi::RINCHI_STD_HEADER.length()) == rinchi::RINCHI_STD_HEADER)
-				file_format = "RINCHI";
-			else
-				file_format = "RD";
-		}
-
-		rinchi::Reaction rxn;
-
-		if (file_format == "RXN") {
-			rinchi::MdlRxnfileReader rxn_rdr;
-			rxn_rdr.read_reaction(file_name, rxn, option_force_equilbrium);
-		}
-		else if (file_format == "RD") {
-			rinchi::MdlRDfileReader rd_rdr;
-			rd_rdr.read_reaction(file_name, rxn, option_force_equilbrium);
-		}
-		else if (file_format == "RINCHI") {
-			std::string rinchi_string;
-			std::string rauxinfo;
-
-			std::ifstream rinchi_file(file_name);
-			rinchi::rinchi_getline(rinchi_file, rinchi_string);
-			rinchi::rinchi_getline(rinchi_file, rauxinfo);
-
-			rinchi::RInChIReader rinchi_rdr;
-			rinchi_rdr.split_into_reaction(rinchi_string, rauxinfo, rxn);
-
-			bool output_rd = (rxn.agents().size() > 0 || option_output_rd) && !option_output_rxn;
-			if (output_rd) {
-				rinchi::MdlRDfileWriter rd_writer;
-				rd_writer.write_reaction(rxn, std::cout);
-			}
-			else {
-				rinchi::MdlRxnfileWriter rxn_writer;
-				rxn_writer.write_reaction(rxn, std::cout);
-			}
-		}
-		else
-			throw std::runtime_error ("Internal bug: Unsupported file format '" + file_format + "'.");
+#ifdef ON_LINUX
+	if (!args.empty() && rinchi::lowercase(args[0]) == "/daemon")
+		return run_daemon(args);
+#endif
 
-		if (file_format != "RINCHI") {
-			std::cout << rxn.rinchi_string() << std::endl;
-			std::cout << rxn.rinchi_auxinfo() << std::endl;
-			std::cout << rxn.rinchi_long_key() << std::endl;
-			std::cout << rxn.rinchi_short_key() << std::endl;
-			std::cout << rxn.rinchi_web_key() << std::endl;
+	std::string file_text;
+	bool file_found = false;
+	if (!args.empty()) {
+		std::ifstream file (args[0].c_str(), std::ios::in | std::ios::binary);
+		if (file) {
+			std::ostringstream contents;
+			contents << file.rdbuf();
+			file_text = contents.str();
+			file_found = true;
 		}
-
-		return 0;
-	} catch (std::exception& e) {
-		std::cerr << "ERROR: " << rinchi::demangled_class_name(typeid(e).name()) << ": " << e.what() << std::endl;
-		return 2;
 	}
+
+	return run_cmdline(args, file_found ? &file_text : NULL, NULL, std::cout, std::cerr);
 }
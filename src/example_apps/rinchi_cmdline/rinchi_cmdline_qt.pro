@@ -10,6 +10,9 @@ TEMPLATE = app
 DEFINES  += TARGET_API_LIB
 QMAKE_CFLAGS += -ansi -DCOMPILE_ANSI_ONLY
 QMAKE_CXXFLAGS += -std=c++11
+# Older glibc versions need -pthread for std::thread.
+unix:!macx: QMAKE_CXXFLAGS += -pthread
+unix:!macx: QMAKE_LFLAGS += -pthread
 
 DEPENDPATH += \
 	./../../lib/ \
@@ -35,11 +38,19 @@ SOURCES += \
 	./../../parsers/mdl_rxnfile_reader.cpp \
 	./../../parsers/mdl_rdfile_reader.cpp \
 	./../../parsers/rinchi_reader.cpp \
+	./../../parsers/inchi_auxinfo_reader.cpp \
 	./../../writers/mdl_rxnfile_writer.cpp \
 	./../../writers/mdl_rdfile_writer.cpp \
+	./../../writers/mdl_molfile_writer.cpp \
 	./../../rinchi/rinchi_reaction.cpp \
+	./../../rinchi/rinchi_inchi_cache.cpp \
+	./../../rinchi/rinchi_result_cache.cpp \
+	./../../rinchi/rinchi_lane_scheduler.cpp \
+	./../../rinchi/rinchi_molecule.cpp \
 	./../../rinchi/rinchi_consts.cpp \
 	./rinchi_cmdline.cpp \
+	./rinchi_daemon.cpp \
+	./rinchi_cmdline_run.cpp \
 	./../../../../InChI/INCHI-1-SRC/INCHI_BASE/src/ichi_bns.c \
 	./../../../../InChI/INCHI-1-SRC/INCHI_BASE/src/ichi_io.c \
 	./../../../../InChI/INCHI-1-SRC/INCHI_BASE/src/ichican2.c \
@@ -90,3 +101,9 @@ SOURCES += \
 	./../../../../InChI/INCHI-1-SRC/INCHI_API/libinchi/src/inchi_dll_a.c \
 	./../../../../InChI/INCHI-1-SRC/INCHI_API/libinchi/src/inchi_dll_a2.c \
 	./../../../../InChI/INCHI-1-SRC/INCHI_API/libinchi/src/inchi_dll_b.c \
+
+# Thin client of 'rinchi_cmdline /daemon', needs none of the other sources: 'make rinchi_client'.
+rinchi_client.target = rinchi_client
+rinchi_client.depends = rinchi_client.cpp rinchi_daemon.h
+rinchi_client.commands = $(CXX) $(CXXFLAGS) $(INCPATH) -o rinchi_client rinchi_client.cpp
+QMAKE_EXTRA_TARGETS += rinchi_client
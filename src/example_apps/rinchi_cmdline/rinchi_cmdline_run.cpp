@@ -0,0 +1,226 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <istream>
+#include <stdexcept>
+#include <typeinfo>
+
+#include "rinchi_platform.h"
+#include "rinchi_utils.h"
+#include "rinchi_reaction.h"
+#include "rinchi_result_cache.h"
+
+#include "rinchi_consts.h"
+#include "rinchi_reader.h"
+#include "mdl_rxnfile.h"
+#include "mdl_rxnfile_reader.h"
+#include "mdl_rdfile_reader.h"
+#include "mdl_rxnfile_writer.h"
+#include "mdl_rdfile_writer.h"
+
+#ifdef ON_LINUX
+	#include "rinchi_daemon.h"
+#endif
+
+#include "rinchi_cmdline_run.h"
+
+bool has_parameter(const std::string& p, const std::vector<std::string>& args)
+{
+	for (std::vector<std::string>::const_iterator arg = args.begin(); arg != args.end(); arg++)
+		if (rinchi::lowercase(p) == rinchi::lowercase(*arg))
+			return true;
+
+	return false;
+}
+
+std::string parameter_value(const std::string& p, const std::vector<std::string>& args, const std::string& default_value)
+{
+	for (std::vector<std::string>::const_iterator arg = args.begin(); arg != args.end(); arg++)
+		if (rinchi::lowercase(arg->substr(0, p.length())) == rinchi::lowercase(p))
+			return arg->substr(p.length());
+
+	return default_value;
+}
+
+void print_usage(std::ostream& err)
+{
+	err << "Usage: rinchi_cmdline <filename> <options>" << "\n"
+		<< "       <filename> may be an RXN or RD file, or a file containing an RInChI" << "\n"
+		<< "                  string optionally followed by a linefeed and RAuxInfo data." << "\n"
+		<< "       <options>" << "\n"
+		<< "            /force-equilibrium" << "\n"
+		<< "                Forces the reaction to be interpreted as an equilibrium reaction." << "\n"
+		<< "                Only relevant for RD or RXN file input." << "\n"
+		<< "            /rd or /rxn" << "\n"
+		<< "                Force output file format of reconstructed reaction file to be RD" << "\n"
+		<< "                or RXN." << "\n"
+		<< "                Only relevant for RInChI string input." << "\n"
+		<< "                If the output file format is not forced, this utility will choose" << "\n"
+		<< "                to write RD files if the reaction has agents, and RXN files if not." << "\n"
+		<< "            /no-auxinfo" << "\n"
+		<< "                Do not calculate or output RAuxInfo, for when only the RInChI string" << "\n"
+		<< "                and keys are needed." << "\n"
+		<< "                Only relevant for RD or RXN file input." << "\n"
+#ifdef ON_LINUX
+		<< "\n"
+		<< "       rinchi_cmdline /daemon [/socket:<path>] [/threads:<n>] [/interactive-threads:<n>]" << "\n"
+		<< "                              [/cache-size:<n>] [/max-connections:<n>]" << "\n"
+		<< "            Serves rinchi_client, which takes the same arguments as rinchi_cmdline," << "\n"
+		<< "            over a Unix domain socket, until stopped with SIGINT or SIGTERM." << "\n"
+		<< "            /socket:<path>" << "\n"
+		<< "                Socket path. Default: $" << rinchi_daemon::SOCKET_PATH_ENV << " or " << rinchi_daemon::default_socket_path() << "\n"
+		<< "            /threads:<n>" << "\n"
+		<< "                Number of worker threads. Default: one per hardware thread." << "\n"
+		<< "            /interactive-threads:<n>" << "\n"
+		<< "                Number of the worker threads kept for interactive requests, so that" << "\n"
+		<< "                these do not wait behind 'rinchi_client /bulk' requests. Default: 1." << "\n"
+		<< "            /cache-size:<n>" << "\n"
+		<< "                Number of reaction results kept in memory. Default: 10000; 0 turns" << "\n"
+		<< "                the cache off." << "\n"
+		<< "            /max-connections:<n>" << "\n"
+		<< "                Number of clients served at once; others get an error. Default: 256." << "\n"
+#endif
+		<< std::endl;
+}
+
+int run_cmdline(const std::vector<std::string>& args, const std::string* file_text, rinchi::ReactionResultCache* cache, std::ostream& out, std::ostream& err)
+{
+	try {
+		// Adding an option that allows 2D coordinate reconstruction from RInChI strings
+		// without RAuxInfo requires linking to a 3rd party ChemInformatics toolkit.
+		if (args.empty()) {
+			print_usage(err);
+			return 1;
+		}
+
+		bool option_force_equilbrium = has_parameter("/force-equilibrium", args);
+		bool option_output_rd        = has_parameter("/rd", args);
+		bool option_output_rxn       = has_parameter("/rxn", args);
+		bool option_no_auxinfo       = has_parameter("/no-auxinfo", args);
+
+		if (option_output_rd && option_output_rxn)
+			throw std::runtime_error ("Only one of /rd and /rxn may be used at a time.");
+
+		const std::string& file_name = args[0];
+		if (!file_text)
+			throw std::runtime_error (std::string("File '") + file_name + "' does not exist.");
+
+		rinchi::MemoryStreamBuffer file_buffer (file_text->data(), file_text->length());
+		std::istream file (&file_buffer);
+
+		// Detect input file format.
+		std::string file_format;
+		{
+			std::string first_line;
+			rinchi::rinchi_getline(file, first_line);
+			if (first_line == rinchi::MDL_TAG_RXN_BEGIN)
+				file_format = "RXN";
+			else if (first_line.substr(0, rinchi::RINCHI_STD_HEADER.length()) == rinchi::RINCHI_STD_HEADER)
+				file_format = "RINCHI";
+			else
+				file_format = "RD";
+			file.clear();
+			file.seekg(0);
+		}
+
+		if (file_format == "RINCHI") {
+			std::string rinchi_string;
+			std::string rauxinfo;
+			rinchi::rinchi_getline(file, rinchi_string);
+			rinchi::rinchi_getline(file, rauxinfo);
+
+			rinchi::Reaction rxn;
+			rinchi::RInChIReader rinchi_rdr;
+			rinchi_rdr.split_into_reaction(rinchi_string, rauxinfo, rxn);
+
+			bool output_rd = (rxn.agents().size() > 0 || option_output_rd) && !option_output_rxn;
+			if (output_rd) {
+				rinchi::MdlRDfileWriter rd_writer;
+				rd_writer.write_reaction(rxn, out);
+			}
+			else {
+				rinchi::MdlRxnfileWriter rxn_writer;
+				rxn_writer.write_reaction(rxn, out);
+			}
+			return 0;
+		}
+
+		rinchi::ReactionResult result;
+		std::string cache_key;
+		if (cache)
+			cache_key = rinchi::ReactionResultCache::cache_key(file_format, option_force_equilbrium, *file_text);
+		if (!cache || !cache->find(cache_key, !option_no_auxinfo, result)) {
+			rinchi::Reaction rxn;
+			rxn.set_omit_auxinfo(option_no_auxinfo);
+
+			if (file_format == "RXN") {
+				rinchi::MdlRxnfileReader rxn_rdr;
+				rxn_rdr.read_reaction(file, rxn, option_force_equilbrium, 0, file_name);
+			}
+			else if (file_format == "RD") {
+				rinchi::MdlRDfileReader rd_rdr;
+				rd_rdr.read_reaction(file, rxn, option_force_equilbrium, 0, file_name);
+			}
+			else
+				throw std::runtime_error ("Internal bug: Unsupported file format '" + file_format + "'.");
+
+			result.rinchi_string = rxn.rinchi_string();
+			if (!option_no_auxinfo)
+				result.rinchi_auxinfo = rxn.rinchi_auxinfo();
+			result.has_auxinfo = !option_no_auxinfo;
+			result.long_key = rxn.rinchi_long_key();
+			result.short_key = rxn.rinchi_short_key();
+			result.web_key = rxn.rinchi_web_key();
+			if (cache)
+				cache->insert(cache_key, result);
+		}
+
+		out << result.rinchi_string << std::endl;
+		if (!option_no_auxinfo)
+			out << result.rinchi_auxinfo << std::endl;
+		out << result.long_key << std::endl;
+		out << result.short_key << std::endl;
+		out << result.web_key << std::endl;
+
+		return 0;
+	} catch (std::exception& e) {
+		err << "ERROR: " << rinchi::demangled_class_name(typeid(e).name()) << ": " << e.what() << std::endl;
+		return 2;
+	}
+}
@@ -0,0 +1,66 @@
+#ifndef IUPAC_RINCHI_CMDLINE_RUN_HEADER_GUARD
+#define IUPAC_RINCHI_CMDLINE_RUN_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace rinchi {
+	class ReactionResultCache;
+}
+
+// True if 'p' is one of 'args', ignoring case.
+bool has_parameter(const std::string& p, const std::vector<std::string>& args);
+
+// The value of a "/name:value" parameter, or 'default_value' if it is not given.
+std::string parameter_value(const std::string& p, const std::vector<std::string>& args, const std::string& default_value);
+
+void print_usage(std::ostream& err);
+
+/**
+  The command line program, for the arguments after the program name. 'file_text' is the
+  content of the file named by the first argument, or NULL if it could not be opened. Results of
+  RD and RXN files are looked up in and added to 'cache', unless it is NULL.
+**/
+int run_cmdline(const std::vector<std::string>& args, const std::string* file_text, rinchi::ReactionResultCache* cache, std::ostream& out, std::ostream& err);
+
+#endif
@@ -0,0 +1,459 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include "rinchi_platform.h"
+
+// The daemon needs Unix domain sockets; on Windows, rinchi_cmdline.cpp does not call it.
+#ifdef ON_LINUX
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <iomanip>
+#include <list>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <typeinfo>
+
+#include <csignal>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "rinchi_utils.h"
+#include "rinchi_result_cache.h"
+#include "rinchi_lane_scheduler.h"
+
+#include "rinchi_daemon.h"
+
+namespace rinchi_daemon {
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	volatile sig_atomic_t stop_requested = 0;
+
+	void request_stop(int)
+	{
+		stop_requested = 1;
+	}
+
+	class Daemon {
+		private:
+			struct ConnectionThread {
+				std::thread thread;
+				bool finished;
+			};
+
+			CommandHandler m_handler;
+			rinchi::ReactionResultCache m_cache;
+			rinchi::LaneScheduler m_scheduler;
+			size_t m_max_connections;
+
+			std::mutex m_mutex;
+			// One per open connection, for reading requests and writing responses; the scheduler runs the requests.
+			std::list<ConnectionThread> m_connections;
+			// Connections being served, shut down for reading on stop so that their threads do not wait for more requests.
+			std::set<int> m_active;
+
+			// From arrival of a request (acceptance of the connection for the first one) to the response.
+			DurationStats m_latency[rinchi::SCHEDULER_LANE_COUNT];
+			// From arrival of a request until a worker takes it.
+			DurationStats m_queue_wait[rinchi::SCHEDULER_LANE_COUNT];
+			std::atomic<unsigned long> m_requests;
+			std::atomic<unsigned long> m_failed_requests;
+			std::atomic<unsigned long> m_refused_connections;
+
+			void serve(int fd, Clock::time_point accepted, ConnectionThread* connection);
+			// Returns the lane of a RUN request, SCHEDULER_LANE_COUNT for other requests.
+			int handle(const std::vector<std::string>& request, std::vector<std::string>& response);
+			int run(rinchi::SchedulerLane lane, const std::vector<std::string>& request, std::ostream& out, std::ostream& err);
+			void join_connections(bool finished_only);
+		public:
+			Daemon(const DaemonOptions& options, CommandHandler handler);
+
+			unsigned worker_count() const { return m_scheduler.worker_count(); }
+			unsigned reserved_workers() const { return m_scheduler.reserved_workers(); }
+			void accept_connection(int fd);
+			void stop();
+			std::string report();
+	};
+
+	Daemon::Daemon(const DaemonOptions& options, CommandHandler handler):
+		m_handler(handler), m_cache(options.cache_entries), m_scheduler(options.worker_count, options.reserved_workers),
+		m_max_connections(std::max<size_t>(options.max_connections, 1)), m_requests(0), m_failed_requests(0), m_refused_connections(0)
+	{
+	}
+
+	// Starts a thread serving the connection, or answers the first request with an error and closes it.
+	void Daemon::accept_connection(int fd)
+	{
+		Clock::time_point accepted = Clock::now();
+		join_connections(true);
+
+		std::string refusal;
+		{
+			std::lock_guard<std::mutex> lock (m_mutex);
+			if (m_active.size() >= m_max_connections)
+				refusal = "ERROR: The daemon already serves " + std::to_string(m_max_connections) + " connections, try again later.\n";
+			else {
+				m_connections.push_back(ConnectionThread());
+				ConnectionThread* connection = &m_connections.back();
+				connection->finished = false;
+				m_active.insert(fd);
+				try {
+					connection->thread = std::thread(&Daemon::serve, this, fd, accepted, connection);
+				}
+				catch (std::system_error& e) {
+					m_active.erase(fd);
+					m_connections.pop_back();
+					refusal = std::string("ERROR: The daemon cannot start a thread for the connection: ") + e.what() + "\n";
+				}
+			}
+		}
+		if (refusal.empty())
+			return;
+
+		// Sent without reading the request; the client finds it once it has sent its own.
+		m_refused_connections++;
+		std::vector<std::string> response;
+		response.push_back("2");
+		response.push_back("");
+		response.push_back(refusal);
+		write_message(fd, response);
+		close(fd);
+	}
+
+	void Daemon::join_connections(bool finished_only)
+	{
+		std::list<ConnectionThread> done;
+		{
+			std::lock_guard<std::mutex> lock (m_mutex);
+			for (std::list<ConnectionThread>::iterator connection = m_connections.begin(); connection != m_connections.end(); ) {
+				std::list<ConnectionThread>::iterator next = connection;
+				next++;
+				if (connection->finished || !finished_only)
+					done.splice(done.end(), m_connections, connection);
+				connection = next;
+			}
+		}
+		for (std::list<ConnectionThread>::iterator connection = done.begin(); connection != done.end(); connection++)
+			connection->thread.join();
+	}
+
+	void Daemon::serve(int fd, Clock::time_point accepted, ConnectionThread* connection)
+	{
+		std::vector<std::string> request;
+		std::vector<std::string> response;
+		Clock::time_point start = accepted;
+		bool first = true;
+		while (read_message(fd, request)) {
+			if (!first)
+				start = Clock::now();
+			first = false;
+
+			int lane = handle(request, response);
+			if (!write_message(fd, response))
+				break;
+			if (lane < rinchi::SCHEDULER_LANE_COUNT)
+				m_latency[lane].add(Clock::now() - start);
+		}
+
+		std::lock_guard<std::mutex> lock (m_mutex);
+		m_active.erase(fd);
+		close(fd);
+		connection->finished = true;
+	}
+
+	int Daemon::handle(const std::vector<std::string>& request, std::vector<std::string>& response)
+	{
+		m_requests++;
+		response.clear();
+		std::string command = request.empty() ? "" : request[0];
+		if ((command == REQUEST_RUN || command == REQUEST_RUN_BULK) && request.size() >= 3) {
+			rinchi::SchedulerLane lane = command == REQUEST_RUN ? rinchi::LANE_INTERACTIVE : rinchi::LANE_BULK;
+			std::ostringstream out;
+			std::ostringstream err;
+			int exit_code = run(lane, request, out, err);
+			if (exit_code != 0)
+				m_failed_requests++;
+			response.push_back(std::to_string(exit_code));
+			response.push_back(out.str());
+			response.push_back(err.str());
+			return lane;
+		}
+		else if (command == REQUEST_STATS) {
+			response.push_back("0");
+			response.push_back(report());
+			response.push_back("");
+		}
+		else {
+			m_failed_requests++;
+			response.push_back("2");
+			response.push_back("");
+			response.push_back("ERROR: Unknown daemon request '" + command + "'.\n");
+		}
+		return rinchi::SCHEDULER_LANE_COUNT;
+	}
+
+	// Runs the command line program for a RUN request on a worker of the scheduler, and waits for it.
+	int Daemon::run(rinchi::SchedulerLane lane, const std::vector<std::string>& request, std::ostream& out, std::ostream& err)
+	{
+		std::vector<std::string> args (request.begin() + 3, request.end());
+		const std::string* file_text = request[2] == "1" ? &request[1] : NULL;
+		rinchi::ReactionResultCache* cache = m_cache.enabled() ? &m_cache : NULL;
+		try {
+			std::promise<int> exit_code;
+			std::future<int> result = exit_code.get_future();
+			bool submitted = m_scheduler.submit(lane, [&](Clock::duration queue_wait) {
+				m_queue_wait[lane].add(queue_wait);
+				try {
+					exit_code.set_value(m_handler(args, file_text, cache, out, err));
+				}
+				catch (...) {
+					exit_code.set_exception(std::current_exception());
+				}
+			});
+			if (!submitted)
+				throw std::runtime_error("The daemon is stopping.");
+			return result.get();
+		}
+		catch (std::exception& e) {
+			err << "ERROR: " << rinchi::demangled_class_name(typeid(e).name()) << ": " << e.what() << std::endl;
+			return 2;
+		}
+	}
+
+	// Lets the connections finish their current request, then stops the workers once they have run all queued requests.
+	void Daemon::stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock (m_mutex);
+			for (std::set<int>::const_iterator fd = m_active.begin(); fd != m_active.end(); fd++)
+				shutdown(*fd, SHUT_RD);
+		}
+		join_connections(false);
+		m_scheduler.shutdown();
+	}
+
+	std::string Daemon::report()
+	{
+		size_t active;
+		{
+			std::lock_guard<std::mutex> lock (m_mutex);
+			active = m_active.size();
+		}
+		std::ostringstream result;
+		result << "Requests: " << m_requests << " (failed: " << m_failed_requests << ")\n";
+		result << "Workers: " << m_scheduler.worker_count() << " (" << m_scheduler.reserved_workers() << " reserved for interactive requests)"
+			<< ", connections open: " << active << " (at most " << m_max_connections << ", refused: " << m_refused_connections << ")\n";
+		for (int i = 0; i < rinchi::SCHEDULER_LANE_COUNT; i++) {
+			rinchi::SchedulerLane lane = (rinchi::SchedulerLane) i;
+			rinchi::LaneStats stats = m_scheduler.stats(lane);
+			result << "Lane " << rinchi::lane_name(lane) << ": " << stats.submitted << " requests, queued " << stats.queue_depth
+				<< " (peak " << stats.peak_queue_depth << "), running " << stats.running << ", taken by "
+				<< rinchi::lane_name(lane == rinchi::LANE_INTERACTIVE ? rinchi::LANE_BULK : rinchi::LANE_INTERACTIVE) << " workers " << stats.stolen << "\n";
+			result << "  Latency (ms, last " << m_latency[i].sample_count() << " requests): " << m_latency[i].report() << "\n";
+			result << "  Queue wait (ms, last " << m_queue_wait[i].sample_count() << " requests): " << m_queue_wait[i].report() << "\n";
+		}
+		if (m_cache.enabled()) {
+			rinchi::ReactionResultCacheStats cache_stats = m_cache.stats();
+			result << "Result cache: " << cache_stats.entries << " entries, " << cache_stats.hits << " hits, " << cache_stats.misses << " misses"
+				<< std::fixed << std::setprecision(1) << " (hit rate " << cache_stats.hit_rate() * 100 << "%)\n";
+		}
+		return result.str();
+	}
+
+	// Creates the directory of the default socket, or checks that only the user may use it.
+	void make_private_directory(const std::string& directory)
+	{
+		if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST)
+			throw std::runtime_error("Cannot create '" + directory + "': " + strerror(errno));
+		struct stat status;
+		if (lstat(directory.c_str(), &status) != 0 || !S_ISDIR(status.st_mode) || status.st_uid != getuid() || (status.st_mode & 077) != 0)
+			throw std::runtime_error("'" + directory + "' is not a directory that only the user running the daemon may use.");
+	}
+
+	// Binds the listening socket, replacing a stale socket file. Fails if a daemon is already listening.
+	int listen_on(const std::string& path)
+	{
+		if (path.compare(0, private_socket_directory().length() + 1, private_socket_directory() + "/") == 0)
+			make_private_directory(private_socket_directory());
+
+		sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (path.empty() || path.length() >= sizeof(address.sun_path))
+			throw std::runtime_error("Invalid daemon socket path '" + path + "'.");
+		strcpy(address.sun_path, path.c_str());
+
+		int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (probe >= 0) {
+			bool in_use = connect(probe, (sockaddr*) &address, sizeof(address)) == 0;
+			close(probe);
+			if (in_use)
+				throw std::runtime_error("A daemon is already listening on '" + path + "'.");
+		}
+		unlink(path.c_str());
+
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+			throw std::runtime_error(std::string("Cannot create socket: ") + strerror(errno));
+		// Only the user running the daemon may connect.
+		mode_t old_umask = umask(0077);
+		int rc = bind(fd, (sockaddr*) &address, sizeof(address));
+		umask(old_umask);
+		if (rc != 0 || listen(fd, SOMAXCONN) != 0) {
+			std::string message = std::string("Cannot listen on '") + path + "': " + strerror(errno);
+			close(fd);
+			throw std::runtime_error(message);
+		}
+		return fd;
+	}
+
+} // end of anonymous namespace
+
+const size_t DurationStats::SAMPLE_COUNT;
+
+DurationStats::DurationStats(): m_next_sample(0), m_count(0), m_max(0)
+{
+}
+
+void DurationStats::add(std::chrono::steady_clock::duration duration)
+{
+	uint64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+	std::lock_guard<std::mutex> lock (m_mutex);
+	if (m_samples.size() < SAMPLE_COUNT)
+		m_samples.push_back(micros);
+	else
+		m_samples[m_next_sample] = micros;
+	m_next_sample = (m_next_sample + 1) % SAMPLE_COUNT;
+	m_count++;
+	m_max = std::max(m_max, micros);
+}
+
+std::string DurationStats::report() const
+{
+	std::vector<uint64_t> samples;
+	uint64_t max;
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		samples = m_samples;
+		max = m_max;
+	}
+	if (samples.empty())
+		return "no requests";
+	std::sort(samples.begin(), samples.end());
+
+	std::ostringstream result;
+	result << std::fixed << std::setprecision(2);
+	// In integers, as 99.9 / 100 * 1000 is a little more than 999 in floating point.
+	const uint64_t per_mille[] = { 500, 900, 990, 999 };
+	const char* labels[] = { "p50", "p90", "p99", "p99.9" };
+	for (size_t i = 0; i < sizeof(per_mille) / sizeof(per_mille[0]); i++) {
+		size_t rank = (size_t) ((per_mille[i] * samples.size() + 999) / 1000);
+		result << labels[i] << " " << samples[std::max<size_t>(rank, 1) - 1] / 1000.0 << "  ";
+	}
+	result << "max " << max / 1000.0;
+	return result.str();
+}
+
+unsigned long DurationStats::count() const
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	return m_count;
+}
+
+size_t DurationStats::sample_count() const
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	return m_samples.size();
+}
+
+int run_daemon(const DaemonOptions& options, CommandHandler handler, std::ostream& log)
+{
+	int listen_fd = listen_on(options.socket_path);
+
+	// Clients that go away before reading their response must not end the daemon.
+	signal(SIGPIPE, SIG_IGN);
+	stop_requested = 0;
+	signal(SIGINT, request_stop);
+	signal(SIGTERM, request_stop);
+
+	Daemon daemon (options, handler);
+	log << "RInChI daemon listening on '" << options.socket_path << "' with " << daemon.worker_count() << " workers, "
+		<< daemon.reserved_workers() << " reserved for interactive requests." << std::endl;
+
+	while (!stop_requested) {
+		pollfd listening = { listen_fd, POLLIN, 0 };
+		// A timeout, so that a stop request is seen even if no client connects.
+		if (poll(&listening, 1, 200) <= 0)
+			continue;
+		int fd = accept(listen_fd, NULL, NULL);
+		if (fd < 0)
+			continue;
+		// Only the user running the daemon is served, wherever the socket is and whatever its permissions.
+		uid_t uid;
+		if (!peer_uid(fd, uid) || uid != getuid()) {
+			log << "Refused a connection of another user." << std::endl;
+			close(fd);
+			continue;
+		}
+		daemon.accept_connection(fd);
+	}
+
+	close(listen_fd);
+	unlink(options.socket_path.c_str());
+	daemon.stop();
+	log << daemon.report() << std::flush;
+	return 0;
+}
+
+} // end of namespace
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef IUPAC_RINCHI_DAEMON_HEADER_GUARD
+#define IUPAC_RINCHI_DAEMON_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/**
+  "rinchi_cmdline /daemon" keeps a process with the InChI library loaded and its caches warm,
+  and runs the command line program for clients that connect to it over a Unix domain socket.
+  rinchi_client is such a client, with the same arguments and output as rinchi_cmdline.
+
+  The daemon only serves connections of its own user: by default the socket is in a directory
+  private to the user, and the daemon checks the user of each client, and the client that of
+  the daemon.
+
+  Protocol: a message is a list of byte string fields, sent as the number of fields followed by
+  the length and the bytes of each field. Numbers are 32-bit unsigned, big-endian. A client
+  sends a request message and reads back a response message, and may send more requests over
+  the same connection.
+
+    Request                                                 Response
+    RUN, file text, "1" | "0", argument...                  exit code, stdout text, stderr text
+    RUN_BULK, file text, "1" | "0", argument...             exit code, stdout text, stderr text
+    STATS                                                   "0", statistics text, ""
+
+  The arguments of RUN are those of rinchi_cmdline, the file name first. The file is read by
+  the client; the third field is "0" (and the file text blank) if it could not be opened.
+  RUN_BULK is RUN for batch jobs: it is queued in the bulk lane of the daemon's scheduler (see
+  rinchi_lane_scheduler.h), and RUN requests of other clients go first.
+**/
+
+namespace rinchi {
+	class ReactionResultCache;
+}
+
+namespace rinchi_daemon {
+
+const char* const REQUEST_RUN = "RUN";
+const char* const REQUEST_RUN_BULK = "RUN_BULK";
+const char* const REQUEST_STATS = "STATS";
+
+// Overrides the default socket path of daemon and client.
+const char* const SOCKET_PATH_ENV = "RINCHI_DAEMON_SOCKET";
+
+// Messages larger than this are refused.
+const uint32_t MAX_MESSAGE_SIZE = 1u << 30;
+const uint32_t MAX_FIELD_COUNT = 4096;
+
+/**
+  Directory of the default socket when $XDG_RUNTIME_DIR is not set. The daemon creates it,
+  accessible to its user only, and refuses to use it if it belongs to somebody else or others
+  may enter it.
+**/
+inline std::string private_socket_directory()
+{
+	return "/tmp/rinchi_daemon-" + std::to_string((unsigned long) getuid());
+}
+
+// $RINCHI_DAEMON_SOCKET, or rinchi_daemon.sock in $XDG_RUNTIME_DIR or private_socket_directory().
+inline std::string default_socket_path()
+{
+	const char* path = std::getenv(SOCKET_PATH_ENV);
+	if (path && *path)
+		return path;
+	const char* runtime_directory = std::getenv("XDG_RUNTIME_DIR");
+	if (runtime_directory && *runtime_directory)
+		return std::string(runtime_directory) + "/rinchi_daemon.sock";
+	return private_socket_directory() + "/rinchi_daemon.sock";
+}
+
+// The user of the process at the other end of a connected Unix domain socket. Returns false if it cannot be told.
+inline bool peer_uid(int fd, uid_t& uid)
+{
+#ifdef SO_PEERCRED
+	ucred credentials;
+	socklen_t length = sizeof(credentials);
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) != 0)
+		return false;
+	uid = credentials.uid;
+	return true;
+#else
+	gid_t gid;
+	return getpeereid(fd, &uid, &gid) == 0;
+#endif
+}
+
+inline bool write_all(int fd, const char* data, size_t length)
+{
+	while (length > 0) {
+		ssize_t written = write(fd, data, length);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return false;
+		data += written;
+		length -= written;
+	}
+	return true;
+}
+
+// Returns false at end of input or on an error.
+inline bool read_all(int fd, char* data, size_t length)
+{
+	while (length > 0) {
+		ssize_t count = read(fd, data, length);
+		if (count < 0 && errno == EINTR)
+			continue;
+		if (count <= 0)
+			return false;
+		data += count;
+		length -= count;
+	}
+	return true;
+}
+
+inline void append_uint32(std::string& buffer, uint32_t value)
+{
+	buffer += (char) (value >> 24);
+	buffer += (char) (value >> 16);
+	buffer += (char) (value >> 8);
+	buffer += (char) value;
+}
+
+inline bool read_uint32(int fd, uint32_t& value)
+{
+	unsigned char bytes[4];
+	if (!read_all(fd, (char*) bytes, 4))
+		return false;
+	value = ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) | ((uint32_t) bytes[2] << 8) | bytes[3];
+	return true;
+}
+
+inline bool write_message(int fd, const std::vector<std::string>& fields)
+{
+	std::string buffer;
+	append_uint32(buffer, (uint32_t) fields.size());
+	for (std::vector<std::string>::const_iterator field = fields.begin(); field != fields.end(); field++) {
+		append_uint32(buffer, (uint32_t) field->length());
+		buffer += *field;
+	}
+	return write_all(fd, buffer.data(), buffer.length());
+}
+
+// Returns false if the peer closed the connection, on an error, or for a message that is too large.
+inline bool read_message(int fd, std::vector<std::string>& fields)
+{
+	fields.clear();
+	uint32_t field_count;
+	if (!read_uint32(fd, field_count) || field_count > MAX_FIELD_COUNT)
+		return false;
+	uint64_t total_size = 0;
+	fields.resize(field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		uint32_t length;
+		if (!read_uint32(fd, length))
+			return false;
+		total_size += length;
+		if (total_size > MAX_MESSAGE_SIZE)
+			return false;
+		fields[i].resize(length);
+		if (length > 0 && !read_all(fd, &fields[i][0], length))
+			return false;
+	}
+	return true;
+}
+
+/**
+  Server side, in rinchi_daemon.cpp.
+**/
+
+// Runs the command line program for 'args'. 'file_text' is NULL if the file could not be opened.
+typedef std::function<int (const std::vector<std::string>& args, const std::string* file_text, rinchi::ReactionResultCache* cache, std::ostream& out, std::ostream& err)> CommandHandler;
+
+/**
+  Durations of the latest requests, for percentiles. Keeps the last SAMPLE_COUNT of them;
+  the count and maximum are over all requests. May be used from several threads at once.
+**/
+class DurationStats {
+	public:
+		static const size_t SAMPLE_COUNT = 100000;
+
+	private:
+		mutable std::mutex m_mutex;
+		// Microseconds; a ring buffer once full.
+		std::vector<uint64_t> m_samples;
+		size_t m_next_sample;
+		unsigned long m_count;
+		uint64_t m_max;
+
+	public:
+		DurationStats();
+
+		void add(std::chrono::steady_clock::duration duration);
+		// "p50 <ms>  p90 <ms>  p99 <ms>  p99.9 <ms>  max <ms>", nearest-rank percentiles; "no requests" if there are none.
+		std::string report() const;
+		unsigned long count() const;
+		size_t sample_count() const;
+};
+
+struct DaemonOptions {
+	std::string socket_path;
+	// 0: one per hardware thread.
+	unsigned worker_count;
+	// Workers kept for RUN requests; they take RUN_BULK requests only while another of them is idle.
+	unsigned reserved_workers;
+	// Reaction results kept in memory; 0 turns the cache off.
+	size_t cache_entries;
+	// Connections served at once, each by a thread of its own; further clients get an error response.
+	size_t max_connections;
+
+	DaemonOptions(): socket_path(default_socket_path()), worker_count(0), reserved_workers(1), cache_entries(10000), max_connections(256) {}
+};
+
+// Serves requests until SIGINT or SIGTERM, then prints the statistics to 'log'. Returns the exit
+// code of the program; throws std::runtime_error if the socket cannot be set up.
+int run_daemon(const DaemonOptions& options, CommandHandler handler, std::ostream& log);
+
+} // end of namespace
+
+#endif
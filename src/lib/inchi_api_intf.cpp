@@ -39,12 +39,19 @@
 
 #include <inchi_api_intf.h>
 
+#include <mutex>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 #include <rinchi_platform.h>
 #include <rinchi_utils.h>
 
+#ifndef RINCHI_LOAD_INCHI_DYNAMICALLY
+// APP_DESCRIPTION of the built-in InChI sources.
+#include <mode.h>
+#endif
+
 /** PLATFORMS BEGIN **/
 
 /** PLATFORM: WINDOWS **/
@@ -52,6 +59,10 @@
 
 	#include <windows.h>
 
+	#ifdef MSVC
+	#pragma comment(lib, "version.lib")
+	#endif
+
 	#define inchi_lib_handle_type HINSTANCE
 	#define DO_INCHI_LOAD_LIBRARY LoadLibraryA(lib_filename.c_str())
 	#define DO_INCHI_UNLOAD_LIBRARY FreeLibrary
@@ -79,6 +90,8 @@
 #elif defined(ON_LINUX) || defined(ON_SOLARIS)
 
 	#include <dlfcn.h>
+	#include <limits.h>
+	#include <stdlib.h>
 
 	#define inchi_lib_handle_type void*
 	#define DO_INCHI_LOAD_LIBRARY dlopen(lib_filename.c_str(), RTLD_NOW)
@@ -103,6 +116,8 @@ namespace rinchi {
 #if defined(ON_WINDOWS)
 	const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_ON  = "/WarnOnEmptyStructure /ChiralFlagON";
 	const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_OFF = "/WarnOnEmptyStructure /ChiralFlagOFF";
+	const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_ON_AUXNONE  = "/WarnOnEmptyStructure /ChiralFlagON /AuxNone";
+	const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_OFF_AUXNONE = "/WarnOnEmptyStructure /ChiralFlagOFF /AuxNone";
 
 	const char* INCHI_OUTPUT_OPTION_SDF                 = "/WarnOnEmptyStructure /OutputSDF";
 	const char* INCHI_OUTPUT_OPTION_SDF_CHIRAL_FLAG_ON  = "/WarnOnEmptyStructure /OutputSDF /SUCF /ChiralFlagON";
@@ -110,6 +125,8 @@ namespace rinchi {
 #elif defined(ON_LINUX) || defined(ON_SOLARIS)
 	const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_ON  = "-WarnOnEmptyStructure -ChiralFlagON";
 	const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_OFF = "-WarnOnEmptyStructure -ChiralFlagOFF";
+	const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_ON_AUXNONE  = "-WarnOnEmptyStructure -ChiralFlagON -AuxNone";
+	const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_OFF_AUXNONE = "-WarnOnEmptyStructure -ChiralFlagOFF -AuxNone";
 
 	const char* INCHI_OUTPUT_OPTION_SDF = "-WarnOnEmptyStructure -OutputSDF";
 	const char* INCHI_OUTPUT_OPTION_SDF_CHIRAL_FLAG_ON  = "-WarnOnEmptyStructure -OutputSDF -SUCF -ChiralFlagON";
@@ -124,6 +141,7 @@ std::string inchi_lib_path;
 char inchi_lib_path_c_str[INCHI_LIB_PATH_MAX] = "";
 
 inchi_lib_handle_type inchi_lib_handle = 0;
+std::string inchi_lib_loaded_version;
 
 // Lazy-load function forward definitions.
 INCHIGEN_HANDLE lazyload_INCHIGEN_Create();
@@ -149,7 +167,57 @@ int lazyload_Get_inchi_Input_FromAuxInfo(char *szInchiAuxInfo, int bDoNotAddH, i
 // void INCHI_DECL Free_inchi_Input( inchi_Input *pInp )
 void lazyload_Free_inchi_Input( inchi_Input *pInp );
 
-void load_inchi_library()
+#if defined(ON_WINDOWS)
+// File version of the loaded DLL, e.g. "1.06.00".
+std::string loaded_library_version()
+{
+	char file_name[MAX_PATH];
+	DWORD length = GetModuleFileNameA(inchi_lib_handle, file_name, MAX_PATH);
+	if (length == 0 || length == MAX_PATH)
+		throw std::runtime_error (std::string("Unable to get the file name of the InChI library: ") + lib_inchi_sys_errmsg() + ".");
+
+	DWORD ignored;
+	std::vector<char> version_info (GetFileVersionInfoSizeA(file_name, &ignored));
+	VS_FIXEDFILEINFO* file_info = NULL;
+	UINT file_info_size = 0;
+	if (
+		version_info.empty() ||
+		!GetFileVersionInfoA(file_name, 0, (DWORD) version_info.size(), version_info.data()) ||
+		!VerQueryValueA(version_info.data(), "\\", (LPVOID*) &file_info, &file_info_size) ||
+		file_info_size < sizeof(VS_FIXEDFILEINFO)
+	)
+		throw std::runtime_error (std::string("The InChI library '") + file_name + "' has no version resource.");
+
+	std::string minor = int2str(LOWORD(file_info->dwFileVersionMS));
+	std::string build = int2str(HIWORD(file_info->dwFileVersionLS));
+	return int2str(HIWORD(file_info->dwFileVersionMS)) + "." +
+		(minor.length() < 2 ? "0" : "") + minor + "." +
+		(build.length() < 2 ? "0" : "") + build;
+}
+#else
+// Version suffix of the real file name of the loaded library, e.g. "1.06.00" of "libinchi.so.1.06.00".
+std::string loaded_library_version()
+{
+	Dl_info info;
+	if (dladdr((void*) lib_GetINCHI, &info) == 0 || info.dli_fname == NULL)
+		throw std::runtime_error ("Unable to get the file name of the InChI library.");
+	char real_name[PATH_MAX];
+	if (realpath(info.dli_fname, real_name) == NULL)
+		throw std::runtime_error (std::string("Unable to resolve the file name of the InChI library '") + info.dli_fname + "'.");
+
+	std::string file_name (real_name);
+	size_t sep_pos = file_name.find_last_of(DIR_SEPARATOR);
+	if (sep_pos != std::string::npos)
+		file_name.erase(0, sep_pos + 1);
+	const std::string SO_SUFFIX = ".so.";
+	size_t suffix_pos = file_name.find(SO_SUFFIX);
+	if (suffix_pos == std::string::npos || suffix_pos + SO_SUFFIX.length() == file_name.length())
+		throw std::runtime_error ("The file name of the InChI library '" + file_name + "' has no version suffix.");
+	return file_name.substr(suffix_pos + SO_SUFFIX.length());
+}
+#endif
+
+void do_load_inchi_library()
 {
 	if (inchi_lib_path.length() == 0) {
 		inchi_lib_path = inchi_lib_path_c_str;
@@ -234,6 +302,24 @@ void load_inchi_library()
 
 		throw std::runtime_error ("The InChI library was successfully loaded, but it does not contain all the required functions.");
 	}
+
+	inchi_lib_loaded_version = loaded_library_version();
+}
+
+// Left unset if loading throws, so that the next call tries again.
+std::once_flag inchi_lib_load_flag;
+
+// The first calls into the InChI library may come from several threads at once; the others wait
+// for the one that loads it.
+void load_inchi_library()
+{
+	std::call_once(inchi_lib_load_flag, do_load_inchi_library);
+}
+
+const std::string& inchi_lib_version()
+{
+	load_inchi_library();
+	return inchi_lib_loaded_version;
 }
 
 /**
@@ -361,6 +447,32 @@ GetINCHI_funcptr lib_GetINCHI = GetINCHI;
 FreeINCHI_funcptr lib_FreeINCHI = FreeINCHI;
 Get_inchi_Input_FromAuxInfo_funcptr lib_Get_inchi_Input_FromAuxInfo = Get_inchi_Input_FromAuxInfo;
 Free_inchi_Input_funcptr lib_Free_inchi_Input = Free_inchi_Input;
+
+void load_inchi_library()
+{
+}
+
+#ifndef APP_DESCRIPTION
+	#error "APP_DESCRIPTION of the InChI sources (mode.h) is needed for the InChI library version."
+#endif
+
+// Release in the description the InChI sources print, e.g. "1.06" of "InChI version 1, Software v. 1.06".
+std::string built_in_library_version()
+{
+	const std::string description (APP_DESCRIPTION);
+	size_t start = description.find("Software v");
+	if (start != std::string::npos)
+		start = description.find_first_of("0123456789", start);
+	if (start == std::string::npos)
+		throw std::runtime_error ("No software version in the InChI description '" + description + "'.");
+	return description.substr(start, description.find_first_not_of("0123456789.", start) - start);
+}
+
+const std::string& inchi_lib_version()
+{
+	static const std::string result (built_in_library_version());
+	return result;
+}
 #endif
 
 /**
@@ -61,14 +61,26 @@ extern std::string inchi_lib_path;
 extern char inchi_lib_path_c_str[INCHI_LIB_PATH_MAX];
 #endif
 
+// Loads the InChI library now rather than on the first call into it, for processes that would
+// rather find out early that it is missing. Does nothing if the library is linked in.
+void load_inchi_library();
+
 /** InChI options **/
 extern const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_ON;
 extern const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_OFF;
+// As above, but have the InChI library skip generating AuxInfo.
+extern const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_ON_AUXNONE;
+extern const char* INCHI_INPUT_OPTION_CHIRAL_FLAG_OFF_AUXNONE;
 
 extern const char* INCHI_OUTPUT_OPTION_SDF;
 extern const char* INCHI_OUTPUT_OPTION_SDF_CHIRAL_FLAG_ON;
 extern const char* INCHI_OUTPUT_OPTION_SDF_CHIRAL_FLAG_OFF;
 
+// Release of the InChI library in use, e.g. "1.06". Built-in InChI sources report the release in
+// their APP_DESCRIPTION; a dynamically loaded library is loaded by this call and reports it in its
+// version resource (Windows) or in the suffix of its real file name, e.g. "libinchi.so.1.06.00".
+const std::string& inchi_lib_version();
+
 /** InChI generator interface **/
 
 // INCHIGEN_HANDLE INCHIGEN_Create(void);
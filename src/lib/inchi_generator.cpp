@@ -38,11 +38,14 @@
 #endif
 
 #include <algorithm>
+#include <mutex>
 #include <sstream>
 
 #include "inchi_generator.h"
 
 #include "inchi_api_intf.h"
+#include "inchi_auxinfo_reader.h"
+#include "mdl_molfile_writer.h"
 #include "rinchi_consts.h"
 #include "rinchi_utils.h"
 
@@ -78,12 +81,25 @@ struct InChIState {
 
 } inchi_lib_state;
 
+// Held while 'inchi_lib_state' is used: the modularized InChI API works on the one handle in it.
+std::mutex inchi_lib_state_mutex;
+
+void create_generator_handle()
+{
+	std::lock_guard<std::mutex> lock (inchi_lib_state_mutex);
+	if (inchi_lib_state.generator_handle == 0)
+		inchi_lib_state.generator_handle = lib_INCHIGEN_Create();
+}
+
 /*
-  Temporary InChI generation call state with guaranteed cleanup.
+  Temporary InChI generation call state with guaranteed cleanup. Holds the lock on the
+  library state for its lifetime.
 */
 class InChICallState {
+private:
+	std::lock_guard<std::mutex> m_lock;
 public:
-	InChICallState()
+	InChICallState(): m_lock(inchi_lib_state_mutex)
 	{
 		if (inchi_lib_state.generator_handle == 0)
 			inchi_lib_state.generator_handle = lib_INCHIGEN_Create();
@@ -185,7 +201,11 @@ void InChIGenerator::calculate_inchi(inchi_Input& inchi_input, std::string& o_in
         int rc = lib_GetINCHI(&inchi_input, &inchi_output);
         if (rc == inchi_Ret_OKAY || rc == inchi_Ret_WARNING) {
             o_inchi_string = inchi_output.szInChI;
-            o_aux_info     = inchi_output.szAuxInfo;
+            // No AuxInfo is returned if it was switched off by the input options.
+            if (inchi_output.szAuxInfo != NULL)
+                o_aux_info = inchi_output.szAuxInfo;
+            else
+                o_aux_info.clear();
         }
         lib_FreeINCHI(&inchi_output);
         InChICallState::check_return_code(rc);
@@ -246,13 +266,17 @@ std::string InChIGenerator::inchi_key(inchi_Input& inchi_input)
 
 std::string InChIGenerator::inchi_string2key(const std::string& inchi_string)
 {
+	// Local buffers, so that several threads can generate keys at once. Sizes as in InChIState.
+	char inchi_key[32];
+	char xtra1[65];
+	char xtra2[65];
 	int return_code = lib_GetINCHIKeyFromINCHI(
 		inchi_string.c_str(), 0, 0,
-		inchi_lib_state.inchi_key, inchi_lib_state.xtra1, inchi_lib_state.xtra2
+		inchi_key, xtra1, xtra2
 	);
 	InChICallState::check_key_return_code(return_code);
 
-	return inchi_lib_state.inchi_key;
+	return inchi_key;
 }
 
 /** InChIToStructureConverter **/
@@ -261,8 +285,7 @@ InChIToStructureConverter::InChIToStructureConverter()
 {
 	reset();
 
-	if (inchi_lib_state.generator_handle == 0)
-		inchi_lib_state.generator_handle = lib_INCHIGEN_Create();
+	create_generator_handle();
 }
 
 InChIToStructureConverter::~InChIToStructureConverter()
@@ -275,6 +298,11 @@ void InChIToStructureConverter::free_inchi_structs()
 	// Zero pointers to strings that we own - just in case.
 	m_input_inchi.szOptions = NULL;
 
+	if (m_owns_input_atoms) {
+		delete[] m_input_inchi.atom;
+		m_input_inchi.atom = NULL;
+		m_owns_input_atoms = false;
+	}
 	lib_Free_inchi_Input(&m_input_inchi);
 	lib_FreeINCHI(&m_output);
 	lib_FreeStructFromINCHI(&m_output_struct);
@@ -289,6 +317,7 @@ void InChIToStructureConverter::reset()
 	memset(&m_input_inchi_struct, 0, sizeof(m_input_inchi_struct));
 	memset(&m_output_struct, 0, sizeof(m_output_struct));
 
+	m_owns_input_atoms = false;
 }
 
 const
@@ -299,7 +328,7 @@ const
 	  "  0  0  0  0  0  0  0  0  0  0999 V2000\n"
 	  "M  END\n";
 
-std::string InChIToStructureConverter::to_molfile(const std::string& inchi_string, const std::string& auxinfo)
+int InChIToStructureConverter::rebuild_structure(const std::string& inchi_string, const std::string& auxinfo, bool use_inchi_lib_parser)
 {
 	if (m_input_data.pInp != NULL) {
 		free_inchi_structs();
@@ -308,25 +337,24 @@ std::string InChIToStructureConverter::to_molfile(const std::string& inchi_strin
 
 	m_input_data.pInp = &m_input_inchi;
 
-	std::string full_input = inchi_string;
-	// We need to handle InChI No-Structures explicitly. Apparently InChI can't convert an empty
-	// InChI into a No-Structure molfile.
-	if (full_input == rinchi::NOSTRUCT_INCHI) {
-		return NO_STRUCTURE_MOLFILE;
-	}
-
 	int output_chiral_flag = 0;
-	// If we have AuxInfo, then rebuild the structure from that.
-	if (!auxinfo.empty()) {
-		full_input += "\n" + auxinfo;
+	// If we have AuxInfo, then rebuild the structure from that. Reading the reversibility layers
+	// ourselves spares the InChI library parsing the InChI string alongside the AuxInfo.
+	if (!auxinfo.empty() && !use_inchi_lib_parser && InChIAuxInfoReader::has_structure_layers(auxinfo)) {
+		m_owns_input_atoms = true;
+		output_chiral_flag = InChIAuxInfoReader().read_structure(auxinfo, m_input_inchi);
+	}
+	else if (!auxinfo.empty()) {
+		std::string full_input = inchi_string + "\n" + auxinfo;
 		InChICallState::check_return_code(lib_Get_inchi_Input_FromAuxInfo((char*) full_input.c_str(), 0, 0, &m_input_data));
 		// Information extracted from AuxInfo on the use of the MDL chiral flag is returned into m_input_data.bChiral.
 		// Thanks to Igor Pletnev for clearing that up.
 		output_chiral_flag = m_input_data.bChiral;
 	}
 	else {
-		m_input_inchi_struct.szInChI = (char*) full_input.c_str();
+		m_input_inchi_struct.szInChI = (char*) inchi_string.c_str();
 		InChICallState::check_return_code(lib_GetStructFromINCHI(&m_input_inchi_struct, &m_output_struct));
+		m_input_inchi_struct.szInChI = NULL;
 
 		// Take ownership of returned atom data from 'm_output_struct'.
 		m_input_inchi.atom         = m_output_struct.atom;
@@ -337,7 +365,37 @@ std::string InChIToStructureConverter::to_molfile(const std::string& inchi_strin
 		m_output_struct.stereo0D = NULL;
 	}
 
-	// Convert inchi_Input returned from above to SD record. Differing options are needed to
+	return output_chiral_flag;
+}
+
+std::string InChIToStructureConverter::to_molfile(const std::string& inchi_string, const std::string& auxinfo)
+{
+	// We need to handle InChI No-Structures explicitly. Apparently InChI can't convert an empty
+	// InChI into a No-Structure molfile.
+	if (inchi_string == rinchi::NOSTRUCT_INCHI)
+		return NO_STRUCTURE_MOLFILE;
+
+	int output_chiral_flag = rebuild_structure(inchi_string, auxinfo);
+
+	// Our writer has no way to express 0D stereo (structures rebuilt without AuxInfo); the InChI
+	// library's SD output keeps it.
+	if (m_input_inchi.num_stereo0D > 0)
+		return write_molfile_using_inchi_lib(output_chiral_flag);
+
+	// Writing the molfile ourselves saves a full GetINCHI() call per component compared to
+	// having the InChI library print an SD record.
+	return MdlMolfileWriter().to_molfile(m_input_inchi, output_chiral_flag);
+}
+
+void InChIToStructureConverter::check_structure(const std::string& inchi_string, const std::string& auxinfo)
+{
+	if (inchi_string != rinchi::NOSTRUCT_INCHI)
+		rebuild_structure(inchi_string, auxinfo);
+}
+
+std::string InChIToStructureConverter::write_molfile_using_inchi_lib(int output_chiral_flag)
+{
+	// Convert 'm_input_inchi' to SD record. Differing options are needed to
 	// avoid losing chirality information in output.
 	// (char*) cast to avoid "warning: deprecated conversion from string constant to ‘char*’" from gcc.
 	if (output_chiral_flag == 1)
@@ -368,4 +426,14 @@ std::string InChIToStructureConverter::to_molfile(const std::string& inchi_strin
 	return result;
 }
 
+#ifdef IN_RINCHI_TEST_SUITE
+std::string InChIToStructureConverter::to_molfile_using_inchi_lib(const std::string& inchi_string, const std::string& auxinfo)
+{
+	if (inchi_string == rinchi::NOSTRUCT_INCHI)
+		return NO_STRUCTURE_MOLFILE;
+
+	return write_molfile_using_inchi_lib(rebuild_structure(inchi_string, auxinfo, true));
+}
+#endif
+
 } // End of namespace.
@@ -55,6 +55,10 @@ class InChIGenerator {
 public:
 	InChIGenerator () {}
 
+	// All members may run on several threads at once, also before the InChI library is loaded.
+	// calculate_inchi(), validate_inchi() and inchi_string2key() only call stateless functions
+	// of the InChI library with buffers of their own; inchi_key() shares the library's single
+	// generator handle, so calls to it run one at a time.
 	void calculate_inchi(inchi_Input& inchi_input, std::string& o_inchi_string, std::string& o_aux_info);
 	void validate_inchi(const std::string& inchi_string);
 
@@ -73,14 +77,29 @@ private:
 	// Following two used to generate 0D structure.
 	inchi_InputINCHI m_input_inchi_struct;
 	inchi_OutputStruct m_output_struct;
+	// True if 'm_input_inchi.atom' was allocated by InChIAuxInfoReader rather than the InChI library.
+	bool m_owns_input_atoms;
 	//
 	void free_inchi_structs();
 	void reset();
+	// Fills 'm_input_inchi' and returns the chiral flag in InchiInpData.bChiral format.
+	// AuxInfo with reversibility layers is parsed by InChIAuxInfoReader unless 'use_inchi_lib_parser'.
+	int rebuild_structure(const std::string& inchi_string, const std::string& auxinfo, bool use_inchi_lib_parser = false);
+	// Has the InChI library write 'm_input_inchi' as a molfile.
+	std::string write_molfile_using_inchi_lib(int output_chiral_flag);
 public:
 	InChIToStructureConverter();
 	~InChIToStructureConverter();
 
 	std::string to_molfile(const std::string& inchi_string, const std::string& auxinfo);
+	// Rebuilds the structure without writing it out, throwing if InChI/AuxInfo are not valid.
+	void check_structure(const std::string& inchi_string, const std::string& auxinfo);
+#ifdef IN_RINCHI_TEST_SUITE
+	// Has the InChI library rebuild the structure and write the molfile, like to_molfile() did
+	// before it got its own AuxInfo reader and molfile writer (and still does for 0D stereo).
+	// Kept as a reference for regression testing.
+	std::string to_molfile_using_inchi_lib(const std::string& inchi_string, const std::string& auxinfo);
+#endif
 };
 
 } // End of namespace.
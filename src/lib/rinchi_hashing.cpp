@@ -65,6 +65,11 @@ std::string sha256hex(const std::string& input)
 	return result.str();
 }
 
+void sha256(const std::string& input, unsigned char result[32])
+{
+	sha2_csum((unsigned char*) input.c_str(), (int) input.length(), result);
+}
+
 std::string hash04char(const std::string& input)
 {
 	unsigned char chksum[32];
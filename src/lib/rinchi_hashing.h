@@ -50,6 +50,9 @@ namespace rinchi {
 // Full SHA checksum in hexadecimal (32 chars).
 std::string sha256hex(const std::string& input);
 
+// Full SHA checksum as 32 raw bytes.
+void sha256(const std::string& input, unsigned char result[32]);
+
 // 4-char InChI encoding, representing the first 18.66 bits of SHA checksum.
 std::string hash04char(const std::string& input);
 
@@ -45,16 +45,19 @@ namespace rinchi {
 
 void RInChILogger::clear()
 {
+	std::lock_guard<std::mutex> lock(m_mutex);
 	m_msg_list.clear();
 }
 
 void RInChILogger::log(const std::string& msg)
 {
+	std::lock_guard<std::mutex> lock(m_mutex);
 	m_msg_list.push_back(msg);
 }
 
 std::string RInChILogger::all_msgs()
 {
+	std::lock_guard<std::mutex> lock(m_mutex);
 	std::stringstream result;
 	for (StringVector::const_iterator s = m_msg_list.begin(); s != m_msg_list.end(); s++)
 		result << *s << "\n";
@@ -64,7 +67,7 @@ std::string RInChILogger::all_msgs()
 
 RInChILogger& default_warning_logger()
 {
-	static RInChILogger _default_instance = RInChILogger();
+	static RInChILogger _default_instance;
 	return _default_instance;
 }
 
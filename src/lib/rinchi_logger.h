@@ -40,15 +40,19 @@
 #pragma endregion
 #endif
 
+#include <mutex>
+
 #include "rinchi_utils.h"
 
 namespace rinchi {
 
 /**
   Log messages to an internal list. Used by RInChI readers and writers to log warnings.
+  Readers on several threads may share a logger (the default one in particular).
   **/
 class RInChILogger {
 private:
+	std::mutex m_mutex;
 	StringVector m_msg_list;
 public:
 	void clear();
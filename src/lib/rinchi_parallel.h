@@ -0,0 +1,87 @@
+#ifndef IUPAC_RINCHI_PARALLEL_HEADER_GUARD
+#define IUPAC_RINCHI_PARALLEL_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace rinchi {
+
+/**
+  Calls 'function' once with each index from 0 to 'count' - 1, on up to 'max_threads' threads
+  (0: one per hardware thread), the calling thread being one of them. Returns when all calls
+  have returned. 'function' must not throw.
+
+  If no more threads can be started, the ones already running do the remaining work.
+**/
+template <typename Function> void parallel_for(size_t count, unsigned max_threads, Function function)
+{
+	if (count == 0)
+		return;
+
+	std::atomic<size_t> next_idx(0);
+	auto run = [&]() {
+		for (size_t idx = next_idx++; idx < count; idx = next_idx++)
+			function(idx);
+	};
+
+	if (max_threads == 0)
+		max_threads = std::max(1u, std::thread::hardware_concurrency());
+	std::vector<std::thread> workers;
+	size_t worker_count = std::min<size_t>(max_threads, count);
+	try {
+		for (size_t i = 1; i < worker_count; i++)
+			workers.push_back(std::thread(run));
+	}
+	catch (std::system_error&) {
+		// Out of threads; the ones already running and this one will do the remaining work.
+	}
+	run();
+	for (std::vector<std::thread>::iterator worker = workers.begin(); worker != workers.end(); worker++)
+		worker->join();
+}
+
+} // end of namespace
+
+#endif
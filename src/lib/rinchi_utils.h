@@ -44,6 +44,7 @@
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
+#include <streambuf>
 #include "rinchi_platform.h"
 
 #if defined(ON_LINUX) || defined(ON_SOLARIS)
@@ -174,6 +175,107 @@ const std::string demangled_class_name(std::string class_name);
 // Platform-agnostic version of std::getline(), handling Windows-, Mac-, or UNIX-like line feeds.
 void rinchi_getline(std::istream& input, std::string& s);
 
+/**
+  Read-only stream buffer over memory owned by the caller, so that a file text can be read
+  through a std::istream without copying it. Supports the seeks done by the readers.
+**/
+class MemoryStreamBuffer: public std::streambuf {
+	public:
+		MemoryStreamBuffer(const char* data, size_t length)
+		{
+			char* begin = const_cast<char*>(data);
+			setg(begin, begin, begin + length);
+		}
+
+	protected:
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which = std::ios_base::in)
+		{
+			if (!(which & std::ios_base::in))
+				return pos_type(off_type(-1));
+
+			char* origin = direction == std::ios_base::beg ? eback() : direction == std::ios_base::cur ? gptr() : egptr();
+			if (offset < eback() - origin || offset > egptr() - origin)
+				return pos_type(off_type(-1));
+
+			setg(eback(), origin + offset, egptr());
+			return pos_type(off_type(gptr() - eback()));
+		}
+
+		pos_type seekpos(pos_type position, std::ios_base::openmode which = std::ios_base::in)
+		{
+			return seekoff(off_type(position), std::ios_base::beg, which);
+		}
+};
+
+/**
+  Read-only stream buffer over a list of memory chunks owned by the caller, read as one text
+  without joining them. Supports the seeks done by the readers, also across chunks.
+**/
+class ChunkListStreamBuffer: public std::streambuf {
+	public:
+		ChunkListStreamBuffer(): m_chunk(0) { m_starts.push_back(0); }
+
+		// Chunks can only be added before reading starts.
+		void add_chunk(const char* data, size_t length)
+		{
+			if (length == 0)
+				return;
+			m_chunks.push_back(std::make_pair(data, length));
+			m_starts.push_back(m_starts.back() + (off_type) length);
+			if (m_chunks.size() == 1)
+				set_chunk(0, 0);
+		}
+
+	protected:
+		int_type underflow()
+		{
+			if (gptr() < egptr())
+				return traits_type::to_int_type(*gptr());
+			if (m_chunk + 1 >= m_chunks.size())
+				return traits_type::eof();
+
+			set_chunk(m_chunk + 1, 0);
+			return traits_type::to_int_type(*gptr());
+		}
+
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which = std::ios_base::in)
+		{
+			if (!(which & std::ios_base::in))
+				return pos_type(off_type(-1));
+
+			off_type current = m_chunks.empty() ? 0 : m_starts[m_chunk] + (gptr() - eback());
+			off_type origin = direction == std::ios_base::beg ? 0 : direction == std::ios_base::cur ? current : m_starts.back();
+			off_type position = origin + offset;
+			if (position < 0 || position > m_starts.back())
+				return pos_type(off_type(-1));
+
+			if (!m_chunks.empty()) {
+				// The last chunk that starts at or before 'position'; the end of the text is the end of the last chunk.
+				size_t chunk = std::upper_bound(m_starts.begin(), m_starts.begin() + m_chunks.size(), position) - m_starts.begin() - 1;
+				set_chunk(chunk, position - m_starts[chunk]);
+			}
+			return pos_type(position);
+		}
+
+		pos_type seekpos(pos_type position, std::ios_base::openmode which = std::ios_base::in)
+		{
+			return seekoff(off_type(position), std::ios_base::beg, which);
+		}
+
+	private:
+		void set_chunk(size_t chunk, off_type offset)
+		{
+			char* begin = const_cast<char*>(m_chunks[chunk].first);
+			setg(begin, begin + offset, begin + m_chunks[chunk].second);
+			m_chunk = chunk;
+		}
+
+		std::vector< std::pair<const char*, size_t> > m_chunks;
+		// Text position of the start of each chunk, and the text length at the end.
+		std::vector<off_type> m_starts;
+		size_t m_chunk;
+};
+
 } // end of namespace
 
 #endif
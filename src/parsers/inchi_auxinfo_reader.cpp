@@ -0,0 +1,379 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <rinchi_utils.h>
+
+#include <inchi_auxinfo_reader.h>
+
+namespace rinchi {
+
+namespace {
+
+	const char AUXINFO_PREFIX[] = "AuxInfo=";
+	const char DELIM_LAYER_CHAR = '/';
+	const char DELIM_ENTRY_CHAR = ';';
+	const char DELIM_COORDINATE_CHAR = ',';
+
+	const int MAX_ATOM_COUNT = std::numeric_limits<AT_NUM>::max();
+	// Enough digits for any coordinate the InChI library writes, without overflowing the mantissa.
+	const int MAX_COORDINATE_DIGITS = 18;
+
+	struct Layer {
+		const char* begin;
+		const char* end;
+		Layer(): begin(NULL), end(NULL) {}
+		bool present() const { return begin != NULL; }
+		std::string text() const { return std::string(begin, end); }
+	};
+
+	struct AuxInfoLayers {
+		Layer atoms;            // "/rA:"
+		Layer bonds;            // "/rB:"
+		Layer coordinates;      // "/rC:"
+		Layer double_bond_0D;   // "/rD:"
+		Layer tetrahedral_0D;   // "/rT:"
+	};
+
+	bool layer_name_is(const char* name_begin, const char* name_end, const char* name)
+	{
+		size_t length = strlen(name);
+		return (size_t) (name_end - name_begin) == length && strncmp(name_begin, name, length) == 0;
+	}
+
+	void split_into_layers(const char* begin, const char* end, AuxInfoLayers& result)
+	{
+		size_t prefix_length = strlen(AUXINFO_PREFIX);
+		if ((size_t) (end - begin) >= prefix_length && strncmp(begin, AUXINFO_PREFIX, prefix_length) == 0)
+			begin += prefix_length;
+
+		const char* layer_start = begin;
+		while (layer_start < end) {
+			const char* layer_end = layer_start;
+			while (layer_end != end && *layer_end != DELIM_LAYER_CHAR)
+				layer_end++;
+			const char* colon = layer_start;
+			while (colon != layer_end && *colon != ':')
+				colon++;
+			if (colon != layer_end) {
+				Layer layer;
+				layer.begin = colon + 1;
+				layer.end = layer_end;
+				if (layer_name_is(layer_start, colon, "rA"))
+					result.atoms = layer;
+				else if (layer_name_is(layer_start, colon, "rB"))
+					result.bonds = layer;
+				else if (layer_name_is(layer_start, colon, "rC"))
+					result.coordinates = layer;
+				else if (layer_name_is(layer_start, colon, "rD"))
+					result.double_bond_0D = layer;
+				else if (layer_name_is(layer_start, colon, "rT"))
+					result.tetrahedral_0D = layer;
+			}
+			layer_start = layer_end + 1;
+		}
+	}
+
+	void throw_invalid(const Layer& layer, const std::string& layer_name, const std::string& reason)
+	{
+		throw InChIAuxInfoReaderError("Invalid AuxInfo layer '/" + layer_name + ":" + layer.text() + "': " + reason + ".");
+	}
+
+	// Reads an unsigned decimal number; returns -1 if 'c' is not at a digit.
+	int read_number(const char*& c, const char* end)
+	{
+		if (c == end || !isdigit(*c))
+			return -1;
+		int result = 0;
+		while (c != end && isdigit(*c)) {
+			// Anything this large fails every range check; just keep it from overflowing.
+			if (result <= MAX_ATOM_COUNT)
+				result = result * 10 + (*c - '0');
+			c++;
+		}
+		return result;
+	}
+
+	// Reads the "/rA:" layer, e.g. "5nCCC.i13N3+O-", into 'atoms'. Returns the chiral flag.
+	int read_atoms(const Layer& layer, std::vector<inchi_Atom>& atoms)
+	{
+		const char* c = layer.begin;
+		int atom_count = read_number(c, layer.end);
+		if (atom_count < 0 || atom_count > MAX_ATOM_COUNT)
+			throw_invalid(layer, "rA", "missing or invalid atom count");
+
+		int chiral_flag = 0;
+		if (c != layer.end && *c == 'c') {
+			chiral_flag = 1;
+			c++;
+		}
+		else if (c != layer.end && *c == 'n') {
+			chiral_flag = 2;
+			c++;
+		}
+
+		atoms.resize(atom_count);
+		int atom_index = 0;
+		while (c != layer.end) {
+			if (atom_index == atom_count)
+				throw_invalid(layer, "rA", "more atoms than the atom count");
+			inchi_Atom& atom = atoms[atom_index++];
+
+			// Element symbol: a capital letter followed by lower case letters.
+			if (!isupper(*c))
+				throw_invalid(layer, "rA", "element symbol expected");
+			const char* symbol_start = c++;
+			while (c != layer.end && islower(*c))
+				c++;
+			if (c - symbol_start >= ATOM_EL_LEN)
+				throw_invalid(layer, "rA", "element symbol too long");
+			memcpy(atom.elname, symbol_start, c - symbol_start);
+			atom.elname[c - symbol_start] = 0;
+
+			// Optional valence. Its implied hydrogen count is fixed up once the bonds are known; for
+			// now keep the valence in num_iso_H[0] with the "not set" value as -1.
+			int valence = read_number(c, layer.end);
+			atom.num_iso_H[0] = (S_CHAR) (valence < 0 ? -1 : std::min(valence, (int) std::numeric_limits<S_CHAR>::max()));
+
+			// Optional charge: sign followed by an optional magnitude.
+			if (c != layer.end && (*c == '+' || *c == '-')) {
+				int sign = *c++ == '+' ? 1 : -1;
+				int magnitude = read_number(c, layer.end);
+				if (magnitude > std::numeric_limits<S_CHAR>::max())
+					throw_invalid(layer, "rA", "charge out of range");
+				atom.charge = (S_CHAR) (sign * (magnitude < 0 ? 1 : magnitude));
+			}
+
+			// Optional radical (".<digit>") and isotopic mass (".i<mass>").
+			while (c != layer.end && *c == '.') {
+				c++;
+				if (c != layer.end && *c == 'i') {
+					c++;
+					int mass = read_number(c, layer.end);
+					if (mass < 1 || mass > std::numeric_limits<AT_NUM>::max())
+						throw_invalid(layer, "rA", "invalid isotopic mass");
+					atom.isotopic_mass = (AT_NUM) mass;
+				}
+				else {
+					int radical = read_number(c, layer.end);
+					if (radical < INCHI_RADICAL_SINGLET || radical > INCHI_RADICAL_TRIPLET)
+						throw_invalid(layer, "rA", "invalid radical");
+					atom.radical = (S_CHAR) radical;
+				}
+			}
+		}
+		if (atom_index != atom_count)
+			throw_invalid(layer, "rA", "fewer atoms than the atom count");
+
+		return chiral_flag;
+	}
+
+	// Reads the "/rB:" layer, e.g. "s1;d2;s2N3;", which lists the bonds of atoms 2..n to lower
+	// numbered atoms. Bonds are stored on the listing atom only, which is how the InChI library
+	// reads molfiles too.
+	void read_bonds(const Layer& layer, std::vector<inchi_Atom>& atoms)
+	{
+		const char* c = layer.begin;
+		int atom_index = 1;
+		while (c != layer.end) {
+			if (*c == DELIM_ENTRY_CHAR) {
+				atom_index++;
+				c++;
+				continue;
+			}
+			if (atom_index >= (int) atoms.size())
+				throw_invalid(layer, "rB", "more entries than atoms");
+
+			char bond_code = *c++;
+			int bond_type = INCHI_BOND_TYPE_SINGLE;
+			int bond_stereo = INCHI_BOND_STEREO_NONE;
+			switch (bond_code) {
+				case 's': break;
+				case 'd': bond_type = INCHI_BOND_TYPE_DOUBLE; break;
+				case 't': bond_type = INCHI_BOND_TYPE_TRIPLE; break;
+				case 'a': bond_type = INCHI_BOND_TYPE_ALTERN; break;
+				case 'w': bond_type = INCHI_BOND_TYPE_DOUBLE; bond_stereo = INCHI_BOND_STEREO_DOUBLE_EITHER; break;
+				// Wedges; lower case has the narrow end at the listing atom, upper case at the neighbour.
+				case 'p': bond_stereo = INCHI_BOND_STEREO_SINGLE_1UP; break;
+				case 'P': bond_stereo = INCHI_BOND_STEREO_SINGLE_2UP; break;
+				case 'n': bond_stereo = INCHI_BOND_STEREO_SINGLE_1DOWN; break;
+				case 'N': bond_stereo = INCHI_BOND_STEREO_SINGLE_2DOWN; break;
+				case 'v': bond_stereo = INCHI_BOND_STEREO_SINGLE_1EITHER; break;
+				case 'V': bond_stereo = INCHI_BOND_STEREO_SINGLE_2EITHER; break;
+				default:
+					throw_invalid(layer, "rB", std::string("unknown bond code '") + bond_code + "'");
+			}
+
+			int neighbor = read_number(c, layer.end);
+			if (neighbor < 1 || neighbor > atom_index)
+				throw_invalid(layer, "rB", "invalid neighbour atom number");
+
+			inchi_Atom& atom = atoms[atom_index];
+			if (atom.num_bonds == MAXVAL)
+				throw_invalid(layer, "rB", "too many bonds on atom " + int2str(atom_index + 1));
+			atom.neighbor[atom.num_bonds] = (AT_NUM) (neighbor - 1);
+			atom.bond_type[atom.num_bonds] = (S_CHAR) bond_type;
+			atom.bond_stereo[atom.num_bonds] = (S_CHAR) bond_stereo;
+			atom.num_bonds++;
+		}
+		// Entries are ';'-terminated, but be lenient about the last terminator.
+		int atom_count = std::max((int) atoms.size(), 1);
+		if (atom_index > atom_count || atom_index < atom_count - 1)
+			throw_invalid(layer, "rB", "entry count does not match atom count");
+	}
+
+	// Reads a coordinate as written by the InChI library: optional sign, digits with an optional
+	// decimal point and no exponent (".4125", "-1.127", "0"). An empty field is 0.
+	double read_coordinate(const Layer& layer, const char*& c)
+	{
+		bool is_negative = false;
+		if (c != layer.end && (*c == '-' || *c == '+'))
+			is_negative = *c++ == '-';
+
+		long long mantissa = 0;
+		long long divisor = 1;
+		int digit_count = 0;
+		bool seen_point = false;
+		for (; c != layer.end && *c != DELIM_COORDINATE_CHAR && *c != DELIM_ENTRY_CHAR; c++) {
+			if (*c == '.' && !seen_point)
+				seen_point = true;
+			else if (isdigit(*c) && digit_count < MAX_COORDINATE_DIGITS) {
+				mantissa = mantissa * 10 + (*c - '0');
+				if (seen_point)
+					divisor *= 10;
+				digit_count++;
+			}
+			else
+				throw_invalid(layer, "rC", "invalid coordinate");
+		}
+		// For the few digits the InChI library writes both operands are exact, so the quotient is
+		// correctly rounded just like strtod() would return it - without strtod()'s locale dependency.
+		double value = (double) mantissa / (double) divisor;
+		return is_negative ? -value : value;
+	}
+
+	// Reads the "/rC:" layer, e.g. "-1.127,-.5635,0;.4125,,0;;".
+	void read_coordinates(const Layer& layer, std::vector<inchi_Atom>& atoms)
+	{
+		const char* c = layer.begin;
+		size_t atom_index = 0;
+		while (c != layer.end) {
+			if (atom_index == atoms.size())
+				throw_invalid(layer, "rC", "more entries than atoms");
+			inchi_Atom& atom = atoms[atom_index++];
+			double* coordinates[] = { &atom.x, &atom.y, &atom.z };
+			for (int i = 0; i < 3 && c != layer.end && *c != DELIM_ENTRY_CHAR; i++) {
+				if (i > 0) {
+					if (*c != DELIM_COORDINATE_CHAR)
+						throw_invalid(layer, "rC", "',' expected");
+					c++;
+				}
+				*coordinates[i] = read_coordinate(layer, c);
+			}
+			if (c != layer.end) {
+				if (*c != DELIM_ENTRY_CHAR)
+					throw_invalid(layer, "rC", "';' expected");
+				c++;
+			}
+		}
+	}
+
+	int bond_order(int bond_type)
+	{
+		return (bond_type == INCHI_BOND_TYPE_DOUBLE || bond_type == INCHI_BOND_TYPE_TRIPLE) ? bond_type : 1;
+	}
+
+	// Turns explicit valences kept in num_iso_H[0] into implicit hydrogen counts.
+	void set_implicit_hydrogens(std::vector<inchi_Atom>& atoms)
+	{
+		std::vector<int> bonds_used(atoms.size(), 0);
+		for (size_t a = 0; a < atoms.size(); a++) {
+			for (int b = 0; b < atoms[a].num_bonds; b++) {
+				int order = bond_order(atoms[a].bond_type[b]);
+				bonds_used[a] += order;
+				bonds_used[atoms[a].neighbor[b]] += order;
+			}
+		}
+		for (size_t a = 0; a < atoms.size(); a++) {
+			if (atoms[a].num_iso_H[0] >= 0)
+				atoms[a].num_iso_H[0] = (S_CHAR) std::max(0, atoms[a].num_iso_H[0] - bonds_used[a]);
+		}
+	}
+
+} // end of anonymous namespace
+
+bool InChIAuxInfoReader::has_structure_layers(const char* begin, const char* end)
+{
+	AuxInfoLayers layers;
+	split_into_layers(begin, end, layers);
+	return layers.atoms.present() && layers.bonds.present() && !layers.double_bond_0D.present() && !layers.tetrahedral_0D.present();
+}
+
+int InChIAuxInfoReader::read_structure(const char* begin, const char* end, inchi_Input& result)
+{
+	AuxInfoLayers layers;
+	split_into_layers(begin, end, layers);
+	if (!layers.atoms.present() || !layers.bonds.present())
+		throw InChIAuxInfoReaderError("AuxInfo '" + std::string(begin, end) + "' has no reversibility layers.");
+	if (layers.double_bond_0D.present() || layers.tetrahedral_0D.present())
+		throw InChIAuxInfoReaderError("AuxInfo '" + std::string(begin, end) + "' has 0D stereo layers, which are not supported.");
+
+	std::vector<inchi_Atom> atoms;
+	int chiral_flag = read_atoms(layers.atoms, atoms);
+	read_bonds(layers.bonds, atoms);
+	if (layers.coordinates.present())
+		read_coordinates(layers.coordinates, atoms);
+	set_implicit_hydrogens(atoms);
+
+	int atom_count = (int) atoms.size();
+	result.num_atoms = (AT_NUM) atom_count;
+	result.atom = NULL;
+	if (atom_count > 0) {
+		result.atom = new inchi_Atom[atom_count];
+		memcpy(result.atom, &atoms[0], atom_count * sizeof(inchi_Atom));
+	}
+	return chiral_flag;
+}
+
+} // end of namespace
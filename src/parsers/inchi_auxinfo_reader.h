@@ -0,0 +1,84 @@
+#ifndef IUPAC_RINCHI_INCHIAUXINFOREADER_HEADER_GUARD
+#define IUPAC_RINCHI_INCHIAUXINFOREADER_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <string>
+#include <stdexcept>
+#include <inchi_api.h>
+
+namespace rinchi {
+
+class InChIAuxInfoReaderError: public std::runtime_error {
+	public:
+		explicit InChIAuxInfoReaderError(const std::string& what) : std::runtime_error(what) { }
+};
+
+/**
+  Rebuilds an inchi_Input structure from the reversibility layers ("/rA:", "/rB:" and "/rC:") of
+  an InChI AuxInfo string, the way Get_inchi_Input_FromAuxInfo() in the InChI library does.
+
+  The 0D stereo layers "/rD:" and "/rT:", written for structures without coordinates, are not
+  read: such AuxInfo goes through the InChI library, which turns them into inchi_Input.stereo0D.
+  The other layers (canonical numbering "/N:", equivalence "/E:", charges, radicals and valences
+  "/CRV:" of the InChI's structure, stereo flags) contribute nothing to the input structure and
+  are skipped, as is the InChI string, which the InChI library also has to parse.
+  Parsing works directly on a character range, so a component of an RAuxInfo string can be read
+  without copying it out.
+**/
+class InChIAuxInfoReader {
+	public:
+		// Returns true if the AuxInfo in [begin, end) has the reversibility layers needed by
+		// read_structure() and no 0D stereo layers. Other AuxInfo (e.g. from "/AuxNone",
+		// No-Structures or 0D structures) must go through the InChI library instead.
+		static bool has_structure_layers(const char* begin, const char* end);
+		static bool has_structure_layers(const std::string& auxinfo) { return has_structure_layers(auxinfo.data(), auxinfo.data() + auxinfo.length()); }
+
+		// Fills 'result' (which must be zeroed) and returns the chiral flag in InchiInpData.bChiral
+		// format: 1 = chiral, 2 = not chiral, 0 = no information.
+		// 'result.atom' is allocated with new[] and must be released with delete[] by the caller;
+		// it is left NULL if parsing fails.
+		int read_structure(const char* begin, const char* end, inchi_Input& result);
+		int read_structure(const std::string& auxinfo, inchi_Input& result) { return read_structure(auxinfo.data(), auxinfo.data() + auxinfo.length(), result); }
+};
+
+} // end of namespace
+
+#endif
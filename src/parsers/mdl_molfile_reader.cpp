@@ -54,7 +54,8 @@ namespace rinchi {
 
 namespace {
 
-	typedef map<inchi_Atom*, int> ValenceMap;
+	// Atom index -> valence.
+	typedef map<int, int> ValenceMap;
 
 	void check(bool condition, const std::string& err_msg)
 	{
@@ -66,9 +67,9 @@ namespace {
 		rinchi::check_range<MdlMolfileReaderError>(value, min, max, err_msg.c_str());
 	}
 
-	typedef std::vector<inchi_Atom*> AtomPointerList;
+	typedef std::vector<int> AtomIndexList;
 
-	void read_V2000_charges(const string& current_line, AtomPointerList& atom_block_charged_atoms, ReactionComponent& result)
+	void read_V2000_charges(const string& current_line, AtomIndexList& atom_block_charged_atoms, ReactionComponent& result)
 	{
 		/**
 			M  CHGnn8 aaa vvv ...
@@ -80,9 +81,10 @@ namespace {
 			            with the description of "M  RAD" lines.]
 		**/
 		// Clear any charge and radical codes already set in atom block - "M  CHG" lines take precedence according to ctfile.pdf.
-		for (AtomPointerList::iterator atom = atom_block_charged_atoms.begin(); atom != atom_block_charged_atoms.end(); atom++) {
-			(*atom)->charge  = 0;
-			(*atom)->radical = 0;
+		Molecule& molecule = result.molecule();
+		for (AtomIndexList::iterator atom = atom_block_charged_atoms.begin(); atom != atom_block_charged_atoms.end(); atom++) {
+			molecule.set_charge(*atom, 0);
+			molecule.set_radical(*atom, 0);
 		}
 		atom_block_charged_atoms.clear();
 
@@ -90,17 +92,17 @@ namespace {
 		check_range(num_atoms, 1, 8, "Charge line item count");
 		for (int i = 0; i < num_atoms; i++) {
 			int atom_index = str2int( current_line.substr(10 + i * 8, 3) );
-			check_range(atom_index, 1, (int) result.inchi_input().num_atoms, "Charge line; atom number");
+			check_range(atom_index, 1, molecule.atom_count(), "Charge line; atom number");
 			atom_index += -1;
 			int charge = str2int( current_line.substr(14 + i * 8, 3) );
 			check_range(charge, -15, 15, "Charge line: charge value");
 
-			result.inchi_input().atom[atom_index].charge = charge;
+			molecule.set_charge(atom_index, charge);
 		}
 	}
 
 
-	void read_V2000_radicals(const string& current_line, AtomPointerList& atom_block_radical_atoms, ReactionComponent& result)
+	void read_V2000_radicals(const string& current_line, AtomIndexList& atom_block_radical_atoms, ReactionComponent& result)
 	{
 		/**
 			M  RADnn8 aaa vvv ...
@@ -110,9 +112,10 @@ namespace {
 			forcing a 0 (zero) charge and radical on all atoms not listed in an M CHG or M RAD line.
 		**/
 		// Clear any charge and radical codes already set in atom block - "M  CHG" lines take precedence according to ctfile.pdf.
-		for (AtomPointerList::iterator atom = atom_block_radical_atoms.begin(); atom != atom_block_radical_atoms.end(); atom++) {
-			(*atom)->charge  = 0;
-			(*atom)->radical = 0;
+		Molecule& molecule = result.molecule();
+		for (AtomIndexList::iterator atom = atom_block_radical_atoms.begin(); atom != atom_block_radical_atoms.end(); atom++) {
+			molecule.set_charge(*atom, 0);
+			molecule.set_radical(*atom, 0);
 		}
 		atom_block_radical_atoms.clear();
 
@@ -120,7 +123,7 @@ namespace {
 		check_range(num_atoms, 1, 8, "Radical line item count");
 		for (int i = 0; i < num_atoms; i++) {
 			int atom_index = str2int( current_line.substr(10 + i * 8, 3) );
-			check_range(atom_index, 1, (int) result.inchi_input().num_atoms, "Radical line; atom number");
+			check_range(atom_index, 1, molecule.atom_count(), "Radical line; atom number");
 			atom_index += -1;
 			int radical = str2int( current_line.substr(14 + i * 8, 3) );
 			check_range(radical, 0, 3, "Radical line: charge value");
@@ -134,11 +137,11 @@ namespace {
 				   INCHI_RADICAL_TRIPLET = 3
 				} inchi_Radical;
 			**/
-			result.inchi_input().atom[atom_index].radical = radical;
+			molecule.set_radical(atom_index, radical);
 		}
 	}
 
-	void read_V2000_isotopes(const string& current_line, AtomPointerList& atom_block_mass_diffs, ReactionComponent& result)
+	void read_V2000_isotopes(const string& current_line, AtomIndexList& atom_block_mass_diffs, ReactionComponent& result)
 	{
 		/**
 			M ISOnn8 aaa vvv ...
@@ -150,21 +153,22 @@ namespace {
 			of -18 to +12.
 		**/
 		// Clear any mass diffs already set in atom block - "M  ISO" lines take precedence according to ctfile.pdf.
-		for (AtomPointerList::iterator iso_atom = atom_block_mass_diffs.begin(); iso_atom != atom_block_mass_diffs.end(); iso_atom++)
-			(*iso_atom)->isotopic_mass = 0;
+		Molecule& molecule = result.molecule();
+		for (AtomIndexList::iterator iso_atom = atom_block_mass_diffs.begin(); iso_atom != atom_block_mass_diffs.end(); iso_atom++)
+			molecule.set_isotopic_mass(*iso_atom, 0);
 		atom_block_mass_diffs.clear();
 
 		int num_atoms = str2int( current_line.substr(6, 3) );
 		check_range(num_atoms, 1, 8, "ISOtope line item count");
 		for (int i = 0; i < num_atoms; i++) {
 			int atom_index = str2int( current_line.substr(10 + i * 8, 3) );
-			check_range(atom_index, 1, (int) result.inchi_input().num_atoms, "ISOtope line; atom number");
+			check_range(atom_index, 1, molecule.atom_count(), "ISOtope line; atom number");
 			atom_index += -1;
 			int abs_mass = str2int( current_line.substr(14 + i * 8, 3) );
 			// TODO: Check that abundance_mass - abs_mass in [-18; +12].
 			// check_range(abundance_mass - abs_mass, -18.0, +12.0, "ISOtope line: abs. mass value");
 
-			result.inchi_input().atom[atom_index].isotopic_mass = abs_mass;
+			molecule.set_isotopic_mass(atom_index, abs_mass);
 		}
 	}
 
@@ -182,11 +186,13 @@ namespace {
 
 	void ignore_tag() { }
 
-	void set_inchi_atom_valence(inchi_Atom* atom, int valence, RInChILogger& warning_logger)
+	void set_atom_valence(Molecule& molecule, int atom_idx, int valence, RInChILogger& warning_logger)
 	{
 		int used_valences = 0;
-		for (int i = 0; i < atom->num_bonds; i++) {
-			int bond_cardinality = atom->bond_type[i];
+		for (int i = 0; i < molecule.bond_count(); i++) {
+			if (molecule.bond_atom(i, 0) != atom_idx && molecule.bond_atom(i, 1) != atom_idx)
+				continue;
+			int bond_cardinality = molecule.bond_order(i);
 			if (bond_cardinality > 3)
 				throw MdlMolfileReaderError("Refusing to guess valence of alternating bond (InChI bond type 4 or greater).");
 			used_valences += bond_cardinality;
@@ -195,10 +201,10 @@ namespace {
 		// number of hydrogens to be zero.
 		int remaining_valences = valence - used_valences;
 		if (remaining_valences < 0) {
-			warning_logger.log(std::string("Valence exceeded on ") + atom->elname + " atom: " + int2str(used_valences) + " valences used, but molfile wants to restrict the valence to " + int2str(valence) + ".");
+			warning_logger.log(std::string("Valence exceeded on ") + molecule.element(atom_idx) + " atom: " + int2str(used_valences) + " valences used, but molfile wants to restrict the valence to " + int2str(valence) + ".");
 			remaining_valences = 0;
 		}
-		atom->num_iso_H[0] = remaining_valences;
+		molecule.set_implicit_hydrogens(atom_idx, remaining_valences);
 	}
 
 	bool is_special_atom(const std::string& atom_symbol)
@@ -233,9 +239,9 @@ void MdlMolfileReader::read_V2000_molecule_from_stream(int atom_count, int bond_
 	Coordinate z;
 	std::string atom_symbol;
 	// Keep track of inline charged or radical atoms - they must be reset if CHG or RAD property lines are present.
-	AtomPointerList atoms_with_charges_or_radicals;
+	AtomIndexList atoms_with_charges_or_radicals;
 	// Keep track of atoms with inline mass differences - they must be reset if ISO property lines are present.
-	AtomPointerList atoms_with_mass_diffs;
+	AtomIndexList atoms_with_mass_diffs;
 	// Keep track of atoms with special valences. These atoms will have their valences fixed after full connection table has been read.
 	ValenceMap atoms_with_special_valences;
 	try {
@@ -261,7 +267,7 @@ void MdlMolfileReader::read_V2000_molecule_from_stream(int atom_count, int bond_
 				else
 					charge = '4' - charge_code;
 
-				atoms_with_charges_or_radicals.push_back( &(result.inchi_input().atom[i]) );
+				atoms_with_charges_or_radicals.push_back(i);
 			}
 
 			int isotopic_mass = 0;
@@ -271,7 +277,7 @@ void MdlMolfileReader::read_V2000_molecule_from_stream(int atom_count, int bond_
 				check_range(isotopic_mass, -3, 4, "Inline mass difference");
 				// mass diff. according to ctfiles.pdf:
 				// -3, -2, -1, 0, 1, 2, 3, 4 (0 if value beyond these limits)
-				atoms_with_mass_diffs.push_back( &(result.inchi_input().atom[i]) );
+				atoms_with_mass_diffs.push_back(i);
 				// Indicate delta mass value.
 				isotopic_mass += ISOTOPIC_SHIFT_FLAG;
 			}
@@ -299,11 +305,11 @@ void MdlMolfileReader::read_V2000_molecule_from_stream(int atom_count, int bond_
 				if (valence != 0) {
 					if (valence == 15)
 						valence = 0;
-					atoms_with_special_valences.insert(std::make_pair( &(result.inchi_input().atom[i]), valence ));
+					atoms_with_special_valences.insert(std::make_pair(i, valence));
 				}
 			}
 
-			inchi_set_atom(result.inchi_input(), i, atom_symbol, x, y, z, charge, radical, isotopic_mass);
+			result.molecule().add_atom(atom_symbol, x, y, z, charge, radical, isotopic_mass);
 		}
 	}
 	catch (exception& e) {
@@ -330,7 +336,7 @@ void MdlMolfileReader::read_V2000_molecule_from_stream(int atom_count, int bond_
 			if (bond_cardinality >= 5)
 				throw MdlMolfileReaderError ("SSS query bonds are not allowed.");
 
-			inchi_add_bond(result.inchi_input(), from_number - 1, to_number - 1, bond_cardinality, V2000_stereo_code_to_BondStereo(stereo_code));
+			result.molecule().add_bond(from_number - 1, to_number - 1, bond_cardinality, V2000_stereo_code_to_BondStereo(stereo_code));
 		}
 	}
 	catch (exception& e) {
@@ -376,9 +382,9 @@ void MdlMolfileReader::read_V2000_molecule_from_stream(int atom_count, int bond_
 
 	// Set any fixed valences.
 	for (ValenceMap::const_iterator val = atoms_with_special_valences.begin(); val != atoms_with_special_valences.end(); val++) {
-		inchi_Atom* atom = val->first;
+		int atom_idx = val->first;
 		int valence = val->second;
-		set_inchi_atom_valence(atom, valence, m_warning_logger);
+		set_atom_valence(result.molecule(), atom_idx, valence, m_warning_logger);
 	}
 }
 
@@ -501,9 +507,9 @@ void MdlMolfileReader::read_V3000_molecule_from_stream(bool is_chiral, std::istr
 				line >> key_value;
 			}
 
-			inchi_set_atom(result.inchi_input(), i - 1, atom_symbol, x, y, z, charge, radical, isotopic_mass);
+			result.molecule().add_atom(atom_symbol, x, y, z, charge, radical, isotopic_mass);
 			if (valence != 0) {
-				set_inchi_atom_valence(&(result.inchi_input().atom[i - 1]), valence, m_warning_logger);
+				set_atom_valence(result.molecule(), i - 1, valence, m_warning_logger);
 			}
 		}
 	}
@@ -547,7 +553,7 @@ void MdlMolfileReader::read_V3000_molecule_from_stream(bool is_chiral, std::istr
 				}
 
 				check_range(bond_cardinality, 1, 3, "Bond cardinality");
-				inchi_add_bond(result.inchi_input(), from_atom_number - 1, to_atom_number - 1, bond_cardinality, bond_stereo);
+				result.molecule().add_bond(from_atom_number - 1, to_atom_number - 1, bond_cardinality, bond_stereo);
 			}
 		}
 		catch (exception& e) {
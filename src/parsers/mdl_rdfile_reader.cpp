@@ -46,6 +46,7 @@
 #include <mdl_rdfile.h>
 #include <mdl_rdfile_reader.h>
 
+#include <mdl_rxnfile.h>
 #include <mdl_rxnfile_reader.h>
 #include <mdl_molfile_reader.h>
 
@@ -221,9 +222,9 @@ void MdlRDfileReader::read_reaction_from_stream(std::istream& input_stream, Reac
 		result.set_directionality(rdEquilibrium);
 }
 
-void MdlRDfileReader::read_reaction(std::istream& input_stream, Reaction& result, bool force_equilibrium, int lines_already_read)
+void MdlRDfileReader::read_reaction(std::istream& input_stream, Reaction& result, bool force_equilibrium, int lines_already_read, const std::string& input_name)
 {
-	m_input_name = "std::istream";
+	m_input_name = input_name;
 	m_line_number = lines_already_read;
 
 	if (!input_stream)
@@ -245,4 +246,65 @@ void MdlRDfileReader::read_reaction(const std::string& file_name, Reaction& resu
 }
 
 
+MdlRDfileRecordReader::MdlRDfileRecordReader(std::istream& input):
+	m_input(input), m_line_number(0), m_next_line_number(0), m_record_line_number(0), m_started(false)
+{
+}
+
+bool MdlRDfileRecordReader::read_line(std::string& line)
+{
+	rinchi_getline(m_input, line);
+	if (m_input.fail())
+		return false;
+	m_line_number++;
+	return true;
+}
+
+bool MdlRDfileRecordReader::next_record(std::string& record_text)
+{
+	record_text.clear();
+	std::string line;
+
+	if (!m_started) {
+		m_started = true;
+		bool is_rxnfile = false;
+		while (read_line(line)) {
+			if (m_line_number == 1 && line == MDL_TAG_RXN_BEGIN)
+				is_rxnfile = true;
+			if (!is_rxnfile && line.compare(0, MDL_RDTAG_RFMT.length(), MDL_RDTAG_RFMT) == 0) {
+				m_next_line = line;
+				m_next_line_number = m_line_number;
+				break;
+			}
+			record_text += line;
+			record_text += '\n';
+		}
+		if (m_next_line.empty()) {
+			// No $RFMT line at all. Leave it to the reader to make sense of it or complain.
+			m_record_line_number = 1;
+			return record_text.find_first_not_of(" \t\n") != std::string::npos;
+		}
+		record_text.clear();
+	}
+
+	if (m_next_line.empty())
+		return false;
+
+	m_record_line_number = m_next_line_number;
+	record_text = m_next_line;
+	record_text += '\n';
+	m_next_line.clear();
+	while (read_line(line)) {
+		if (line.compare(0, MDL_RDTAG_RFMT.length(), MDL_RDTAG_RFMT) == 0) {
+			m_next_line = line;
+			m_next_line_number = m_line_number;
+			break;
+		}
+		record_text += line;
+		record_text += '\n';
+	}
+	return true;
+}
+
+
 } // end of namespace
@@ -66,7 +66,35 @@ class MdlRDfileReader: public GenericLineReader<MdlRDfileReaderError> {
 		MdlRDfileReader(const StringVector& non_agent_keywords);
 
 		void read_reaction(const std::string& file_name, Reaction& result, bool force_equilibrium = false, int lines_already_read = 0);
-		void read_reaction(std::istream& input_stream, Reaction& result, bool force_equilibrium = false, int lines_already_read = 0);
+		// 'input_name' is the name of the input in error messages.
+		void read_reaction(std::istream& input_stream, Reaction& result, bool force_equilibrium = false, int lines_already_read = 0, const std::string& input_name = "std::istream");
+};
+
+/**
+ * @brief Splits an RD file with many records into the texts of its reaction records, one at a
+ * time, so that each can be read by an MdlRDfileReader (possibly on another thread).
+ *
+ * Lines before the first $RFMT line (the $RDFILE and $DATM header) are skipped. An input
+ * without any $RFMT line, e.g. an RXN file, is returned whole as a single record.
+ */
+class MdlRDfileRecordReader {
+	private:
+		std::istream& m_input;
+		int m_line_number;
+		// The $RFMT line that ended the previous record and starts the next one.
+		std::string m_next_line;
+		int m_next_line_number;
+		int m_record_line_number;
+		bool m_started;
+
+		bool read_line(std::string& line);
+	public:
+		explicit MdlRDfileRecordReader(std::istream& input);
+
+		// Returns false at end of input.
+		bool next_record(std::string& record_text);
+		// Line number of the first line of the record last returned by next_record(), from 1.
+		int record_line_number() const { return m_record_line_number; }
 };
 
 } // end of namespace
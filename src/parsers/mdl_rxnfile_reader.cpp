@@ -112,9 +112,9 @@ void MdlRxnfileReader::read_reaction_from_stream(std::istream& input_stream, Rea
 	}
 }
 
-void MdlRxnfileReader::read_reaction(std::istream& input_stream, Reaction& result, bool force_equilibrium, int lines_already_read)
+void MdlRxnfileReader::read_reaction(std::istream& input_stream, Reaction& result, bool force_equilibrium, int lines_already_read, const std::string& input_name)
 {
-	m_input_name = "std::istream";
+	m_input_name = input_name;
 	m_line_number = lines_already_read;
 
 	if (!input_stream)
@@ -57,7 +57,8 @@ class MdlRxnfileReader: public GenericLineReader<MdlRxnfileReaderError> {
 		MdlRxnfileReader() {}
 
 		void read_reaction(const std::string& file_name, Reaction& result, bool force_equilibrium = false, int lines_already_read = 0);
-		void read_reaction(std::istream& input_stream, Reaction& result, bool force_equilibrium = false, int lines_already_read = 0);
+		// 'input_name' is the name of the input in error messages.
+		void read_reaction(std::istream& input_stream, Reaction& result, bool force_equilibrium = false, int lines_already_read = 0, const std::string& input_name = "std::istream");
 };
 
 } // end of namespace
@@ -56,18 +56,56 @@ namespace rinchi {
 
 	class RInChIReaderHelper {
     private:
+        // Validate AuxInfo by attempting a structure rebuild. The rebuilt structure is kept as the
+        // component's molfile, unless 'keep_molfile' is false.
+        static void validate_reaction_component_auxinfo(ReactionComponent* c, bool keep_molfile)
+        {
+            try {
+                if (keep_molfile)
+                    c->molfile();
+                else
+                    InChIToStructureConverter().check_structure(c->m_inchi_string, c->m_inchi_auxinfo);
+            } catch (std::exception&) {
+                throw RInChIReaderError("Invalid AuxInfo '" + c->m_inchi_auxinfo + "' for a reaction component.");
+            }
+        }
+
         // Validate the direct-loaded InChI string and AuxInfo (if any).
-        static void validate_reaction_component_inchi_strings(ReactionComponent* c)
+        static void validate_reaction_component_inchi_strings(ReactionComponent* c, bool keep_molfile)
         {
             InChIGenerator().validate_inchi(c->m_inchi_string);
-            if (!c->m_inchi_auxinfo.empty()) {
-                // Validate AuxInfo by attempting a structure rebuild.
-                try {
-                    InChIToStructureConverter().to_molfile(c->m_inchi_string, c->m_inchi_auxinfo);
-                } catch (std::exception&) {
-                    throw RInChIReaderError("Invalid AuxInfo '" + c->m_inchi_auxinfo + "' for a reaction component.");
-                }
+            if (!c->m_inchi_auxinfo.empty())
+                validate_reaction_component_auxinfo(c, keep_molfile);
+        }
+
+        // Standard InChIKeys are 14 letters, a dash, 10 letters, a dash and a letter.
+        static bool is_valid_inchi_key(const std::string& key)
+        {
+            if (key.length() != 27 || key[14] != '-' || key[25] != '-')
+                return false;
+            for (size_t i = 0; i < key.length(); i++) {
+                if (i != 14 && i != 25 && (key[i] < 'A' || key[i] > 'Z'))
+                    return false;
+            }
+            return true;
+        }
+
+        static void read_inchi_key(const std::string& line, int line_no, ReactionComponent* c, unsigned check_interval, std::atomic<unsigned long>& key_count)
+        {
+            if (c == nullptr)
+                throw RInChIReaderError("Line " + int2str(line_no) + ": InChIKey without preceeding InChI string.");
+            if (!c->m_inchi_key.empty())
+                throw RInChIReaderError("Line " + int2str(line_no) + ": Duplicate InChIKey for a reaction component.");
+
+            std::string key = line.substr(INCHI_KEY_HEADER.length());
+            if (!is_valid_inchi_key(key))
+                throw RInChIReaderError("Line " + int2str(line_no) + ": Invalid InChIKey '" + key + "'.");
+            unsigned long key_number = key_count++;
+            if (check_interval > 0 && key_number % check_interval == 0) {
+                if (InChIGenerator().inchi_string2key(c->m_inchi_string) != key)
+                    throw RInChIReaderError("Line " + int2str(line_no) + ": InChIKey '" + key + "' does not match InChI string '" + c->m_inchi_string + "'.");
             }
+            c->m_inchi_key = key;
         }
 
 	public:
@@ -108,7 +146,7 @@ namespace rinchi {
 			}
 		}
 
-		static void add_auxinfo_to_components(const std::string& auxinfogroup, ReactionComponentList& components, const std::string& group_name)
+		static void add_auxinfo_to_components(const std::string& auxinfogroup, ReactionComponentList& components, const std::string& group_name, bool keep_molfiles)
 		{
 			if (auxinfogroup.empty())
 				return;
@@ -131,15 +169,8 @@ namespace rinchi {
 					throw RInChIReaderError ("RAuxInfo contains too many elements in the " + group_name + ".");
 				ReactionComponent* cmp = components.at(cmp_idx);
 
-				auxinfo = INCHI_AUXINFO_HEADER + auxinfo;
-				// Validate AuxInfo by attempting a structure rebuild.
-				try {
-					InChIToStructureConverter().to_molfile(cmp->inchi_string(), auxinfo);
-				} catch (std::exception&) {
-					throw RInChIReaderError("Invalid AuxInfo '" + auxinfo + "' for a reaction component.");
-				}
-
-				cmp->m_inchi_auxinfo = auxinfo;
+				cmp->m_inchi_auxinfo = INCHI_AUXINFO_HEADER + auxinfo;
+				validate_reaction_component_auxinfo(cmp, keep_molfiles);
 				cmp_idx++;
 
 				if (delim_pos == std::string::npos)
@@ -147,7 +178,7 @@ namespace rinchi {
 			}
 		}
 
-        static void read_components(const std::string& inchi_lines, ReactionComponentList& components)
+        static void read_components(const std::string& inchi_lines, ReactionComponentList& components, bool keep_molfiles, unsigned key_check_interval, std::atomic<unsigned long>& key_count)
         {
             if (inchi_lines.empty())
                 return;
@@ -161,14 +192,17 @@ namespace rinchi {
             ReactionComponent* c = nullptr;
             while (inchi_lines_stream) {
                 rinchi_getline(inchi_lines_stream, line);
+                // After a last line without a line break, getline() fails and leaves 'line' as it was.
+                if (inchi_lines_stream.fail())
+                    break;
                 if (blank_line_detected && inchi_lines_stream)
                     throw RInChIReaderError("Line " + int2str(line_no) + ": Unexpected trailing data; expected an EOF after previous blank line.");
                 // ' line.rfind("ABC", 0) == 0 ' is equivalent to ' line.starts_with("ABC") '.
                 if (line.rfind("InChI=", 0) == 0) {
-                    if (c == nullptr || !c->inchi_string().empty()) {
+                    if (c == nullptr || c->has_inchi_string()) {
                         // Check previously added component, if any.
                         if (c != nullptr)
-                            validate_reaction_component_inchi_strings(c);
+                            validate_reaction_component_inchi_strings(c, keep_molfiles);
                         // Add new component to reaction.
                         c = new ReactionComponent();
                         components.push_back(c);
@@ -176,30 +210,33 @@ namespace rinchi {
                     c->m_inchi_string = line;
                 }
                 else if (line.rfind("AuxInfo=", 0) == 0) {
-                    if (c->inchi_string().empty())
-                        throw new RInChIReaderError ("Line " + int2str(line_no) + ": AuxInfo without preceeding InChI string.");
+                    if (c == nullptr)
+                        throw RInChIReaderError ("Line " + int2str(line_no) + ": AuxInfo without preceeding InChI string.");
                     c->m_inchi_auxinfo = line;
                 }
+                else if (line.rfind(INCHI_KEY_HEADER, 0) == 0) {
+                    read_inchi_key(line, line_no, c, key_check_interval, key_count);
+                }
                 else if (line.empty()) {
                     blank_line_detected = true;
                 }
                 else
-                    throw RInChIReaderError("Line " + int2str(line_no) + ": Unexpected line data; expected an InChI or AuxInfo string.");
+                    throw RInChIReaderError("Line " + int2str(line_no) + ": Unexpected line data; expected an InChI, AuxInfo or InChIKey string.");
 
                 ++line_no;
             }
             // Check last-added reaction component.
             if (c != nullptr)
-                validate_reaction_component_inchi_strings(c);
+                validate_reaction_component_inchi_strings(c, keep_molfiles);
         }
 
-        static void add_inchis_to_reaction(const std::string& reactant_inchis, const std::string& product_inchis, const std::string& agent_inchis, Reaction& rxn)
+        static void add_inchis_to_reaction(const std::string& reactant_inchis, const std::string& product_inchis, const std::string& agent_inchis, Reaction& rxn, bool keep_molfiles, unsigned key_check_interval, std::atomic<unsigned long>& key_count)
         {
-            read_components(reactant_inchis, rxn.m_reactants);
-            read_components(product_inchis,  rxn.m_products);
-            read_components(agent_inchis,    rxn.m_agents);
+            read_components(reactant_inchis, rxn.m_reactants, keep_molfiles, key_check_interval, key_count);
+            read_components(product_inchis,  rxn.m_products, keep_molfiles, key_check_interval, key_count);
+            read_components(agent_inchis,    rxn.m_agents, keep_molfiles, key_check_interval, key_count);
 
-            rxn.m_is_cache_valid = false;
+            rxn.reset_rinchis();
         }
 
     };
@@ -311,7 +348,6 @@ void RInChIReader::split_into_reaction(const std::string& rinchi_string, const s
 
 	if (is_reverse_direction != NULL)
 		*is_reverse_direction = (direction_flag == DIRECTION_REVERSE);
-	rxn.m_reverse_output = (direction_flag == DIRECTION_REVERSE);
 
 	/**
 	  Split RAuxInfo string, if any, into groups. **/
@@ -342,14 +378,14 @@ void RInChIReader::split_into_reaction(const std::string& rinchi_string, const s
 		}
 
 		if (direction_flag == DIRECTION_FORWARD || direction_flag == DIRECTION_EQUILIBRIUM) {
-			RInChIReaderHelper::add_auxinfo_to_components(first_group, rxn.m_reactants, "first group (reactants)");
-			RInChIReaderHelper::add_auxinfo_to_components(second_group, rxn.m_products, "second group (products)");
+			RInChIReaderHelper::add_auxinfo_to_components(first_group, rxn.m_reactants, "first group (reactants)", m_keep_molfiles);
+			RInChIReaderHelper::add_auxinfo_to_components(second_group, rxn.m_products, "second group (products)", m_keep_molfiles);
 		}
 		else if (direction_flag == DIRECTION_REVERSE) {
-			RInChIReaderHelper::add_auxinfo_to_components(first_group, rxn.m_products, "first group (products)");
-			RInChIReaderHelper::add_auxinfo_to_components(second_group, rxn.m_reactants, "second group (reactants)");
+			RInChIReaderHelper::add_auxinfo_to_components(first_group, rxn.m_products, "first group (products)", m_keep_molfiles);
+			RInChIReaderHelper::add_auxinfo_to_components(second_group, rxn.m_reactants, "second group (reactants)", m_keep_molfiles);
 		}
-		RInChIReaderHelper::add_auxinfo_to_components(third_group, rxn.m_agents, "third group (agents)");
+		RInChIReaderHelper::add_auxinfo_to_components(third_group, rxn.m_agents, "third group (agents)", m_keep_molfiles);
 	}
 	// If no RAuxInfo, set blank AuxInfo on all components.
 	else {
@@ -373,7 +409,7 @@ void RInChIReader::split_into_reaction(const std::string& rinchi_string, const s
 		rxn.m_nostruct_counts[1] = str2int(no_struct_data.substr(first_delim + 1, last_delim - first_delim - 1));
 		rxn.m_nostruct_counts[2] = str2int(no_struct_data.substr(last_delim + 1));
 
-		if (rxn.m_reverse_output)
+		if (direction_flag == DIRECTION_REVERSE)
 			std::swap(rxn.m_nostruct_counts[0], rxn.m_nostruct_counts[1]);
 
 		// Add No-Structures to reaction component lists.
@@ -401,7 +437,7 @@ void RInChIReader::split_into_reaction(const std::string& rinchi_string, const s
 		for (int i = 0; i < RINCHI_NUM_GROUPS; i++)
 			rxn.m_nostruct_counts[i] = 0;
 
-	rxn.m_is_cache_valid = false;
+	rxn.reset_rinchis();
 
 #ifdef RINCHI_READER_DEBUG_TO_CONSOLE
 	std::cout << "RInChI reader: Reactants (" << rxn.reactants().size() << "): " << std::endl;
@@ -448,7 +484,8 @@ namespace {
 
 void RInChIReader::add_inchis_to_reaction(const std::string& reactant_inchis, const std::string& product_inchis, const std::string& agent_inchis, Reaction& rxn)
 {
-    RInChIReaderHelper::add_inchis_to_reaction(reactant_inchis, product_inchis, agent_inchis, rxn);
+    RInChIReaderHelper::add_inchis_to_reaction(reactant_inchis, product_inchis, agent_inchis, rxn, m_keep_molfiles, m_inchi_key_check_interval,
+        m_inchi_key_counter ? *m_inchi_key_counter : m_inchi_key_count);
 }
 
 } // end of namespace
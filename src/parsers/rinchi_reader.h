@@ -40,6 +40,8 @@
 #pragma endregion
 #endif
 
+#include <atomic>
+
 #include <rinchi_reaction.h>
 
 namespace rinchi {
@@ -56,8 +58,40 @@ class RInChIReaderError: public RInChIError {
 };
 
 class RInChIReader {
+private:
+	bool m_keep_molfiles;
+	unsigned m_inchi_key_check_interval;
+	// InChIKeys read by add_inchis_to_reaction(), for spot checks.
+	std::atomic<unsigned long> m_inchi_key_count;
+	// See set_inchi_key_counter().
+	std::atomic<unsigned long>* m_inchi_key_counter;
 public:
-	RInChIReader() {}
+	RInChIReader(): m_keep_molfiles(true), m_inchi_key_check_interval(1), m_inchi_key_count(0), m_inchi_key_counter(NULL) {}
+
+	/**
+		AuxInfo is validated by rebuilding the component structures. By default the result is
+		kept as the components' molfile (see ReactionComponent::molfile()) so that writers need
+		not rebuild them. Set to false when only the InChI strings are of interest, to save the
+		memory.
+	**/
+	bool keep_molfiles() const { return m_keep_molfiles; }
+	void set_keep_molfiles(bool value) { m_keep_molfiles = value; }
+
+	/**
+		InChIKeys given to add_inchis_to_reaction() are always checked for their format. Every
+		'interval'th of them, starting with the first, is also checked against its InChI string,
+		which takes as long as calculating the key. 1 (the default) checks all of them; 0 trusts
+		all of them.
+	**/
+	unsigned inchi_key_check_interval() const { return m_inchi_key_check_interval; }
+	void set_inchi_key_check_interval(unsigned value) { m_inchi_key_check_interval = value; }
+	/**
+		The spot checks count the keys read by this reader, so a reader that reads only a few
+		keys checks its first one every time. Readers that share a counter here check every
+		'interval'th key over all of them, e.g. one reader per call of a library function.
+		NULL (the default) uses the reader's own count.
+	**/
+	void set_inchi_key_counter(std::atomic<unsigned long>* counter) { m_inchi_key_counter = counter; }
 
         /**
                 Splits an RInChI string into its separate InChI strings and puts them
@@ -97,6 +131,14 @@ public:
 
 		In the last example, only reactant #2 will have AuxInfo attached. This mode of mixing
 		components with and without AuxInfo is NOT recommended.
+
+		Each InChI string may also be followed by the standard InChIKey of the component, before
+		or after its AuxInfo, so that RInChIKeys need not calculate it (but see
+		set_inchi_key_check_interval()):
+
+		InChI=...    <-- Reactant #1
+		AuxInfo=...  <-- Reactant #1, AuxInfo
+		InChIKey=... <-- Reactant #1, InChIKey
         **/
 	void add_inchis_to_reaction(const std::string& reactant_inchis, const std::string& product_inchis, const std::string& agent_inchis, Reaction& rxn);
 
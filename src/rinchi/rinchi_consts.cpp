@@ -50,6 +50,8 @@ const std::string RINCHI_STD_HEADER = "RInChI=" + RINCHI_VERSION + ".1S/";
 const std::string INCHI_AUXINFO_HEADER = "AuxInfo=1/";
 const std::string RINCHI_AUXINFO_HEADER = "RAuxInfo=" + RINCHI_VERSION + ".1/";
 
+const std::string INCHI_KEY_HEADER = "InChIKey=";
+
 // Delimiters in RInChI strings.
 const std::string DELIM_LAYER = "/";
 const std::string DELIM_COMP = "!";
@@ -54,6 +54,8 @@ extern const std::string RINCHI_STD_HEADER;
 extern const std::string INCHI_AUXINFO_HEADER;
 extern const std::string RINCHI_AUXINFO_HEADER;
 
+extern const std::string INCHI_KEY_HEADER;
+
 // RInChI String delimiters.
 extern const std::string DELIM_LAYER;
 extern const std::string DELIM_COMP;
@@ -0,0 +1,666 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include "rinchi_inchi_cache.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "rinchi_platform.h"
+#include "rinchi_consts.h"
+#include "rinchi_hashing.h"
+#include "rinchi_utils.h"
+#include "inchi_api_intf.h"
+
+#ifdef ON_WINDOWS
+	#include <windows.h>
+#elif defined(ON_LINUX) || defined(ON_SOLARIS)
+	#include <cerrno>
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace rinchi {
+
+namespace {
+
+	const size_t VERSION_LENGTH = 24;
+
+	struct FileHeader {
+		char magic[8];
+		uint32_t format_version;
+		// BYTE_ORDER_MARK as written by the creating platform.
+		uint32_t byte_order;
+		char rinchi_version[VERSION_LENGTH];
+		char inchi_version[VERSION_LENGTH];
+	};
+
+	const char FILE_MAGIC[8] = { 'R', 'I', 'n', 'C', 'h', 'I', 'C', '\x1a' };
+	const uint32_t FILE_FORMAT_VERSION = 1;
+	const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+	// Followed by the body: a RecordBodyHeader, the InChI string, AuxInfo and InChIKey (without
+	// terminating zeroes), and zero padding up to a multiple of 8 bytes.
+	struct RecordHeader {
+		uint32_t magic;
+		uint32_t body_length;
+		uint64_t checksum;
+	};
+
+	struct RecordBodyHeader {
+		unsigned char digest[32];
+		uint32_t inchi_length;
+		uint32_t auxinfo_length;
+		uint32_t key_length;
+		uint32_t reserved;
+	};
+
+	const uint32_t RECORD_MAGIC = 0x31484352;
+
+	// Held while this process holds a file lock, and while it closes a cache file. POSIX record
+	// locks belong to the process: they do not keep its threads apart, and closing any descriptor
+	// of a file releases all of them.
+	std::mutex file_lock_mutex;
+
+	FileHeader current_header()
+	{
+		FileHeader result;
+		memset(&result, 0, sizeof(result));
+		memcpy(result.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+		result.format_version = FILE_FORMAT_VERSION;
+		result.byte_order = BYTE_ORDER_MARK;
+		safe_strcpy(result.rinchi_version, VERSION_LENGTH, RINCHI_VERSION.c_str(), RINCHI_VERSION.length());
+		safe_strcpy(result.inchi_version, VERSION_LENGTH, inchi_lib_version().c_str(), inchi_lib_version().length());
+		return result;
+	}
+
+	uint64_t fnv1a(const char* data, size_t length)
+	{
+		uint64_t result = 14695981039346656037ULL;
+		for (size_t i = 0; i < length; i++) {
+			result ^= (unsigned char) data[i];
+			result *= 1099511628211ULL;
+		}
+		return result;
+	}
+
+	uint64_t digest_prefix(const unsigned char* digest)
+	{
+		uint64_t result;
+		memcpy(&result, digest, sizeof(result));
+		return result;
+	}
+
+	template <typename T> void append_value(std::string& output, const T& value)
+	{
+		output.append((const char*) &value, sizeof(value));
+	}
+
+}
+
+/**
+  InChICache::File - the platform specific part: an open file, its read-only mapping and the
+  exclusive lock for writers.
+**/
+
+class InChICache::File {
+	private:
+		std::string m_path;
+#ifdef ON_WINDOWS
+		HANDLE m_handle;
+		HANDLE m_mapping;
+#elif defined(ON_LINUX) || defined(ON_SOLARIS)
+		int m_fd;
+#endif
+		const char* m_data;
+		uint64_t m_mapped_size;
+
+		void unmap();
+		void fail(const std::string& what);
+	public:
+		explicit File(const std::string& path);
+		~File();
+
+		// Current size of the file, not of the mapping.
+		uint64_t size();
+		// (Re)maps the first 'size' bytes of the file.
+		void map(uint64_t size);
+		const char* data() const { return m_data; }
+		uint64_t mapped_size() const { return m_mapped_size; }
+
+		void lock();
+		void unlock();
+		// False if 'm_path' has been replaced by another file since it was opened.
+		bool is_current();
+		void write_at(uint64_t offset, const std::string& bytes);
+		// Atomically replaces the file at 'm_path' by one holding only 'contents'. Nothing but
+		// the destructor may be called afterwards.
+		void replace(const std::string& contents);
+};
+
+#ifdef ON_WINDOWS
+
+InChICache::File::File(const std::string& path)
+	: m_path(path), m_handle(INVALID_HANDLE_VALUE), m_mapping(NULL), m_data(NULL), m_mapped_size(0)
+{
+	m_handle = CreateFileA(
+		path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL
+	);
+	if (m_handle == INVALID_HANDLE_VALUE)
+		fail("open");
+}
+
+InChICache::File::~File()
+{
+	unmap();
+	if (m_handle != INVALID_HANDLE_VALUE)
+		CloseHandle(m_handle);
+}
+
+void InChICache::File::fail(const std::string& what)
+{
+	throw InChICacheError("InChI cache file " + m_path + ": " + what + " failed (error " + int2str((int) GetLastError()) + ").");
+}
+
+uint64_t InChICache::File::size()
+{
+	LARGE_INTEGER result;
+	if (!GetFileSizeEx(m_handle, &result))
+		fail("getting the size");
+	return (uint64_t) result.QuadPart;
+}
+
+void InChICache::File::unmap()
+{
+	if (m_data)
+		UnmapViewOfFile(m_data);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	m_data = NULL;
+	m_mapping = NULL;
+	m_mapped_size = 0;
+}
+
+void InChICache::File::map(uint64_t size)
+{
+	unmap();
+	if (size == 0)
+		return;
+	m_mapping = CreateFileMappingA(m_handle, NULL, PAGE_READONLY, (DWORD) (size >> 32), (DWORD) size, NULL);
+	if (!m_mapping)
+		fail("mapping");
+	m_data = (const char*) MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, (SIZE_T) size);
+	if (!m_data)
+		fail("mapping");
+	m_mapped_size = size;
+}
+
+void InChICache::File::lock()
+{
+	OVERLAPPED whole_file = {};
+	if (!LockFileEx(m_handle, LOCKFILE_EXCLUSIVE_LOCK, 0, MAXDWORD, MAXDWORD, &whole_file))
+		fail("locking");
+}
+
+void InChICache::File::unlock()
+{
+	OVERLAPPED whole_file = {};
+	UnlockFileEx(m_handle, 0, MAXDWORD, MAXDWORD, &whole_file);
+}
+
+bool InChICache::File::is_current()
+{
+	// Open files cannot be replaced on Windows (see replace()).
+	return true;
+}
+
+void InChICache::File::write_at(uint64_t offset, const std::string& bytes)
+{
+	OVERLAPPED position = {};
+	position.Offset = (DWORD) offset;
+	position.OffsetHigh = (DWORD) (offset >> 32);
+	DWORD written = 0;
+	if (!WriteFile(m_handle, bytes.data(), (DWORD) bytes.length(), &written, &position) || written != bytes.length())
+		fail("writing");
+}
+
+void InChICache::File::replace(const std::string& contents)
+{
+	// Windows refuses to replace a file that is open or mapped anywhere, this process included.
+	unmap();
+	CloseHandle(m_handle);
+	m_handle = INVALID_HANDLE_VALUE;
+
+	std::string new_path = m_path + "." + int2str((int) GetCurrentProcessId()) + ".new";
+	HANDLE new_file = CreateFileA(new_path.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (new_file == INVALID_HANDLE_VALUE)
+		fail("creating " + new_path);
+	DWORD written = 0;
+	bool ok = WriteFile(new_file, contents.data(), (DWORD) contents.length(), &written, NULL) && written == contents.length();
+	CloseHandle(new_file);
+	if (!ok || !MoveFileExA(new_path.c_str(), m_path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+		DeleteFileA(new_path.c_str());
+		fail("replacing the cache of another version (is it still in use?)");
+	}
+}
+
+#elif defined(ON_LINUX) || defined(ON_SOLARIS)
+
+InChICache::File::File(const std::string& path)
+	: m_path(path), m_fd(-1), m_data(NULL), m_mapped_size(0)
+{
+	m_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0666);
+	if (m_fd < 0)
+		fail("open");
+}
+
+InChICache::File::~File()
+{
+	unmap();
+	if (m_fd >= 0)
+		::close(m_fd);
+}
+
+void InChICache::File::fail(const std::string& what)
+{
+	throw InChICacheError("InChI cache file " + m_path + ": " + what + " failed (" + strerror(errno) + ").");
+}
+
+uint64_t InChICache::File::size()
+{
+	struct stat file_stat;
+	if (fstat(m_fd, &file_stat) != 0)
+		fail("getting the size");
+	return (uint64_t) file_stat.st_size;
+}
+
+void InChICache::File::unmap()
+{
+	if (m_data)
+		munmap((void*) m_data, (size_t) m_mapped_size);
+	m_data = NULL;
+	m_mapped_size = 0;
+}
+
+void InChICache::File::map(uint64_t size)
+{
+	unmap();
+	if (size == 0)
+		return;
+	void* data = mmap(NULL, (size_t) size, PROT_READ, MAP_SHARED, m_fd, 0);
+	if (data == MAP_FAILED)
+		fail("mapping");
+	m_data = (const char*) data;
+	m_mapped_size = size;
+}
+
+void InChICache::File::lock()
+{
+	struct flock whole_file;
+	memset(&whole_file, 0, sizeof(whole_file));
+	whole_file.l_type = F_WRLCK;
+	whole_file.l_whence = SEEK_SET;
+	while (fcntl(m_fd, F_SETLKW, &whole_file) != 0) {
+		if (errno != EINTR)
+			fail("locking");
+	}
+}
+
+void InChICache::File::unlock()
+{
+	struct flock whole_file;
+	memset(&whole_file, 0, sizeof(whole_file));
+	whole_file.l_type = F_UNLCK;
+	whole_file.l_whence = SEEK_SET;
+	fcntl(m_fd, F_SETLK, &whole_file);
+}
+
+bool InChICache::File::is_current()
+{
+	struct stat open_stat, path_stat;
+	if (fstat(m_fd, &open_stat) != 0)
+		fail("getting the status");
+	if (stat(m_path.c_str(), &path_stat) != 0)
+		return false;
+	return open_stat.st_dev == path_stat.st_dev && open_stat.st_ino == path_stat.st_ino;
+}
+
+void InChICache::File::write_at(uint64_t offset, const std::string& bytes)
+{
+	size_t done = 0;
+	while (done < bytes.length()) {
+		ssize_t written = pwrite(m_fd, bytes.data() + done, bytes.length() - done, (off_t) (offset + done));
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			fail("writing");
+		}
+		done += written;
+	}
+}
+
+void InChICache::File::replace(const std::string& contents)
+{
+	// Processes that have the old file open keep it until they close it.
+	std::string new_path = m_path + "." + int2str((int) getpid()) + ".new";
+	int new_fd = ::open(new_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	if (new_fd < 0)
+		fail("creating " + new_path);
+	bool ok = write(new_fd, contents.data(), contents.length()) == (ssize_t) contents.length();
+	ok = (::close(new_fd) == 0) && ok;
+	if (!ok || rename(new_path.c_str(), m_path.c_str()) != 0) {
+		unlink(new_path.c_str());
+		fail("replacing the cache of another version");
+	}
+}
+
+#else
+	Unsupported_platform
+#endif
+
+/**
+  InChICache
+**/
+
+InChICache::Digest InChICache::digest(const inchi_Input& input)
+{
+	std::string data;
+	data.reserve(64 * input.num_atoms + 64);
+
+	append_value(data, input.num_atoms);
+	for (int i = 0; i < input.num_atoms; i++) {
+		const inchi_Atom& atom = input.atom[i];
+		data.append(atom.elname, ATOM_EL_LEN);
+		append_value(data, atom.x);
+		append_value(data, atom.y);
+		append_value(data, atom.z);
+		append_value(data, atom.charge);
+		append_value(data, atom.radical);
+		append_value(data, atom.isotopic_mass);
+		for (int h = 0; h <= NUM_H_ISOTOPES; h++)
+			append_value(data, atom.num_iso_H[h]);
+		append_value(data, atom.num_bonds);
+		for (int b = 0; b < atom.num_bonds; b++) {
+			append_value(data, atom.neighbor[b]);
+			append_value(data, atom.bond_type[b]);
+			append_value(data, atom.bond_stereo[b]);
+		}
+	}
+
+	append_value(data, input.num_stereo0D);
+	for (int i = 0; i < input.num_stereo0D; i++) {
+		const inchi_Stereo0D& stereo = input.stereo0D[i];
+		for (int n = 0; n < 4; n++)
+			append_value(data, stereo.neighbor[n]);
+		append_value(data, stereo.central_atom);
+		append_value(data, stereo.type);
+		append_value(data, stereo.parity);
+	}
+
+	if (input.szOptions)
+		data += input.szOptions;
+
+	Digest result;
+	sha256(data, result.bytes);
+	return result;
+}
+
+InChICache::InChICache(const std::string& path)
+	: m_path(path), m_scan_end(sizeof(FileHeader))
+{
+	open();
+	refresh();
+}
+
+InChICache::~InChICache()
+{
+	std::lock_guard<std::mutex> lock (file_lock_mutex);
+	m_file.reset();
+}
+
+void InChICache::open()
+{
+	const FileHeader header = current_header();
+
+	std::lock_guard<std::mutex> lock (file_lock_mutex);
+	// Each round either finds a usable file or replaces the one it found; more than a few
+	// rounds mean that processes of different versions keep replacing each other's files.
+	for (int round = 0; round < 5; round++) {
+		m_file.reset(new File(m_path));
+		m_file->lock();
+		try {
+			// Another process replaced the file between our open() and lock().
+			if (!m_file->is_current()) {
+				m_file->unlock();
+				continue;
+			}
+
+			uint64_t size = m_file->size();
+			// New, or left incomplete by a process that crashed while creating it.
+			if (size < sizeof(FileHeader)) {
+				m_file->write_at(0, std::string((const char*) &header, sizeof(header)));
+				size = m_file->size();
+			}
+			m_file->map(size);
+			if (memcmp(m_file->data(), &header, sizeof(header)) == 0) {
+				m_file->unlock();
+				return;
+			}
+
+			m_file->replace(std::string((const char*) &header, sizeof(header)));
+		}
+		catch (...) {
+			m_file->unlock();
+			throw;
+		}
+		// Unlocks by closing.
+		m_file.reset();
+	}
+	throw InChICacheError("InChI cache file " + m_path + " keeps being replaced by other RInChI or InChI library versions.");
+}
+
+void InChICache::refresh()
+{
+	uint64_t size = m_file->size();
+	if (size > m_file->mapped_size())
+		m_file->map(size);
+
+	const char* data = m_file->data();
+	const uint64_t end = m_file->mapped_size();
+	uint64_t pos = m_scan_end;
+	while (end - pos >= sizeof(RecordHeader)) {
+		RecordHeader header;
+		memcpy(&header, data + pos, sizeof(header));
+		if (header.magic != RECORD_MAGIC || header.body_length < sizeof(RecordBodyHeader) || header.body_length % 8 != 0)
+			break;
+		if (header.body_length > end - pos - sizeof(header))
+			break;
+		const char* body = data + pos + sizeof(header);
+		if (fnv1a(body, header.body_length) != header.checksum)
+			break;
+		RecordBodyHeader body_header;
+		memcpy(&body_header, body, sizeof(body_header));
+		if ((uint64_t) body_header.inchi_length + body_header.auxinfo_length + body_header.key_length > header.body_length - sizeof(body_header))
+			break;
+
+		m_index[digest_prefix(body_header.digest)] = pos;
+		pos += sizeof(header) + header.body_length;
+	}
+	m_scan_end = pos;
+	m_stats.entries = m_index.size();
+}
+
+bool InChICache::lookup(const Digest& key, InChICacheValue* result)
+{
+	std::unordered_map<uint64_t, uint64_t>::const_iterator entry = m_index.find(digest_prefix(key.bytes));
+	if (entry == m_index.end())
+		return false;
+
+	// Records in the index have been validated, and mappings only grow.
+	const char* body = m_file->data() + entry->second + sizeof(RecordHeader);
+	RecordBodyHeader body_header;
+	memcpy(&body_header, body, sizeof(body_header));
+	if (memcmp(body_header.digest, key.bytes, sizeof(key.bytes)) != 0)
+		return false;
+
+	if (result) {
+		const char* text = body + sizeof(body_header);
+		result->inchi_string.assign(text, body_header.inchi_length);
+		text += body_header.inchi_length;
+		result->inchi_auxinfo.assign(text, body_header.auxinfo_length);
+		text += body_header.auxinfo_length;
+		result->inchi_key.assign(text, body_header.key_length);
+	}
+	return true;
+}
+
+bool InChICache::find(const Digest& key, InChICacheValue& result)
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	if (!lookup(key, &result)) {
+		// Other processes may have added it since we last looked.
+		try {
+			refresh();
+		}
+		catch (InChICacheError&) {
+			m_stats.misses++;
+			return false;
+		}
+		if (!lookup(key, &result)) {
+			m_stats.misses++;
+			return false;
+		}
+	}
+	m_stats.hits++;
+	return true;
+}
+
+void InChICache::insert(const Digest& key, const InChICacheValue& value)
+{
+	RecordBodyHeader body_header;
+	memset(&body_header, 0, sizeof(body_header));
+	memcpy(body_header.digest, key.bytes, sizeof(key.bytes));
+	body_header.inchi_length = (uint32_t) value.inchi_string.length();
+	body_header.auxinfo_length = (uint32_t) value.inchi_auxinfo.length();
+	body_header.key_length = (uint32_t) value.inchi_key.length();
+
+	std::string body ((const char*) &body_header, sizeof(body_header));
+	body += value.inchi_string;
+	body += value.inchi_auxinfo;
+	body += value.inchi_key;
+	body.resize((body.length() + 7) / 8 * 8, '\0');
+
+	RecordHeader header;
+	header.magic = RECORD_MAGIC;
+	header.body_length = (uint32_t) body.length();
+	header.checksum = fnv1a(body.data(), body.length());
+	std::string record ((const char*) &header, sizeof(header));
+	record += body;
+
+	std::lock_guard<std::mutex> lock (m_mutex);
+	std::lock_guard<std::mutex> file_lock (file_lock_mutex);
+	try {
+		m_file->lock();
+	}
+	catch (InChICacheError&) {
+		m_stats.append_errors++;
+		return;
+	}
+	try {
+		refresh();
+		// Written at the end of the valid records, over what a crashed writer may have left.
+		if (!lookup(key, NULL)) {
+			m_file->write_at(m_scan_end, record);
+			m_stats.appends++;
+		}
+	}
+	catch (InChICacheError&) {
+		m_stats.append_errors++;
+	}
+	m_file->unlock();
+}
+
+InChICacheStats InChICache::stats()
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	return m_stats;
+}
+
+/**
+  The process-wide cache.
+**/
+
+namespace {
+
+	std::mutex process_cache_mutex;
+	std::shared_ptr<InChICache> process_cache;
+	// False until set_inchi_cache_file() is called or RINCHI_INCHI_CACHE has been opened.
+	bool process_cache_configured = false;
+
+}
+
+std::shared_ptr<InChICache> inchi_cache()
+{
+	std::lock_guard<std::mutex> lock (process_cache_mutex);
+	if (!process_cache_configured) {
+		const char* path = getenv("RINCHI_INCHI_CACHE");
+		// A file that cannot be opened fails every InChI calculation, rather than silently
+		// running without the cache that was asked for.
+		if (path && *path)
+			process_cache = std::make_shared<InChICache>(path);
+		process_cache_configured = true;
+	}
+	return process_cache;
+}
+
+void set_inchi_cache_file(const std::string& path)
+{
+	std::shared_ptr<InChICache> cache;
+	if (!path.empty())
+		cache = std::make_shared<InChICache>(path);
+
+	std::lock_guard<std::mutex> lock (process_cache_mutex);
+	process_cache.swap(cache);
+	process_cache_configured = true;
+}
+
+} // end of namespace
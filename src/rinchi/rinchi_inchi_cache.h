@@ -0,0 +1,161 @@
+#ifndef IUPAC_RINCHI_INCHI_CACHE_HEADER_GUARD
+#define IUPAC_RINCHI_INCHI_CACHE_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "inchi_api.h"
+
+namespace rinchi {
+
+class InChICacheError: public std::runtime_error {
+	public:
+		explicit InChICacheError(const std::string& what) : std::runtime_error(what) { }
+};
+
+/**
+  What the InChI library returned for one component structure.
+**/
+struct InChICacheValue {
+	std::string inchi_string;
+	std::string inchi_auxinfo;
+	std::string inchi_key;
+};
+
+struct InChICacheStats {
+	unsigned long hits;
+	unsigned long misses;
+	// Records written by this process.
+	unsigned long appends;
+	// Records that could not be written (e.g. disk full); the InChIs were still returned.
+	unsigned long append_errors;
+	// Valid records in the file as last seen by this process, including those of other processes.
+	size_t entries;
+
+	InChICacheStats(): hits(0), misses(0), appends(0), append_errors(0), entries(0) {}
+};
+
+/**
+  Persistent InChI cache file, shared by all processes (command line, Python, Oracle extproc)
+  that open the same path.
+
+  The file is a header followed by append-only records. Each record holds the SHA-256 of an
+  InChI input structure (see digest()) and the InChI string, AuxInfo and InChIKey calculated
+  for it. Every record carries a checksum, so a record that is still being written, or that was
+  left half-written by a crashed process, is simply not seen.
+
+  Readers map the file into memory and never take the file lock; each process keeps its own
+  index of the records it has seen and re-scans the file when it has grown. Writers take an
+  exclusive file lock to append. The file never shrinks, so a mapping never loses its pages.
+
+  The header records RINCHI_VERSION and inchi_lib_version(). A file written by another version
+  is replaced by an empty one on open; processes still running the old version keep using the
+  file they have open. Records are in native byte order, so a file written on a platform of the
+  other endianness is replaced too.
+**/
+class InChICache {
+	public:
+		// The key of a structure: SHA-256 over all fields of 'input' that the InChI library reads,
+		// including 'szOptions'. The same structure with its atoms in another order gets another
+		// key; only the InChI library itself can canonicalize atom order.
+		struct Digest {
+			unsigned char bytes[32];
+		};
+		static Digest digest(const inchi_Input& input);
+
+		// Opens or creates the cache file. Throws InChICacheError if it cannot be opened or
+		// mapped, or if a file of another version cannot be replaced.
+		explicit InChICache(const std::string& path);
+		~InChICache();
+
+		InChICache(const InChICache&) = delete;
+		InChICache& operator=(const InChICache&) = delete;
+
+		const std::string& path() const { return m_path; }
+
+		// Returns false on a miss. Does not take the file lock.
+		bool find(const Digest& key, InChICacheValue& result);
+		// Appends a record unless another process (or thread) already has. I/O errors are only
+		// counted: the cache is an optimization and must not make InChI calculation fail.
+		void insert(const Digest& key, const InChICacheValue& value);
+
+		InChICacheStats stats();
+
+	private:
+		class File;
+
+		std::string m_path;
+		std::unique_ptr<File> m_file;
+		// Guards everything below, and the mapping in 'm_file'.
+		std::mutex m_mutex;
+		// Maps the first 8 bytes of a digest to the offset of its record.
+		std::unordered_map<uint64_t, uint64_t> m_index;
+		// End of the last valid record seen; new records are written here.
+		uint64_t m_scan_end;
+		InChICacheStats m_stats;
+
+		// Opens 'm_path', replacing a file of another version.
+		void open();
+		// Maps any bytes appended since the last call and indexes the records in them.
+		void refresh();
+		bool lookup(const Digest& key, InChICacheValue* result);
+};
+
+/**
+  The process-wide cache consulted by ReactionComponent. Unless set_inchi_cache_file() is
+  called first, the cache file is taken from the RINCHI_INCHI_CACHE environment variable, which
+  is the way to configure it for the command line program and the Oracle extproc agent.
+**/
+
+// NULL if no cache file is configured.
+std::shared_ptr<InChICache> inchi_cache();
+// A blank 'path' turns the cache off. Throws InChICacheError (and leaves the previous cache in
+// place) if the file cannot be opened.
+void set_inchi_cache_file(const std::string& path);
+
+} // end of namespace
+
+#endif
@@ -0,0 +1,191 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include "rinchi_lane_scheduler.h"
+
+#include <algorithm>
+
+namespace rinchi {
+
+const char* lane_name(SchedulerLane lane)
+{
+	return lane == LANE_INTERACTIVE ? "interactive" : "bulk";
+}
+
+double LaneStats::mean_wait_ms() const
+{
+	unsigned long started = completed + failed + running;
+	return started == 0 ? 0.0 : total_wait.count() / 1000.0 / started;
+}
+
+LaneScheduler::LaneScheduler(unsigned worker_count, unsigned reserved_workers):
+	m_worker_count(worker_count), m_reserved_workers(reserved_workers), m_idle_reserved_workers(0), m_stopping(false)
+{
+	if (m_worker_count == 0)
+		m_worker_count = std::max(1u, std::thread::hardware_concurrency());
+	if (m_reserved_workers >= m_worker_count)
+		m_worker_count = m_reserved_workers + 1;
+
+	for (unsigned i = 0; i < m_worker_count; i++)
+		m_workers.push_back(std::thread(&LaneScheduler::work, this, i < m_reserved_workers ? LANE_INTERACTIVE : LANE_BULK));
+}
+
+LaneScheduler::~LaneScheduler()
+{
+	shutdown();
+}
+
+bool LaneScheduler::can_take(SchedulerLane home_lane, SchedulerLane& lane) const
+{
+	if (!m_queues[LANE_INTERACTIVE].empty()) {
+		lane = LANE_INTERACTIVE;
+		return true;
+	}
+	// The calling worker counts as idle, so "> 1" leaves another interactive worker waiting.
+	if (!m_queues[LANE_BULK].empty() && (home_lane == LANE_BULK || m_idle_reserved_workers > 1 || m_stopping)) {
+		lane = LANE_BULK;
+		return true;
+	}
+	return false;
+}
+
+void LaneScheduler::work(SchedulerLane home_lane)
+{
+	for (;;) {
+		QueuedTask queued;
+		SchedulerLane lane = home_lane;
+		Clock::duration wait;
+		{
+			std::unique_lock<std::mutex> lock (m_mutex);
+			if (home_lane == LANE_INTERACTIVE) {
+				m_idle_reserved_workers++;
+				// Another interactive worker may steal bulk work now that this one is idle.
+				if (!m_queues[LANE_BULK].empty())
+					m_work_available.notify_all();
+			}
+			m_work_available.wait(lock, [&]() { return m_stopping || can_take(home_lane, lane); });
+			bool has_task = can_take(home_lane, lane);
+			if (home_lane == LANE_INTERACTIVE)
+				m_idle_reserved_workers--;
+			if (!has_task)
+				return;
+
+			queued = m_queues[lane].front();
+			m_queues[lane].pop_front();
+
+			LaneStats& stats = m_stats[lane];
+			wait = Clock::now() - queued.submitted;
+			std::chrono::microseconds wait_micros = std::chrono::duration_cast<std::chrono::microseconds>(wait);
+			stats.total_wait += wait_micros;
+			stats.max_wait = std::max(stats.max_wait, wait_micros);
+			stats.running++;
+			if (lane != home_lane)
+				stats.stolen++;
+		}
+
+		bool failed = false;
+		try {
+			queued.task(wait);
+		}
+		catch (...) {
+			failed = true;
+		}
+
+		std::lock_guard<std::mutex> lock (m_mutex);
+		LaneStats& stats = m_stats[lane];
+		stats.running--;
+		if (failed)
+			stats.failed++;
+		else
+			stats.completed++;
+	}
+}
+
+bool LaneScheduler::submit(SchedulerLane lane, Task task)
+{
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		if (m_stopping)
+			return false;
+		QueuedTask queued;
+		queued.task = task;
+		queued.submitted = Clock::now();
+		m_queues[lane].push_back(queued);
+
+		LaneStats& stats = m_stats[lane];
+		stats.submitted++;
+		stats.peak_queue_depth = std::max(stats.peak_queue_depth, m_queues[lane].size());
+	}
+	// Not every waiting worker may take a bulk task.
+	m_work_available.notify_all();
+	return true;
+}
+
+void LaneScheduler::shutdown()
+{
+	std::vector<std::thread> workers;
+	{
+		std::lock_guard<std::mutex> lock (m_mutex);
+		m_stopping = true;
+		workers.swap(m_workers);
+	}
+	m_work_available.notify_all();
+	for (std::vector<std::thread>::iterator worker = workers.begin(); worker != workers.end(); worker++)
+		worker->join();
+}
+
+unsigned LaneScheduler::worker_count() const
+{
+	return m_worker_count;
+}
+
+unsigned LaneScheduler::reserved_workers() const
+{
+	return m_reserved_workers;
+}
+
+LaneStats LaneScheduler::stats(SchedulerLane lane) const
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	LaneStats result = m_stats[lane];
+	result.queue_depth = m_queues[lane].size();
+	return result;
+}
+
+} // End of namespace.
@@ -0,0 +1,145 @@
+#ifndef IUPAC_RINCHI_LANE_SCHEDULER_HEADER_GUARD
+#define IUPAC_RINCHI_LANE_SCHEDULER_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rinchi {
+
+enum SchedulerLane {
+	// Single reactions somebody waits for.
+	LANE_INTERACTIVE = 0,
+	// Large files and batch jobs.
+	LANE_BULK = 1
+};
+
+const int SCHEDULER_LANE_COUNT = 2;
+
+// "interactive" or "bulk".
+const char* lane_name(SchedulerLane lane);
+
+struct LaneStats {
+	unsigned long submitted;
+	unsigned long completed;
+	// Tasks that threw an exception.
+	unsigned long failed;
+	// Tasks run by a worker of the other lane.
+	unsigned long stolen;
+	size_t queue_depth;
+	size_t peak_queue_depth;
+	size_t running;
+	// From submit() until a worker starts the task, over all started tasks.
+	std::chrono::microseconds total_wait;
+	std::chrono::microseconds max_wait;
+
+	LaneStats(): submitted(0), completed(0), failed(0), stolen(0), queue_depth(0), peak_queue_depth(0), running(0),
+		total_wait(0), max_wait(0) {}
+
+	double mean_wait_ms() const;
+};
+
+/**
+  Runs tasks of two lanes on one pool of worker threads, so that interactive requests do not
+  queue behind bulk jobs in a process that serves both.
+
+  Each lane has its own first-in-first-out queue. Interactive tasks come first for every worker.
+  'reserved_workers' of the workers belong to the interactive lane, the others to the bulk lane.
+  Bulk workers run interactive tasks whenever there are any, and otherwise bulk tasks. Interactive
+  workers steal bulk tasks only while another interactive worker stays idle, so that a new
+  interactive task always finds a worker without waiting for a bulk task to finish. With
+  interactive tasks arriving faster than all workers can run them, bulk tasks wait.
+
+  Tasks get the time they spent queued. They should not throw; an exception is caught and
+  counted in LaneStats::failed. All member functions may be called from several threads.
+**/
+class LaneScheduler {
+public:
+	typedef std::function<void (std::chrono::steady_clock::duration queue_wait)> Task;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct QueuedTask {
+		Task task;
+		Clock::time_point submitted;
+	};
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_work_available;
+	std::deque<QueuedTask> m_queues[SCHEDULER_LANE_COUNT];
+	LaneStats m_stats[SCHEDULER_LANE_COUNT];
+	unsigned m_worker_count;
+	unsigned m_reserved_workers;
+	// Interactive workers waiting for a task.
+	unsigned m_idle_reserved_workers;
+	bool m_stopping;
+	std::vector<std::thread> m_workers;
+
+	bool can_take(SchedulerLane home_lane, SchedulerLane& lane) const;
+	void work(SchedulerLane home_lane);
+public:
+	/**
+	  'worker_count' 0 means one per hardware thread. At least one worker belongs to the bulk
+	  lane: a worker is added if 'reserved_workers' would take them all.
+	**/
+	LaneScheduler(unsigned worker_count, unsigned reserved_workers);
+	// Runs the tasks still queued, see shutdown().
+	~LaneScheduler();
+
+	// Returns false, without running the task, after shutdown().
+	bool submit(SchedulerLane lane, Task task);
+	// Runs the tasks still queued, then stops the workers.
+	void shutdown();
+
+	unsigned worker_count() const;
+	unsigned reserved_workers() const;
+	LaneStats stats(SchedulerLane lane) const;
+};
+
+} // End of namespace.
+
+#endif
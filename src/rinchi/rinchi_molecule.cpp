@@ -0,0 +1,203 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include "rinchi_molecule.h"
+
+#include <cstring>
+
+#include "rinchi_utils.h"
+
+namespace rinchi {
+
+namespace {
+
+	template <typename T> size_t capacity_bytes(const std::vector<T>& v)
+	{
+		return v.capacity() * sizeof(T);
+	}
+
+}
+
+void Molecule::clear()
+{
+	m_elements.clear();
+	m_x.clear();
+	m_y.clear();
+	m_z.clear();
+	m_charges.clear();
+	m_radicals.clear();
+	m_isotopic_masses.clear();
+	m_implicit_hydrogens.clear();
+	m_bond_counts.clear();
+	m_bond_atoms.clear();
+	m_bond_orders.clear();
+	m_bond_stereos.clear();
+}
+
+void Molecule::swap(Molecule& other) noexcept
+{
+	m_elements.swap(other.m_elements);
+	m_x.swap(other.m_x);
+	m_y.swap(other.m_y);
+	m_z.swap(other.m_z);
+	m_charges.swap(other.m_charges);
+	m_radicals.swap(other.m_radicals);
+	m_isotopic_masses.swap(other.m_isotopic_masses);
+	m_implicit_hydrogens.swap(other.m_implicit_hydrogens);
+	m_bond_counts.swap(other.m_bond_counts);
+	m_bond_atoms.swap(other.m_bond_atoms);
+	m_bond_orders.swap(other.m_bond_orders);
+	m_bond_stereos.swap(other.m_bond_stereos);
+}
+
+void Molecule::reserve(int atom_count, int bond_count)
+{
+	m_elements.reserve(atom_count * ATOM_EL_LEN);
+	m_x.reserve(atom_count);
+	m_y.reserve(atom_count);
+	m_z.reserve(atom_count);
+	m_charges.reserve(atom_count);
+	m_radicals.reserve(atom_count);
+	m_isotopic_masses.reserve(atom_count);
+	m_implicit_hydrogens.reserve(atom_count);
+	m_bond_counts.reserve(atom_count);
+	m_bond_atoms.reserve(2 * bond_count);
+	m_bond_orders.reserve(bond_count);
+	m_bond_stereos.reserve(bond_count);
+}
+
+int Molecule::add_atom(const std::string& symbol, double x, double y, double z, int charge, int radical, int isotopic_mass)
+{
+	// Same limit as the InChI library's elname field; the string-length + 1 bytes include the 0-byte.
+	char elname[ATOM_EL_LEN];
+	memset(elname, 0, ATOM_EL_LEN);
+	safe_strcpy(elname, ATOM_EL_LEN, symbol.c_str(), symbol.length() + 1);
+	m_elements.insert(m_elements.end(), elname, elname + ATOM_EL_LEN);
+
+	m_x.push_back(x);
+	m_y.push_back(y);
+	m_z.push_back(z);
+	m_charges.push_back(charge);
+	m_radicals.push_back(radical);
+	m_isotopic_masses.push_back(isotopic_mass);
+	m_implicit_hydrogens.push_back(-1);
+	m_bond_counts.push_back(0);
+	return atom_count() - 1;
+}
+
+void Molecule::add_bond(int from_atom_idx, int to_atom_idx, int bond_order, BondStereo bond_stereo)
+{
+	check_range<std::runtime_error>(from_atom_idx, 0, atom_count() - 1, "Bond: from atom index");
+	check_range<std::runtime_error>(to_atom_idx, 0, atom_count() - 1, "Bond: to atom index");
+	if (m_bond_counts[from_atom_idx] >= MAXVAL || m_bond_counts[to_atom_idx] >= MAXVAL)
+		throw std::runtime_error("Atom with more than " + int2str(MAXVAL) + " bonds.");
+
+	m_bond_counts[from_atom_idx]++;
+	m_bond_counts[to_atom_idx]++;
+	m_bond_atoms.push_back(from_atom_idx);
+	m_bond_atoms.push_back(to_atom_idx);
+	m_bond_orders.push_back(bond_order);
+	m_bond_stereos.push_back(bond_stereo);
+}
+
+const char* Molecule::element(int atom_idx) const
+{
+	check_range<std::runtime_error>(atom_idx, 0, atom_count() - 1, "Atom index");
+	return &m_elements[atom_idx * ATOM_EL_LEN];
+}
+
+void Molecule::set_charge(int atom_idx, int charge)
+{
+	check_range<std::runtime_error>(atom_idx, 0, atom_count() - 1, "Atom index");
+	m_charges[atom_idx] = charge;
+}
+
+void Molecule::set_radical(int atom_idx, int radical)
+{
+	check_range<std::runtime_error>(atom_idx, 0, atom_count() - 1, "Atom index");
+	m_radicals[atom_idx] = radical;
+}
+
+void Molecule::set_isotopic_mass(int atom_idx, int isotopic_mass)
+{
+	check_range<std::runtime_error>(atom_idx, 0, atom_count() - 1, "Atom index");
+	m_isotopic_masses[atom_idx] = isotopic_mass;
+}
+
+void Molecule::set_implicit_hydrogens(int atom_idx, int count)
+{
+	check_range<std::runtime_error>(atom_idx, 0, atom_count() - 1, "Atom index");
+	m_implicit_hydrogens[atom_idx] = count;
+}
+
+void Molecule::to_inchi_input(std::vector<inchi_Atom>& atoms, inchi_Input& result) const
+{
+	// Value-initialization zeroes the atoms, which is what InChI expects of unused fields.
+	atoms.assign(atom_count(), inchi_Atom());
+
+	memset(&result, 0, sizeof(result));
+	result.atom = atoms.empty() ? NULL : &atoms[0];
+	result.num_atoms = atom_count();
+
+	for (int i = 0; i < atom_count(); i++) {
+		inchi_Atom& atom = atoms[i];
+		memcpy(atom.elname, &m_elements[i * ATOM_EL_LEN], ATOM_EL_LEN);
+		atom.x = m_x[i];
+		atom.y = m_y[i];
+		atom.z = m_z[i];
+		atom.charge = m_charges[i];
+		atom.radical = m_radicals[i];
+		atom.isotopic_mass = m_isotopic_masses[i];
+		atom.num_iso_H[0] = m_implicit_hydrogens[i];
+	}
+
+	for (int i = 0; i < bond_count(); i++)
+		inchi_add_bond(result, bond_atom(i, 0), bond_atom(i, 1), m_bond_orders[i], (BondStereo) m_bond_stereos[i]);
+}
+
+size_t Molecule::memory_usage() const
+{
+	return
+		capacity_bytes(m_elements) + capacity_bytes(m_x) + capacity_bytes(m_y) + capacity_bytes(m_z) +
+		capacity_bytes(m_charges) + capacity_bytes(m_radicals) + capacity_bytes(m_isotopic_masses) +
+		capacity_bytes(m_implicit_hydrogens) + capacity_bytes(m_bond_counts) +
+		capacity_bytes(m_bond_atoms) + capacity_bytes(m_bond_orders) + capacity_bytes(m_bond_stereos);
+}
+
+} // End of namespace.
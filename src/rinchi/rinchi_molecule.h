@@ -0,0 +1,109 @@
+#ifndef IUPAC_RINCHI_MOLECULE_HEADER_GUARD
+#define IUPAC_RINCHI_MOLECULE_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <string>
+#include <vector>
+
+#include "inchi_api.h"
+#include "inchi_api_intf.h"
+
+namespace rinchi {
+
+/**
+  Structure of a reaction component as filled in by the parsers, kept as one array per atom
+  property plus a bond list.
+
+  An inchi_Atom has room for MAXVAL neighbours, bond types and bond stereos on every atom, which
+  makes it several times larger than the atom and its share of the bonds. The inchi_Input that
+  the InChI library needs is therefore only built by to_inchi_input() for the duration of a call.
+**/
+class Molecule {
+private:
+	// ATOM_EL_LEN chars per atom, 0-terminated.
+	std::vector<char> m_elements;
+	std::vector<double> m_x;
+	std::vector<double> m_y;
+	std::vector<double> m_z;
+	std::vector<signed char> m_charges;
+	std::vector<signed char> m_radicals;
+	std::vector<short> m_isotopic_masses;
+	// inchi_Atom.num_iso_H[0] convention: -1 lets InChI add implicit hydrogens.
+	std::vector<signed char> m_implicit_hydrogens;
+	std::vector<unsigned char> m_bond_counts;
+	// Two atom indexes per bond.
+	std::vector<int> m_bond_atoms;
+	std::vector<signed char> m_bond_orders;
+	std::vector<signed char> m_bond_stereos;
+public:
+	void clear();
+	void reserve(int atom_count, int bond_count);
+	void swap(Molecule& other) noexcept;
+
+	int atom_count() const { return (int) m_charges.size(); }
+	int bond_count() const { return (int) m_bond_orders.size(); }
+
+	// Appends an atom and returns its index. Implicit hydrogens are left to InChI.
+	int add_atom(const std::string& symbol, double x, double y, double z, int charge, int radical, int isotopic_mass);
+	// Throws if an atom index is out of range or an atom would get more than MAXVAL bonds.
+	void add_bond(int from_atom_idx, int to_atom_idx, int bond_order, BondStereo bond_stereo);
+
+	const char* element(int atom_idx) const;
+	void set_charge(int atom_idx, int charge);
+	void set_radical(int atom_idx, int radical);
+	void set_isotopic_mass(int atom_idx, int isotopic_mass);
+	// Fixes the number of implicit hydrogens; -1 leaves them to InChI again.
+	void set_implicit_hydrogens(int atom_idx, int count);
+
+	int bond_atom(int bond_idx, int end) const { return m_bond_atoms[2 * bond_idx + end]; }
+	int bond_order(int bond_idx) const { return m_bond_orders[bond_idx]; }
+
+	// Fills 'result' with the structure, keeping the atoms in 'atoms'. 'result' points into
+	// 'atoms' and is only valid as long as that is left alone. 'result.szOptions' is not set.
+	void to_inchi_input(std::vector<inchi_Atom>& atoms, inchi_Input& result) const;
+
+	// Bytes allocated for the arrays.
+	size_t memory_usage() const;
+};
+
+} // End of namespace.
+
+#endif
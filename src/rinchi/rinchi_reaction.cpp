@@ -41,6 +41,9 @@
 #include <algorithm>
 #include <memory>
 #include <map>
+#include <exception>
+#include <thread>
+#include <utility>
 
 #include "inchi_api_intf.h"
 
@@ -49,11 +52,14 @@
 #include "inchi_generator.h"
 #include "rinchi_utils.h"
 #include "rinchi_hashing.h"
+#include "rinchi_parallel.h"
+#include "rinchi_inchi_cache.h"
 
 namespace rinchi {
 
 #ifdef IN_RINCHI_TEST_SUITE
-std::string __latest_hash_cleartext;
+// Per thread, as keys may be calculated on several threads at once.
+thread_local std::string __latest_hash_cleartext;
 
 std::string latest_hash_cleartext()
 {
@@ -66,60 +72,126 @@ std::string latest_hash_cleartext()
 **/
 
 ReactionComponent::ReactionComponent()
+	: m_has_structure(false), m_structure_released(false), m_is_chiral(false), m_omit_auxinfo(false)
 {
-	clear_inchi_input();
 }
 
 ReactionComponent::~ReactionComponent()
 {
-	if (m_inchi_input.atom != NULL)
-		delete [] m_inchi_input.atom;
 }
 
-void ReactionComponent::clear_inchi_input()
+ReactionComponent::ReactionComponent(ReactionComponent&& other) noexcept
+	: ReactionComponent()
 {
-	m_inchi_input.atom      = NULL;
-	m_inchi_input.stereo0D  = NULL;
-	m_inchi_input.szOptions = NULL;
-	m_inchi_input.num_atoms    = 0;
-	m_inchi_input.num_stereo0D = 0;
+	swap(other);
 }
 
-void ReactionComponent::initialize(int atom_count, bool is_chiral)
+ReactionComponent& ReactionComponent::operator=(ReactionComponent&& other) noexcept
+{
+	// The old content goes with 'tmp'.
+	ReactionComponent tmp (std::move(other));
+	swap(tmp);
+	return *this;
+}
+
+void ReactionComponent::swap(ReactionComponent& other) noexcept
 {
-	if (m_inchi_input.atom != NULL)
-		delete [] m_inchi_input.atom;
+	m_molecule.swap(other.m_molecule);
+	std::swap(m_has_structure, other.m_has_structure);
+	std::swap(m_structure_released, other.m_structure_released);
+	m_inchi_string.swap(other.m_inchi_string);
+	m_inchi_auxinfo.swap(other.m_inchi_auxinfo);
+	m_inchi_key.swap(other.m_inchi_key);
+	m_molfile.swap(other.m_molfile);
+	std::swap(m_is_chiral, other.m_is_chiral);
+	std::swap(m_omit_auxinfo, other.m_omit_auxinfo);
+}
 
-	clear_inchi_input();
-	m_inchi_input.num_atoms = atom_count;
-	m_inchi_input.atom = new inchi_Atom[atom_count];
+void ReactionComponent::initialize(int atom_count, bool is_chiral)
+{
+	m_molecule.clear();
+	// Molfiles rarely have many more bonds than atoms.
+	m_molecule.reserve(atom_count, atom_count + atom_count / 4);
+	m_has_structure = true;
+	m_structure_released = false;
+	m_is_chiral = is_chiral;
+}
 
-	if (is_chiral)
-		m_inchi_input.szOptions = (char *) INCHI_INPUT_OPTION_CHIRAL_FLAG_ON;
+const char* ReactionComponent::inchi_options() const
+{
+	if (m_is_chiral)
+		return m_omit_auxinfo ? INCHI_INPUT_OPTION_CHIRAL_FLAG_ON_AUXNONE : INCHI_INPUT_OPTION_CHIRAL_FLAG_ON;
 	else
-		m_inchi_input.szOptions = (char *) INCHI_INPUT_OPTION_CHIRAL_FLAG_OFF;
+		return m_omit_auxinfo ? INCHI_INPUT_OPTION_CHIRAL_FLAG_OFF_AUXNONE : INCHI_INPUT_OPTION_CHIRAL_FLAG_OFF;
 }
 
-inchi_Input& ReactionComponent::inchi_input()
+void ReactionComponent::calculate_inchi(std::string& inchi_string, std::string& inchi_auxinfo, std::string& inchi_key) const
 {
-	return m_inchi_input;
+	std::vector<inchi_Atom> atoms;
+	inchi_Input input;
+	m_molecule.to_inchi_input(atoms, input);
+	input.szOptions = (char *) inchi_options();
+
+	// No-Structures are quicker to calculate than to look up.
+	std::shared_ptr<InChICache> cache;
+	if (input.num_atoms > 0)
+		cache = inchi_cache();
+	if (!cache) {
+		InChIGenerator().calculate_inchi(input, inchi_string, inchi_auxinfo);
+		return;
+	}
+
+	InChICache::Digest key = InChICache::digest(input);
+	InChICacheValue value;
+	if (!cache->find(key, value)) {
+		InChIGenerator().calculate_inchi(input, value.inchi_string, value.inchi_auxinfo);
+		value.inchi_key = InChIGenerator().inchi_string2key(value.inchi_string);
+		cache->insert(key, value);
+	}
+	inchi_string.swap(value.inchi_string);
+	inchi_auxinfo.swap(value.inchi_auxinfo);
+	inchi_key.swap(value.inchi_key);
 }
 
 bool ReactionComponent::is_no_structure() const
 {
 	// If component was instantiated directly from RInChI, then
-	// 'm_inchi_input' has not had atoms allocated.
-	if (m_inchi_input.atom == NULL)
+	// there is no molecule to look at.
+	if (!m_has_structure)
 		return m_inchi_string == INCHI_STD_HEADER + "/";
 	else
-		return m_inchi_input.num_atoms == 0;
+		return m_molecule.atom_count() == 0;
+}
+
+size_t ReactionComponent::release_structure()
+{
+	size_t result = m_molecule.memory_usage();
+	if (!m_molfile.empty())
+		result += m_molfile.capacity();
+
+	// No-Structures have no InChI to fall back on; an empty structure keeps them what they are.
+	if (m_has_structure && !is_no_structure()) {
+		inchi_string();
+		m_has_structure = false;
+		m_structure_released = true;
+	}
+	// swap() rather than clear() to actually free the arrays.
+	Molecule().swap(m_molecule);
+	release_molfile();
+	return result;
 }
 
 void ReactionComponent::reset_inchi_string()
 {
+	// The InChI string is the structure of these; an empty Molecule would make them No-Structures.
+	if (!m_has_structure) {
+		release_molfile();
+		return;
+	}
 	m_inchi_string.clear();
 	m_inchi_auxinfo.clear();
 	m_inchi_key.clear();
+	release_molfile();
 }
 
 const std::string& ReactionComponent::inchi_string()
@@ -127,7 +199,7 @@ const std::string& ReactionComponent::inchi_string()
 	if (!m_inchi_string.empty())
 		return m_inchi_string;
 
-	InChIGenerator().calculate_inchi(m_inchi_input, m_inchi_string, m_inchi_auxinfo);
+	calculate_inchi(m_inchi_string, m_inchi_auxinfo, m_inchi_key);
 	return m_inchi_string;
 }
 
@@ -136,7 +208,7 @@ const std::string& ReactionComponent::inchi_auxinfo()
 	if (!m_inchi_string.empty())
 		return m_inchi_auxinfo;
 
-	InChIGenerator().calculate_inchi(m_inchi_input, m_inchi_string, m_inchi_auxinfo);
+	calculate_inchi(m_inchi_string, m_inchi_auxinfo, m_inchi_key);
 	return m_inchi_auxinfo;
 }
 
@@ -149,15 +221,65 @@ const std::string& ReactionComponent::inchi_key()
 	return m_inchi_key;
 }
 
+const std::string& ReactionComponent::molfile()
+{
+	if (!m_molfile.empty())
+		return m_molfile;
+
+	m_molfile = InChIToStructureConverter().to_molfile(inchi_string(), inchi_auxinfo());
+	return m_molfile;
+}
+
+void ReactionComponent::release_molfile()
+{
+	// swap() rather than clear() to actually free the string's buffer.
+	std::string().swap(m_molfile);
+}
+
+std::string ReactionComponent::to_molfile() const
+{
+	if (!m_molfile.empty())
+		return m_molfile;
+	if (!m_inchi_string.empty())
+		return InChIToStructureConverter().to_molfile(m_inchi_string, m_inchi_auxinfo);
+
+	std::string inchi_string;
+	std::string inchi_auxinfo;
+	std::string inchi_key;
+	calculate_inchi(inchi_string, inchi_auxinfo, inchi_key);
+	return InChIToStructureConverter().to_molfile(inchi_string, inchi_auxinfo);
+}
+
+void ReactionComponent::set_omit_auxinfo(bool value)
+{
+	if (value == m_omit_auxinfo)
+		return;
+	if (!value && !can_calculate_auxinfo())
+		throw RInChIError("Cannot calculate AuxInfo of a component whose structure was released without it.");
+	m_omit_auxinfo = value;
+
+	// Components loaded from InChI strings have no structure to recalculate from.
+	if (!m_has_structure)
+		return;
+	if (!m_omit_auxinfo && m_inchi_auxinfo.empty())
+		reset_inchi_string();
+}
+
+bool ReactionComponent::can_calculate_auxinfo() const
+{
+	return !m_structure_released || !m_inchi_auxinfo.empty();
+}
+
 /**
   Reaction
 **/
 
 namespace {
 
-	ReactionComponent* add_new_component_to_list(ReactionComponentList& list)
+	ReactionComponent* add_new_component_to_list(ReactionComponentList& list, bool omit_auxinfo)
 	{
 		std::unique_ptr<ReactionComponent> cmp (new ReactionComponent());
+		cmp->set_omit_auxinfo(omit_auxinfo);
 		list.push_back(cmp.get());
 		return cmp.release();
 	}
@@ -172,11 +294,13 @@ namespace {
 }
 
 Reaction::Reaction()
-	: m_directionality(rdDirectional), m_is_cache_valid(false), m_reverse_output(false)
+	: m_directionality(rdDirectional), m_omit_auxinfo(false), m_max_inchi_threads(0), m_is_cache_valid(false)
 {
 	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
-		m_output_order[i]    = -1;
 		m_nostruct_counts[i] = 0;
+		m_is_group_dirty[i]  = false;
+		m_has_long_key_group[i]   = false;
+		m_has_short_key_hashes[i] = false;
 	}
 }
 
@@ -187,6 +311,49 @@ Reaction::~Reaction()
 	clear_component_list(m_agents);
 }
 
+Reaction::Reaction(Reaction&& other) noexcept
+	: Reaction()
+{
+	swap(other);
+}
+
+Reaction& Reaction::operator=(Reaction&& other) noexcept
+{
+	// The old components are deleted with 'tmp'.
+	Reaction tmp (std::move(other));
+	swap(tmp);
+	return *this;
+}
+
+void Reaction::swap(Reaction& other) noexcept
+{
+	// The component lists only hold pointers, so the cache stays valid on either side.
+	m_reactants.swap(other.m_reactants);
+	m_products.swap(other.m_products);
+	m_agents.swap(other.m_agents);
+	std::swap(m_directionality, other.m_directionality);
+	std::swap(m_omit_auxinfo, other.m_omit_auxinfo);
+	std::swap(m_max_inchi_threads, other.m_max_inchi_threads);
+
+	std::swap(m_is_cache_valid, other.m_is_cache_valid);
+	std::swap(m_is_group_dirty, other.m_is_group_dirty);
+	std::swap(m_ordered_rcs, other.m_ordered_rcs);
+	std::swap(m_pending_rcs, other.m_pending_rcs);
+	std::swap(m_rinchi_groups, other.m_rinchi_groups);
+	std::swap(m_rauxinfo_groups, other.m_rauxinfo_groups);
+	std::swap(m_nostruct_counts, other.m_nostruct_counts);
+	std::swap(m_has_long_key_group, other.m_has_long_key_group);
+	std::swap(m_long_key_groups, other.m_long_key_groups);
+	std::swap(m_has_short_key_hashes, other.m_has_short_key_hashes);
+	std::swap(m_short_key_major_hashes, other.m_short_key_major_hashes);
+	std::swap(m_short_key_minor_hashes, other.m_short_key_minor_hashes);
+	m_web_key.swap(other.m_web_key);
+#ifdef IN_RINCHI_TEST_SUITE
+	std::swap(m_short_key_cleartexts, other.m_short_key_cleartexts);
+	m_web_key_cleartext.swap(other.m_web_key_cleartext);
+#endif
+}
+
 bool Reaction::empty() const
 {
 	return (
@@ -195,22 +362,107 @@ bool Reaction::empty() const
 	);
 }
 
-ReactionComponent* Reaction::add_reactant()
+size_t Reaction::structure_memory_usage() const
 {
+	size_t result = 0;
+	const ReactionComponentList* lists[RINCHI_NUM_GROUPS] = { &m_reactants, &m_products, &m_agents };
+	for (int i = 0; i < RINCHI_NUM_GROUPS; i++)
+		for (ReactionComponentList::const_iterator rc = lists[i]->begin(); rc != lists[i]->end(); rc++)
+			result += (*rc)->structure_memory_usage();
+	return result;
+}
+
+size_t Reaction::compact()
+{
+	// Brings every group up to date, which calculates the InChIs of all components with a
+	// structure.
+	update_cache();
+
+	size_t result = 0;
+	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
+		const ReactionComponentList& list = component_list(i);
+		for (ReactionComponentList::const_iterator rc = list.begin(); rc != list.end(); rc++)
+			result += (*rc)->release_structure();
+	}
+	return result;
+}
+
+ReactionComponentList& Reaction::component_list(int group_idx)
+{
+	switch (group_idx) {
+		case 0: return m_reactants;
+		case 1: return m_products;
+		case 2: return m_agents;
+		default:
+			throw RInChIError("Internal bug: Unexpected group index (" + int2str(group_idx) + ").");
+	}
+}
+
+void Reaction::mark_group_dirty(int group_idx)
+{
+	m_is_group_dirty[group_idx] = true;
 	m_is_cache_valid = false;
-	return add_new_component_to_list(m_reactants);
+}
+
+ReactionComponent* Reaction::add_reactant()
+{
+	ReactionComponent* result = add_new_component_to_list(m_reactants, m_omit_auxinfo);
+	m_pending_rcs[0].push_back(result);
+	mark_group_dirty(0);
+	return result;
 }
 
 ReactionComponent* Reaction::add_product()
 {
-	m_is_cache_valid = false;
-	return add_new_component_to_list(m_products);
+	ReactionComponent* result = add_new_component_to_list(m_products, m_omit_auxinfo);
+	m_pending_rcs[1].push_back(result);
+	mark_group_dirty(1);
+	return result;
 }
 
 ReactionComponent* Reaction::add_agent()
 {
-	m_is_cache_valid = false;
-	return add_new_component_to_list(m_agents);
+	ReactionComponent* result = add_new_component_to_list(m_agents, m_omit_auxinfo);
+	m_pending_rcs[2].push_back(result);
+	mark_group_dirty(2);
+	return result;
+}
+
+namespace {
+
+	ReactionComponent* component_at(const ReactionComponentList& list, int idx, const char* group_name)
+	{
+		if (idx < 0 || idx >= (int) list.size())
+			throw RInChIError(std::string(group_name) + " index out of range (" + int2str(idx) + ").");
+		return list[idx];
+	}
+
+}
+
+ReactionComponent* Reaction::reactant(int idx)
+{
+	return component_at(m_reactants, idx, "Reactant");
+}
+
+ReactionComponent* Reaction::product(int idx)
+{
+	return component_at(m_products, idx, "Product");
+}
+
+ReactionComponent* Reaction::agent(int idx)
+{
+	return component_at(m_agents, idx, "Agent");
+}
+
+namespace {
+
+	void remove_from_list(ReactionComponentList& list, ReactionComponent* component)
+	{
+		ReactionComponentList::iterator pos = std::find(list.begin(), list.end(), component);
+		if (pos != list.end())
+			list.erase(pos);
+	}
+
 }
 
 void Reaction::delete_agent(ReactionComponent* agent)
@@ -219,11 +471,38 @@ void Reaction::delete_agent(ReactionComponent* agent)
 	if (agent_to_delete == m_agents.end())
 		return;
 
-	m_is_cache_valid = false;
 	m_agents.erase(agent_to_delete);
+	// The rest of the group stays sorted without it.
+	remove_from_list(m_ordered_rcs[2], agent);
+	remove_from_list(m_pending_rcs[2], agent);
+	mark_group_dirty(2);
 	delete agent;
 }
 
+void Reaction::reset_rinchis()
+{
+	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
+		m_ordered_rcs[i].clear();
+		m_pending_rcs[i] = component_list(i);
+		mark_group_dirty(i);
+	}
+}
+
+void Reaction::reset_component(ReactionComponent* component)
+{
+	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
+		ReactionComponentList& list = component_list(i);
+		if (std::find(list.begin(), list.end(), component) == list.end())
+			continue;
+
+		component->reset_inchi_string();
+		if (std::find(m_pending_rcs[i].begin(), m_pending_rcs[i].end(), component) == m_pending_rcs[i].end())
+			m_pending_rcs[i].push_back(component);
+		mark_group_dirty(i);
+		return;
+	}
+}
+
 ReactionDirectionality Reaction::directionality() const
 {
 	return m_directionality;
@@ -240,13 +519,65 @@ int Reaction::nostructure_count(int group_idx)
 	return m_nostruct_counts[group_idx];
 }
 
-int Reaction::num_output_groups(bool consider_nostruct_counts)
+void Reaction::set_omit_auxinfo(bool value)
+{
+	if (value == m_omit_auxinfo)
+		return;
+
+	// Checked up front so that a failure leaves every component as it was.
+	if (!value) {
+		for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
+			ReactionComponentList& list = component_list(i);
+			for (ReactionComponentList::iterator rc = list.begin(); rc != list.end(); rc++)
+				if (!(*rc)->can_calculate_auxinfo())
+					throw RInChIError("Cannot calculate RAuxInfo: the reaction was compacted in AuxInfo-free mode.");
+		}
+	}
+
+	m_omit_auxinfo = value;
+	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
+		ReactionComponentList& list = component_list(i);
+		for (ReactionComponentList::iterator rc = list.begin(); rc != list.end(); rc++)
+			(*rc)->set_omit_auxinfo(value);
+		// The InChIs, and so the order of the components, do not change; only RAuxInfo does.
+		mark_group_dirty(i);
+	}
+}
+
+Reaction::OutputLayout Reaction::output_layout(int variant_flags)
+{
+	update_cache();
+
+	OutputLayout result;
+	int reactants_idx = 0;
+	int products_idx = 1;
+	if (variant_flags & rvReversed)
+		std::swap(reactants_idx, products_idx);
+
+	// Products go first if their InChIs sort before those of the reactants.
+	result.reverse_output = m_rinchi_groups[products_idx] < m_rinchi_groups[reactants_idx];
+	result.groups[0] = result.reverse_output ? products_idx : reactants_idx;
+	result.groups[1] = result.reverse_output ? reactants_idx : products_idx;
+	result.groups[2] = (variant_flags & rvWithoutAgents) ? -1 : 2;
+
+	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
+		if (result.groups[i] == -1 || (variant_flags & rvWithoutNoStructures))
+			result.nostruct_counts[i] = 0;
+		else
+			result.nostruct_counts[i] = m_nostruct_counts[result.groups[i]];
+	}
+
+	result.directionality = (variant_flags & rvEquilibrium) ? rdEquilibrium : m_directionality;
+	return result;
+}
+
+int Reaction::num_output_groups(const OutputLayout& layout, bool consider_nostruct_counts)
 {
 	int result = 1;
 	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
-		if (!m_rinchi_groups[m_output_order[i]].empty())
+		if (layout.groups[i] != -1 && !m_rinchi_groups[layout.groups[i]].empty())
 			result = i + 1;
-		if (consider_nostruct_counts && m_nostruct_counts[m_output_order[i]] != 0)
+		if (consider_nostruct_counts && layout.nostruct_counts[i] != 0)
 			result = i + 1;
 	}
 	return result;
@@ -279,36 +610,118 @@ namespace {
 
 }
 
-void Reaction::update_cache()
+void Reaction::calculate_missing_inchis()
 {
-	if (m_is_cache_valid)
+	unsigned thread_count = m_max_inchi_threads;
+	if (thread_count == 0)
+		thread_count = std::thread::hardware_concurrency();
+	if (thread_count <= 1)
 		return;
 
-	// Initialize output cache.
-	m_reverse_output = false;
-	{
-		ReactionComponentList* rc_lists [RINCHI_NUM_GROUPS];
+	// Components of clean groups all have their InChIs already, and No-Structures do not need
+	// the InChI library.
+	ReactionComponentList missing;
+	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
+		if (!m_is_group_dirty[i])
+			continue;
+		ReactionComponentList* rc_lists[2] = { &m_ordered_rcs[i], &m_pending_rcs[i] };
+		for (int k = 0; k < 2; k++) {
+			for (ReactionComponentList::const_iterator rc = rc_lists[k]->begin(); rc != rc_lists[k]->end(); rc++) {
+				if (!(*rc)->has_inchi_string() && !(*rc)->is_no_structure())
+					missing.push_back(*rc);
+			}
+		}
+	}
+	if (missing.size() < 2)
+		return;
+
+	// Errors are kept per component so that they are rethrown in component order, whatever the
+	// thread timing.
+	std::vector<std::exception_ptr> errors(missing.size());
+	parallel_for(missing.size(), thread_count, [&](size_t idx) {
+		try {
+			missing[idx]->inchi_string();
+		}
+		catch (...) {
+			errors[idx] = std::current_exception();
+		}
+	});
 
-		rc_lists[0] = &m_reactants;
-		rc_lists[1] = &m_products;
-		rc_lists[2] = &m_agents;
+	for (std::vector<std::exception_ptr>::const_iterator error = errors.begin(); error != errors.end(); error++) {
+		if (*error)
+			std::rethrow_exception(*error);
+	}
+}
 
-		for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
-			m_output_order[i] = i;
-			m_ordered_rcs[i].clear();
-			m_rinchi_groups[i].clear();
-			m_rauxinfo_groups[i].clear();
-			m_nostruct_counts[i] = 0;
-			// 'm_ordered_rcs' will not contain any No-Structures.
-			for (ReactionComponentList::const_iterator rc = rc_lists[i]->begin(); rc != rc_lists[i]->end(); rc++) {
-				if ((*rc)->is_no_structure())
-					m_nostruct_counts[i]++;
-				else
-					m_ordered_rcs[i].push_back(*rc);
-			}
+void Reaction::update_group(int group_idx)
+{
+	ReactionComponentList& ordered = m_ordered_rcs[group_idx];
+	ReactionComponentList& pending = m_pending_rcs[group_idx];
+
+	// Calculate the InChIs needed for sorting before anything is changed, so that an InChI
+	// error leaves the group dirty and intact.
+	for (ReactionComponentList::const_iterator rc = pending.begin(); rc != pending.end(); rc++) {
+		if (!(*rc)->is_no_structure())
+			(*rc)->inchi_string();
+	}
+
+	// Take changed components out of the sorted list; they are merged back in below.
+	for (ReactionComponentList::const_iterator rc = pending.begin(); rc != pending.end(); rc++)
+		remove_from_list(ordered, *rc);
+
+	// 'm_ordered_rcs' will not contain any No-Structures. Counting them again is cheap, and a
+	// changed component may have become, or stopped being, a No-Structure.
+	const ReactionComponentList& all_rcs = component_list(group_idx);
+	m_nostruct_counts[group_idx] = 0;
+	for (ReactionComponentList::const_iterator rc = all_rcs.begin(); rc != all_rcs.end(); rc++) {
+		if ((*rc)->is_no_structure())
+			m_nostruct_counts[group_idx]++;
+	}
+
+	// Sort the pending components on their own and merge them into the sorted rest. After a
+	// single-component edit this costs one pass over the group rather than a full re-sort.
+	size_t sorted_count = ordered.size();
+	for (ReactionComponentList::const_iterator rc = pending.begin(); rc != pending.end(); rc++) {
+		if (!(*rc)->is_no_structure())
+			ordered.push_back(*rc);
+	}
+	pending.clear();
+	std::sort(ordered.begin() + sorted_count, ordered.end(), ReactionComponent_inchi_string_less_than);
+	std::inplace_merge(ordered.begin(), ordered.begin() + sorted_count, ordered.end(), ReactionComponent_inchi_string_less_than);
+
+	// Concatenate InChIs into the group strings.
+	std::ostringstream rinchi_stream;
+	std::ostringstream rauxinfo_stream;
+	for (ReactionComponentList::const_iterator rc = ordered.begin(); rc != ordered.end(); rc++) {
+		if (rc != ordered.begin()) {
+			rinchi_stream << DELIM_COMP;
+			if (!m_omit_auxinfo)
+				rauxinfo_stream << DELIM_COMP;
 		}
+		// InChI string minus the leading "InChI=1S/".
+		rinchi_stream << (*rc)->inchi_string().substr(INCHI_STD_HEADER.length());
+		if (m_omit_auxinfo)
+			continue;
+		// AuxInfo minus the leading "AuxInfo=".
+		const std::string& auxinfo = (*rc)->inchi_auxinfo();
+		if (auxinfo.empty())
+			rauxinfo_stream << DELIM_LAYER;
+		else
+			rauxinfo_stream << auxinfo.substr(INCHI_AUXINFO_HEADER.length());
 	}
 
+	m_rinchi_groups[group_idx] = rinchi_stream.str();
+	m_rauxinfo_groups[group_idx] = rauxinfo_stream.str();
+	m_has_long_key_group[group_idx] = false;
+	m_has_short_key_hashes[group_idx] = false;
+	m_is_group_dirty[group_idx] = false;
+}
+
+void Reaction::update_cache()
+{
+	if (m_is_cache_valid)
+		return;
+
 	/** From Guenthers paper: 
 	    "For example, a RInChI of a reaction without a known product and no information about 
 		 solvents/reagents would only show the first group."
@@ -324,82 +737,67 @@ void Reaction::update_cache()
 	// if (m_reactants.empty() && m_nostruct_counts[0] == 0 && m_products.empty() && m_nostruct_counts[1] == 0)
 	//		throw RInChIError("Reaction has neither reactants nor products.");
 
-	// Sort and concatenate InChIs into groups.
-	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
-		std::sort(m_ordered_rcs[i].begin(), m_ordered_rcs[i].end(), ReactionComponent_inchi_string_less_than);
+	calculate_missing_inchis();
 
-		std::ostringstream rinchi_stream;
-		std::ostringstream rauxinfo_stream;
-		for (ReactionComponentList::const_iterator rc = m_ordered_rcs[i].begin(); rc != m_ordered_rcs[i].end(); rc++) {
-			if (rc != m_ordered_rcs[i].begin()) {
-				rinchi_stream << DELIM_COMP;
-				rauxinfo_stream << DELIM_COMP;
-			}
-			// InChI string minus the leading "InChI=1S/".
-			rinchi_stream << (*rc)->inchi_string().substr(INCHI_STD_HEADER.length());
-			// AuxInfo minus the leading "AuxInfo=".
-			const std::string& auxinfo = (*rc)->inchi_auxinfo();
-			if (auxinfo.empty())
-				rauxinfo_stream << DELIM_LAYER;
-			else
-				rauxinfo_stream << auxinfo.substr(INCHI_AUXINFO_HEADER.length());
-		}
-
-		m_rinchi_groups[i] = rinchi_stream.str();
-		m_rauxinfo_groups[i] = rauxinfo_stream.str();
+	// Bring the dirty groups up to date; the others keep their cached strings and key blocks.
+	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
+		if (!m_is_group_dirty[i])
+			continue;
+		update_group(i);
+		m_web_key.clear();
 	}
 
-	// Is the output reversed ?        +- products          +- reactants
-	m_reverse_output = m_rinchi_groups[1] < m_rinchi_groups[0];
-
-	if (m_reverse_output)
-		std::swap(m_output_order[0], m_output_order[1]);
-
 	m_is_cache_valid = true;
 }
 
 const std::string Reaction::rinchi_string()
 {
-	update_cache();
+	return rinchi_string(output_layout(0));
+}
 
+std::string Reaction::rinchi_string(const OutputLayout& layout)
+{
 	std::ostringstream result;
 	result << RINCHI_STD_HEADER;
 
 	bool has_nostructures = false;
 	for (int i = 0; i < RINCHI_NUM_GROUPS; i++)
-		has_nostructures |= (m_nostruct_counts[i] > 0);
+		has_nostructures |= (layout.nostruct_counts[i] > 0);
 
-	int group_count = num_output_groups(false);
+	int group_count = num_output_groups(layout, false);
 	for (int i = 0; i < group_count; i++) {
-		result << m_rinchi_groups[m_output_order[i]];
+		if (layout.groups[i] != -1)
+			result << m_rinchi_groups[layout.groups[i]];
 		if (i < group_count - 1)
 			result << DELIM_GROUP;
 	}
 
-	output_direction_flag(m_directionality, m_reverse_output, result);
+	output_direction_flag(layout.directionality, layout.reverse_output, result);
 
 	if (has_nostructures) {
 		result << NOSTRUCT_TAG;
 		for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
-			result << m_nostruct_counts[m_output_order[i]];
+			result << layout.nostruct_counts[i];
 			if (i < RINCHI_NUM_GROUPS - 1)
 				result << NOSTRUCT_DELIM;
 		}
 	}
 
-	return result.str();;
+	return result.str();
 }
 
 const std::string Reaction::rinchi_auxinfo()
 {
-	update_cache();
+	if (m_omit_auxinfo)
+		throw RInChIError("No RAuxInfo available: the reaction is in AuxInfo-free mode.");
+	OutputLayout layout = output_layout(0);
 
 	std::ostringstream result;
 	result << RINCHI_AUXINFO_HEADER;
 
-	int group_count = num_output_groups(false);
+	int group_count = num_output_groups(layout, false);
 	for (int i = 0; i < group_count; i++) {
-		result << m_rauxinfo_groups[m_output_order[i]];
+		result << m_rauxinfo_groups[layout.groups[i]];
 		if (i < group_count - 1)
 			result << DELIM_GROUP;
 	}
@@ -446,10 +844,10 @@ namespace {
 			return 'A' + nostruct_count - 1;
 	}
 
-	void output_nostruct_count_chars(int (& nostruct_counts)[RINCHI_NUM_GROUPS], int (& output_order)[RINCHI_NUM_GROUPS], std::ostream& result)
+	void output_nostruct_count_chars(const int (& nostruct_counts)[RINCHI_NUM_GROUPS], std::ostream& result)
 	{
 		for (int i = 0; i < RINCHI_NUM_GROUPS; i++)
-			result << nostruct_count2char(nostruct_counts[output_order[i]]);
+			result << nostruct_count2char(nostruct_counts[i]);
 	}
 
 	void output_direction_code(ReactionDirectionality direction, bool reverse_output, std::ostream& output)
@@ -472,10 +870,24 @@ namespace {
 
 }
 
+const std::string& Reaction::long_key_group(int group_idx)
+{
+	if (!m_has_long_key_group[group_idx]) {
+		std::ostringstream group_stream;
+		output_inchikey_group(m_ordered_rcs[group_idx], m_nostruct_counts[group_idx], group_stream);
+		m_long_key_groups[group_idx] = group_stream.str();
+		m_has_long_key_group[group_idx] = true;
+	}
+	return m_long_key_groups[group_idx];
+}
+
 const std::string Reaction::rinchi_long_key()
 {
-	update_cache();
+	return rinchi_long_key(output_layout(0));
+}
 
+std::string Reaction::rinchi_long_key(const OutputLayout& layout)
+{
 	std::ostringstream result;
 	result << RINCHI_LONG_KEY_HEADER;
 	/** Cite paper:
@@ -496,15 +908,22 @@ const std::string Reaction::rinchi_long_key()
 	  Since we don't handle unknown reaction directionality at present, only
 	  F, B, or E will be output by this code.
 	**/
-	output_direction_code(m_directionality, m_reverse_output, result);
+	output_direction_code(layout.directionality, layout.reverse_output, result);
 	// Output hash block for "additional reaction layers" - reserved for future use.
 	result << HASH_12_EMPTY_STRING.substr(0, 4) << KEY_DELIM_BLOCK;
 
 	std::string result_str = result.str();
 
-	int group_count = num_output_groups(true);
+	int group_count = num_output_groups(layout, true);
 	for (int i = 0; i < group_count; i++) {
-		output_inchikey_group(m_ordered_rcs[m_output_order[i]], m_nostruct_counts[m_output_order[i]], result);
+		int group_idx = layout.groups[i];
+		// A group left out of a variant has neither components nor No-Structures to output.
+		if (group_idx != -1) {
+			if (layout.nostruct_counts[i] == m_nostruct_counts[group_idx])
+				result << long_key_group(group_idx);
+			else
+				output_inchikey_group(m_ordered_rcs[group_idx], layout.nostruct_counts[i], result);
+		}
 		if (i < group_count - 1)
 			result << KEY_DELIM_GROUP;
 	}
@@ -674,9 +1093,27 @@ namespace {
 	};
 }
 
+void Reaction::update_short_key_hashes(int group_idx)
+{
+	if (m_has_short_key_hashes[group_idx])
+		return;
+
+	InChILayers layers (m_ordered_rcs[group_idx]);
+	m_short_key_major_hashes[group_idx] = layers.major_hash();
+	m_short_key_minor_hashes[group_idx] = layers.minor_hash();
+#ifdef IN_RINCHI_TEST_SUITE
+	m_short_key_cleartexts[group_idx] = layers.majors + "\n" + layers.minors + "\n";
+#endif
+	m_has_short_key_hashes[group_idx] = true;
+}
+
 const std::string Reaction::rinchi_short_key()
 {
-	update_cache();
+	return rinchi_short_key(output_layout(0));
+}
+
+std::string Reaction::rinchi_short_key(const OutputLayout& layout)
+{
 #ifdef IN_RINCHI_TEST_SUITE
 	__latest_hash_cleartext = "";
 #endif
@@ -685,7 +1122,7 @@ const std::string Reaction::rinchi_short_key()
 	result << RINCHI_SHORT_KEY_HEADER;
 
 	result << RINCHI_KEY_VERSION_ID_HEADER << KEY_DELIM_BLOCK;
-	output_direction_code(m_directionality, m_reverse_output, result);
+	output_direction_code(layout.directionality, layout.reverse_output, result);
 	// Output hash block for "additional reaction layers" - reserved for future use.
 	result << HASH_04_EMPTY_STRING;
 
@@ -693,51 +1130,76 @@ const std::string Reaction::rinchi_short_key()
 	std::string all_minor_hash = "";
 	// Output major/minor hash of component groups.
 	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
-		InChILayers layers (m_ordered_rcs[m_output_order[i]]);
-		all_major_hash += KEY_DELIM_BLOCK + layers.major_hash();
-		all_minor_hash += KEY_DELIM_BLOCK + layers.minor_hash();
+		int group_idx = layout.groups[i];
+		if (group_idx == -1) {
+			InChILayers no_layers;
+			all_major_hash += KEY_DELIM_BLOCK + no_layers.major_hash();
+			all_minor_hash += KEY_DELIM_BLOCK + no_layers.minor_hash();
+#ifdef IN_RINCHI_TEST_SUITE
+			__latest_hash_cleartext += "\n\n";
+#endif
+			continue;
+		}
+		update_short_key_hashes(group_idx);
+		all_major_hash += KEY_DELIM_BLOCK + m_short_key_major_hashes[group_idx];
+		all_minor_hash += KEY_DELIM_BLOCK + m_short_key_minor_hashes[group_idx];
 #ifdef IN_RINCHI_TEST_SUITE
-		__latest_hash_cleartext += layers.majors + "\n" + layers.minors + "\n";
+		__latest_hash_cleartext += m_short_key_cleartexts[group_idx];
 #endif
 	}
 	result << all_major_hash << all_minor_hash;
 
 	result << KEY_DELIM_BLOCK;
-	output_nostruct_count_chars(m_nostruct_counts, m_output_order, result);
+	output_nostruct_count_chars(layout.nostruct_counts, result);
 
 	return result.str();
 }
 
 const std::string Reaction::rinchi_web_key()
 {
-	update_cache();
+	OutputLayout layout = output_layout(0);
+	if (m_web_key.empty()) {
+		m_web_key = rinchi_web_key(layout);
+#ifdef IN_RINCHI_TEST_SUITE
+		m_web_key_cleartext = __latest_hash_cleartext;
+#endif
+	}
+#ifdef IN_RINCHI_TEST_SUITE
+	__latest_hash_cleartext = m_web_key_cleartext;
+#endif
+	return m_web_key;
+}
+
+std::string Reaction::rinchi_web_key(const OutputLayout& layout)
+{
 #ifdef IN_RINCHI_TEST_SUITE
 	__latest_hash_cleartext = "";
 #endif
 
-	// Create a unique list of all component InChIs.
+	// Create a unique list of all component InChIs. The sorted groups hold all components but
+	// the No-Structures, which all share one InChI.
 	typedef std::map<std::string, int> UniqueStringList;
 	UniqueStringList unique_inchis;
 
-	ReactionComponentList* all_comp_lists[RINCHI_NUM_GROUPS];
-	all_comp_lists[0] = &m_reactants;
-	all_comp_lists[1] = &m_products;
-	all_comp_lists[2] = &m_agents;
-
 	for (int i = 0; i < RINCHI_NUM_GROUPS; i++) {
-		for (ReactionComponentList::const_iterator rc = all_comp_lists[i]->begin(); rc != all_comp_lists[i]->end(); rc++)
-			unique_inchis.insert( make_pair((**rc).inchi_string(), 1) );
-	}
-
-	// Sort unique InChIs. A map will keep items sorted, but that is an implementation detail
-	// that I do not dare to rely on. So push items to a standard vector and sort that.
+		if (layout.groups[i] == -1)
+			continue;
+		const ReactionComponentList& group = m_ordered_rcs[layout.groups[i]];
+		for (ReactionComponentList::const_iterator rc = group.begin(); rc != group.end(); rc++)
+			unique_inchis.insert( make_pair((**rc).inchi_string(), 1) );
+		if (layout.nostruct_counts[i] > 0)
+			unique_inchis.insert( make_pair(NOSTRUCT_INCHI, 1) );
+	}
+
+	// Sort unique InChIs. A map will keep items sorted, but that is an implementation detail
+	// that I do not dare to rely on. So push items to a standard vector and sort that.
 	typedef std::vector<std::string> StringList;
 	StringList sorted_inchis;
-
-	for (UniqueStringList::const_iterator i = unique_inchis.begin(); i != unique_inchis.end(); i++)
-		sorted_inchis.push_back(i->first);
-
-	std::sort(sorted_inchis.begin(), sorted_inchis.end());
+
+	for (UniqueStringList::const_iterator i = unique_inchis.begin(); i != unique_inchis.end(); i++)
+		sorted_inchis.push_back(i->first);
+
+	std::sort(sorted_inchis.begin(), sorted_inchis.end());
 
 	// Output major/minor hash of combined unique InChI strings.
 	std::ostringstream result;
@@ -755,4 +1217,20 @@ const std::string Reaction::rinchi_web_key()
 	return result.str();
 }
 
+RInChIVariant Reaction::variant(int variant_flags)
+{
+	OutputLayout layout = output_layout(variant_flags);
+
+	RInChIVariant result;
+	result.rinchi_string = rinchi_string(layout);
+	result.long_key = rinchi_long_key(layout);
+	result.short_key = rinchi_short_key(layout);
+	// Neither direction nor the order of the groups goes into the web key.
+	if (variant_flags & (rvWithoutAgents | rvWithoutNoStructures))
+		result.web_key = rinchi_web_key(layout);
+	else
+		result.web_key = rinchi_web_key();
+	return result;
+}
+
 } // End of namespace.
@@ -45,6 +45,7 @@
 #include <stdexcept>
 
 #include "inchi_api.h"
+#include "rinchi_molecule.h"
 
 namespace rinchi {
 
@@ -64,35 +65,106 @@ class ReactionComponent {
 	friend class RInChIReader;
 	friend class RInChIReaderHelper;
 private:
-	inchi_Input m_inchi_input;
+	Molecule m_molecule;
+	// False for components loaded from InChI strings.
+	bool m_has_structure;
+	// Set by release_structure(): the InChI string is all that is left of the structure.
+	bool m_structure_released;
 	std::string m_inchi_string;
 	std::string m_inchi_auxinfo;
 	std::string m_inchi_key;
-	// Clear the 'inchi_input' data structure.
-	void clear_inchi_input();
+	std::string m_molfile;
+	bool m_is_chiral;
+	bool m_omit_auxinfo;
+	// The InChI options matching the flags above.
+	const char* inchi_options() const;
+	// Builds an inchi_Input from 'm_molecule' just for the InChI library call, or for looking
+	// it up in the InChI cache file (see inchi_cache()), which also provides the InChIKey;
+	// 'inchi_key' is left as it is otherwise.
+	void calculate_inchi(std::string& inchi_string, std::string& inchi_auxinfo, std::string& inchi_key) const;
 public:
 	ReactionComponent();
 	~ReactionComponent();
 
-	// Initializes the 'inchi_input' data structure.
+	// Components move, taking their structure along and leaving the source empty. Moving a
+	// component out of a Reaction empties it there too; call Reaction::reset_component() then.
+	// They do not copy: re-read the structure instead.
+	ReactionComponent(ReactionComponent&& other) noexcept;
+	ReactionComponent& operator=(ReactionComponent&& other) noexcept;
+	ReactionComponent(const ReactionComponent&) = delete;
+	ReactionComponent& operator=(const ReactionComponent&) = delete;
+	void swap(ReactionComponent& other) noexcept;
+
+	// Clears the structure and reserves room for 'atom_count' atoms.
 	void initialize(int atom_count, bool is_chiral);
-	inchi_Input& inchi_input();
+	Molecule& molecule() { return m_molecule; }
+	const Molecule& molecule() const { return m_molecule; }
 	bool is_no_structure() const;
+	// False once the structure is gone (release_structure()) or was never there (components
+	// read from RInChIs): the component then only has its InChI string and AuxInfo.
+	bool has_structure() const { return m_has_structure; }
+	// Bytes allocated for the structure; InChI strings are not counted.
+	size_t structure_memory_usage() const { return m_molecule.memory_usage(); }
+	// Calculates the InChI string if needed, then frees the structure and any molfile,
+	// leaving the component string-backed. Returns the number of bytes freed. Released while
+	// omit_auxinfo() is set, the component has no AuxInfo to return to: set_omit_auxinfo(false)
+	// then throws.
+	size_t release_structure();
 
-	// If you change 'inchi_input' after having called any of the functions
-	// below, call reset_inchi_string() to ensure that InChI string, auxinfo
-	// and key are re-calculated on next call to inchi_string(), inchi_auxinfo()
-	// or inchi_key().
+	// If you change the molecule after having called any of the functions
+	// below, call reset_inchi_string() to ensure that InChI string, auxinfo,
+	// key and molfile are re-calculated on next call to inchi_string(),
+	// inchi_auxinfo(), inchi_key() or molfile(). For a component of a Reaction,
+	// call Reaction::reset_component() instead so the RInChI is updated too.
+	// Components without a structure (has_structure()) keep their InChI string, AuxInfo and
+	// key, which they cannot recalculate; only the molfile is dropped.
 	void reset_inchi_string();
+	// True if inchi_string() will return without calling the InChI library.
+	bool has_inchi_string() const { return !m_inchi_string.empty(); }
 	const std::string& inchi_string();
 	const std::string& inchi_auxinfo();
 	const std::string& inchi_key();
+
+	// The component as an MDL molfile, rebuilt from its InChI string and AuxInfo.
+	// The molfile is kept once built (RInChIReader builds it while validating
+	// AuxInfo); release_molfile() drops it to save memory.
+	const std::string& molfile();
+	void release_molfile();
+	bool has_molfile() const { return !m_molfile.empty(); }
+	// The kept molfile, or one built without keeping it or the InChI string it needs. For
+	// writers, which get the reaction as const and should not grow it.
+	std::string to_molfile() const;
+
+	// When set, InChI strings are calculated without AuxInfo, and inchi_auxinfo()
+	// returns a blank string for components that have a structure.
+	bool omit_auxinfo() const { return m_omit_auxinfo; }
+	// Throws RInChIError when clearing it on a component released without AuxInfo.
+	void set_omit_auxinfo(bool value);
+	// False for a component released (release_structure()) without AuxInfo.
+	bool can_calculate_auxinfo() const;
 };
 
 typedef std::vector<ReactionComponent*> ReactionComponentList;
 
 #define RINCHI_NUM_GROUPS 3
 
+/**
+  Flags for Reaction::variant(); they can be combined.
+**/
+typedef enum {
+	rvReversed            = 1,	// Reactants and products swapped.
+	rvEquilibrium         = 2,	// Direction set to equilibrium.
+	rvWithoutAgents       = 4,	// Agents left out.
+	rvWithoutNoStructures = 8	// No-Structures left out of all groups.
+} ReactionVariantFlag;
+
+struct RInChIVariant {
+	std::string rinchi_string;
+	std::string long_key;
+	std::string short_key;
+	std::string web_key;
+};
+
 class Reaction {
 	friend class RInChIReader;
 	friend class RInChIReaderHelper;
@@ -101,40 +173,97 @@ private:
 	ReactionComponentList m_products;
 	ReactionComponentList m_agents;
 	ReactionDirectionality m_directionality;
+	bool m_omit_auxinfo;
+	unsigned m_max_inchi_threads;
 
 	// Flag that InChI-s have been sorted and groups calculated.
 	bool m_is_cache_valid;
-	/* When the RInChI string is calculated, this flag will be set to true if
-	   the InChI group string of 'm_products' is lexically less than (lexically 
-	   before) the InChI group string of 'm_reactants'. */
-	bool m_reverse_output;
+	// Per-group flags that the group's entries in the cache arrays below are out of date.
+	bool m_is_group_dirty [RINCHI_NUM_GROUPS];
 	/**
 	 * I would have liked to use std::array for the cache arrays, but it is too hard to
 	 * define a useful C-array declaration for the platforms that do not support std::array.
 	 * See e.g. discussion of the failure to typedef a fixed-size C-array at
 	 * http://stackoverflow.com/questions/4523497/typedef-fixed-length-array
 	**/
-	// {0, 1, 2} when forward output; {1, 0, 2} when reverse output.
-	int m_output_order [RINCHI_NUM_GROUPS];
 	// Copies of m_reactants, m_products, m_agents that are sorted by InChIs; 'rcs' = 'ReactionComponentS'.
 	ReactionComponentList m_ordered_rcs [RINCHI_NUM_GROUPS];
+	// Components added or changed since their group was last sorted. update_cache() merges
+	// them into 'm_ordered_rcs' instead of sorting the whole group again.
+	ReactionComponentList m_pending_rcs [RINCHI_NUM_GROUPS];
 	// Concatenated InChI's of ordered component lists.
 	std::string m_rinchi_groups [RINCHI_NUM_GROUPS];
 	std::string m_rauxinfo_groups [RINCHI_NUM_GROUPS];
 	int m_nostruct_counts [RINCHI_NUM_GROUPS];
+	// Per-group key blocks, calculated on first use after the group was last updated.
+	bool m_has_long_key_group [RINCHI_NUM_GROUPS];
+	std::string m_long_key_groups [RINCHI_NUM_GROUPS];
+	bool m_has_short_key_hashes [RINCHI_NUM_GROUPS];
+	std::string m_short_key_major_hashes [RINCHI_NUM_GROUPS];
+	std::string m_short_key_minor_hashes [RINCHI_NUM_GROUPS];
+	// The web key hashes all groups together; it is cleared whenever any group is updated.
+	std::string m_web_key;
+#ifdef IN_RINCHI_TEST_SUITE
+	std::string m_short_key_cleartexts [RINCHI_NUM_GROUPS];
+	std::string m_web_key_cleartext;
+#endif
 
+	// Where the groups go in the output of the reaction or one of its variants.
+	struct OutputLayout {
+		// Group index for each output position; -1 for a group left out of a variant.
+		int groups [RINCHI_NUM_GROUPS];
+		// No-Structure count for each output position.
+		int nostruct_counts [RINCHI_NUM_GROUPS];
+		ReactionDirectionality directionality;
+		bool reverse_output;
+	};
+	// Brings the cache up to date and lays it out for 'variant_flags' (0 for the reaction itself).
+	OutputLayout output_layout(int variant_flags);
 	// Number of RInChI groups to output, e.g. if no agents present only reactants and products
 	// will be output (returns 2).
 	// For RInChI and RAuxInfo output No-Structures are irrelevant for the group count, but they
 	// are relevant for the output of e.g. the RInChI long key.
-	int num_output_groups(bool consider_nostruct_counts);
-	// Calculate above member variables (below 'm_has_rinchi') if 'm_has_rinchi' is false.
+	int num_output_groups(const OutputLayout& layout, bool consider_nostruct_counts);
+	// m_reactants, m_products or m_agents by group index.
+	ReactionComponentList& component_list(int group_idx);
+	void mark_group_dirty(int group_idx);
+	// Calculate the InChIs of all components in dirty groups that do not have one yet,
+	// spreading them over up to 'm_max_inchi_threads' threads.
+	void calculate_missing_inchis();
+	// Merge the group's pending components into its ordered list and rebuild its strings.
+	void update_group(int group_idx);
+	// Calculate above member variables of the dirty groups if 'm_is_cache_valid' is false.
 	void update_cache();
+	const std::string& long_key_group(int group_idx);
+	void update_short_key_hashes(int group_idx);
+	std::string rinchi_string(const OutputLayout& layout);
+	std::string rinchi_long_key(const OutputLayout& layout);
+	std::string rinchi_short_key(const OutputLayout& layout);
+	std::string rinchi_web_key(const OutputLayout& layout);
 public:
 	Reaction();
 	~Reaction();
 
+	// Reactions move with their components and cache, leaving the source an empty Reaction.
+	// Component pointers obtained from the source stay valid and now belong to the target.
+	// They do not copy.
+	Reaction(Reaction&& other) noexcept;
+	Reaction& operator=(Reaction&& other) noexcept;
+	Reaction(const Reaction&) = delete;
+	Reaction& operator=(const Reaction&) = delete;
+	void swap(Reaction& other) noexcept;
+
 	bool empty() const;
+	// Sum of the components' structure_memory_usage().
+	size_t structure_memory_usage() const;
+
+	/**
+	  Calculates all component InChIs and releases the structures they were calculated from
+	  (see ReactionComponent::release_structure()), for reactions that are kept around only
+	  for their RInChI. Cached RInChI data and InChIs stay valid. Returns the number of bytes
+	  freed; if an InChI cannot be calculated, the error is thrown and nothing is released.
+	**/
+	size_t compact();
 
 	const ReactionComponentList& reactants() const { return m_reactants; }
 	const ReactionComponentList& products() const { return m_products; }
@@ -154,8 +283,36 @@ public:
 
 	int nostructure_count(int group_idx);
 
+	/**
+	  AuxInfo-free mode for callers that only need RInChI strings or keys. The InChI
+	  library is asked not to generate AuxInfo (which, with its coordinates, is often
+	  larger than the InChI itself), no RAuxInfo is assembled, and rinchi_auxinfo()
+	  throws. Set it before adding components; components added later inherit it.
+	  Switching it off again recalculates InChIs with AuxInfo on demand; after compact()
+	  there is nothing to recalculate from, and it throws RInChIError.
+	**/
+	bool omit_auxinfo() const { return m_omit_auxinfo; }
+	void set_omit_auxinfo(bool value);
+
+	/**
+	  Maximum number of threads used to calculate component InChIs when the RInChI is
+	  (re)calculated. 0 (the default) means one per hardware thread; 1 calculates all
+	  InChIs on the calling thread, as the sort needs them.
+	**/
+	unsigned max_inchi_threads() const { return m_max_inchi_threads; }
+	void set_max_inchi_threads(unsigned value) { m_max_inchi_threads = value; }
+
 	// Force re-calculation on next request of RInChI string, auxinfo or key.
-	// void reset_rinchis(); // TODO: Implement.
+	// Component InChIs are kept; all groups are sorted again.
+	void reset_rinchis();
+
+	/**
+	  Use instead of component->reset_inchi_string() after changing a component of this
+	  reaction. Only the component's group is updated on the next request: the component is
+	  moved to its new place in the sorted group, and the key blocks of the other groups are
+	  reused. Does nothing if 'component' does not belong to the reaction.
+	**/
+	void reset_component(ReactionComponent* component);
 
 	const std::string rinchi_string();
 	const std::string rinchi_auxinfo();
@@ -163,6 +320,13 @@ public:
 	const std::string rinchi_long_key();
 	const std::string rinchi_short_key();
 	const std::string rinchi_web_key();
+
+	/**
+	  RInChI string and keys of a derived variant of the reaction (see ReactionVariantFlag),
+	  e.g. rvReversed | rvWithoutAgents. They are what the reaction changed that way would give,
+	  but are put together from the cached groups without calculating any InChI again.
+	**/
+	RInChIVariant variant(int variant_flags);
 };
 
 #ifdef IN_RINCHI_TEST_SUITE
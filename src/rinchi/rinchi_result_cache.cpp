@@ -0,0 +1,211 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include "rinchi_result_cache.h"
+
+#include <cstring>
+
+namespace rinchi {
+
+namespace {
+
+	const char* const TAG_RXN_BEGIN = "$RXN";
+	const char* const TAG_MOL_BEGIN = "$MOL";
+	const char* const LINE_RD_MOLFILE_DATUM = "$DATUM $MFMT";
+	const char* const TAG_RD_RFMT = "$RFMT";
+	// Name, program/timestamp and comment lines.
+	const int HEADER_LINE_COUNT = 3;
+
+	// 64-bit FNV-1a.
+	uint64_t hash_of(const std::string& s)
+	{
+		uint64_t result = 14695981039346656037ULL;
+		for (std::string::const_iterator c = s.begin(); c != s.end(); c++) {
+			result ^= (unsigned char) *c;
+			result *= 1099511628211ULL;
+		}
+		return result;
+	}
+
+}
+
+ReactionResultCache::ReactionResultCache(size_t max_entries, std::chrono::milliseconds time_to_live)
+	: m_max_entries(max_entries), m_time_to_live(time_to_live)
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+bool ReactionResultCache::enabled() const
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	return m_max_entries > 0;
+}
+
+void ReactionResultCache::set_limits(size_t max_entries, std::chrono::milliseconds time_to_live)
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	m_max_entries = max_entries;
+	m_time_to_live = time_to_live;
+	while (m_entries.size() > m_max_entries) {
+		erase(--m_entries.end());
+		m_stats.evictions++;
+	}
+}
+
+std::string ReactionResultCache::cache_key(const std::string& file_format, bool force_equilibrium, const std::string& file_text)
+{
+	std::string result = file_format + (force_equilibrium ? "\nE\n" : "\nD\n");
+	result.reserve(result.length() + file_text.length());
+
+	bool before_rd_record = file_format == "RD";
+	int header_lines_left = 0;
+	size_t line_start = 0;
+	while (true) {
+		size_t line_end = file_text.find('\n', line_start);
+		if (line_end == std::string::npos)
+			line_end = file_text.length();
+
+		// As rinchi_getline() gives it: without one trailing and one leading CR.
+		size_t begin = line_start;
+		size_t end = line_end;
+		if (end > begin && file_text[end - 1] == '\r')
+			end--;
+		if (end > begin && file_text[begin] == '\r')
+			begin++;
+		std::string line (file_text, begin, end - begin);
+
+		if (before_rd_record && line.compare(0, strlen(TAG_RD_RFMT), TAG_RD_RFMT) == 0)
+			before_rd_record = false;
+
+		if (before_rd_record) {
+			// The RD reader skips everything up to the first record.
+		}
+		else if (header_lines_left > 0) {
+			header_lines_left--;
+			// A header line that looks like a tag is kept, in case it is not a header line
+			// after all, e.g. a "$MOL" line in an RD data field.
+			if (!line.empty() && line[0] == '$')
+				result += line;
+		}
+		else {
+			result += line;
+			if (line == TAG_RXN_BEGIN || line == TAG_MOL_BEGIN || line == LINE_RD_MOLFILE_DATUM)
+				header_lines_left = HEADER_LINE_COUNT;
+		}
+
+		if (line_end == file_text.length())
+			break;
+		result += '\n';
+		line_start = line_end + 1;
+	}
+	return result;
+}
+
+void ReactionResultCache::erase(EntryList::iterator entry)
+{
+	m_index.erase(entry->hash);
+	m_entries.erase(entry);
+}
+
+bool ReactionResultCache::find(const std::string& key, bool need_auxinfo, ReactionResult& result)
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	std::unordered_map<uint64_t, EntryList::iterator>::iterator idx = m_index.find(hash_of(key));
+	if (idx == m_index.end() || idx->second->key != key || (need_auxinfo && !idx->second->result.has_auxinfo)) {
+		m_stats.misses++;
+		return false;
+	}
+
+	EntryList::iterator entry = idx->second;
+	if (m_time_to_live.count() > 0 && std::chrono::steady_clock::now() - entry->created >= m_time_to_live) {
+		erase(entry);
+		m_stats.expirations++;
+		m_stats.misses++;
+		return false;
+	}
+
+	m_entries.splice(m_entries.begin(), m_entries, entry);
+	result = entry->result;
+	m_stats.hits++;
+	return true;
+}
+
+void ReactionResultCache::insert(const std::string& key, const ReactionResult& result)
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	if (m_max_entries == 0)
+		return;
+
+	// Replaces an entry without AuxInfo, an expired one, or one whose key has the same hash.
+	uint64_t hash = hash_of(key);
+	std::unordered_map<uint64_t, EntryList::iterator>::iterator idx = m_index.find(hash);
+	if (idx != m_index.end())
+		erase(idx->second);
+
+	Entry entry;
+	entry.hash = hash;
+	entry.key = key;
+	entry.result = result;
+	entry.created = std::chrono::steady_clock::now();
+	m_entries.push_front(entry);
+	m_index[hash] = m_entries.begin();
+
+	while (m_entries.size() > m_max_entries) {
+		erase(--m_entries.end());
+		m_stats.evictions++;
+	}
+}
+
+void ReactionResultCache::clear()
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	m_entries.clear();
+	m_index.clear();
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+ReactionResultCacheStats ReactionResultCache::stats() const
+{
+	std::lock_guard<std::mutex> lock (m_mutex);
+	ReactionResultCacheStats result = m_stats;
+	result.entries = m_entries.size();
+	return result;
+}
+
+} // End of namespace.
@@ -0,0 +1,136 @@
+#ifndef IUPAC_RINCHI_RESULT_CACHE_HEADER_GUARD
+#define IUPAC_RINCHI_RESULT_CACHE_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace rinchi {
+
+/**
+  What is calculated for a reaction read from an RD or RXN file text.
+**/
+struct ReactionResult {
+	std::string rinchi_string;
+	std::string rinchi_auxinfo;
+	std::string long_key;
+	std::string short_key;
+	std::string web_key;
+	// False if calculated without AuxInfo (Reaction::set_omit_auxinfo()); 'rinchi_auxinfo' is blank then.
+	bool has_auxinfo;
+
+	ReactionResult(): has_auxinfo(false) {}
+};
+
+struct ReactionResultCacheStats {
+	unsigned long hits;
+	unsigned long misses;
+	// Entries found to be older than the time-to-live.
+	unsigned long expirations;
+	// Entries dropped to make room.
+	unsigned long evictions;
+	size_t entries;
+
+	double hit_rate() const { return hits + misses == 0 ? 0.0 : (double) hits / (hits + misses); }
+};
+
+/**
+  Results of reactions read from file texts, for callers that see the same texts over and over.
+
+  Entries are keyed on cache_key(), which takes out the differences that do not reach the
+  readers: line endings and the header lines they skip. The least recently used entry is
+  dropped when the cache is full, and entries older than the time-to-live are not used.
+  Errors are not cached. All member functions may be called from several threads.
+**/
+class ReactionResultCache {
+private:
+	struct Entry {
+		uint64_t hash;
+		// The full key, so that hash collisions cannot mix up reactions.
+		std::string key;
+		ReactionResult result;
+		std::chrono::steady_clock::time_point created;
+	};
+	typedef std::list<Entry> EntryList;
+
+	mutable std::mutex m_mutex;
+	size_t m_max_entries;
+	std::chrono::milliseconds m_time_to_live;
+	// Most recently used first.
+	EntryList m_entries;
+	std::unordered_map<uint64_t, EntryList::iterator> m_index;
+	ReactionResultCacheStats m_stats;
+
+	void erase(EntryList::iterator entry);
+public:
+	// 'max_entries' 0 disables the cache; 'time_to_live' 0 keeps entries until they are evicted.
+	explicit ReactionResultCache(size_t max_entries = 0, std::chrono::milliseconds time_to_live = std::chrono::milliseconds(0));
+
+	bool enabled() const;
+	// Entries over the new limit are evicted right away.
+	void set_limits(size_t max_entries, std::chrono::milliseconds time_to_live);
+
+	/**
+	  The key for a file text. 'file_format' is the format the text is read as ("RD" or "RXN"),
+	  after any auto-detection. Lines are compared the way the readers get them, i.e. without
+	  a trailing or leading CR. Blanked out are the three header lines following "$RXN", "$MOL"
+	  and "$DATUM $MFMT" (name, program/timestamp and comment lines) unless they start with
+	  "$", and for RD files every line before the first "$RFMT" ("$RDFILE 1", "$DATM <date>").
+	**/
+	static std::string cache_key(const std::string& file_format, bool force_equilibrium, const std::string& file_text);
+
+	// Returns true and fills 'result' on a hit. An entry calculated without AuxInfo does not
+	// count if 'need_auxinfo' is set.
+	bool find(const std::string& key, bool need_auxinfo, ReactionResult& result);
+	void insert(const std::string& key, const ReactionResult& result);
+
+	// Drops all entries and zeroes the statistics.
+	void clear();
+	ReactionResultCacheStats stats() const;
+};
+
+} // End of namespace.
+
+#endif
@@ -12,6 +12,9 @@ TEMPLATE = lib
 DEFINES  += TARGET_API_LIB
 QMAKE_CFLAGS += -ansi -DCOMPILE_ANSI_ONLY
 QMAKE_CXXFLAGS += -std=c++11
+# Older glibc versions need -pthread for std::thread.
+unix:!macx: QMAKE_CXXFLAGS += -pthread
+unix:!macx: QMAKE_LFLAGS += -pthread
 
 # Ensure that only explicitly exported functions are present in symbol table.
 QMAKE_CXXFLAGS += -fvisibility=hidden
@@ -41,9 +44,14 @@ SOURCES += \
 	./../parsers/mdl_rxnfile_reader.cpp \
 	./../parsers/mdl_rdfile_reader.cpp \
 	./../parsers/rinchi_reader.cpp \
+	./../parsers/inchi_auxinfo_reader.cpp \
 	./../writers/mdl_rxnfile_writer.cpp \
 	./../writers/mdl_rdfile_writer.cpp \
+	./../writers/mdl_molfile_writer.cpp \
 	./../rinchi/rinchi_reaction.cpp \
+	./../rinchi/rinchi_inchi_cache.cpp \
+	./../rinchi/rinchi_molecule.cpp \
+	./../rinchi/rinchi_result_cache.cpp \
 	./../rinchi/rinchi_consts.cpp \
 	./rinchi_lib.cpp \
 	./../../../InChI/INCHI-1-SRC/INCHI_BASE/src/ichi_bns.c \
@@ -37,8 +37,12 @@
 #pragma endregion
 #endif
 
+#include <atomic>
+#include <initializer_list>
+#include <memory>
 #include <string>
 #include <sstream>
+#include <vector>
 #ifdef LIB_RINCHI_DEBUG
 	#include <iostream>
 #endif
@@ -49,6 +53,8 @@
 
 #include "rinchi_consts.h"
 #include "rinchi_reaction.h"
+#include "rinchi_result_cache.h"
+#include "rinchi_inchi_cache.h"
 
 #include "mdl_rxnfile.h"
 #include "mdl_rxnfile_reader.h"
@@ -87,15 +93,34 @@ std::string cpp_error_message;
 // Holds latest results.
 std::string cpp_result1;
 std::string cpp_result2;
+// Holds latest results of rinchilib_all_from_file_text().
+rinchi::ReactionResult cpp_results;
+
+// Results of the *_from_file_text() functions; disabled until rinchilib_set_result_cache() is called.
+rinchi::ReactionResultCache result_cache;
+
+// See rinchilib_set_inchi_key_check().
+unsigned inchi_key_check_interval = 1;
+// InChIKeys read by all calls, so that the spot checks are spread over them (see RInChIReader::set_inchi_key_counter()).
+std::atomic<unsigned long> inchi_key_count (0);
+
+// See rinchilib_set_allocator().
+rinchilib_allocator output_allocator = NULL;
+void* output_allocator_context = NULL;
+
+// The reaction behind a handle of the rinchilib_reaction_*() functions.
+struct rinchilib_reaction {
+	rinchi::Reaction reaction;
+};
 
 #define BEGIN_EXCP_CODE try { cpp_error_message.clear();
-#define END_EXCP_CODE return RETURN_CODE_SUCCESS; } catch (std::exception& e) { cpp_error_message = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what(); return RETURN_CODE_ERROR; }
+#define CATCH_EXCP_CODE } catch (std::exception& e) { cpp_error_message = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what(); return RETURN_CODE_ERROR; }
+#define END_EXCP_CODE return RETURN_CODE_SUCCESS; CATCH_EXCP_CODE
 
 namespace {
 
-	void load_reaction(const char* input_format, const char* in_file_text, bool in_force_equilibrium, rinchi::Reaction& rxn) {
-		std::stringstream file_text_stream (in_file_text);
-
+	std::string detect_file_format(const char* input_format, std::istream& file_text_stream)
+	{
 		std::string file_format = input_format;
 		if (file_format.empty() || file_format == RINCHI_INPUT_FORMAT_AUTO) {
 			std::ios::pos_type saved_stream_pos = file_text_stream.tellg();
@@ -108,6 +133,14 @@ namespace {
 			else
 				file_format = RINCHI_INPUT_FORMAT_RDFILE;
 		}
+		return file_format;
+	}
+
+	void load_reaction(const char* input_format, const char* in_file_text, bool in_force_equilibrium, rinchi::Reaction& rxn, bool omit_auxinfo = false) {
+		std::stringstream file_text_stream (in_file_text);
+		rxn.set_omit_auxinfo(omit_auxinfo);
+
+		std::string file_format = detect_file_format(input_format, file_text_stream);
 
 		if (file_format == RINCHI_INPUT_FORMAT_RDFILE) {
 			rinchi::MdlRDfileReader rd_reader;
@@ -121,68 +154,220 @@ namespace {
 			throw rinchi::RInChIError(std::string("Unsupported input file format '") + file_format + "'.");
 	}
 
+	void load_inchis(const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, rinchi::Reaction& rxn)
+	{
+		rinchi::RInChIReader reader;
+		reader.set_inchi_key_check_interval(inchi_key_check_interval);
+		reader.set_inchi_key_counter(&inchi_key_count);
+		reader.add_inchis_to_reaction(
+			reactant_inchis ? reactant_inchis : "", product_inchis ? product_inchis : "", agent_inchis ? agent_inchis : "", rxn
+		);
+	}
+
+	void set_output(const std::string& value, const char** out)
+	{
+		if (out)
+			*out = value.c_str();
+	}
+
+	// Like MdlMolfileReader, treats a component of a single query or R-group atom as a No-Structure.
+	bool is_special_atom(const char* atom_symbol)
+	{
+		return strcmp(atom_symbol, "A") == 0 || strcmp(atom_symbol, "X") == 0 || strcmp(atom_symbol, "R#") == 0 || strcmp(atom_symbol, "R") == 0 || strcmp(atom_symbol, "*") == 0;
+	}
+
+	// Fills 'result' from the connection table arrays of rinchilib_reaction_add_component().
+	void load_component(
+		int atom_count, const char* const* elements, const double* coordinates, const int* charges, const int* isotopic_masses, const int* radicals, const int* implicit_hydrogens,
+		int bond_count, const int* bond_atoms, const int* bond_orders, const int* bond_stereos, bool is_chiral, rinchi::ReactionComponent& result
+	)
+	{
+		if (atom_count < 0 || bond_count < 0)
+			throw rinchi::RInChIError("Atom and bond counts must not be negative.");
+		if (atom_count > 0 && !elements)
+			throw rinchi::RInChIError("Missing element symbols.");
+		if (bond_count > 0 && (!bond_atoms || !bond_orders))
+			throw rinchi::RInChIError("Missing bond atoms or bond orders.");
+
+		if (atom_count == 1 && elements[0] && is_special_atom(elements[0])) {
+			result.initialize(0, is_chiral);
+			return;
+		}
+
+		result.initialize(atom_count, is_chiral);
+		rinchi::Molecule& molecule = result.molecule();
+		molecule.reserve(atom_count, bond_count);
+		for (int i = 0; i < atom_count; i++) {
+			std::string atom_context = "Atom " + rinchi::int2str(i + 1) + ": ";
+			if (!elements[i] || !*elements[i] || strlen(elements[i]) >= ATOM_EL_LEN)
+				throw rinchi::RInChIError(atom_context + "Invalid element symbol.");
+			int charge = charges ? charges[i] : 0;
+			int isotopic_mass = isotopic_masses ? isotopic_masses[i] : 0;
+			int radical = radicals ? radicals[i] : 0;
+			rinchi::check_range<rinchi::RInChIError>(charge, -127, 127, (atom_context + "Charge").c_str());
+			rinchi::check_range<rinchi::RInChIError>(isotopic_mass, 0, ISOTOPIC_SHIFT_FLAG - 1, (atom_context + "Isotopic mass").c_str());
+			rinchi::check_range<rinchi::RInChIError>(radical, 0, 3, (atom_context + "Radical").c_str());
+			if (coordinates)
+				molecule.add_atom(elements[i], coordinates[3 * i], coordinates[3 * i + 1], coordinates[3 * i + 2], charge, radical, isotopic_mass);
+			else
+				molecule.add_atom(elements[i], 0, 0, 0, charge, radical, isotopic_mass);
+			if (implicit_hydrogens && implicit_hydrogens[i] != -1) {
+				rinchi::check_range<rinchi::RInChIError>(implicit_hydrogens[i], 0, 127, (atom_context + "Implicit hydrogen count").c_str());
+				molecule.set_implicit_hydrogens(i, implicit_hydrogens[i]);
+			}
+		}
+
+		for (int i = 0; i < bond_count; i++) {
+			std::string bond_context = "Bond " + rinchi::int2str(i + 1) + ": ";
+			int stereo = bond_stereos ? bond_stereos[i] : RINCHILIB_BOND_STEREO_NONE;
+			// As for molfiles, aromatic bonds (4) are accepted but query bond types are not.
+			rinchi::check_range<rinchi::RInChIError>(bond_orders[i], 1, 4, (bond_context + "Bond order").c_str());
+			rinchi::check_range<rinchi::RInChIError>(stereo, RINCHILIB_BOND_STEREO_NONE, RINCHILIB_BOND_STEREO_DOUBLE_EITHER, (bond_context + "Bond stereo").c_str());
+			rinchi::check_range<rinchi::RInChIError>(bond_atoms[2 * i], 0, atom_count - 1, (bond_context + "From atom index").c_str());
+			rinchi::check_range<rinchi::RInChIError>(bond_atoms[2 * i + 1], 0, atom_count - 1, (bond_context + "To atom index").c_str());
+			try {
+				molecule.add_bond(bond_atoms[2 * i], bond_atoms[2 * i + 1], bond_orders[i], (rinchi::BondStereo) stereo);
+			}
+			catch (std::runtime_error& e) {
+				throw rinchi::RInChIError(bond_context + e.what());
+			}
+		}
+	}
+
 	void output_component_as_string(const std::string& prefix, rinchi::ReactionComponent& rc, std::ostream& output_stream)
 	{
 		output_stream << prefix << rc.inchi_string() << "\n" << prefix << rc.inchi_auxinfo() << "\n";
 	}
 
-	std::string calculate_key(rinchi::Reaction& rxn, const char* key_type)
+	char key_selector(const char* key_type)
 	{
-		char key_selector = *key_type;
-		if (key_selector == 0)
+		char result = *key_type;
+		if (result == 0)
 			throw rinchi::RInChIError("Missing key selector: 'key_type' parameter must be 'L'(ong), 'S'(hort) or W(eb).");
-
-		if (key_selector == 'L')
-			return rxn.rinchi_long_key();
-		else if (key_selector == 'S')
-			return rxn.rinchi_short_key();
-		else if (key_selector == 'W')
-			return rxn.rinchi_web_key();
-		else
+		if (result != 'L' && result != 'S' && result != 'W')
 			throw rinchi::RInChIError("Invalid key selector. 'key_type' parameter must be 'L'(ong), 'S'(hort) or W(eb).");
+		return result;
 	}
 
-}
-
-extern "C" {
+	std::string calculate_key(rinchi::Reaction& rxn, const char* key_type)
+	{
+		switch (key_selector(key_type)) {
+			case 'L': return rxn.rinchi_long_key();
+			case 'S': return rxn.rinchi_short_key();
+			default:  return rxn.rinchi_web_key();
+		}
+	}
 
-	API_EXPORT const char* rinchilib_latest_err_msg()
+	const std::string& select_key(const rinchi::ReactionResult& result, const char* key_type)
 	{
-		return cpp_error_message.c_str();
+		switch (key_selector(key_type)) {
+			case 'L': return result.long_key;
+			case 'S': return result.short_key;
+			default:  return result.web_key;
+		}
 	}
 
-	API_EXPORT int rinchilib_rinchi_from_file_text(
-		const char* input_format, const char* in_file_text, bool in_force_equilibrium, const char** out_rinchi_string, const char** out_rinchi_auxinfo
-	)
+	// Takes the results for a file text from 'result_cache', or reads the reaction and calculates
+	// and caches all of them: RInChI, RAuxInfo unless 'need_auxinfo' is false, and all keys.
+	rinchi::ReactionResult cached_results(const char* input_format, const char* in_file_text, bool in_force_equilibrium, bool need_auxinfo)
 	{
-		BEGIN_EXCP_CODE
+		std::string file_text = in_file_text;
+		std::istringstream file_text_stream (file_text);
+		std::string key = rinchi::ReactionResultCache::cache_key(detect_file_format(input_format, file_text_stream), in_force_equilibrium, file_text);
+
+		rinchi::ReactionResult result;
+		if (result_cache.find(key, need_auxinfo, result))
+			return result;
+
 		rinchi::Reaction rxn;
-		load_reaction(input_format, in_file_text, in_force_equilibrium, rxn);
-		cpp_result1 = rxn.rinchi_string();
-		cpp_result2 = rxn.rinchi_auxinfo();
+		load_reaction(input_format, in_file_text, in_force_equilibrium, rxn, !need_auxinfo);
+		result.rinchi_string = rxn.rinchi_string();
+		if (need_auxinfo)
+			result.rinchi_auxinfo = rxn.rinchi_auxinfo();
+		result.has_auxinfo = need_auxinfo;
+		result.long_key = rxn.rinchi_long_key();
+		result.short_key = rxn.rinchi_short_key();
+		result.web_key = rxn.rinchi_web_key();
+		result_cache.insert(key, result);
+		return result;
+	}
 
-		*out_rinchi_string  = cpp_result1.c_str();
-		*out_rinchi_auxinfo = cpp_result2.c_str();
-		END_EXCP_CODE
+
+	void rinchi_from_file_text(const char* input_format, const char* in_file_text, bool in_force_equilibrium, std::string& rinchi_string, std::string& rinchi_auxinfo)
+	{
+		if (result_cache.enabled()) {
+			rinchi::ReactionResult result = cached_results(input_format, in_file_text, in_force_equilibrium, true);
+			rinchi_string  = result.rinchi_string;
+			rinchi_auxinfo = result.rinchi_auxinfo;
+		}
+		else {
+			rinchi::Reaction rxn;
+			load_reaction(input_format, in_file_text, in_force_equilibrium, rxn);
+			rinchi_string  = rxn.rinchi_string();
+			rinchi_auxinfo = rxn.rinchi_auxinfo();
+		}
 	}
 
-	API_EXPORT int rinchilib_rinchikey_from_file_text(
-		const char* input_format, const char* in_file_text, const char* key_type, bool in_force_equilibrium, const char** out_rinchi_key
-	)
+	std::string rinchi_string_from_file_text(const char* input_format, const char* in_file_text, bool in_force_equilibrium)
 	{
-		BEGIN_EXCP_CODE
+		if (result_cache.enabled())
+			return cached_results(input_format, in_file_text, in_force_equilibrium, false).rinchi_string;
+
 		rinchi::Reaction rxn;
-		load_reaction(input_format, in_file_text, in_force_equilibrium, rxn);
-		cpp_result1 = calculate_key(rxn, key_type);
-		*out_rinchi_key = cpp_result1.c_str();
-		END_EXCP_CODE
+		load_reaction(input_format, in_file_text, in_force_equilibrium, rxn, true);
+		return rxn.rinchi_string();
 	}
 
-	API_EXPORT int rinchilib_file_text_from_rinchi(
-		const char* rinchi_string, const char* rinchi_auxinfo, const char* output_format, const char** out_file_text
-	)
+	std::string rinchikey_from_file_text(const char* input_format, const char* in_file_text, const char* key_type, bool in_force_equilibrium)
+	{
+		// Keys do not depend on AuxInfo.
+		if (result_cache.enabled())
+			return select_key(cached_results(input_format, in_file_text, in_force_equilibrium, false), key_type);
+
+		rinchi::Reaction rxn;
+		load_reaction(input_format, in_file_text, in_force_equilibrium, rxn, true);
+		return calculate_key(rxn, key_type);
+	}
+
+	// Outputs that are not selected in 'output_mask' are left blank in 'results'.
+	void all_from_file_text(const char* input_format, const char* in_file_text, bool in_force_equilibrium, int output_mask, rinchi::ReactionResult& results)
+	{
+		if (output_mask <= 0 || (output_mask & ~RINCHI_OUTPUT_ALL) != 0)
+			throw rinchi::RInChIError("Invalid output selection. 'output_mask' must be a combination of RINCHI_OUTPUT_* values.");
+		bool need_auxinfo = (output_mask & RINCHI_OUTPUT_RAUXINFO) != 0;
+
+		if (result_cache.enabled())
+			results = cached_results(input_format, in_file_text, in_force_equilibrium, need_auxinfo);
+		else {
+			rinchi::Reaction rxn;
+			load_reaction(input_format, in_file_text, in_force_equilibrium, rxn, !need_auxinfo);
+			results = rinchi::ReactionResult();
+			if (output_mask & RINCHI_OUTPUT_RINCHI_STRING)
+				results.rinchi_string = rxn.rinchi_string();
+			if (need_auxinfo)
+				results.rinchi_auxinfo = rxn.rinchi_auxinfo();
+			if (output_mask & RINCHI_OUTPUT_LONG_KEY)
+				results.long_key = rxn.rinchi_long_key();
+			if (output_mask & RINCHI_OUTPUT_SHORT_KEY)
+				results.short_key = rxn.rinchi_short_key();
+			if (output_mask & RINCHI_OUTPUT_WEB_KEY)
+				results.web_key = rxn.rinchi_web_key();
+		}
+
+		if ((output_mask & RINCHI_OUTPUT_RINCHI_STRING) == 0)
+			results.rinchi_string.clear();
+		if (!need_auxinfo)
+			results.rinchi_auxinfo.clear();
+		if ((output_mask & RINCHI_OUTPUT_LONG_KEY) == 0)
+			results.long_key.clear();
+		if ((output_mask & RINCHI_OUTPUT_SHORT_KEY) == 0)
+			results.short_key.clear();
+		if ((output_mask & RINCHI_OUTPUT_WEB_KEY) == 0)
+			results.web_key.clear();
+	}
+
+	std::string file_text_from_rinchi(const char* rinchi_string, const char* rinchi_auxinfo, const char* output_format)
 	{
-		BEGIN_EXCP_CODE
 		rinchi::Reaction rxn;
 		rinchi::RInChIReader reader;
 #ifdef LIB_RINCHI_DEBUG
@@ -202,16 +387,11 @@ extern "C" {
 		else
 			throw rinchi::RInChIError(std::string("Unsupported output file format '") + output_format + "'.");
 
-		cpp_result1 = file_text_stream.str();
-		*out_file_text = cpp_result1.c_str();
-		END_EXCP_CODE
+		return file_text_stream.str();
 	}
 
-	API_EXPORT int rinchilib_inchis_from_rinchi(
-		const char* rinchi_string, const char* rinchi_auxinfo, const char** out_inchis_text
-	)
+	std::string inchis_from_rinchi(const char* rinchi_string, const char* rinchi_auxinfo)
 	{
-		BEGIN_EXCP_CODE
 		rinchi::Reaction rxn;
 		rinchi::RInChIReader reader;
 #ifdef LIB_RINCHI_DEBUG
@@ -255,41 +435,42 @@ extern "C" {
 		for (rinchi::ReactionComponentList::const_iterator rc = rxn.agents().begin(); rc != rxn.agents().end(); rc++)
 			output_component_as_string("A:", **rc, inchi_stream);
 
-		cpp_result1 = inchi_stream.str();
-		*out_inchis_text = cpp_result1.c_str();
-		END_EXCP_CODE
+		return inchi_stream.str();
 	}
 
-    API_EXPORT int rinchilib_rinchi_from_inchis(
-            const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, const char** out_rinchi_string, const char** out_rinchi_auxinfo
-    )
-    {
-        BEGIN_EXCP_CODE
-        rinchi::Reaction rxn;
-        rinchi::RInChIReader reader;
+	void rinchi_from_inchis(const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, std::string& rinchi_string, std::string& rinchi_auxinfo)
+	{
+		rinchi::Reaction rxn;
+		load_inchis(reactant_inchis, product_inchis, agent_inchis, rxn);
 
-        std::string reactant_inchis_str;
-        std::string product_inchis_str;
-        std::string agent_inchis_str;
-        if (reactant_inchis != nullptr) reactant_inchis_str = reactant_inchis;
-        if (product_inchis  != nullptr) product_inchis_str  = product_inchis;
-        if (agent_inchis    != nullptr) agent_inchis_str    = agent_inchis;
+		rinchi_string  = rxn.rinchi_string();
+		rinchi_auxinfo = rxn.rinchi_auxinfo();
+	}
 
-        reader.add_inchis_to_reaction(reactant_inchis_str, product_inchis_str, agent_inchis_str, rxn);
+	std::string rinchikey_from_inchis(const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, const char* key_type)
+	{
+		rinchi::Reaction rxn;
+		load_inchis(reactant_inchis, product_inchis, agent_inchis, rxn);
+		return calculate_key(rxn, key_type);
+	}
 
-        cpp_result1 = rxn.rinchi_string();
-        cpp_result2 = rxn.rinchi_auxinfo();
+	void reaction_rinchi(rinchilib_reaction* reaction, std::string& rinchi_string, std::string& rinchi_auxinfo)
+	{
+		if (!reaction)
+			throw rinchi::RInChIError("Missing reaction handle.");
+		rinchi_string = reaction->reaction.rinchi_string();
+		rinchi_auxinfo = reaction->reaction.omit_auxinfo() ? "" : reaction->reaction.rinchi_auxinfo();
+	}
 
-        *out_rinchi_string  = cpp_result1.c_str();
-        *out_rinchi_auxinfo = cpp_result2.c_str();
-        END_EXCP_CODE
-    }
+	std::string reaction_rinchikey(rinchilib_reaction* reaction, const char* key_type)
+	{
+		if (!reaction)
+			throw rinchi::RInChIError("Missing reaction handle.");
+		return calculate_key(reaction->reaction, key_type);
+	}
 
-	API_EXPORT int rinchilib_rinchikey_from_rinchi(
-		const char* rinchi_string, const char* key_type, const char** out_rinchi_key
-	)
+	std::string rinchikey_from_rinchi(const char* rinchi_string, const char* key_type)
 	{
-		BEGIN_EXCP_CODE
 #ifdef LIB_RINCHI_DEBUG
 		std::cout << "RInChI string:\n" << rinchi_string << std::endl;
 #endif
@@ -306,9 +487,605 @@ extern "C" {
 
 		reader.split_into_reaction(rinchi_input, "", rxn);
 
-		cpp_result1 = calculate_key(rxn, key_type);
+		return calculate_key(rxn, key_type);
+	}
+
+	struct BufferOutput {
+		const std::string& value;
+		rinchilib_buffer* buffer;
+	};
+
+	// Copies each value to its buffer as documented for rinchilib_buffer. Returns
+	// RETURN_CODE_BUFFER_TOO_SMALL, with an error message, if any of them does not fit
+	// or could not be allocated; 'length' of the buffer holds the size required.
+	int fill_buffers(std::initializer_list<BufferOutput> outputs)
+	{
+		size_t too_small_count = 0;
+		bool allocator_failed = false;
+		for (const BufferOutput& output: outputs) {
+			rinchilib_buffer* buffer = output.buffer;
+			if (!buffer)
+				continue;
+			size_t length = output.value.length();
+			buffer->length = length;
+			if (!buffer->data && output_allocator) {
+				buffer->data = (char*) output_allocator(length + 1, output_allocator_context);
+				if (buffer->data)
+					buffer->capacity = length + 1;
+				else
+					allocator_failed = true;
+			}
+			if (!buffer->data || buffer->capacity <= length) {
+				too_small_count++;
+				continue;
+			}
+			memcpy(buffer->data, output.value.data(), length);
+			buffer->data[length] = 0;
+		}
+		if (too_small_count == 0)
+			return RETURN_CODE_SUCCESS;
+		if (allocator_failed)
+			cpp_error_message = "Output allocator failed: see 'length' of the buffers for the sizes required.";
+		else
+			cpp_error_message = "Output buffer too small: see 'length' of the buffers for the sizes required.";
+		return RETURN_CODE_BUFFER_TOO_SMALL;
+	}
+
+	/**
+	  Arrow C Data Interface export of rinchilib_all_from_file_texts_arrow(). Every exported
+	  ArrowArray and ArrowSchema, the table and each of its columns, owns its memory through
+	  'private_data'; releasing the table releases the columns that the consumer has not moved.
+	**/
+
+	struct ArrowArrayData {
+		std::vector<uint8_t> validity;
+		std::vector<int64_t> offsets;
+		std::string chars;
+		std::vector<int32_t> values;
+		std::vector<const void*> buffers;
+		std::vector<ArrowArray*> children;
+	};
+
+	struct ArrowSchemaData {
+		std::string format;
+		std::string name;
+		std::vector<ArrowSchema*> children;
+	};
+
+	void release_arrow_array(ArrowArray* array)
+	{
+		ArrowArrayData* data = (ArrowArrayData*) array->private_data;
+		for (std::vector<ArrowArray*>::iterator child = data->children.begin(); child != data->children.end(); child++) {
+			if ((*child)->release)
+				(*child)->release(*child);
+			delete *child;
+		}
+		delete data;
+		array->release = NULL;
+	}
+
+	void release_arrow_schema(ArrowSchema* schema)
+	{
+		ArrowSchemaData* data = (ArrowSchemaData*) schema->private_data;
+		for (std::vector<ArrowSchema*>::iterator child = data->children.begin(); child != data->children.end(); child++) {
+			if ((*child)->release)
+				(*child)->release(*child);
+			delete *child;
+		}
+		delete data;
+		schema->release = NULL;
+	}
+
+	// Points 'array' at 'data', which it then owns.
+	void init_arrow_array(ArrowArray* array, int64_t length, int64_t null_count, std::unique_ptr<ArrowArrayData>& data)
+	{
+		array->length = length;
+		array->null_count = null_count;
+		array->offset = 0;
+		array->n_buffers = (int64_t) data->buffers.size();
+		array->n_children = (int64_t) data->children.size();
+		array->buffers = data->buffers.data();
+		array->children = data->children.empty() ? NULL : data->children.data();
+		array->dictionary = NULL;
+		array->release = release_arrow_array;
+		array->private_data = data.release();
+	}
+
+	void init_arrow_schema(ArrowSchema* schema, const std::string& format, const std::string& name, int64_t flags, std::unique_ptr<ArrowSchemaData>& data)
+	{
+		data->format = format;
+		data->name = name;
+		schema->format = data->format.c_str();
+		schema->name = data->name.c_str();
+		schema->metadata = NULL;
+		schema->flags = flags;
+		schema->n_children = (int64_t) data->children.size();
+		schema->children = data->children.empty() ? NULL : data->children.data();
+		schema->dictionary = NULL;
+		schema->release = release_arrow_schema;
+		schema->private_data = data.release();
+	}
+
+	// A large UTF-8 column; rows for which 'value' returns NULL are null.
+	template <typename ValueFunction> void export_string_column(size_t row_count, ValueFunction value, ArrowArray* array)
+	{
+		std::unique_ptr<ArrowArrayData> data(new ArrowArrayData());
+		data->validity.assign((row_count + 7) / 8, 0);
+		data->offsets.reserve(row_count + 1);
+		data->offsets.push_back(0);
+		int64_t null_count = 0;
+		for (size_t row = 0; row < row_count; row++) {
+			const std::string* s = value(row);
+			if (s) {
+				data->validity[row / 8] |= (uint8_t) (1 << (row % 8));
+				data->chars += *s;
+			}
+			else
+				null_count++;
+			data->offsets.push_back((int64_t) data->chars.length());
+		}
+		data->buffers.push_back(null_count == 0 ? NULL : data->validity.data());
+		data->buffers.push_back(data->offsets.data());
+		data->buffers.push_back(data->chars.data());
+		init_arrow_array(array, (int64_t) row_count, null_count, data);
+	}
+
+	void export_int32_column(const std::vector<int32_t>& values, ArrowArray* array)
+	{
+		std::unique_ptr<ArrowArrayData> data(new ArrowArrayData());
+		data->values = values;
+		data->buffers.push_back(NULL);
+		data->buffers.push_back(data->values.data());
+		init_arrow_array(array, (int64_t) values.size(), 0, data);
+	}
+
+	struct FileTextRow {
+		rinchi::ReactionResult results;
+		std::string error;
+		bool failed;
+
+		FileTextRow(): failed(false) {}
+	};
+
+	void export_arrow_table(const std::vector<FileTextRow>& rows, int output_mask, ArrowArray* out_array, ArrowSchema* out_schema)
+	{
+		struct OutputColumn {
+			int output;
+			const char* name;
+			std::string rinchi::ReactionResult::* value;
+		} output_columns[] = {
+			{ RINCHI_OUTPUT_RINCHI_STRING, "rinchi_string", &rinchi::ReactionResult::rinchi_string },
+			{ RINCHI_OUTPUT_RAUXINFO, "rinchi_auxinfo", &rinchi::ReactionResult::rinchi_auxinfo },
+			{ RINCHI_OUTPUT_LONG_KEY, "long_key", &rinchi::ReactionResult::long_key },
+			{ RINCHI_OUTPUT_SHORT_KEY, "short_key", &rinchi::ReactionResult::short_key },
+			{ RINCHI_OUTPUT_WEB_KEY, "web_key", &rinchi::ReactionResult::web_key },
+		};
+
+		std::unique_ptr<ArrowArrayData> table(new ArrowArrayData());
+		std::unique_ptr<ArrowSchemaData> table_type(new ArrowSchemaData());
+		table->buffers.push_back(NULL);
+		try {
+			for (size_t i = 0; i < sizeof(output_columns) / sizeof(output_columns[0]); i++) {
+				if ((output_mask & output_columns[i].output) == 0)
+					continue;
+				std::string rinchi::ReactionResult::* member = output_columns[i].value;
+				table->children.push_back(new ArrowArray());
+				export_string_column(rows.size(), [&](size_t row) { return rows[row].failed ? NULL : &(rows[row].results.*member); }, table->children.back());
+				table_type->children.push_back(new ArrowSchema());
+				std::unique_ptr<ArrowSchemaData> column_type(new ArrowSchemaData());
+				init_arrow_schema(table_type->children.back(), "U", output_columns[i].name, ARROW_FLAG_NULLABLE, column_type);
+			}
+
+			table->children.push_back(new ArrowArray());
+			export_string_column(rows.size(), [&](size_t row) { return rows[row].failed ? &rows[row].error : NULL; }, table->children.back());
+			table_type->children.push_back(new ArrowSchema());
+			std::unique_ptr<ArrowSchemaData> error_type(new ArrowSchemaData());
+			init_arrow_schema(table_type->children.back(), "U", "error", ARROW_FLAG_NULLABLE, error_type);
+
+			std::vector<int32_t> status;
+			status.reserve(rows.size());
+			for (std::vector<FileTextRow>::const_iterator row = rows.begin(); row != rows.end(); row++)
+				status.push_back(row->failed ? RETURN_CODE_ERROR : RETURN_CODE_SUCCESS);
+			table->children.push_back(new ArrowArray());
+			export_int32_column(status, table->children.back());
+			table_type->children.push_back(new ArrowSchema());
+			std::unique_ptr<ArrowSchemaData> status_type(new ArrowSchemaData());
+			init_arrow_schema(table_type->children.back(), "i", "status", 0, status_type);
+		}
+		catch (...) {
+			// Release the columns made so far; a column whose export failed has no release callback yet.
+			ArrowArray partial_table;
+			ArrowSchema partial_type;
+			init_arrow_array(&partial_table, 0, 0, table);
+			init_arrow_schema(&partial_type, "+s", "", 0, table_type);
+			partial_table.release(&partial_table);
+			partial_type.release(&partial_type);
+			throw;
+		}
+
+		init_arrow_array(out_array, (int64_t) rows.size(), 0, table);
+		init_arrow_schema(out_schema, "+s", "", 0, table_type);
+	}
+
+}
+
+extern "C" {
+
+	API_EXPORT const char* rinchilib_latest_err_msg()
+	{
+		return cpp_error_message.c_str();
+	}
+
+	API_EXPORT int rinchilib_rinchi_from_file_text(
+		const char* input_format, const char* in_file_text, bool in_force_equilibrium, const char** out_rinchi_string, const char** out_rinchi_auxinfo
+	)
+	{
+		BEGIN_EXCP_CODE
+		rinchi_from_file_text(input_format, in_file_text, in_force_equilibrium, cpp_result1, cpp_result2);
+
+		*out_rinchi_string  = cpp_result1.c_str();
+		*out_rinchi_auxinfo = cpp_result2.c_str();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchi_from_file_text_buf(
+		const char* input_format, const char* in_file_text, bool in_force_equilibrium, rinchilib_buffer* out_rinchi_string, rinchilib_buffer* out_rinchi_auxinfo
+	)
+	{
+		BEGIN_EXCP_CODE
+		std::string rinchi_string;
+		std::string rinchi_auxinfo;
+		rinchi_from_file_text(input_format, in_file_text, in_force_equilibrium, rinchi_string, rinchi_auxinfo);
+		return fill_buffers({ {rinchi_string, out_rinchi_string}, {rinchi_auxinfo, out_rinchi_auxinfo} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchi_string_from_file_text(
+		const char* input_format, const char* in_file_text, bool in_force_equilibrium, const char** out_rinchi_string
+	)
+	{
+		BEGIN_EXCP_CODE
+		cpp_result1 = rinchi_string_from_file_text(input_format, in_file_text, in_force_equilibrium);
+		*out_rinchi_string = cpp_result1.c_str();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchi_string_from_file_text_buf(
+		const char* input_format, const char* in_file_text, bool in_force_equilibrium, rinchilib_buffer* out_rinchi_string
+	)
+	{
+		BEGIN_EXCP_CODE
+		return fill_buffers({ {rinchi_string_from_file_text(input_format, in_file_text, in_force_equilibrium), out_rinchi_string} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchikey_from_file_text(
+		const char* input_format, const char* in_file_text, const char* key_type, bool in_force_equilibrium, const char** out_rinchi_key
+	)
+	{
+		BEGIN_EXCP_CODE
+		cpp_result1 = rinchikey_from_file_text(input_format, in_file_text, key_type, in_force_equilibrium);
 		*out_rinchi_key = cpp_result1.c_str();
 		END_EXCP_CODE
 	}
 
+	API_EXPORT int rinchilib_rinchikey_from_file_text_buf(
+		const char* input_format, const char* in_file_text, const char* key_type, bool in_force_equilibrium, rinchilib_buffer* out_rinchi_key
+	)
+	{
+		BEGIN_EXCP_CODE
+		return fill_buffers({ {rinchikey_from_file_text(input_format, in_file_text, key_type, in_force_equilibrium), out_rinchi_key} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_all_from_file_text(
+		const char* input_format, const char* in_file_text, bool in_force_equilibrium, int output_mask,
+		const char** out_rinchi_string, const char** out_rinchi_auxinfo, const char** out_long_key, const char** out_short_key, const char** out_web_key
+	)
+	{
+		BEGIN_EXCP_CODE
+		all_from_file_text(input_format, in_file_text, in_force_equilibrium, output_mask, cpp_results);
+
+		set_output(cpp_results.rinchi_string, out_rinchi_string);
+		set_output(cpp_results.rinchi_auxinfo, out_rinchi_auxinfo);
+		set_output(cpp_results.long_key, out_long_key);
+		set_output(cpp_results.short_key, out_short_key);
+		set_output(cpp_results.web_key, out_web_key);
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_all_from_file_text_buf(
+		const char* input_format, const char* in_file_text, bool in_force_equilibrium, int output_mask,
+		rinchilib_buffer* out_rinchi_string, rinchilib_buffer* out_rinchi_auxinfo, rinchilib_buffer* out_long_key, rinchilib_buffer* out_short_key, rinchilib_buffer* out_web_key
+	)
+	{
+		BEGIN_EXCP_CODE
+		rinchi::ReactionResult results;
+		all_from_file_text(input_format, in_file_text, in_force_equilibrium, output_mask, results);
+		return fill_buffers({
+			{results.rinchi_string, out_rinchi_string}, {results.rinchi_auxinfo, out_rinchi_auxinfo},
+			{results.long_key, out_long_key}, {results.short_key, out_short_key}, {results.web_key, out_web_key}
+		});
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_all_from_file_texts_arrow(
+		const char* input_format, const char* const* in_file_texts, long count, bool in_force_equilibrium, int output_mask,
+		ArrowArray* out_array, ArrowSchema* out_schema
+	)
+	{
+		BEGIN_EXCP_CODE
+		if (output_mask <= 0 || (output_mask & ~RINCHI_OUTPUT_ALL) != 0)
+			throw rinchi::RInChIError("Invalid output selection. 'output_mask' must be a combination of RINCHI_OUTPUT_* values.");
+		if (count < 0 || (count > 0 && !in_file_texts))
+			throw rinchi::RInChIError("Invalid file text array.");
+
+		std::vector<FileTextRow> rows(count);
+		for (long i = 0; i < count; i++) {
+			FileTextRow& row = rows[i];
+			try {
+				if (!in_file_texts[i])
+					throw rinchi::RInChIError("Missing file text.");
+				all_from_file_text(input_format, in_file_texts[i], in_force_equilibrium, output_mask, row.results);
+			}
+			catch (std::exception& e) {
+				row.failed = true;
+				row.error = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what();
+			}
+		}
+
+		export_arrow_table(rows, output_mask, out_array, out_schema);
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_file_text_from_rinchi(
+		const char* rinchi_string, const char* rinchi_auxinfo, const char* output_format, const char** out_file_text
+	)
+	{
+		BEGIN_EXCP_CODE
+		cpp_result1 = file_text_from_rinchi(rinchi_string, rinchi_auxinfo, output_format);
+		*out_file_text = cpp_result1.c_str();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_file_text_from_rinchi_buf(
+		const char* rinchi_string, const char* rinchi_auxinfo, const char* output_format, rinchilib_buffer* out_file_text
+	)
+	{
+		BEGIN_EXCP_CODE
+		return fill_buffers({ {file_text_from_rinchi(rinchi_string, rinchi_auxinfo, output_format), out_file_text} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_inchis_from_rinchi(
+		const char* rinchi_string, const char* rinchi_auxinfo, const char** out_inchis_text
+	)
+	{
+		BEGIN_EXCP_CODE
+		cpp_result1 = inchis_from_rinchi(rinchi_string, rinchi_auxinfo);
+		*out_inchis_text = cpp_result1.c_str();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_inchis_from_rinchi_buf(
+		const char* rinchi_string, const char* rinchi_auxinfo, rinchilib_buffer* out_inchis_text
+	)
+	{
+		BEGIN_EXCP_CODE
+		return fill_buffers({ {inchis_from_rinchi(rinchi_string, rinchi_auxinfo), out_inchis_text} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchi_from_inchis(
+		const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, const char** out_rinchi_string, const char** out_rinchi_auxinfo
+	)
+	{
+		BEGIN_EXCP_CODE
+		rinchi_from_inchis(reactant_inchis, product_inchis, agent_inchis, cpp_result1, cpp_result2);
+
+		*out_rinchi_string  = cpp_result1.c_str();
+		*out_rinchi_auxinfo = cpp_result2.c_str();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchi_from_inchis_buf(
+		const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, rinchilib_buffer* out_rinchi_string, rinchilib_buffer* out_rinchi_auxinfo
+	)
+	{
+		BEGIN_EXCP_CODE
+		std::string rinchi_string;
+		std::string rinchi_auxinfo;
+		rinchi_from_inchis(reactant_inchis, product_inchis, agent_inchis, rinchi_string, rinchi_auxinfo);
+		return fill_buffers({ {rinchi_string, out_rinchi_string}, {rinchi_auxinfo, out_rinchi_auxinfo} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchikey_from_inchis(
+		const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, const char* key_type, const char** out_rinchi_key
+	)
+	{
+		BEGIN_EXCP_CODE
+		cpp_result1 = rinchikey_from_inchis(reactant_inchis, product_inchis, agent_inchis, key_type);
+		*out_rinchi_key = cpp_result1.c_str();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchikey_from_inchis_buf(
+		const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, const char* key_type, rinchilib_buffer* out_rinchi_key
+	)
+	{
+		BEGIN_EXCP_CODE
+		return fill_buffers({ {rinchikey_from_inchis(reactant_inchis, product_inchis, agent_inchis, key_type), out_rinchi_key} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_set_inchi_key_check(long interval)
+	{
+		BEGIN_EXCP_CODE
+		if (interval < 0)
+			throw rinchi::RInChIError("InChIKey check interval must not be negative.");
+		inchi_key_check_interval = (unsigned) interval;
+		inchi_key_count = 0;
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_reaction_create(bool in_force_equilibrium, bool in_omit_auxinfo, rinchilib_reaction** out_reaction)
+	{
+		BEGIN_EXCP_CODE
+		std::unique_ptr<rinchilib_reaction> result (new rinchilib_reaction());
+		result->reaction.set_omit_auxinfo(in_omit_auxinfo);
+		if (in_force_equilibrium)
+			result->reaction.set_directionality(rinchi::rdEquilibrium);
+		*out_reaction = result.release();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT void rinchilib_reaction_destroy(rinchilib_reaction* reaction)
+	{
+		delete reaction;
+	}
+
+	API_EXPORT int rinchilib_reaction_add_component(
+		rinchilib_reaction* reaction, const char* role, bool is_chiral,
+		int atom_count, const char* const* elements, const double* coordinates, const int* charges, const int* isotopic_masses, const int* radicals, const int* implicit_hydrogens,
+		int bond_count, const int* bond_atoms, const int* bond_orders, const int* bond_stereos
+	)
+	{
+		BEGIN_EXCP_CODE
+		if (!reaction)
+			throw rinchi::RInChIError("Missing reaction handle.");
+		std::string component_role = role ? role : "";
+		if (component_role != "R" && component_role != "P" && component_role != "A")
+			throw rinchi::RInChIError("Invalid component role. 'role' parameter must be 'R'(eactant), 'P'(roduct) or 'A'(gent).");
+
+		// Built on the side, so that the reaction is left as it was if the structure is rejected.
+		rinchi::ReactionComponent component;
+		load_component(atom_count, elements, coordinates, charges, isotopic_masses, radicals, implicit_hydrogens, bond_count, bond_atoms, bond_orders, bond_stereos, is_chiral, component);
+		component.set_omit_auxinfo(reaction->reaction.omit_auxinfo());
+
+		rinchi::ReactionComponent* target;
+		if (component_role == "R")
+			target = reaction->reaction.add_reactant();
+		else if (component_role == "P")
+			target = reaction->reaction.add_product();
+		else
+			target = reaction->reaction.add_agent();
+		*target = std::move(component);
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_reaction_rinchi(rinchilib_reaction* reaction, const char** out_rinchi_string, const char** out_rinchi_auxinfo)
+	{
+		BEGIN_EXCP_CODE
+		reaction_rinchi(reaction, cpp_result1, cpp_result2);
+
+		*out_rinchi_string = cpp_result1.c_str();
+		if (out_rinchi_auxinfo)
+			*out_rinchi_auxinfo = cpp_result2.c_str();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_reaction_rinchi_buf(rinchilib_reaction* reaction, rinchilib_buffer* out_rinchi_string, rinchilib_buffer* out_rinchi_auxinfo)
+	{
+		BEGIN_EXCP_CODE
+		std::string rinchi_string;
+		std::string rinchi_auxinfo;
+		reaction_rinchi(reaction, rinchi_string, rinchi_auxinfo);
+		return fill_buffers({ {rinchi_string, out_rinchi_string}, {rinchi_auxinfo, out_rinchi_auxinfo} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_reaction_rinchikey(rinchilib_reaction* reaction, const char* key_type, const char** out_rinchi_key)
+	{
+		BEGIN_EXCP_CODE
+		cpp_result1 = reaction_rinchikey(reaction, key_type);
+		*out_rinchi_key = cpp_result1.c_str();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_reaction_rinchikey_buf(rinchilib_reaction* reaction, const char* key_type, rinchilib_buffer* out_rinchi_key)
+	{
+		BEGIN_EXCP_CODE
+		return fill_buffers({ {reaction_rinchikey(reaction, key_type), out_rinchi_key} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchikey_from_rinchi(
+		const char* rinchi_string, const char* key_type, const char** out_rinchi_key
+	)
+	{
+		BEGIN_EXCP_CODE
+		cpp_result1 = rinchikey_from_rinchi(rinchi_string, key_type);
+		*out_rinchi_key = cpp_result1.c_str();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_rinchikey_from_rinchi_buf(
+		const char* rinchi_string, const char* key_type, rinchilib_buffer* out_rinchi_key
+	)
+	{
+		BEGIN_EXCP_CODE
+		return fill_buffers({ {rinchikey_from_rinchi(rinchi_string, key_type), out_rinchi_key} });
+		CATCH_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_set_allocator(rinchilib_allocator allocate, void* context)
+	{
+		BEGIN_EXCP_CODE
+		output_allocator = allocate;
+		output_allocator_context = allocate ? context : NULL;
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_set_result_cache(long max_entries, long ttl_seconds)
+	{
+		BEGIN_EXCP_CODE
+		if (max_entries < 0 || ttl_seconds < 0)
+			throw rinchi::RInChIError("Result cache limits must not be negative.");
+		result_cache.set_limits(max_entries, std::chrono::seconds(ttl_seconds));
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_result_cache_stats(
+		long* out_hits, long* out_misses, long* out_expirations, long* out_evictions, long* out_entries
+	)
+	{
+		BEGIN_EXCP_CODE
+		rinchi::ReactionResultCacheStats stats = result_cache.stats();
+		*out_hits        = stats.hits;
+		*out_misses      = stats.misses;
+		*out_expirations = stats.expirations;
+		*out_evictions   = stats.evictions;
+		*out_entries     = (long) stats.entries;
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_clear_result_cache()
+	{
+		BEGIN_EXCP_CODE
+		result_cache.clear();
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_set_inchi_cache_file(const char* path)
+	{
+		BEGIN_EXCP_CODE
+		rinchi::set_inchi_cache_file(path ? path : "");
+		END_EXCP_CODE
+	}
+
+	API_EXPORT int rinchilib_inchi_cache_stats(long* out_hits, long* out_misses, long* out_appends, long* out_entries)
+	{
+		BEGIN_EXCP_CODE
+		std::shared_ptr<rinchi::InChICache> cache = rinchi::inchi_cache();
+		rinchi::InChICacheStats stats;
+		if (cache)
+			stats = cache->stats();
+		*out_hits    = stats.hits;
+		*out_misses  = stats.misses;
+		*out_appends = stats.appends;
+		*out_entries = (long) stats.entries;
+		END_EXCP_CODE
+	}
+
 }
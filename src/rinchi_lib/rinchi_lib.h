@@ -42,11 +42,99 @@
 
 #define RETURN_CODE_SUCCESS 0
 #define RETURN_CODE_ERROR 1
+// Returned by the *_buf() functions if a result does not fit its buffer.
+#define RETURN_CODE_BUFFER_TOO_SMALL 2
+
+#include <stddef.h>
+#include <stdint.h>
 
 extern const char* RINCHI_INPUT_FORMAT_RDFILE;
 extern const char* RINCHI_INPUT_FORMAT_RXNFILE;
 extern const char* RINCHI_INPUT_FORMAT_AUTO;
 
+// Output selectors for rinchilib_all_from_file_text(); they can be combined.
+#define RINCHI_OUTPUT_RINCHI_STRING 1
+#define RINCHI_OUTPUT_RAUXINFO 2
+#define RINCHI_OUTPUT_LONG_KEY 4
+#define RINCHI_OUTPUT_SHORT_KEY 8
+#define RINCHI_OUTPUT_WEB_KEY 16
+#define RINCHI_OUTPUT_ALL 31
+
+// Bond stereo values for rinchilib_reaction_add_component(). Wedges point from the first atom of the bond.
+#define RINCHILIB_BOND_STEREO_NONE 0
+#define RINCHILIB_BOND_STEREO_UP 1
+#define RINCHILIB_BOND_STEREO_DOWN 2
+#define RINCHILIB_BOND_STEREO_EITHER 3
+#define RINCHILIB_BOND_STEREO_DOUBLE_EITHER 4
+
+/**
+ * Output buffer of the *_buf() functions, which copy their results into memory of the caller instead of returning
+ * pointers to library memory that the next call overwrites.
+ * - If 'data' has room for the result and its terminating 0 ('capacity' > result length), the result is copied there.
+ * - If 'data' is NULL and an allocator is set (rinchilib_set_allocator()), 'data' is set to a block of result length + 1
+ *   bytes from the allocator, and 'capacity' to its size. The block belongs to the caller. If the allocator returns
+ *   NULL, 'data' stays NULL and the function returns RETURN_CODE_BUFFER_TOO_SMALL as below.
+ * - Otherwise nothing is copied and the function returns RETURN_CODE_BUFFER_TOO_SMALL; the other results are still
+ *   copied. Call again with buffers of at least 'length' + 1 bytes.
+ * 'length' is always set to the length of the result, without the terminating 0. A NULL buffer discards its result.
+ */
+typedef struct {
+	char* data;
+	size_t capacity;
+	size_t length;
+} rinchilib_buffer;
+
+// Allocates 'size' bytes for a result of a *_buf() function; 'context' is the value passed to rinchilib_set_allocator().
+// Returns NULL on failure, which makes the function return RETURN_CODE_BUFFER_TOO_SMALL.
+typedef void* (*rinchilib_allocator)(size_t size, void* context);
+
+// Handle of a reaction built by the rinchilib_reaction_*() functions.
+typedef struct rinchilib_reaction rinchilib_reaction;
+
+// Arrow C Data Interface, for rinchilib_all_from_file_texts_arrow(). These definitions are fixed by the Arrow
+// specification (https://arrow.apache.org/docs/format/CDataInterface.html) and may also come from other headers.
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+	// Array type description
+	const char* format;
+	const char* name;
+	const char* metadata;
+	int64_t flags;
+	int64_t n_children;
+	struct ArrowSchema** children;
+	struct ArrowSchema* dictionary;
+
+	// Release callback
+	void (*release)(struct ArrowSchema*);
+	// Opaque producer-specific data
+	void* private_data;
+};
+
+struct ArrowArray {
+	// Array data description
+	int64_t length;
+	int64_t null_count;
+	int64_t offset;
+	int64_t n_buffers;
+	int64_t n_children;
+	const void** buffers;
+	struct ArrowArray** children;
+	struct ArrowArray* dictionary;
+
+	// Release callback
+	void (*release)(struct ArrowArray*);
+	// Opaque producer-specific data
+	void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
 #ifdef __cplusplus
 extern "C" {
 #else
@@ -74,6 +162,19 @@ int rinchilib_rinchi_from_file_text(
 	const char* input_format, const char* in_file_text, bool in_force_equilibrium, const char** out_rinchi_string, const char** out_rinchi_auxinfo
 );
 
+/**
+ * @brief rinchilib_rinchi_string_from_file_text() generates an RInChI string only from an RD or RXN file text block.
+ *        No AuxInfo is calculated, which makes it faster than rinchilib_rinchi_from_file_text().
+ * @param input_format - "RD" or "RXN" to force explicit parsing; "" or "AUTO" to attempt format auto-detection.
+ * @param in_file_text - Text block with RD or RXN file contents.
+ * @param in_force_equilibrium - Force interpretation of reaction as equilibrium reaction.
+ * @param out_rinchi_string - Returned pointer to C-string with generated RInChI.
+ * @return Standard error code.
+ */
+int rinchilib_rinchi_string_from_file_text(
+	const char* input_format, const char* in_file_text, bool in_force_equilibrium, const char** out_rinchi_string
+);
+
 /**
  * @brief rinchilib_rinchikey_from_file_text() generates an RInChI key from an RD or RXN file text block.
  * @param input_format - "RD" or "RXN" to force explicit parsing; "" or "AUTO" to attempt format auto-detection.
@@ -87,6 +188,48 @@ int rinchilib_rinchikey_from_file_text(
 	const char* input_format, const char* in_file_text, const char* key_type, bool in_force_equilibrium, const char** out_rinchi_key
 );
 
+/**
+ * @brief rinchilib_all_from_file_text() generates any of RInChI, RAuxInfo and the three RInChI keys from an RD or RXN file text block,
+ *        reading the file and calculating the component InChIs only once. AuxInfo is only calculated if RAuxInfo is selected.
+ * @param input_format - "RD" or "RXN" to force explicit parsing; "" or "AUTO" to attempt format auto-detection.
+ * @param in_file_text - Text block with RD or RXN file contents.
+ * @param in_force_equilibrium - Force interpretation of reaction as equilibrium reaction.
+ * @param output_mask - The outputs to generate: RINCHI_OUTPUT_* values combined with '|', e.g. RINCHI_OUTPUT_ALL.
+ * @param out_rinchi_string - Returned pointer to C-string with generated RInChI.
+ * @param out_rinchi_auxinfo - Returned pointer to C-string with generated RAuxInfo.
+ * @param out_long_key - Returned pointer to C-string with generated Long-RInChIKey.
+ * @param out_short_key - Returned pointer to C-string with generated Short-RInChIKey.
+ * @param out_web_key - Returned pointer to C-string with generated Web-RInChIKey.
+ *        Outputs that are not selected are returned as blank strings; their pointers may be NULL.
+ * @return Standard error code.
+ */
+int rinchilib_all_from_file_text(
+	const char* input_format, const char* in_file_text, bool in_force_equilibrium, int output_mask,
+	const char** out_rinchi_string, const char** out_rinchi_auxinfo, const char** out_long_key, const char** out_short_key, const char** out_web_key
+);
+
+/**
+ * @brief rinchilib_all_from_file_texts_arrow() generates the outputs of rinchilib_all_from_file_text() for many RD or RXN file
+ *        text blocks and returns them as one table in the Arrow C Data Interface format, which Arrow consumers like pyarrow,
+ *        polars and pandas import without copying. The table is a struct array with a row per file text and these columns:
+ *        - "rinchi_string", "rinchi_auxinfo", "long_key", "short_key", "web_key": the outputs selected in 'output_mask', as
+ *          large UTF-8 strings ("U"). Null in rows that failed.
+ *        - "error": large UTF-8 string. The error message of rows that failed, null in the others.
+ *        - "status": int32 ("i"). RETURN_CODE_SUCCESS or RETURN_CODE_ERROR.
+ *        A file text that fails does not make the function fail.
+ * @param input_format - "RD" or "RXN" to force explicit parsing; "" or "AUTO" to attempt format auto-detection.
+ * @param in_file_texts - Array of 'count' text blocks with RD or RXN file contents.
+ * @param count - Number of file texts.
+ * @param in_force_equilibrium - Force interpretation of reactions as equilibrium reactions.
+ * @param output_mask - The outputs to generate: RINCHI_OUTPUT_* values combined with '|', e.g. RINCHI_OUTPUT_ALL.
+ * @param out_array - Returned table. It belongs to the caller, who must call its 'release' callback or pass it on to a consumer.
+ * @param out_schema - Returned type of the table. Released like 'out_array'.
+ * @return Standard error code. On error nothing is returned.
+ */
+int rinchilib_all_from_file_texts_arrow(
+	const char* input_format, const char* const* in_file_texts, long count, bool in_force_equilibrium, int output_mask,
+	struct ArrowArray* out_array, struct ArrowSchema* out_schema
+);
 /**
  * @brief rinchilib_file_text_from_rinchi() reconstructs an RD or RXN file from RInChI and (optionally) RAuxInfo.
  * @param rinchi_string - RInChI string.
@@ -123,6 +266,91 @@ int rinchilib_rinchi_from_inchis(
         const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, const char** out_rinchi_string, const char** out_rinchi_auxinfo
 );
 
+/**
+ * @brief rinchilib_rinchikey_from_inchis() loads pre-calculated InChI strings like rinchilib_rinchi_from_inchis() and outputs an RInChI key.
+ *        Each InChI line may be followed by an "InChIKey=" line with the standard InChIKey of the component (before or after its
+ *        AuxInfo line); the key is then used instead of being calculated, subject to rinchilib_set_inchi_key_check().
+ * @param reactant_inchis - Text lines with InChI lines, each optionally followed by AuxInfo and InChIKey lines. NULL input is equivalent to a blank input string.
+ * @param product_inchis - Text lines with InChI lines, each optionally followed by AuxInfo and InChIKey lines. NULL input is equivalent to a blank input string.
+ * @param agent_inchis - Text lines with InChI lines, each optionally followed by AuxInfo and InChIKey lines. NULL input is equivalent to a blank input string.
+ * @param key_type - 1-letter string controlling the type of key generated: L(ong), S(hort) or W(eb).
+ * @param out_rinchi_key - Returned pointer to C-string with generated key.
+ * @return Standard error code.
+ */
+int rinchilib_rinchikey_from_inchis(
+	const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, const char* key_type, const char** out_rinchi_key
+);
+
+/**
+ * @brief rinchilib_set_inchi_key_check() controls how InChIKey lines given to the *_from_inchis() functions are checked. Their format
+ *        is always checked. Every interval'th key, starting with the first, is also checked against its InChI string, which takes
+ *        as long as calculating it. Keys are counted over all calls, from the latest call of this function on.
+ * @param interval - 1 (the default) checks every key, 0 trusts all keys, e.g. 100 checks 1 key in 100.
+ * @return Standard error code.
+ */
+int rinchilib_set_inchi_key_check(long interval);
+
+/**
+ * @brief rinchilib_reaction_create() creates an empty reaction, to which components are added from in-memory connection tables
+ *        with rinchilib_reaction_add_component(). This avoids writing and parsing RXN file text.
+ * @param in_force_equilibrium - Make the reaction an equilibrium reaction.
+ * @param in_omit_auxinfo - Calculate no AuxInfo, for callers that only need the RInChI string or keys.
+ * @param out_reaction - Returned reaction handle; release it with rinchilib_reaction_destroy().
+ * @return Standard error code.
+ */
+int rinchilib_reaction_create(bool in_force_equilibrium, bool in_omit_auxinfo, rinchilib_reaction** out_reaction);
+
+/**
+ * @brief rinchilib_reaction_destroy() releases a reaction handle. NULL is ignored.
+ * @param reaction - Handle returned by rinchilib_reaction_create().
+ */
+void rinchilib_reaction_destroy(rinchilib_reaction* reaction);
+
+/**
+ * @brief rinchilib_reaction_add_component() adds a reactant, product or agent given as atom and bond arrays. Atoms and bonds have the
+ *        meaning they have in an MDL molfile; atoms are numbered from 0. A component without atoms, or with a single "A", "X", "R",
+ *        "R#" or "*" atom, is a No-Structure. Optional arrays may be NULL. If the structure is rejected, the reaction is unchanged.
+ * @param reaction - Handle returned by rinchilib_reaction_create().
+ * @param role - 1-letter string: R(eactant), P(roduct) or A(gent).
+ * @param is_chiral - The molfile chiral flag: stereo centres are absolute rather than relative.
+ * @param atom_count - Number of atoms.
+ * @param elements - Element symbol of each atom.
+ * @param coordinates - Optional; x, y and z of each atom, 3 values per atom. Without them the structure has no stereo.
+ * @param charges - Optional; charge of each atom.
+ * @param isotopic_masses - Optional; mass number of each atom, or 0 for the natural isotope mix.
+ * @param radicals - Optional; radical of each atom: 0 (none), 1 (singlet), 2 (doublet) or 3 (triplet).
+ * @param implicit_hydrogens - Optional; number of implicit hydrogens of each atom, or -1 to let InChI add them.
+ * @param bond_count - Number of bonds.
+ * @param bond_atoms - The two atom indexes of each bond, 2 values per bond.
+ * @param bond_orders - Order of each bond: 1, 2, 3 or 4 (aromatic).
+ * @param bond_stereos - Optional; RINCHILIB_BOND_STEREO_* value of each bond.
+ * @return Standard error code.
+ */
+int rinchilib_reaction_add_component(
+	rinchilib_reaction* reaction, const char* role, bool is_chiral,
+	int atom_count, const char* const* elements, const double* coordinates, const int* charges, const int* isotopic_masses, const int* radicals, const int* implicit_hydrogens,
+	int bond_count, const int* bond_atoms, const int* bond_orders, const int* bond_stereos
+);
+
+/**
+ * @brief rinchilib_reaction_rinchi() generates RInChI and RAuxInfo of a reaction. Components may be added afterwards; only the groups
+ *        they are added to are recalculated next time.
+ * @param reaction - Handle returned by rinchilib_reaction_create().
+ * @param out_rinchi_string - Returned pointer to C-string with generated RInChI.
+ * @param out_rinchi_auxinfo - Returned pointer to C-string with generated RAuxInfo, blank if the reaction omits AuxInfo. May be NULL.
+ * @return Standard error code.
+ */
+int rinchilib_reaction_rinchi(rinchilib_reaction* reaction, const char** out_rinchi_string, const char** out_rinchi_auxinfo);
+
+/**
+ * @brief rinchilib_reaction_rinchikey() generates an RInChI key of a reaction.
+ * @param reaction - Handle returned by rinchilib_reaction_create().
+ * @param key_type - 1-letter string controlling the type of key generated: L(ong), S(hort) or W(eb).
+ * @param out_rinchi_key - Returned pointer to C-string with generated key.
+ * @return Standard error code.
+ */
+int rinchilib_reaction_rinchikey(rinchilib_reaction* reaction, const char* key_type, const char** out_rinchi_key);
+
 /**
  * @brief rinchilib_rinchikey_from_rinchi() generates an RInChI key from an RInChI string.
  * @param rinchi_string - RInChI string.
@@ -134,6 +362,103 @@ int rinchilib_rinchikey_from_rinchi(
 	const char* rinchi_string, const char* key_type, const char** out_rinchi_key
 );
 
+/**
+ * @brief rinchilib_set_result_cache() enables, resizes or disables the cache used by the *_from_file_text() functions.
+ *        The cache maps file texts to RInChI, RAuxInfo and keys. Texts that only differ in line endings, in the
+ *        name/timestamp/comment header lines or in the lines before the first $RFMT of an RD file share an entry.
+ *        Errors are not cached.
+ * @param max_entries - Maximum number of cached reactions; the least recently used is dropped to make room.
+ *                      0 (the default) disables the cache.
+ * @param ttl_seconds - Entries older than this are calculated again. 0 keeps entries until they are dropped.
+ * @return Standard error code.
+ */
+int rinchilib_set_result_cache(long max_entries, long ttl_seconds);
+
+/**
+ * @brief rinchilib_result_cache_stats() returns the result cache statistics since the last rinchilib_clear_result_cache().
+ *        The hit rate is hits / (hits + misses).
+ * @param out_hits - Returned number of calls answered from the cache.
+ * @param out_misses - Returned number of calls that had to calculate, including expired entries.
+ * @param out_expirations - Returned number of entries found to be older than the time-to-live.
+ * @param out_evictions - Returned number of entries dropped to make room.
+ * @param out_entries - Returned number of entries in the cache.
+ * @return Standard error code.
+ */
+int rinchilib_result_cache_stats(
+	long* out_hits, long* out_misses, long* out_expirations, long* out_evictions, long* out_entries
+);
+
+/**
+ * @brief rinchilib_clear_result_cache() empties the result cache and zeroes its statistics. The limits are kept.
+ * @return Standard error code.
+ */
+int rinchilib_clear_result_cache();
+
+/**
+ * @brief rinchilib_set_inchi_cache_file() sets the persistent InChI cache file, which keeps the InChI, AuxInfo and
+ *        InChIKey of every component structure calculated. Processes using the same file share it, and it is kept
+ *        between runs; a file written by another RInChI or InChI library version is replaced by an empty one.
+ *        Without a call to this function the file named by the RINCHI_INCHI_CACHE environment variable is used.
+ * @param path - Path of the cache file, created if it does not exist. NULL or "" turns the cache off.
+ * @return Standard error code.
+ */
+int rinchilib_set_inchi_cache_file(const char* path);
+
+/**
+ * @brief rinchilib_inchi_cache_stats() returns the statistics of the InChI cache file since it was opened by this process.
+ *        All values are 0 if there is no cache file.
+ * @param out_hits - Returned number of component InChIs taken from the cache.
+ * @param out_misses - Returned number of component InChIs that had to be calculated.
+ * @param out_appends - Returned number of records this process added to the file.
+ * @param out_entries - Returned number of records in the file, including those of other processes.
+ * @return Standard error code.
+ */
+int rinchilib_inchi_cache_stats(long* out_hits, long* out_misses, long* out_appends, long* out_entries);
+
+/**
+ * @brief rinchilib_set_allocator() sets the allocator used for the results of the *_buf() functions when they are passed
+ *        a buffer without 'data'. Hosts can use it to receive results straight into memory they manage.
+ * @param allocate - The allocator; NULL removes it.
+ * @param context - Passed on to every call of 'allocate'.
+ * @return Standard error code.
+ */
+int rinchilib_set_allocator(rinchilib_allocator allocate, void* context);
+
+/**
+ * The *_buf() functions are the functions of the same name without "_buf", with the results copied to rinchilib_buffer-s
+ * (see there). Besides the standard error codes they return RETURN_CODE_BUFFER_TOO_SMALL.
+ */
+int rinchilib_rinchi_from_file_text_buf(
+	const char* input_format, const char* in_file_text, bool in_force_equilibrium, rinchilib_buffer* out_rinchi_string, rinchilib_buffer* out_rinchi_auxinfo
+);
+int rinchilib_rinchi_string_from_file_text_buf(
+	const char* input_format, const char* in_file_text, bool in_force_equilibrium, rinchilib_buffer* out_rinchi_string
+);
+int rinchilib_rinchikey_from_file_text_buf(
+	const char* input_format, const char* in_file_text, const char* key_type, bool in_force_equilibrium, rinchilib_buffer* out_rinchi_key
+);
+int rinchilib_all_from_file_text_buf(
+	const char* input_format, const char* in_file_text, bool in_force_equilibrium, int output_mask,
+	rinchilib_buffer* out_rinchi_string, rinchilib_buffer* out_rinchi_auxinfo, rinchilib_buffer* out_long_key, rinchilib_buffer* out_short_key, rinchilib_buffer* out_web_key
+);
+int rinchilib_file_text_from_rinchi_buf(
+	const char* rinchi_string, const char* rinchi_auxinfo, const char* output_format, rinchilib_buffer* out_file_text
+);
+int rinchilib_inchis_from_rinchi_buf(
+	const char* rinchi_string, const char* rinchi_auxinfo, rinchilib_buffer* out_inchis_text
+);
+int rinchilib_rinchi_from_inchis_buf(
+	const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, rinchilib_buffer* out_rinchi_string, rinchilib_buffer* out_rinchi_auxinfo
+);
+int rinchilib_rinchikey_from_inchis_buf(
+	const char* reactant_inchis, const char* product_inchis, const char* agent_inchis, const char* key_type, rinchilib_buffer* out_rinchi_key
+);
+int rinchilib_rinchikey_from_rinchi_buf(
+	const char* rinchi_string, const char* key_type, rinchilib_buffer* out_rinchi_key
+);
+int rinchilib_reaction_rinchi_buf(rinchilib_reaction* reaction, rinchilib_buffer* out_rinchi_string, rinchilib_buffer* out_rinchi_auxinfo);
+int rinchilib_reaction_rinchikey_buf(rinchilib_reaction* reaction, const char* key_type, rinchilib_buffer* out_rinchi_key);
+
 #ifdef __cplusplus
 } // end of extern "C"
 #endif
@@ -38,7 +38,25 @@
 import os
 from ctypes import *
 
+# Arrow C Data Interface structures (https://arrow.apache.org/docs/format/CDataInterface.html).
+class ArrowSchema(Structure):
+	pass
+ArrowSchema._fields_ = [("format", c_char_p), ("name", c_char_p), ("metadata", c_char_p), ("flags", c_int64), ("n_children", c_int64),
+	("children", POINTER(POINTER(ArrowSchema))), ("dictionary", POINTER(ArrowSchema)), ("release", CFUNCTYPE(None, POINTER(ArrowSchema))), ("private_data", c_void_p)]
+
+class ArrowArray(Structure):
+	pass
+ArrowArray._fields_ = [("length", c_int64), ("null_count", c_int64), ("offset", c_int64), ("n_buffers", c_int64), ("n_children", c_int64),
+	("buffers", POINTER(c_void_p)), ("children", POINTER(POINTER(ArrowArray))), ("dictionary", POINTER(ArrowArray)), ("release", CFUNCTYPE(None, POINTER(ArrowArray))), ("private_data", c_void_p)]
+
 class RInChI:
+	# Output selectors for all_from_file_text(); they can be combined with '|'.
+	OUTPUT_RINCHI_STRING = 1
+	OUTPUT_RAUXINFO = 2
+	OUTPUT_LONG_KEY = 4
+	OUTPUT_SHORT_KEY = 8
+	OUTPUT_WEB_KEY = 16
+	OUTPUT_ALL = 31
 	def __init__(self, lib_path = "."):
 		if os.sep == "\\":
 			self.lib_handle = cdll.LoadLibrary(lib_path + "/librinchi.dll")
@@ -52,10 +70,20 @@ class RInChI:
 		self.lib_rinchi_from_file_text.argtypes = [c_char_p, c_char_p, c_bool, POINTER(c_char_p), POINTER(c_char_p)]
 		self.lib_rinchi_from_file_text.restype = c_long
 
+		self.lib_rinchi_string_from_file_text = self.lib_handle.rinchilib_rinchi_string_from_file_text
+		self.lib_rinchi_string_from_file_text.argtypes = [c_char_p, c_char_p, c_bool, POINTER(c_char_p)]
+		self.lib_rinchi_string_from_file_text.restype = c_long
+
 		self.lib_rinchikey_from_file_text = self.lib_handle.rinchilib_rinchikey_from_file_text
 		self.lib_rinchikey_from_file_text.argtypes = [c_char_p, c_char_p, c_char_p, c_bool, POINTER(c_char_p)]
 		self.lib_rinchikey_from_file_text.restype = c_long
 
+		self.lib_all_from_file_text = self.lib_handle.rinchilib_all_from_file_text
+		self.lib_all_from_file_text.argtypes = [c_char_p, c_char_p, c_bool, c_int, POINTER(c_char_p), POINTER(c_char_p), POINTER(c_char_p), POINTER(c_char_p), POINTER(c_char_p)]
+		self.lib_all_from_file_text.restype = c_long
+		self.lib_all_from_file_texts_arrow = self.lib_handle.rinchilib_all_from_file_texts_arrow
+		self.lib_all_from_file_texts_arrow.argtypes = [c_char_p, POINTER(c_char_p), c_long, c_bool, c_int, POINTER(ArrowArray), POINTER(ArrowSchema)]
+		self.lib_all_from_file_texts_arrow.restype = c_long
 		self.lib_file_text_from_rinchi = self.lib_handle.rinchilib_file_text_from_rinchi
 		self.lib_file_text_from_rinchi.argtypes = [c_char_p, c_char_p, c_char_p, POINTER(c_char_p)]
 		self.lib_file_text_from_rinchi.restype = c_long
@@ -68,10 +96,52 @@ class RInChI:
 		self.lib_rinchi_from_inchis.argtypes = [c_char_p, c_char_p, c_char_p, POINTER(c_char_p), POINTER(c_char_p)]
 		self.lib_rinchi_from_inchis.restype = c_long
 
+		self.lib_rinchikey_from_inchis = self.lib_handle.rinchilib_rinchikey_from_inchis
+		self.lib_rinchikey_from_inchis.argtypes = [c_char_p, c_char_p, c_char_p, c_char_p, POINTER(c_char_p)]
+		self.lib_rinchikey_from_inchis.restype = c_long
+
+		self.lib_set_inchi_key_check = self.lib_handle.rinchilib_set_inchi_key_check
+		self.lib_set_inchi_key_check.argtypes = [c_long]
+		self.lib_set_inchi_key_check.restype = c_long
+
+		self.lib_reaction_create = self.lib_handle.rinchilib_reaction_create
+		self.lib_reaction_create.argtypes = [c_bool, c_bool, POINTER(c_void_p)]
+		self.lib_reaction_create.restype = c_long
+		self.lib_reaction_destroy = self.lib_handle.rinchilib_reaction_destroy
+		self.lib_reaction_destroy.argtypes = [c_void_p]
+		self.lib_reaction_destroy.restype = None
+		self.lib_reaction_add_component = self.lib_handle.rinchilib_reaction_add_component
+		self.lib_reaction_add_component.argtypes = [c_void_p, c_char_p, c_bool, c_int, POINTER(c_char_p), POINTER(c_double), POINTER(c_int), POINTER(c_int), POINTER(c_int), POINTER(c_int), c_int, POINTER(c_int), POINTER(c_int), POINTER(c_int)]
+		self.lib_reaction_add_component.restype = c_long
+		self.lib_reaction_rinchi = self.lib_handle.rinchilib_reaction_rinchi
+		self.lib_reaction_rinchi.argtypes = [c_void_p, POINTER(c_char_p), POINTER(c_char_p)]
+		self.lib_reaction_rinchi.restype = c_long
+		self.lib_reaction_rinchikey = self.lib_handle.rinchilib_reaction_rinchikey
+		self.lib_reaction_rinchikey.argtypes = [c_void_p, c_char_p, POINTER(c_char_p)]
+		self.lib_reaction_rinchikey.restype = c_long
 		self.lib_rinchikey_from_rinchi = self.lib_handle.rinchilib_rinchikey_from_rinchi
 		self.lib_rinchikey_from_rinchi.argtypes = [c_char_p, c_char_p, POINTER(c_char_p)]
 		self.lib_rinchikey_from_rinchi.restype = c_long
 
+		self.lib_set_result_cache = self.lib_handle.rinchilib_set_result_cache
+		self.lib_set_result_cache.argtypes = [c_long, c_long]
+		self.lib_set_result_cache.restype = c_long
+
+		self.lib_result_cache_stats = self.lib_handle.rinchilib_result_cache_stats
+		self.lib_result_cache_stats.argtypes = [POINTER(c_long), POINTER(c_long), POINTER(c_long), POINTER(c_long), POINTER(c_long)]
+		self.lib_result_cache_stats.restype = c_long
+
+		self.lib_clear_result_cache = self.lib_handle.rinchilib_clear_result_cache
+		self.lib_clear_result_cache.restype = c_long
+
+		self.lib_set_inchi_cache_file = self.lib_handle.rinchilib_set_inchi_cache_file
+		self.lib_set_inchi_cache_file.argtypes = [c_char_p]
+		self.lib_set_inchi_cache_file.restype = c_long
+
+		self.lib_inchi_cache_stats = self.lib_handle.rinchilib_inchi_cache_stats
+		self.lib_inchi_cache_stats.argtypes = [POINTER(c_long), POINTER(c_long), POINTER(c_long), POINTER(c_long)]
+		self.lib_inchi_cache_stats.restype = c_long
+
 	def rinchi_errorcheck(self, return_code):
 		if return_code != 0:
 			raise Exception (self.lib_latest_error_message().decode('utf-8'))
@@ -83,12 +153,46 @@ class RInChI:
 		self.rinchi_errorcheck( self.lib_rinchi_from_file_text(input_format.encode('utf-8'), rxnfile_data.encode('utf-8'), force_equilibrium, byref(result_rinchi_string), byref(result_rinchi_auxinfo)) )
 		return [str(result_rinchi_string.value.decode('utf-8')), str(result_rinchi_auxinfo.value.decode('utf-8'))]
 
+	def rinchi_string_from_file_text( self, input_format, rxnfile_data, force_equilibrium = False ):
+		"""Generates only the RInChI string from supplied RD or RXN file text, skipping the AuxInfo calculation."""
+		result_rinchi_string = c_char_p()
+		self.rinchi_errorcheck( self.lib_rinchi_string_from_file_text(input_format.encode('utf-8'), rxnfile_data.encode('utf-8'), force_equilibrium, byref(result_rinchi_string)) )
+		return str(result_rinchi_string.value.decode('utf-8'))
+
 	def rinchikey_from_file_text( self, input_format, file_text, key_type, force_equilibrium = False ):
 		"""Generates RInChI key of supplied RD or RXN file text."""
 		result = c_char_p()
 		self.rinchi_errorcheck( self.lib_rinchikey_from_file_text(input_format.encode('utf-8'), file_text.encode('utf-8'), key_type.encode('utf-8'), force_equilibrium, byref(result)) )
 		return str(result.value.decode('utf-8'))
 
+	def all_from_file_text( self, input_format, file_text, outputs = OUTPUT_ALL, force_equilibrium = False ):
+		"""Generates the outputs selected by the OUTPUT_* flags in outputs from supplied RD or RXN file text, reading it only once. Result is returned as a dictionary with the keys rinchi_string, rinchi_auxinfo, long_key, short_key and web_key of the selected outputs."""
+		names = ["rinchi_string", "rinchi_auxinfo", "long_key", "short_key", "web_key"]
+		results = [c_char_p() for name in names]
+		self.rinchi_errorcheck( self.lib_all_from_file_text(input_format.encode('utf-8'), file_text.encode('utf-8'), force_equilibrium, outputs, *[byref(r) for r in results]) )
+		return dict((names[i], results[i].value.decode('utf-8')) for i in range(len(names)) if outputs & (1 << i))
+
+	def all_from_file_texts_arrow_c( self, input_format, file_texts, outputs = OUTPUT_ALL, force_equilibrium = False ):
+		"""Like all_from_file_texts_arrow(), but returns the table as an (ArrowArray, ArrowSchema) tuple of Arrow C Data Interface structures. The caller must call the release callback of both."""
+		texts = (c_char_p * len(file_texts))(*[text.encode('utf-8') for text in file_texts])
+		array = ArrowArray()
+		schema = ArrowSchema()
+		self.rinchi_errorcheck( self.lib_all_from_file_texts_arrow(input_format.encode('utf-8'), texts, len(file_texts), force_equilibrium, outputs, byref(array), byref(schema)) )
+		return (array, schema)
+
+	def all_from_file_texts_arrow( self, input_format, file_texts, outputs = OUTPUT_ALL, force_equilibrium = False ):
+		"""Generates the outputs selected by the OUTPUT_* flags in outputs for a list of RD or RXN file texts. Result is returned as a pyarrow RecordBatch with a row per file text, a column per selected output, an error column and a status column (0: success); a file text that fails does not raise. Requires pyarrow."""
+		import pyarrow
+		array, schema = self.all_from_file_texts_arrow_c(input_format, file_texts, outputs, force_equilibrium)
+		try:
+			return pyarrow.RecordBatch._import_from_c(addressof(array), addressof(schema))
+		finally:
+			# Release what pyarrow has not taken over; its import leaves no release callback behind.
+			if array.release:
+				array.release(byref(array))
+			if schema.release:
+				schema.release(byref(schema))
+
 	def file_text_from_rinchi( self, rinchi_string, rinchi_auxinfo, output_format ):
 		"""Reconstructs (or attempts to reconstruct) RD or RXN file from RInChI string and RAuxInfo. RAuxInfo is not strictly required, but highly recommended."""
 		result = c_char_p()
@@ -153,9 +257,101 @@ class RInChI:
 		self.rinchi_errorcheck( self.lib_rinchi_from_inchis(reactant_inchis.encode('utf-8'), product_inchis.encode('utf-8'), agent_inchis.encode('utf-8'), byref(result_rinchi_string), byref(result_rinchi_auxinfo)) )
 		return [str(result_rinchi_string.value.decode('utf-8')), str(result_rinchi_auxinfo.value.decode('utf-8'))]
 
+	def rinchikey_from_inchis( self, reactant_inchis, product_inchis, agent_inchis, key_type ):
+		"""Generates RInChI key from linefeed-delimited InChI strings, each optionally followed by AuxInfo and InChIKey lines."""
+		result = c_char_p()
+		self.rinchi_errorcheck( self.lib_rinchikey_from_inchis(reactant_inchis.encode('utf-8'), product_inchis.encode('utf-8'), agent_inchis.encode('utf-8'), key_type.encode('utf-8'), byref(result)) )
+		return result.value.decode('utf-8')
+
+	def set_inchi_key_check( self, interval ):
+		"""Checks every interval'th InChIKey given to the *_from_inchis() functions against its InChI string (1: all, 0: none)."""
+		self.rinchi_errorcheck( self.lib_set_inchi_key_check(interval) )
+
+	def reaction( self, force_equilibrium = False, omit_auxinfo = False ):
+		"""Creates an empty RInChIReaction, to be filled with components given as atom and bond lists."""
+		handle = c_void_p()
+		self.rinchi_errorcheck( self.lib_reaction_create(force_equilibrium, omit_auxinfo, byref(handle)) )
+		return RInChIReaction(self, handle)
 	def rinchikey_from_rinchi( self, rinchi_string, key_type ):
 		"""Generates RInChI key of supplied RD or RXN file text."""
 		result = c_char_p()
 		self.rinchi_errorcheck( self.lib_rinchikey_from_rinchi(rinchi_string.encode('utf-8'), key_type.encode('utf-8'), byref(result)) )
 		return result.value.decode('utf-8')
 
+	def set_result_cache( self, max_entries, ttl_seconds = 0 ):
+		"""Caches the results of the *_from_file_text() functions for up to max_entries reactions, each for ttl_seconds (0: no limit). Texts differing only in line endings or header lines share an entry. max_entries = 0 disables the cache."""
+		self.rinchi_errorcheck( self.lib_set_result_cache(max_entries, ttl_seconds) )
+
+	def result_cache_stats( self ):
+		"""Returns a dictionary with the result cache's hits, misses, expirations, evictions, entries and hit_rate."""
+		values = [c_long() for i in range(5)]
+		self.rinchi_errorcheck( self.lib_result_cache_stats(*[byref(v) for v in values]) )
+		result = dict(zip(["hits", "misses", "expirations", "evictions", "entries"], [v.value for v in values]))
+		lookups = result["hits"] + result["misses"]
+		result["hit_rate"] = float(result["hits"]) / lookups if lookups > 0 else 0.0
+		return result
+
+	def clear_result_cache( self ):
+		"""Empties the result cache and zeroes its statistics."""
+		self.rinchi_errorcheck( self.lib_clear_result_cache() )
+
+	def set_inchi_cache_file( self, path ):
+		"""Keeps the InChIs of all component structures in the cache file at path, shared with other processes and kept between runs. None or "" turns the cache off."""
+		self.rinchi_errorcheck( self.lib_set_inchi_cache_file((path or "").encode('utf-8')) )
+
+	def inchi_cache_stats( self ):
+		"""Returns a dictionary with the InChI cache file's hits, misses, appends and entries as seen by this process."""
+		values = [c_long() for i in range(4)]
+		self.rinchi_errorcheck( self.lib_inchi_cache_stats(*[byref(v) for v in values]) )
+		return dict(zip(["hits", "misses", "appends", "entries"], [v.value for v in values]))
+
+class RInChIReaction:
+	"""A reaction built from in-memory structures by RInChI.reaction(). Use it in a with statement, or call close(), to free it."""
+	BOND_STEREO_NONE = 0
+	BOND_STEREO_UP = 1
+	BOND_STEREO_DOWN = 2
+	BOND_STEREO_EITHER = 3
+	BOND_STEREO_DOUBLE_EITHER = 4
+	def __init__(self, rinchi, handle):
+		self.owner = rinchi
+		self.handle = handle
+	def __enter__(self):
+		return self
+	def __exit__(self, exc_type, exc_value, traceback):
+		self.close()
+	def __del__(self):
+		self.close()
+	def close(self):
+		if self.handle:
+			self.owner.lib_reaction_destroy(self.handle)
+			self.handle = None
+	def add_component( self, role, elements, bonds = (), coordinates = None, charges = None, isotopic_masses = None, radicals = None, implicit_hydrogens = None, is_chiral = False ):
+		"""Adds a component; role is "R", "P" or "A". Atoms are numbered from 0. bonds holds (atom, atom, order) or (atom, atom, order, stereo) tuples, coordinates (x, y, z) tuples. An empty elements list adds a No-Structure."""
+		def int_array(values):
+			return (c_int * len(values))(*values) if values is not None else None
+		atom_count = len(elements)
+		bond_stereos = [bond[3] if len(bond) > 3 else RInChIReaction.BOND_STEREO_NONE for bond in bonds]
+		self.owner.rinchi_errorcheck( self.owner.lib_reaction_add_component(
+			self.handle, role.encode('utf-8'), is_chiral,
+			atom_count, (c_char_p * atom_count)(*[e.encode('utf-8') for e in elements]),
+			(c_double * (3 * atom_count))(*[v for xyz in coordinates for v in xyz]) if coordinates is not None else None,
+			int_array(charges), int_array(isotopic_masses), int_array(radicals), int_array(implicit_hydrogens),
+			len(bonds), int_array([atom for bond in bonds for atom in bond[:2]]), int_array([bond[2] for bond in bonds]), int_array(bond_stereos)
+		) )
+	def add_reactant( self, elements, bonds = (), **kwargs ):
+		self.add_component("R", elements, bonds, **kwargs)
+	def add_product( self, elements, bonds = (), **kwargs ):
+		self.add_component("P", elements, bonds, **kwargs)
+	def add_agent( self, elements, bonds = (), **kwargs ):
+		self.add_component("A", elements, bonds, **kwargs)
+	def rinchi( self ):
+		"""Generates RInChI string and RAuxInfo. Result is returned as a list."""
+		result_rinchi_string  = c_char_p()
+		result_rinchi_auxinfo = c_char_p()
+		self.owner.rinchi_errorcheck( self.owner.lib_reaction_rinchi(self.handle, byref(result_rinchi_string), byref(result_rinchi_auxinfo)) )
+		return [str(result_rinchi_string.value.decode('utf-8')), str(result_rinchi_auxinfo.value.decode('utf-8'))]
+	def rinchikey( self, key_type ):
+		"""Generates RInChI key of type "L", "S" or "W"."""
+		result = c_char_p()
+		self.owner.rinchi_errorcheck( self.owner.lib_reaction_rinchikey(self.handle, key_type.encode('utf-8'), byref(result)) )
+		return result.value.decode('utf-8')
@@ -35,6 +35,10 @@
 # */
 #pragma endregion
 
+import ctypes
+import os
+import tempfile
+
 import rinchi_lib
 
 # ## Shadow build with Qt creator on Linux.
@@ -62,6 +66,56 @@ assert (rinchi.rinchi_from_file_text("AUTO", rxndata) == [
     'RInChI=1.00.1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1<>C4H9BrO/c1-3(5)4(2)6/h3-4,6H,1-2H3/t3-,4+/m1/s1!Na.H2O/h;1H2/q+1;/p-1/d-',
     'RAuxInfo=1.00.1/0/N:4,1,3,2,5/E:(1,2)(3,4)/it:im/rA:5nCCCCO/rB:N1;s2;P3;s2s3;/rC:-1.127,-.5635,0;-.4125,-.151,0;.4125,-.151,0;1.127,-.5635,0;0,.5635,0;<>0/N:4,1,3,2,6,5/it:im/rA:6nCCCCOBr/rB:s1;s2;s3;N2;P3;/rC:-.825,-.7557,0;-.4125,-.0412,0;.4125,-.0412,0;.825,.6733,0;-.626,.7557,0;.825,-.7557,0;!1/N:1;2/rA:2nNaO/rB:s1;/rC:-.4125,0,0;.4125,0,0;',
 ])
+assert (rinchi.rinchi_string_from_file_text("RXN", rxndata) ==
+    'RInChI=1.00.1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1<>C4H9BrO/c1-3(5)4(2)6/h3-4,6H,1-2H3/t3-,4+/m1/s1!Na.H2O/h;1H2/q+1;/p-1/d-'
+)
+
+# All outputs from one call.
+assert (rinchi.all_from_file_text("RXN", rxndata) == {
+    "rinchi_string": rinchi.rinchi_from_file_text("RXN", rxndata)[0],
+    "rinchi_auxinfo": rinchi.rinchi_from_file_text("RXN", rxndata)[1],
+    "long_key": rinchi.rinchikey_from_file_text("RXN", rxndata, "L"),
+    "short_key": rinchi.rinchikey_from_file_text("RXN", rxndata, "S"),
+    "web_key": rinchi.rinchikey_from_file_text("RXN", rxndata, "W"),
+})
+assert (rinchi.all_from_file_text("RXN", rxndata, rinchi.OUTPUT_LONG_KEY | rinchi.OUTPUT_WEB_KEY) == {
+    "long_key": rinchi.rinchikey_from_file_text("RXN", rxndata, "L"),
+    "web_key": rinchi.rinchikey_from_file_text("RXN", rxndata, "W"),
+})
+
+# Many file texts as an Arrow table; read here through the C structures so that pyarrow is not needed.
+def arrow_column(array, schema, i):
+    column = array.children[i].contents
+    name = schema.children[i].contents.name.decode('utf-8')
+    buffers = column.buffers
+    if schema.children[i].contents.format == b"i":
+        return name, list(ctypes.cast(buffers[1], ctypes.POINTER(ctypes.c_int32))[:column.length])
+    validity = ctypes.cast(buffers[0], ctypes.POINTER(ctypes.c_uint8)) if buffers[0] else None
+    offsets = ctypes.cast(buffers[1], ctypes.POINTER(ctypes.c_int64))
+    values = []
+    for row in range(column.length):
+        if validity and not validity[row // 8] & (1 << (row % 8)):
+            values.append(None)
+        else:
+            values.append(ctypes.string_at(buffers[2] + offsets[row], offsets[row + 1] - offsets[row]).decode('utf-8'))
+    return name, values
+
+array, schema = rinchi.all_from_file_texts_arrow_c("RXN", [rxndata, "no reaction", rxndata], rinchi.OUTPUT_RINCHI_STRING | rinchi.OUTPUT_SHORT_KEY)
+assert (schema.format == b"+s" and array.length == 3 and array.n_children == 4)
+table = dict(arrow_column(array, schema, i) for i in range(array.n_children))
+array.release(ctypes.byref(array))
+schema.release(ctypes.byref(schema))
+assert (table["rinchi_string"] == [rinchi.rinchi_string_from_file_text("RXN", rxndata), None, rinchi.rinchi_string_from_file_text("RXN", rxndata)])
+assert (table["short_key"] == [rinchi.rinchikey_from_file_text("RXN", rxndata, "S"), None, rinchi.rinchikey_from_file_text("RXN", rxndata, "S")])
+assert (table["error"][0] is None and table["error"][1] and table["error"][2] is None)
+assert (table["status"] == [0, 1, 0])
+try:
+    import pyarrow
+    batch = rinchi.all_from_file_texts_arrow("RXN", [rxndata, "no reaction"])
+    assert (batch.column_names == ["rinchi_string", "rinchi_auxinfo", "long_key", "short_key", "web_key", "error", "status"])
+    assert (batch.column("long_key").to_pylist() == [rinchi.rinchikey_from_file_text("RXN", rxndata, "L"), None])
+except ImportError:
+    pass
 print ("===========")
 
 # rddata = open("/home/jhje/RInChI/src/test/RDfiles/Example 01 CCR.rdf").readlines()
@@ -177,6 +231,50 @@ except Exception as e:
 else:
 	assert False, "No error raised as expected, reading InChI input text."
 
+#   Precomputed InChIKeys are used for the RInChI keys.
+rinchi.set_inchi_key_check(0)
+assert (rinchi.rinchikey_from_inchis("""InChI=1S/C4H9BrO/c1-3(5)4(2)6/h3-4,6H,1-2H3/t3-,4+/m1/s1
+InChIKey=JCYSVJNMXBWPHS-DMTCNVIQSA-N
+InChI=1S/Na.H2O/h;1H2/q+1;/p-1
+InChIKey=HEMHJVSKTPXQMS-UHFFFAOYSA-M""", """InChI=1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1
+InChIKey=PQXKWPLDPFFDJP-WUCPZUCCSA-N""", "", "L") ==
+    "Long-RInChIKey=SA-BUHFF-PQXKWPLDPFFDJP-WUCPZUCCSA-N--JCYSVJNMXBWPHS-DMTCNVIQSA-N-HEMHJVSKTPXQMS-UHFFFAOYSA-M")
+#   Spot checks are spread over the calls: with an interval of 2, every other call checks its one key.
+rinchi.set_inchi_key_check(2)
+for call in range(4):
+    try:
+        rinchi.rinchikey_from_inchis("", """InChI=1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1
+InChIKey=PQXKWPLDPFFDJP-UHFFFAOYSA-N""", "", "L")
+    except Exception as e:
+        assert call % 2 == 0 and "does not match InChI string" in str(e), str(e)
+    else:
+        assert call % 2 == 1, "Key of call %d not checked." % (call + 1)
+rinchi.set_inchi_key_check(1)
+
+# Reactions from in-memory atom and bond lists give the same results as their RXN file.
+print ("=== RInChI from structures ===")
+with rinchi.reaction() as reaction:
+    reaction.add_reactant(
+        ["C", "C", "C", "C", "O", "Br"],
+        [(0, 1, 1), (1, 2, 1), (2, 3, 1), (1, 4, 1, reaction.BOND_STEREO_DOWN), (2, 5, 1, reaction.BOND_STEREO_UP)],
+        coordinates = [(-0.825, -0.7557, 0), (-0.4125, -0.0412, 0), (0.4125, -0.0412, 0), (0.825, 0.6733, 0), (-0.626, 0.7557, 0), (0.825, -0.7557, 0)])
+    reaction.add_reactant(["Na", "O"], [(0, 1, 1)], coordinates = [(-0.4125, 0, 0), (0.4125, 0, 0)])
+    reaction.add_product(
+        ["C", "C", "C", "C", "O"],
+        [(0, 1, 1, reaction.BOND_STEREO_DOWN), (1, 2, 1), (2, 3, 1, reaction.BOND_STEREO_UP), (1, 4, 1), (2, 4, 1)],
+        coordinates = [(-1.127, -0.5635, 0), (-0.4125, -0.151, 0), (0.4125, -0.151, 0), (1.127, -0.5635, 0), (0, 0.5635, 0)])
+    assert (reaction.rinchi() == rinchi.rinchi_from_file_text("RXN", rxndata))
+    assert (reaction.rinchikey("L") == rinchi.rinchikey_from_file_text("RXN", rxndata, "L"))
+    # A rejected structure leaves the reaction unchanged.
+    try:
+        reaction.add_agent(["C", "C"], [(0, 2, 1)])
+    except Exception as e:
+        assert (str(e).startswith("rinchi::RInChIError: Bond 1: "))
+    else:
+        assert False, "No error raised as expected, adding a bond to a missing atom."
+    assert (reaction.rinchi() == rinchi.rinchi_from_file_text("RXN", rxndata))
+    reaction.add_agent([])
+    assert (reaction.rinchi()[0].endswith("/d-/u0-0-1"))
 
 # RInChI => RInChI keys.
 print ("=== RInChI keys from RInChI ===")
@@ -187,3 +285,79 @@ assert (rinchi.rinchikey_from_rinchi(rinchi_nostructs, "S") ==
 assert (rinchi.rinchikey_from_rinchi(rinchi_nostructs, "W") ==
     "Web-RInChIKey=BAUCRGUJNIZBSVGHT-MCQMHLCOYUUCESA")
 
+# Results copied to caller buffers (the *_buf() functions), called through ctypes as the wrapper does not use them.
+print ("=== Result buffers ===")
+class Buffer(ctypes.Structure):
+    _fields_ = [("data", ctypes.c_void_p), ("capacity", ctypes.c_size_t), ("length", ctypes.c_size_t)]
+RETURN_CODE_BUFFER_TOO_SMALL = 2
+def buffer_text(buffer):
+    return ctypes.string_at(buffer.data, buffer.length).decode('utf-8')
+
+#   Too small: the required length is reported and nothing is copied.
+expected = rinchi.rinchi_string_from_file_text("RXN", rxndata)
+memory = ctypes.create_string_buffer(b"untouched", 10)
+small = Buffer(ctypes.cast(memory, ctypes.c_void_p), 10, 0)
+assert (rinchi.lib_handle.rinchilib_rinchi_string_from_file_text_buf(b"RXN", rxndata.encode('utf-8'), False, ctypes.byref(small)) == RETURN_CODE_BUFFER_TOO_SMALL)
+assert (small.length == len(expected) and memory.value == b"untouched")
+memory = ctypes.create_string_buffer(small.length + 1)
+large = Buffer(ctypes.cast(memory, ctypes.c_void_p), len(memory), 0)
+assert (rinchi.lib_handle.rinchilib_rinchi_string_from_file_text_buf(b"RXN", rxndata.encode('utf-8'), False, ctypes.byref(large)) == 0)
+assert (buffer_text(large) == expected and memory.value.decode('utf-8') == expected)
+
+#   Without 'data' the results are put in blocks from the allocator.
+blocks = []
+def allocate(size, context):
+    blocks.append(ctypes.create_string_buffer(size))
+    context[0] += 1
+    return ctypes.addressof(blocks[-1])
+allocator = ctypes.CFUNCTYPE(ctypes.c_void_p, ctypes.c_size_t, ctypes.POINTER(ctypes.c_int))(allocate)
+allocations = ctypes.c_int(0)
+assert (rinchi.lib_handle.rinchilib_set_allocator(allocator, ctypes.byref(allocations)) == 0)
+inchis = ["InChI=1S/Na.H2O/h;1H2/q+1;/p-1", "InChI=1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1", ""]
+key = Buffer()
+assert (rinchi.lib_handle.rinchilib_rinchikey_from_inchis_buf(*[inchi.encode('utf-8') for inchi in inchis], b"S", ctypes.byref(key)) == 0)
+assert (buffer_text(key) == rinchi.rinchikey_from_inchis(*inchis, "S") and key.capacity == key.length + 1)
+with rinchi.reaction() as reaction:
+    reaction.add_reactant(["Na", "O"], [(0, 1, 1)], coordinates = [(-0.4125, 0, 0), (0.4125, 0, 0)])
+    rinchi_string, rinchi_auxinfo = Buffer(), Buffer()
+    assert (rinchi.lib_handle.rinchilib_reaction_rinchi_buf(reaction.handle, ctypes.byref(rinchi_string), ctypes.byref(rinchi_auxinfo)) == 0)
+    assert ([buffer_text(rinchi_string), buffer_text(rinchi_auxinfo)] == reaction.rinchi())
+    key = Buffer()
+    assert (rinchi.lib_handle.rinchilib_reaction_rinchikey_buf(reaction.handle, b"W", ctypes.byref(key)) == 0)
+    assert (buffer_text(key) == reaction.rinchikey("W"))
+assert (allocations.value == 4 and len(blocks) == 4)
+#   A failing allocator leaves 'data' NULL and reports the size required.
+failing_allocator = ctypes.CFUNCTYPE(ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p)(lambda size, context: None)
+assert (rinchi.lib_handle.rinchilib_set_allocator(failing_allocator, None) == 0)
+unallocated = Buffer()
+assert (rinchi.lib_handle.rinchilib_rinchi_string_from_file_text_buf(b"RXN", rxndata.encode('utf-8'), False, ctypes.byref(unallocated)) == RETURN_CODE_BUFFER_TOO_SMALL)
+assert (unallocated.length == len(expected) and not unallocated.data)
+rinchi.lib_handle.rinchilib_set_allocator(None, None)
+unallocated = Buffer()
+assert (rinchi.lib_handle.rinchilib_rinchi_string_from_file_text_buf(b"RXN", rxndata.encode('utf-8'), False, ctypes.byref(unallocated)) == RETURN_CODE_BUFFER_TOO_SMALL)
+assert (unallocated.length == len(expected) and not unallocated.data)
+
+# Result cache: texts differing only in line endings or header lines share an entry.
+print ("=== Result cache ===")
+rinchi.set_result_cache(100)
+expected = rinchi.rinchi_from_file_text("RXN", rxndata)
+rxnlines = rxndata.split("\n")
+rxnlines[2] = "  Some other program  0101260000"
+assert (rinchi.rinchi_from_file_text("RXN", "\r\n".join(rxnlines)) == expected)
+rinchi.rinchikey_from_file_text("RXN", rxndata, "L")
+stats = rinchi.result_cache_stats()
+assert (stats["hits"] == 2 and stats["misses"] == 1 and stats["entries"] == 1)
+rinchi.set_result_cache(0)
+rinchi.clear_result_cache()
+
+# InChI cache file: the second calculation takes the component InChIs from the file.
+print ("=== InChI cache file ===")
+cache_file = os.path.join(tempfile.mkdtemp(), "inchi.cache")
+rinchi.set_inchi_cache_file(cache_file)
+expected = rinchi.rinchi_from_file_text("RXN", rxndata)
+misses = rinchi.inchi_cache_stats()["misses"]
+assert (rinchi.rinchi_from_file_text("RXN", rxndata) == expected)
+stats = rinchi.inchi_cache_stats()
+assert (stats["misses"] == misses and stats["hits"] >= misses and 0 < stats["entries"] <= misses)
+rinchi.set_inchi_cache_file(None)
+os.remove(cache_file)
@@ -37,11 +37,21 @@
 #pragma endregion
 #endif
 
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include "rinchi_platform.h"
 #include "rinchi_utils.h"
+#include "rinchi_parallel.h"
 #include "rinchi_ora_cartridge.h"
 
 #include "rinchi_reaction.h"
@@ -74,13 +84,11 @@
 	#define API_EXPORT
 #endif
 
-// Holds the part of input that is larger than MAX_PLSQL_VARCHAR2_LEN which is usually 32k.
-std::stringstream cpp_input_buffer;
-// Holds latest error message in case a C++ exception is thrown in an exported function.
-std::string cpp_error_message;
-
-#define BEGIN_EXCP_CODE try { cpp_error_message.clear();
-#define END_EXCP_CODE return RETURN_CODE_SUCCESS; } catch (std::exception& e) { cpp_error_message = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what(); return RETURN_CODE_ERROR; } 
+// Exported functions that take a session handle start with BEGIN_EXCP_CODE(session_handle), which locks the session
+// as 'session'. A call with an unknown handle fails, with the message from rinorca_latest_err_msg() for that handle.
+#define BEGIN_EXCP_CODE(handle) SessionAccess session (handle); if (!session.valid()) return RETURN_CODE_ERROR; try { session->error_message.clear();
+#define CATCH_EXCP_CODE } catch (std::exception& e) { session->error_message = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what(); return RETURN_CODE_ERROR; }
+#define END_EXCP_CODE return RETURN_CODE_SUCCESS; CATCH_EXCP_CODE
 
 const char* RINCHI_INPUT_FORMAT_RDFILE = "RD";
 const char* RINCHI_INPUT_FORMAT_RXNFILE = "RXN";
@@ -88,9 +96,118 @@ const char* RINCHI_INPUT_FORMAT_AUTO = "AUTO";
 
 namespace {
 
-	void load_reaction(const char* input_format, const char* in_file_text, rinchi::Reaction& rxn) {
-		std::stringstream file_text_stream (in_file_text);
+	const char* INVALID_SESSION_MESSAGE = "rinchi::RInChIError: Invalid cartridge session handle.";
+
+	// Sessions that have not been used for this long are dropped when a new one is opened.
+	const std::chrono::hours SESSION_IDLE_TIMEOUT (1);
+
+	/**
+	  The state of a database session in the cartridge, kept between the calls that make up a
+	  chunked transfer. A multithreaded extproc agent serves many sessions concurrently; each
+	  session's calls come one at a time.
+
+	  The session lock only covers the session's own state. What the calls of different sessions
+	  share lives in the RInChI library, which is safe to use from several threads at once:
+	  InChIKeys are generated in buffers of each call (InChIGenerator::inchi_string2key()), and
+	  the one generator handle of the InChI library is created and used under a lock of its own
+	  in inchi_generator.cpp. Reactions and readers are local to a call.
+	**/
+	struct Session {
+		std::mutex mutex;
+		// Holds the part of input that is larger than MAX_PLSQL_VARCHAR2_LEN which is usually 32k, as the chunks passed to
+		// rinorca_set_input_chunk(). The readers read them in place, followed by the final part of the input.
+		std::vector<std::string> input_chunks;
+		// True if the session was dropped while idle and recreated; chunks passed before then are gone.
+		bool input_lost;
+		// Holds an output that is larger than the Oracle-supplied character buffer, and the position of the part
+		// that rinorca_get_output_chunk() returns next.
+		std::string output_buffer;
+		size_t output_pos;
+		// Holds latest error message in case a C++ exception is thrown in an exported function.
+		std::string error_message;
+		// In steady_clock ticks; read without the session lock when dropping idle sessions.
+		std::atomic<std::chrono::steady_clock::rep> last_used;
+
+		Session(bool recreated): input_lost(recreated), output_pos(0), last_used(std::chrono::steady_clock::now().time_since_epoch().count()) {}
+	};
+
+	// Handles start at a random point, so that the handles the database sessions kept from an extproc
+	// agent that was restarted are unlikely to be handed out again by the new one.
+	int first_session_handle()
+	{
+		std::random_device random;
+		return (int) (random() % (INT_MAX / 2));
+	}
 
+	std::mutex sessions_mutex;
+	// Sessions dropped for being idle keep an empty entry; closed ones have none.
+	std::map< int, std::shared_ptr<Session> > sessions;
+	int last_session_handle = first_session_handle();
+
+	/**
+	  Locks the session of a handle for the duration of a call. The session of a handle that was
+	  dropped for being idle is recreated, empty; closed handles and handles that were never
+	  opened are invalid.
+	**/
+	class SessionAccess {
+		public:
+			explicit SessionAccess(int handle)
+			{
+				{
+					std::lock_guard<std::mutex> sessions_lock (sessions_mutex);
+					std::map< int, std::shared_ptr<Session> >::iterator session = sessions.find(handle);
+					if (session == sessions.end())
+						return;
+					if (!session->second)
+						session->second.reset(new Session(true));
+					m_session = session->second;
+				}
+				m_lock = std::unique_lock<std::mutex>(m_session->mutex);
+				m_session->last_used = std::chrono::steady_clock::now().time_since_epoch().count();
+			}
+
+			bool valid() const { return (bool) m_session; }
+			Session* operator->() const { return m_session.get(); }
+			Session& operator*() const { return *m_session; }
+
+		private:
+			std::shared_ptr<Session> m_session;
+			std::unique_lock<std::mutex> m_lock;
+	};
+
+	/**
+	  The input of a call: the chunks passed to rinorca_set_input_chunk() followed by 'last_chunk', or only
+	  'last_chunk' if 'append_to_buffer' is 0. Nothing is copied; 'last_chunk' is not kept after the call,
+	  and the chunks are dropped when the stream is.
+	**/
+	class InputStream: public std::istream {
+		public:
+			InputStream(Session& session, int append_to_buffer, const char* last_chunk): std::istream(NULL), m_session(session)
+			{
+				if (append_to_buffer == 0) {
+					session.input_chunks.clear();
+					session.input_lost = false;
+				}
+				else if (session.input_lost)
+					throw rinchi::RInChIError("Cartridge session expired during input transfer.");
+
+				for (std::vector<std::string>::const_iterator chunk = session.input_chunks.begin(); chunk != session.input_chunks.end(); chunk++)
+					m_buffer.add_chunk(chunk->data(), chunk->length());
+				m_buffer.add_chunk(last_chunk, strlen(last_chunk));
+				rdbuf(&m_buffer);
+			}
+
+			~InputStream()
+			{
+				std::vector<std::string>().swap(m_session.input_chunks);
+			}
+
+		private:
+			Session& m_session;
+			rinchi::ChunkListStreamBuffer m_buffer;
+	};
+
+	void load_reaction(const char* input_format, std::istream& file_text_stream, rinchi::Reaction& rxn) {
 		std::string file_format = input_format;
 		if (file_format.empty() || file_format == RINCHI_INPUT_FORMAT_AUTO) {
 			std::ios::pos_type saved_stream_pos = file_text_stream.tellg();
@@ -116,6 +233,16 @@ namespace {
 			throw rinchi::RInChIError(std::string("Unsupported input file format '") + file_format + "'.");
 	}
 
+	// Reads a line up to a linefeed, without a trailing carriage return.
+	std::string read_input_line(std::istream& input)
+	{
+		std::string line;
+		std::getline(input, line);
+		if (!line.empty() && line.at(line.length() - 1) == '\r')
+			line.erase(line.length() - 1);
+		return line;
+	}
+
 	std::string calculate_key(rinchi::Reaction& rxn, const char* key_type)
 	{
 		char key_selector = *key_type;
@@ -134,137 +261,319 @@ namespace {
 		// TODO: Add check that 'key_type' is only one character long.
 	}
 
-}
+	std::string rinchi_from_file(std::istream& input, const char* input_format, int include_auxinfo, unsigned max_inchi_threads)
+	{
+		rinchi::Reaction rxn;
+		rxn.set_omit_auxinfo(include_auxinfo == 0);
+		rxn.set_max_inchi_threads(max_inchi_threads);
+		load_reaction(input_format, input, rxn);
 
-inline void reset_stream(std::stringstream& s)
-{
-	s.str("");
-	s.clear();
-}
+		std::string result = rxn.rinchi_string();
+		if (include_auxinfo != 0)
+			result += '\n' + rxn.rinchi_auxinfo();
+		return result;
+	}
+
+	std::string rinchikey_from_file(std::istream& input, const char* input_format, const char* key_type, unsigned max_inchi_threads)
+	{
+		rinchi::Reaction rxn;
+		// Keys do not depend on AuxInfo.
+		rxn.set_omit_auxinfo(true);
+		rxn.set_max_inchi_threads(max_inchi_threads);
+		load_reaction(input_format, input, rxn);
+
+		return calculate_key(rxn, key_type);
+	}
+
+	std::string rinchikey_from_rinchi(std::istream& input, const char* key_type)
+	{
+		rinchi::Reaction rxn;
+		rinchi::RInChIReader reader;
+		// Anything after the first line (like RAuxInfo) is ignored.
+		reader.split_into_reaction(read_input_line(input), "", rxn);
+
+		return calculate_key(rxn, key_type);
+	}
+
+	// Splits the input of a *_bulk() function into its items. There is always at least one, maybe empty.
+	// A separator after the last item ends that item; it does not start an empty one.
+	std::vector<std::string> read_bulk_items(std::istream& input)
+	{
+		std::vector<std::string> items;
+		do {
+			items.push_back(std::string());
+			std::getline(input, items.back(), RINORCA_BULK_SEPARATOR);
+		} while (!input.eof());
+		if (items.size() > 1 && items.back().empty())
+			items.pop_back();
+		return items;
+	}
+
+	/**
+	  Calls 'calculate' on an input stream over each of 'items', on up to 'max_threads' threads (0: one per
+	  processor), and returns the output of a *_bulk() function: for each item its status code as a digit,
+	  followed by its result or its error message, separated by RINORCA_BULK_SEPARATOR.
+	**/
+	template <typename Calculate> std::string calculate_bulk(const std::vector<std::string>& items, int max_threads, Calculate calculate)
+	{
+		std::vector<std::string> results(items.size());
+		std::vector<char> failed(items.size(), 0);
+		auto calculate_item = [&](size_t idx) {
+			try {
+				rinchi::MemoryStreamBuffer buffer (items[idx].data(), items[idx].length());
+				std::istream input (&buffer);
+				results[idx] = calculate(input);
+			}
+			catch (std::exception& e) {
+				failed[idx] = 1;
+				results[idx] = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what();
+			}
+		};
+
+		rinchi::parallel_for(items.size(), max_threads > 0 ? max_threads : 0, calculate_item);
+
+		size_t output_length = 0;
+		for (size_t idx = 0; idx < results.size(); idx++)
+			output_length += results[idx].length() + 2;
+		std::string output;
+		output.reserve(output_length);
+		for (size_t idx = 0; idx < results.size(); idx++) {
+			if (idx > 0)
+				output += RINORCA_BULK_SEPARATOR;
+			output += (char) ('0' + (failed[idx] ? RETURN_CODE_ERROR : RETURN_CODE_SUCCESS));
+			output += results[idx];
+		}
+		return output;
+	}
+
+	/**
+	  Copies the next part of the pending output into the Oracle-supplied character buffer, as much as fits
+	  without splitting a UTF-8 character. Returns RETURN_CODE_MORE_OUTPUT if a part remains.
+	**/
+	int copy_output_chunk(Session& session, char* out_data, int* out_data_maxlen)
+	{
+		if (*out_data_maxlen <= 0)
+			throw rinchi::RInChIError("Oracle-supplied character buffer has no room for output.");
+
+		size_t length = session.output_buffer.length() - session.output_pos;
+		if (length > (size_t) *out_data_maxlen) {
+			length = *out_data_maxlen;
+			while (length > 0 && (session.output_buffer[session.output_pos + length] & 0xC0) == 0x80)
+				length--;
+			if (length == 0)
+				throw rinchi::RInChIError("Oracle-supplied character buffer is too small for a single character of output.");
+		}
+
+		memcpy(out_data, session.output_buffer.data() + session.output_pos, length);
+		out_data[length] = 0; // Necessary, or Oracle will complain about a length mismatch problem.
+		session.output_pos += length;
+		if (session.output_pos < session.output_buffer.length())
+			return RETURN_CODE_MORE_OUTPUT;
+
+		std::string().swap(session.output_buffer);
+		session.output_pos = 0;
+		return RETURN_CODE_SUCCESS;
+	}
+
+	// Makes 'result' the pending output (taking its contents) and copies its first part to 'out_data'.
+	int set_output(Session& session, std::string& result, char* out_data, int* out_data_maxlen)
+	{
+		session.output_buffer.swap(result);
+		session.output_pos = 0;
+		return copy_output_chunk(session, out_data, out_data_maxlen);
+	}
 
-inline void copy_result_to_oracharbuf(const char* result, char* charbuf, int* charbuf_maxlen)
-{
-	// This produces a warning in MSVC that can be safely ignored
-	// to the extent that we trust the maxlen that comes from Oracle.
-#pragma warning(push)
-#pragma warning(disable: 4996) // "'strncpy': This function or variable may be unsafe. Consider using strncpy_s instead."
-	strncpy(charbuf, result, *charbuf_maxlen);
-	charbuf[*charbuf_maxlen] = 0; // Necessary, or Oracle will complain about a length mismatch problem.
-#pragma warning(pop)
 }
 
 extern "C" {
 
-	API_EXPORT const char* rinorca_latest_err_msg()
+	API_EXPORT int rinorca_open_session()
+	{
+		std::lock_guard<std::mutex> sessions_lock (sessions_mutex);
+		// Drop idle sessions whose database sessions have probably ended without closing them.
+		std::chrono::steady_clock::rep idle_since = (std::chrono::steady_clock::now() - SESSION_IDLE_TIMEOUT).time_since_epoch().count();
+		for (std::map< int, std::shared_ptr<Session> >::iterator session = sessions.begin(); session != sessions.end(); session++) {
+			if (session->second && session->second->last_used < idle_since)
+				session->second.reset();
+		}
+
+		if (last_session_handle == INT_MAX)
+			return 0;
+		sessions[++last_session_handle].reset(new Session(false));
+		return last_session_handle;
+	}
+
+	API_EXPORT void rinorca_close_session(int session_handle)
 	{
-		return cpp_error_message.c_str();
+		std::lock_guard<std::mutex> sessions_lock (sessions_mutex);
+		sessions.erase(session_handle);
 	}
 
-	API_EXPORT const char* rinorca_debug_input_buffer()
+	API_EXPORT const char* rinorca_latest_err_msg(int session_handle)
 	{
-		cpp_error_message = cpp_input_buffer.str();
-		return cpp_error_message.c_str();
+		SessionAccess session (session_handle);
+		if (!session.valid())
+			return INVALID_SESSION_MESSAGE;
+		return session->error_message.c_str();
+	}
+
+	API_EXPORT const char* rinorca_debug_input_buffer(int session_handle)
+	{
+		SessionAccess session (session_handle);
+		if (!session.valid())
+			return INVALID_SESSION_MESSAGE;
+
+		session->error_message.clear();
+		for (std::vector<std::string>::const_iterator chunk = session->input_chunks.begin(); chunk != session->input_chunks.end(); chunk++)
+			session->error_message += *chunk;
+		return session->error_message.c_str();
 	}
 
 	API_EXPORT int rinorca_set_input_chunk(
-		int append_to_buffer, const char* chunk
+		int session_handle, int append_to_buffer, const char* chunk
 	)
 	{
-		BEGIN_EXCP_CODE
-		if (append_to_buffer == 0)
-			reset_stream(cpp_input_buffer);
+		BEGIN_EXCP_CODE(session_handle)
+		if (append_to_buffer == 0) {
+			session->input_chunks.clear();
+			session->input_lost = false;
+		}
+		else if (session->input_lost)
+			throw rinchi::RInChIError("Cartridge session expired during input transfer.");
 
-		cpp_input_buffer << chunk;
+		session->input_chunks.push_back(chunk);
 		END_EXCP_CODE 
 	}
 
-	API_EXPORT int rinorca_rinchi_from_file(
-		int append_to_buffer, const char* input_file, const char* input_format, int include_auxinfo, char* out_data, int* out_data_maxlen
+	API_EXPORT int rinorca_get_output_chunk(
+		int session_handle, char* out_data, int* out_data_maxlen
 	)
 	{
-		BEGIN_EXCP_CODE
-		if (append_to_buffer == 0)
-			reset_stream(cpp_input_buffer);
+		BEGIN_EXCP_CODE(session_handle)
+		if (session->output_buffer.empty())
+			throw rinchi::RInChIError("No pending output.");
 
-		cpp_input_buffer << input_file;
-
-		rinchi::Reaction rxn;
-		load_reaction(input_format, cpp_input_buffer.str().c_str(), rxn);
-
-		std::string result = rxn.rinchi_string();
-		if (include_auxinfo != 0)
-			result += '\n' + rxn.rinchi_auxinfo();
-		if ((int) result.length() > *out_data_maxlen)
-			throw std::runtime_error("RInChI output length exceeds max. length of Oracle-supplied character buffer.");
+		return copy_output_chunk(*session, out_data, out_data_maxlen);
+		CATCH_EXCP_CODE
+	}
 
-		copy_result_to_oracharbuf(result.c_str(), out_data, out_data_maxlen);
-		END_EXCP_CODE 
+	API_EXPORT int rinorca_rinchi_from_file(
+		int session_handle, int append_to_buffer, const char* input_file, const char* input_format, int include_auxinfo, char* out_data, int* out_data_maxlen
+	)
+	{
+		BEGIN_EXCP_CODE(session_handle)
+		InputStream input(*session, append_to_buffer, input_file);
+		std::string result = rinchi_from_file(input, input_format, include_auxinfo, 0);
+		return set_output(*session, result, out_data, out_data_maxlen);
+		CATCH_EXCP_CODE
 	}
 
 	API_EXPORT int rinorca_rinchikey_from_file(
-		int append_to_buffer, const char* input_file, const char* input_format, const char* key_type, char* out_data, int* out_data_maxlen
+		int session_handle, int append_to_buffer, const char* input_file, const char* input_format, const char* key_type, char* out_data, int* out_data_maxlen
 	)
 	{
-		BEGIN_EXCP_CODE
-		if (append_to_buffer == 0)
-			reset_stream(cpp_input_buffer);
-
-		cpp_input_buffer << input_file;
-
-		rinchi::Reaction rxn;
-		load_reaction(input_format, cpp_input_buffer.str().c_str(), rxn);
-
-		std::string result = calculate_key(rxn, key_type);
-		if ((int) result.length() > *out_data_maxlen)
-			throw std::runtime_error("RInChI key output length exceeds max. length of Oracle-supplied character buffer.");
-
-		copy_result_to_oracharbuf(result.c_str(), out_data, out_data_maxlen);
-		END_EXCP_CODE
+		BEGIN_EXCP_CODE(session_handle)
+		InputStream input(*session, append_to_buffer, input_file);
+		std::string result = rinchikey_from_file(input, input_format, key_type, 0);
+		return set_output(*session, result, out_data, out_data_maxlen);
+		CATCH_EXCP_CODE
 	}
 
-	API_EXPORT int rinorca_rinchikey_from_rinchi(
-		int append_to_buffer, const char* rinchi_string, const char* key_type, char* out_data, int* out_data_maxlen
+	API_EXPORT int rinorca_all_from_file(
+		int session_handle, int append_to_buffer, const char* input_file, const char* input_format, int output_mask, char* out_data, int* out_data_maxlen
 	)
 	{
-		BEGIN_EXCP_CODE
-		if (append_to_buffer == 0)
-			reset_stream(cpp_input_buffer);
+		BEGIN_EXCP_CODE(session_handle)
+		InputStream input(*session, append_to_buffer, input_file);
 
-		cpp_input_buffer << rinchi_string;
+		if (output_mask <= 0 || (output_mask & ~RINCHI_OUTPUT_ALL) != 0)
+			throw rinchi::RInChIError("Invalid output selection. Output mask must be a combination of the OUTPUT_* values.");
 
 		rinchi::Reaction rxn;
-		rinchi::RInChIReader reader;
+		rxn.set_omit_auxinfo((output_mask & RINCHI_OUTPUT_RAUXINFO) == 0);
+		load_reaction(input_format, input, rxn);
+
+		// The selected outputs, separated by linefeeds, in the order of the RINCHI_OUTPUT_* values.
+		std::string result;
+		if (output_mask & RINCHI_OUTPUT_RINCHI_STRING)
+			result += rxn.rinchi_string() + '\n';
+		if (output_mask & RINCHI_OUTPUT_RAUXINFO)
+			result += rxn.rinchi_auxinfo() + '\n';
+		if (output_mask & RINCHI_OUTPUT_LONG_KEY)
+			result += rxn.rinchi_long_key() + '\n';
+		if (output_mask & RINCHI_OUTPUT_SHORT_KEY)
+			result += rxn.rinchi_short_key() + '\n';
+		if (output_mask & RINCHI_OUTPUT_WEB_KEY)
+			result += rxn.rinchi_web_key() + '\n';
+		result.erase(result.length() - 1);
+
+		return set_output(*session, result, out_data, out_data_maxlen);
+		CATCH_EXCP_CODE
+	}
 
-		std::string rinchi_input = cpp_input_buffer.str();
-		size_t lf_pos = rinchi_input.find('\n');
-		if (lf_pos != std::string::npos)
-			rinchi_input.erase(lf_pos);
-		if (!rinchi_input.empty() && rinchi_input.at(rinchi_input.length() - 1) == '\r')
-			rinchi_input.erase(rinchi_input.length() - 1);
+	API_EXPORT int rinorca_rinchikey_from_rinchi(
+		int session_handle, int append_to_buffer, const char* rinchi_string, const char* key_type, char* out_data, int* out_data_maxlen
+	)
+	{
+		BEGIN_EXCP_CODE(session_handle)
+		InputStream input(*session, append_to_buffer, rinchi_string);
+		std::string result = rinchikey_from_rinchi(input, key_type);
+		return set_output(*session, result, out_data, out_data_maxlen);
+		CATCH_EXCP_CODE
+	}
 
-		reader.split_into_reaction(rinchi_input, "", rxn);
+	API_EXPORT int rinorca_rinchi_from_file_bulk(
+		int session_handle, int append_to_buffer, const char* input_files, const char* input_format, int include_auxinfo, int max_threads, char* out_data, int* out_data_maxlen
+	)
+	{
+		BEGIN_EXCP_CODE(session_handle)
+		InputStream input(*session, append_to_buffer, input_files);
+		std::string result = calculate_bulk(read_bulk_items(input), max_threads, [&](std::istream& item) {
+			return rinchi_from_file(item, input_format, include_auxinfo, 1);
+		});
+		return set_output(*session, result, out_data, out_data_maxlen);
+		CATCH_EXCP_CODE
+	}
 
-		std::string result = calculate_key(rxn, key_type);
-		if ((int) result.length() > *out_data_maxlen)
-			throw std::runtime_error("RInChI key output length exceeds max. length of Oracle-supplied character buffer.");
+	API_EXPORT int rinorca_rinchikey_from_file_bulk(
+		int session_handle, int append_to_buffer, const char* input_files, const char* input_format, const char* key_type, int max_threads, char* out_data, int* out_data_maxlen
+	)
+	{
+		BEGIN_EXCP_CODE(session_handle)
+		InputStream input(*session, append_to_buffer, input_files);
+		std::string result = calculate_bulk(read_bulk_items(input), max_threads, [&](std::istream& item) {
+			return rinchikey_from_file(item, input_format, key_type, 1);
+		});
+		return set_output(*session, result, out_data, out_data_maxlen);
+		CATCH_EXCP_CODE
+	}
 
-		copy_result_to_oracharbuf(result.c_str(), out_data, out_data_maxlen);
-		END_EXCP_CODE
+	API_EXPORT int rinorca_rinchikey_from_rinchi_bulk(
+		int session_handle, int append_to_buffer, const char* rinchi_strings, const char* key_type, int max_threads, char* out_data, int* out_data_maxlen
+	)
+	{
+		BEGIN_EXCP_CODE(session_handle)
+		InputStream input(*session, append_to_buffer, rinchi_strings);
+		std::string result = calculate_bulk(read_bulk_items(input), max_threads, [&](std::istream& item) {
+			return rinchikey_from_rinchi(item, key_type);
+		});
+		return set_output(*session, result, out_data, out_data_maxlen);
+		CATCH_EXCP_CODE
 	}
 
 	API_EXPORT int rinorca_file_from_rinchi(
-		const char* rinchi_string, const char* rinchi_auxinfo, const char* output_format, char* out_data, int* out_data_maxlen
+		int session_handle, int append_to_buffer, const char* rinchi_input, const char* output_format, char* out_data, int* out_data_maxlen
 	)
 	{
-		BEGIN_EXCP_CODE
-		std::string the_rauxinfo = rinchi_auxinfo;
-		// PL/SQL package will indicate a blank RAuxInfo field by passing a single space (to avoid NULLs).
-		if (the_rauxinfo == " ")
-			the_rauxinfo.clear();
+		BEGIN_EXCP_CODE(session_handle)
+		// The RInChI string, optionally followed by a linefeed and the RAuxInfo.
+		InputStream input(*session, append_to_buffer, rinchi_input);
+		std::string the_rinchi_string = read_input_line(input);
+		std::string the_rauxinfo = read_input_line(input);
 
 		rinchi::Reaction rxn;
 		rinchi::RInChIReader reader;
-		reader.split_into_reaction(rinchi_string, the_rauxinfo, rxn);
+		reader.split_into_reaction(the_rinchi_string, the_rauxinfo, rxn);
 
 		std::ostringstream file_text_stream;
 		if (strcmp(output_format, RINCHI_INPUT_FORMAT_RDFILE) == 0) {
@@ -278,11 +587,9 @@ extern "C" {
 		else
 			throw rinchi::RInChIError(std::string("Unsupported output file format '") + output_format + "'.");
 
-		if ((int) file_text_stream.str().length() > *out_data_maxlen)
-			throw std::runtime_error(std::string("Reaction file in '") + output_format + "' format has a length that exceeds max. length of Oracle-supplied character buffer.");
-
-		copy_result_to_oracharbuf(file_text_stream.str().c_str(), out_data, out_data_maxlen);
-		END_EXCP_CODE 
+		std::string result = file_text_stream.str();
+		return set_output(*session, result, out_data, out_data_maxlen);
+		CATCH_EXCP_CODE
 	}
 
 }
@@ -41,5 +41,71 @@
 
 #define RETURN_CODE_SUCCESS 0
 #define RETURN_CODE_ERROR 1
+// The output did not fit into the Oracle-supplied character buffer; fetch the rest with rinorca_get_output_chunk().
+#define RETURN_CODE_MORE_OUTPUT 2
 
-// TODO: Add function prototypes here. Not necessary in order to build prototype.
+// Output selectors for rinorca_all_from_file(); they can be combined.
+#define RINCHI_OUTPUT_RINCHI_STRING 1
+#define RINCHI_OUTPUT_RAUXINFO 2
+#define RINCHI_OUTPUT_LONG_KEY 4
+#define RINCHI_OUTPUT_SHORT_KEY 8
+#define RINCHI_OUTPUT_WEB_KEY 16
+#define RINCHI_OUTPUT_ALL 31
+
+// Separates the items in the inputs and outputs of the *_bulk() functions (ASCII record separator).
+#define RINORCA_BULK_SEPARATOR '\x1E'
+
+/**
+  Functions called by the PL/SQL package 'rinorca'. Each database session opens a session in the
+  cartridge with rinorca_open_session() and passes its handle to all other functions, so that one
+  multithreaded extproc agent can serve many database sessions concurrently: calls with different
+  handles may run at once, calls with the same handle run one at a time. Sessions that stay
+  unused for an hour may be dropped; the next call with their handle starts them anew. Calls with
+  a closed handle, or one the extproc agent does not know (e.g. after a restart), fail with
+  "Invalid cartridge session handle.".
+
+  Inputs longer than a PL/SQL varchar2 are passed
+  in chunks: all but the last through rinorca_set_input_chunk(), the last as the input parameter
+  with 'append_to_buffer' <> 0. Outputs longer than '*out_data_maxlen' are returned in chunks: the
+  function returns RETURN_CODE_MORE_OUTPUT and the rest comes from rinorca_get_output_chunk().
+
+  The *_bulk() functions take items that are each followed by RINORCA_BULK_SEPARATOR, which may be
+  left out after the last one, and calculate them on up to 'max_threads' threads (0: one per
+  processor). An empty last item must be followed by the separator. Their output has an item per input item, in order:
+  its status code as a digit ('0' or '1'), then its result or error message. A failing item does
+  not make the call fail.
+**/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Returns the handle of a new session, or 0 if no more can be opened.
+int rinorca_open_session();
+void rinorca_close_session(int session_handle);
+
+const char* rinorca_latest_err_msg(int session_handle);
+const char* rinorca_debug_input_buffer(int session_handle);
+int rinorca_set_input_chunk(int session_handle, int append_to_buffer, const char* chunk);
+int rinorca_get_output_chunk(int session_handle, char* out_data, int* out_data_maxlen);
+
+int rinorca_rinchi_from_file(
+	int session_handle, int append_to_buffer, const char* input_file, const char* input_format, int include_auxinfo, char* out_data, int* out_data_maxlen);
+int rinorca_rinchikey_from_file(
+	int session_handle, int append_to_buffer, const char* input_file, const char* input_format, const char* key_type, char* out_data, int* out_data_maxlen);
+int rinorca_all_from_file(
+	int session_handle, int append_to_buffer, const char* input_file, const char* input_format, int output_mask, char* out_data, int* out_data_maxlen);
+int rinorca_rinchikey_from_rinchi(
+	int session_handle, int append_to_buffer, const char* rinchi_string, const char* key_type, char* out_data, int* out_data_maxlen);
+int rinorca_file_from_rinchi(
+	int session_handle, int append_to_buffer, const char* rinchi_input, const char* output_format, char* out_data, int* out_data_maxlen);
+
+int rinorca_rinchi_from_file_bulk(
+	int session_handle, int append_to_buffer, const char* input_files, const char* input_format, int include_auxinfo, int max_threads, char* out_data, int* out_data_maxlen);
+int rinorca_rinchikey_from_file_bulk(
+	int session_handle, int append_to_buffer, const char* input_files, const char* input_format, const char* key_type, int max_threads, char* out_data, int* out_data_maxlen);
+int rinorca_rinchikey_from_rinchi_bulk(
+	int session_handle, int append_to_buffer, const char* rinchi_strings, const char* key_type, int max_threads, char* out_data, int* out_data_maxlen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,6 +9,9 @@ TEMPLATE = lib
 DEFINES  += TARGET_API_LIB
 QMAKE_CFLAGS += -ansi -DCOMPILE_ANSI_ONLY
 QMAKE_CXXFLAGS += -std=c++11
+# Older glibc versions need -pthread for std::thread.
+unix:!macx: QMAKE_CXXFLAGS += -pthread
+unix:!macx: QMAKE_LFLAGS += -pthread
 
 DEPENDPATH += \
 	./../lib/ \
@@ -34,9 +37,13 @@ SOURCES += \
 	./../parsers/mdl_rxnfile_reader.cpp \
 	./../parsers/mdl_rdfile_reader.cpp \
 	./../parsers/rinchi_reader.cpp \
+	./../parsers/inchi_auxinfo_reader.cpp \
 	./../writers/mdl_rxnfile_writer.cpp \
 	./../writers/mdl_rdfile_writer.cpp \
+	./../writers/mdl_molfile_writer.cpp \
 	./../rinchi/rinchi_reaction.cpp \
+	./../rinchi/rinchi_inchi_cache.cpp \
+	./../rinchi/rinchi_molecule.cpp \
 	./../rinchi/rinchi_consts.cpp \
 	./rinchi_ora_cartridge.cpp \
         ./../../../InChI/INCHI-1-SRC/INCHI_BASE/src/ichi_bns.c \
@@ -89,3 +96,10 @@ SOURCES += \
         ./../../../InChI/INCHI-1-SRC/INCHI_API/libinchi/src/inchi_dll_a.c \
         ./../../../InChI/INCHI-1-SRC/INCHI_API/libinchi/src/inchi_dll_a2.c \
         ./../../../InChI/INCHI-1-SRC/INCHI_API/libinchi/src/inchi_dll_b.c \
+
+# Local driver for the bulk functions, runs without Oracle: 'make rinorca_driver'.
+# Run it with LD_LIBRARY_PATH=. so that it finds the cartridge library.
+rinorca_driver.target = rinorca_driver
+rinorca_driver.depends = rinorca_driver.cpp rinchi_ora_cartridge.h $(TARGET)
+rinorca_driver.commands = $(CXX) $(CXXFLAGS) $(INCPATH) -o rinorca_driver rinorca_driver.cpp $(TARGET)
+QMAKE_EXTRA_TARGETS += rinorca_driver
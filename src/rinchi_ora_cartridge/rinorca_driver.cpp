@@ -0,0 +1,331 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rinchi_ora_cartridge.h"
+
+/**
+  Local driver for the cartridge's bulk functions: calls them the way the PL/SQL package 'rinorca' does,
+  with inputs and outputs transferred in chunks, but without Oracle. With /check every item is also
+  calculated by the single-row function and the results are compared. With /sessions the items are
+  calculated by several concurrent cartridge sessions, as in a multithreaded extproc agent.
+**/
+
+namespace {
+
+	struct Options {
+		std::string function;
+		std::string input_format;
+		std::string key_type;
+		int max_threads;
+		size_t batch_size;
+		size_t input_chunk_size;
+		int output_chunk_size;
+		bool check;
+		int session_count;
+
+		Options(): input_format("AUTO"), key_type("L"), max_threads(0), batch_size(500), input_chunk_size(32000), output_chunk_size(32000), check(false), session_count(1) {}
+	};
+
+	typedef std::vector< std::pair<int, std::string> > Results;
+
+	void check_return(int session, int return_code)
+	{
+		if (return_code == RETURN_CODE_ERROR)
+			throw std::runtime_error(rinorca_latest_err_msg(session));
+	}
+
+	std::string read_file(const std::string& file_name)
+	{
+		std::ifstream file(file_name.c_str(), std::ios::binary);
+		if (!file)
+			throw std::runtime_error("File '" + file_name + "' does not exist.");
+		std::stringstream text;
+		text << file.rdbuf();
+		return text.str();
+	}
+
+	// Passes all but the last 'chunk_size' bytes of 'input' to rinorca_set_input_chunk() and returns the rest.
+	std::string set_input(int session, const std::string& input, size_t chunk_size, int& append_to_buffer)
+	{
+		append_to_buffer = 0;
+		size_t pos = 0;
+		for (; input.length() - pos > chunk_size; pos += chunk_size) {
+			check_return(session, rinorca_set_input_chunk(session, append_to_buffer, input.substr(pos, chunk_size).c_str()));
+			append_to_buffer = 1;
+		}
+		return input.substr(pos);
+	}
+
+	// Returns the output of a call that returned 'return_code' and 'first_chunk', fetching any remaining chunks.
+	std::string get_output(int session, int return_code, const char* first_chunk, int chunk_size)
+	{
+		check_return(session, return_code);
+		std::string output = first_chunk;
+		std::vector<char> buffer(chunk_size + 1);
+		while (return_code == RETURN_CODE_MORE_OUTPUT) {
+			int maxlen = chunk_size;
+			return_code = rinorca_get_output_chunk(session, buffer.data(), &maxlen);
+			check_return(session, return_code);
+			output += buffer.data();
+		}
+		return output;
+	}
+
+	// Calls the bulk function for 'items' and returns the (status code, result) pairs.
+	Results call_bulk(const Options& options, int session, const std::vector<std::string>& items)
+	{
+		std::string input;
+		// Every item is followed by the separator, as in PL/SQL.
+		for (std::vector<std::string>::const_iterator item = items.begin(); item != items.end(); item++)
+			input += *item + RINORCA_BULK_SEPARATOR;
+
+		int append_to_buffer;
+		std::string last_chunk = set_input(session, input, options.input_chunk_size, append_to_buffer);
+		std::vector<char> out_data(options.output_chunk_size + 1);
+		int maxlen = options.output_chunk_size;
+		int return_code;
+		if (options.function == "rinchi")
+			return_code = rinorca_rinchi_from_file_bulk(session, append_to_buffer, last_chunk.c_str(), options.input_format.c_str(), 1, options.max_threads, out_data.data(), &maxlen);
+		else if (options.function == "key")
+			return_code = rinorca_rinchikey_from_file_bulk(session, append_to_buffer, last_chunk.c_str(), options.input_format.c_str(), options.key_type.c_str(), options.max_threads, out_data.data(), &maxlen);
+		else
+			return_code = rinorca_rinchikey_from_rinchi_bulk(session, append_to_buffer, last_chunk.c_str(), options.key_type.c_str(), options.max_threads, out_data.data(), &maxlen);
+		std::string output = get_output(session, return_code, out_data.data(), options.output_chunk_size);
+
+		Results results;
+		std::istringstream output_stream(output);
+		std::string item_output;
+		while (std::getline(output_stream, item_output, RINORCA_BULK_SEPARATOR))
+			results.push_back(std::make_pair(item_output.at(0) - '0', item_output.substr(1)));
+		if (results.size() != items.size())
+			throw std::runtime_error("Bulk output does not have a result per input item.");
+		return results;
+	}
+
+	// Calls the single-row function for 'item'.
+	std::pair<int, std::string> call_single(const Options& options, int session, const std::string& item)
+	{
+		int append_to_buffer;
+		std::string last_chunk = set_input(session, item, options.input_chunk_size, append_to_buffer);
+		std::vector<char> out_data(options.output_chunk_size + 1);
+		int maxlen = options.output_chunk_size;
+		int return_code;
+		if (options.function == "rinchi")
+			return_code = rinorca_rinchi_from_file(session, append_to_buffer, last_chunk.c_str(), options.input_format.c_str(), 1, out_data.data(), &maxlen);
+		else if (options.function == "key")
+			return_code = rinorca_rinchikey_from_file(session, append_to_buffer, last_chunk.c_str(), options.input_format.c_str(), options.key_type.c_str(), out_data.data(), &maxlen);
+		else
+			return_code = rinorca_rinchikey_from_rinchi(session, append_to_buffer, last_chunk.c_str(), options.key_type.c_str(), out_data.data(), &maxlen);
+
+		if (return_code == RETURN_CODE_ERROR)
+			return std::make_pair(RETURN_CODE_ERROR, std::string(rinorca_latest_err_msg(session)));
+		return std::make_pair(RETURN_CODE_SUCCESS, get_output(session, return_code, out_data.data(), options.output_chunk_size));
+	}
+
+	// Calculates all 'items' in batches in a session of its own.
+	void calculate_items(const Options& options, const std::vector<std::string>& items, Results& results, std::string& error)
+	{
+		int session = rinorca_open_session();
+		try {
+			if (session == 0)
+				throw std::runtime_error("Could not open a cartridge session.");
+			for (size_t first = 0; first < items.size(); first += options.batch_size) {
+				std::vector<std::string> batch(items.begin() + first, items.begin() + std::min(items.size(), first + options.batch_size));
+				Results batch_results = call_bulk(options, session, batch);
+				results.insert(results.end(), batch_results.begin(), batch_results.end());
+			}
+			// An empty last item gets a result of its own, as from PL/SQL.
+			std::vector<std::string> batch (1, items.empty() ? std::string() : items.front());
+			batch.push_back(std::string());
+			if (call_bulk(options, session, batch).back().first != RETURN_CODE_ERROR)
+				throw std::runtime_error("Empty last bulk item did not fail.");
+		}
+		catch (std::exception& e) {
+			error = e.what();
+		}
+		rinorca_close_session(session);
+		// A closed handle must not come back to life.
+		if (session != 0 && error.empty() && rinorca_set_input_chunk(session, 0, "") != RETURN_CODE_ERROR)
+			error = "Closed cartridge session still in use.";
+	}
+
+	double seconds_since(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+}
+
+int main(int argc, char* argv[])
+{
+	try {
+		Options options;
+		std::vector<std::string> inputs;
+		for (int i = 1; i < argc; i++) {
+			std::string arg = argv[i];
+			if (arg == "/check")
+				options.check = true;
+			else if (arg.compare(0, 8, "/format:") == 0)
+				options.input_format = arg.substr(8);
+			else if (arg.compare(0, 5, "/key:") == 0)
+				options.key_type = arg.substr(5);
+			else if (arg.compare(0, 9, "/threads:") == 0)
+				options.max_threads = atoi(arg.c_str() + 9);
+			else if (arg.compare(0, 7, "/batch:") == 0)
+				options.batch_size = atoi(arg.c_str() + 7);
+			else if (arg.compare(0, 10, "/in-chunk:") == 0)
+				options.input_chunk_size = atoi(arg.c_str() + 10);
+			else if (arg.compare(0, 11, "/out-chunk:") == 0)
+				options.output_chunk_size = atoi(arg.c_str() + 11);
+			else if (arg.compare(0, 10, "/sessions:") == 0)
+				options.session_count = atoi(arg.c_str() + 10);
+			else if (options.function.empty())
+				options.function = arg;
+			else
+				inputs.push_back(arg);
+		}
+
+		if ((options.function != "rinchi" && options.function != "key" && options.function != "rinchikey") || inputs.empty()
+			|| options.batch_size == 0 || options.input_chunk_size == 0 || options.output_chunk_size <= 0 || options.session_count <= 0) {
+			std::cerr << "Usage: rinorca_driver <function> <files> <options>" << "\n"
+				<< "       <function>" << "\n"
+				<< "            rinchi     RInChI strings and RAuxInfo of the RXN or RD files <files>." << "\n"
+				<< "            key        RInChIKeys of the RXN or RD files <files>." << "\n"
+				<< "            rinchikey  RInChIKeys of the RInChI strings in <files>, one per line." << "\n"
+				<< "       <options>" << "\n"
+				<< "            /format:<RD|RXN|AUTO>   Input file format (default AUTO)." << "\n"
+				<< "            /key:<L|S|W>            Key type (default L)." << "\n"
+				<< "            /threads:<n>            Threads per bulk call (default 0: one per processor)." << "\n"
+				<< "            /batch:<n>              Items per bulk call (default 500)." << "\n"
+				<< "            /in-chunk:<n>           Input chunk size (default 32000, as in PL/SQL)." << "\n"
+				<< "            /out-chunk:<n>          Output chunk size (default 32000, as in PL/SQL)." << "\n"
+				<< "            /sessions:<n>           Concurrent sessions that each calculate all items (default 1)." << "\n"
+				<< "            /check                  Compare with the single-row functions." << "\n"
+				<< std::endl;
+			return 1;
+		}
+
+		std::vector<std::string> names;
+		std::vector<std::string> items;
+		for (std::vector<std::string>::const_iterator input = inputs.begin(); input != inputs.end(); input++) {
+			if (options.function != "rinchikey") {
+				names.push_back(*input);
+				items.push_back(read_file(*input));
+				continue;
+			}
+			std::istringstream lines(read_file(*input));
+			std::string line;
+			for (int line_no = 1; std::getline(lines, line); line_no++) {
+				if (!line.empty() && line.at(line.length() - 1) == '\r')
+					line.erase(line.length() - 1);
+				if (line.empty())
+					continue;
+				std::ostringstream name;
+				name << *input << ":" << line_no;
+				names.push_back(name.str());
+				items.push_back(line);
+			}
+		}
+
+		std::vector<Results> session_results(options.session_count);
+		std::vector<std::string> session_errors(options.session_count);
+		std::vector<std::thread> session_threads;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int s = 1; s < options.session_count; s++)
+			session_threads.push_back(std::thread(calculate_items, std::cref(options), std::cref(items), std::ref(session_results[s]), std::ref(session_errors[s])));
+		calculate_items(options, items, session_results[0], session_errors[0]);
+		for (std::vector<std::thread>::iterator session_thread = session_threads.begin(); session_thread != session_threads.end(); session_thread++)
+			session_thread->join();
+		double bulk_seconds = seconds_since(start);
+
+		const Results& results = session_results[0];
+		for (int s = 0; s < options.session_count; s++) {
+			if (!session_errors[s].empty())
+				throw std::runtime_error(session_errors[s]);
+			if (session_results[s] != results)
+				throw std::runtime_error("Concurrent sessions returned different results.");
+		}
+
+		size_t failures = 0;
+		for (size_t i = 0; i < results.size(); i++) {
+			std::cout << results[i].first << "\t" << names[i] << "\t" << results[i].second.substr(0, results[i].second.find('\n')) << "\n";
+			if (results[i].first != RETURN_CODE_SUCCESS)
+				failures++;
+		}
+		std::cerr << items.size() << " items, " << failures << " failed, " << bulk_seconds << " s in bulk calls";
+		if (options.session_count > 1)
+			std::cerr << " of " << options.session_count << " concurrent sessions";
+		std::cerr << "." << std::endl;
+
+		if (options.check) {
+			size_t mismatches = 0;
+			int session = rinorca_open_session();
+			start = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < items.size(); i++) {
+				std::pair<int, std::string> single_result = call_single(options, session, items[i]);
+				if (single_result != results[i]) {
+					std::cerr << "MISMATCH " << names[i] << ": bulk " << results[i].first << " '" << results[i].second
+						<< "', single row " << single_result.first << " '" << single_result.second << "'" << std::endl;
+					mismatches++;
+				}
+			}
+			rinorca_close_session(session);
+			std::cerr << mismatches << " mismatches, " << seconds_since(start) << " s in single-row calls." << std::endl;
+			if (mismatches > 0)
+				return 1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
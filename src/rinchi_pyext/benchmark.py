@@ -0,0 +1,123 @@
+#pragma region InChI-Trust Licence
+#/*
+# * Reaction International Chemical Identifier (RInChI)
+# * Version 1
+# * Software version 1.00
+# * 2022-01-14
+# * 
+# * The RInChI library and programs are free software developed under the
+# * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+# * 
+# * IUPAC/InChI-Trust Licence No.1.0 for the 
+# * Reaction International Chemical Identifier (RInChI) Software version 1.0
+# * Copyright (C) IUPAC and InChI Trust Limited
+# * 
+# * This library is free software; you can redistribute it and/or modify it 
+# * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+# * or any later version.
+# * 
+# * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+# * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+# * Licence for the International Chemical Identifier (InChI) Software
+# * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+# * for more details.
+# * 
+# * You should have received a copy of the IUPAC/InChI Trust InChI 
+# * Licence No. 1.0 with this library; if not, please write to:
+# * 
+# *     The InChI Trust
+# *     8 Cavendish Avenue
+# *     Cambridge CB1 7US
+# *     UK
+# *
+# * or email to: alan@inchi-trust.org.
+# *
+# */
+#pragma endregion
+
+# Compares the ctypes wrapper in ../rinchi_lib with the 'rinchi_ext' extension module on the
+# USPTO patent reactions in ../test/USPTO_patent_data. Both must be built first (see BUILD.TXT
+# here and in ../rinchi_lib). Example:
+#
+#     python benchmark.py --limit 5000 --threads 8
+
+import argparse
+import glob
+import os
+import sys
+import time
+
+sys.path.insert(0, "../rinchi_lib")
+
+import rinchi_ext
+import rinchi_lib
+
+parser = argparse.ArgumentParser(description = "RInChI from RXN files: ctypes wrapper vs. extension module.")
+parser.add_argument("--data", default = "../test/USPTO_patent_data", help = "folder with .rxn files")
+parser.add_argument("--lib", default = "../rinchi_lib", help = "folder with the rinchi_lib shared library")
+parser.add_argument("--limit", type = int, default = 0, help = "use only the first LIMIT files (0: all)")
+parser.add_argument("--threads", type = int, default = 0, help = "threads for the batch calls (0: one per hardware thread)")
+parser.add_argument("--chunk-size", type = int, default = 256, help = "chunk size for the batch calls")
+args = parser.parse_args()
+
+paths = sorted(glob.glob(os.path.join(args.data, "*.rxn")))
+if args.limit:
+    paths = paths[:args.limit]
+if not paths:
+    sys.exit("No .rxn files in '" + args.data + "'.")
+file_texts = [open(path, "rb").read() for path in paths]
+print ("%d RXN files, %.1f MB" % (len(file_texts), sum(len(t) for t in file_texts) / 1e6))
+
+def run(name, fn):
+    start = time.perf_counter()
+    results = fn()
+    seconds = time.perf_counter() - start
+    print ("%-50s %8.2f s %10.0f reactions/s" % (name, seconds, len(file_texts) / seconds))
+    return results
+
+# Files that the RInChI library cannot read count as None in every run.
+def each(fn):
+    results = []
+    for file_text in file_texts:
+        try:
+            results.append(fn(file_text))
+        except Exception:
+            results.append(None)
+    return results
+
+rinchi = rinchi_lib.RInChI(args.lib)
+
+def ctypes_separate(file_text):
+    text = file_text.decode("utf-8")
+    rinchi_string, rinchi_auxinfo = rinchi.rinchi_from_file_text("AUTO", text)
+    return {
+        "rinchi_string": rinchi_string,
+        "rinchi_auxinfo": rinchi_auxinfo,
+        "long_key": rinchi.rinchikey_from_file_text("AUTO", text, "L"),
+        "short_key": rinchi.rinchikey_from_file_text("AUTO", text, "S"),
+        "web_key": rinchi.rinchikey_from_file_text("AUTO", text, "W"),
+    }
+
+expected = run("ctypes: rinchi_from_file_text + 3 keys", lambda: each(ctypes_separate))
+results = run("ctypes: all_from_file_text", lambda: each(lambda t: rinchi.all_from_file_text("AUTO", t.decode("utf-8"))))
+assert (results == expected)
+
+results = run("rinchi_ext: all_from_file_text", lambda: each(rinchi_ext.all_from_file_text))
+assert (results == expected)
+
+def batch(threads):
+    results = rinchi_ext.all_from_file_texts(file_texts, threads = threads, chunk_size = args.chunk_size, errors = "return")
+    return [None if isinstance(result, rinchi_ext.RInChIError) else result for result in results]
+
+results = run("rinchi_ext: all_from_file_texts, 1 thread", lambda: batch(1))
+assert (results == expected)
+results = run("rinchi_ext: all_from_file_texts, %s threads" % (args.threads or "all"), lambda: batch(args.threads))
+assert (results == expected)
+
+def generator_batch():
+    file_texts_read = (open(path, "rb").read() for path in paths)
+    results = rinchi_ext.iall_from_file_texts(file_texts_read, threads = args.threads, chunk_size = args.chunk_size, errors = "return")
+    return [None if isinstance(result, rinchi_ext.RInChIError) else result for result in results]
+
+results = run("rinchi_ext: iall_from_file_texts over a generator", generator_batch)
+assert (results == expected)
@@ -0,0 +1,938 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+/**
+  Native CPython extension module 'rinchi_ext'. Calls the RInChI C++ classes directly, without
+  the C API and ctypes of rinchi_lib, so that
+
+    - file texts are read from str, bytes, bytearray or memoryview objects in place,
+    - the GIL is released while reactions are read and RInChIs calculated,
+    - batches of file texts (any iterable, including generators) are spread over a thread pool,
+    - RD files with many records are read record by record, without splitting them in Python.
+
+  See BUILD.TXT for how to build it and test.py for usage.
+**/
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "rinchi_platform.h"
+#include "rinchi_utils.h"
+#include "rinchi_parallel.h"
+
+#include "rinchi_consts.h"
+#include "rinchi_reaction.h"
+#include "rinchi_result_cache.h"
+
+#include "mdl_rxnfile.h"
+#include "mdl_rxnfile_reader.h"
+#include "mdl_rdfile_reader.h"
+
+#include "rinchi_reader.h"
+#include "mdl_rxnfile_writer.h"
+#include "mdl_rdfile_writer.h"
+
+namespace {
+
+	// Same values as RINCHI_OUTPUT_* in rinchi_lib.h.
+	const int OUTPUT_RINCHI_STRING = 1;
+	const int OUTPUT_RAUXINFO = 2;
+	const int OUTPUT_LONG_KEY = 4;
+	const int OUTPUT_SHORT_KEY = 8;
+	const int OUTPUT_WEB_KEY = 16;
+	const int OUTPUT_ALL = 31;
+
+	const Py_ssize_t DEFAULT_CHUNK_SIZE = 256;
+	// Bytes asked for per read() call on a Python file object.
+	const Py_ssize_t FILE_BLOCK_SIZE = 65536;
+
+	// rinchi_ext.RInChIError, raised for all errors from the RInChI library.
+	PyObject* rinchi_error = NULL;
+
+	/**
+	  Text passed in from Python: the UTF-8 of a str, or the buffer of a bytes-like object.
+	  Holds a reference to the object for as long as the text is used, so the GIL is not needed
+	  to read it. Must be released with the GIL held.
+	  Record texts split from a file are held as strings of their own instead.
+	**/
+	class InputText {
+		private:
+			PyObject* m_object;
+			Py_buffer m_buffer;
+			bool m_has_buffer;
+			const char* m_data;
+			size_t m_length;
+			std::string m_text;
+
+		public:
+			InputText(): m_object(NULL), m_buffer(), m_has_buffer(false), m_data(NULL), m_length(0) {}
+			InputText(InputText&& other): m_object(other.m_object), m_buffer(other.m_buffer), m_has_buffer(other.m_has_buffer), m_data(other.m_data), m_length(other.m_length), m_text(std::move(other.m_text))
+			{
+				other.m_object = NULL;
+				other.m_has_buffer = false;
+			}
+			~InputText() { release(); }
+
+			InputText(const InputText&) = delete;
+			InputText& operator=(const InputText&) = delete;
+
+			const char* data() const { return m_object ? m_data : m_text.data(); }
+			size_t length() const { return m_object ? m_length : m_text.length(); }
+
+			void assign(std::string& text)
+			{
+				release();
+				m_text.swap(text);
+			}
+
+			// Returns false, with a Python exception set, if 'object' is neither a str nor a
+			// contiguous bytes-like object.
+			bool acquire(PyObject* object, const char* what)
+			{
+				release();
+				if (PyUnicode_Check(object)) {
+					Py_ssize_t length;
+					// CPython keeps the UTF-8 with the str; ASCII strings are not even converted.
+					m_data = PyUnicode_AsUTF8AndSize(object, &length);
+					if (!m_data)
+						return false;
+					m_length = length;
+				}
+				else if (PyObject_CheckBuffer(object)) {
+					if (PyObject_GetBuffer(object, &m_buffer, PyBUF_SIMPLE) != 0)
+						return false;
+					m_has_buffer = true;
+					m_data = (const char*) m_buffer.buf;
+					m_length = m_buffer.len;
+				}
+				else {
+					PyErr_Format(PyExc_TypeError, "%s must be str or a bytes-like object, not '%.200s'.", what, Py_TYPE(object)->tp_name);
+					return false;
+				}
+				Py_INCREF(object);
+				m_object = object;
+				return true;
+			}
+
+			void release()
+			{
+				if (m_has_buffer)
+					PyBuffer_Release(&m_buffer);
+				m_has_buffer = false;
+				Py_XDECREF(m_object);
+				m_object = NULL;
+				m_data = NULL;
+				m_length = 0;
+				m_text.clear();
+			}
+	};
+
+	struct FileTextOptions {
+		std::string input_format;
+		bool force_equilibrium;
+		int outputs;
+		// Passed to Reaction::set_max_inchi_threads(). Batches calculate one reaction per thread.
+		unsigned max_inchi_threads;
+
+		FileTextOptions(): input_format("AUTO"), force_equilibrium(false), outputs(OUTPUT_ALL), max_inchi_threads(0) {}
+	};
+
+	// Outcome of one file text. 'error' is set instead of 'result' if it failed.
+	struct FileTextResult {
+		rinchi::ReactionResult result;
+		std::string error;
+		bool failed;
+
+		FileTextResult(): failed(false) {}
+	};
+
+	void load_reaction(const char* data, size_t length, const FileTextOptions& options, rinchi::Reaction& rxn)
+	{
+		rinchi::MemoryStreamBuffer buffer(data, length);
+		std::istream file_text_stream(&buffer);
+
+		std::string file_format = options.input_format;
+		if (file_format.empty() || file_format == "AUTO") {
+			std::string first_line;
+			rinchi::rinchi_getline(file_text_stream, first_line);
+			file_text_stream.clear();
+			file_text_stream.seekg(0);
+			file_format = first_line == rinchi::MDL_TAG_RXN_BEGIN ? "RXN" : "RD";
+		}
+
+		if (file_format == "RD") {
+			rinchi::MdlRDfileReader rd_reader;
+			rd_reader.read_reaction(file_text_stream, rxn, options.force_equilibrium);
+		}
+		else if (file_format == "RXN") {
+			rinchi::MdlRxnfileReader rxn_reader;
+			rxn_reader.read_reaction(file_text_stream, rxn, options.force_equilibrium);
+		}
+		else
+			throw rinchi::RInChIError(std::string("Unsupported input file format '") + file_format + "'.");
+	}
+
+	// Runs without the GIL; never throws.
+	void calculate(const char* data, size_t length, const FileTextOptions& options, FileTextResult& outcome)
+	{
+		try {
+			bool need_auxinfo = (options.outputs & OUTPUT_RAUXINFO) != 0;
+			rinchi::Reaction rxn;
+			rxn.set_omit_auxinfo(!need_auxinfo);
+			rxn.set_max_inchi_threads(options.max_inchi_threads);
+			load_reaction(data, length, options, rxn);
+
+			rinchi::ReactionResult& result = outcome.result;
+			if (options.outputs & OUTPUT_RINCHI_STRING)
+				result.rinchi_string = rxn.rinchi_string();
+			if (need_auxinfo)
+				result.rinchi_auxinfo = rxn.rinchi_auxinfo();
+			result.has_auxinfo = need_auxinfo;
+			if (options.outputs & OUTPUT_LONG_KEY)
+				result.long_key = rxn.rinchi_long_key();
+			if (options.outputs & OUTPUT_SHORT_KEY)
+				result.short_key = rxn.rinchi_short_key();
+			if (options.outputs & OUTPUT_WEB_KEY)
+				result.web_key = rxn.rinchi_web_key();
+		}
+		catch (std::exception& e) {
+			outcome.failed = true;
+			outcome.error = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what();
+		}
+	}
+
+	// Calculates all of 'inputs' on up to 'thread_count' threads (0: one per hardware thread).
+	// Runs without the GIL.
+	void calculate_all(const std::vector<InputText>& inputs, const FileTextOptions& options, unsigned thread_count, std::vector<FileTextResult>& outcomes)
+	{
+		outcomes.assign(inputs.size(), FileTextResult());
+		rinchi::parallel_for(inputs.size(), thread_count, [&](size_t idx) {
+			calculate(inputs[idx].data(), inputs[idx].length(), options, outcomes[idx]);
+		});
+	}
+
+	PyObject* set_rinchi_error(const std::string& message)
+	{
+		PyErr_SetString(rinchi_error, message.c_str());
+		return NULL;
+	}
+
+	PyObject* new_str(const std::string& value)
+	{
+		return PyUnicode_FromStringAndSize(value.data(), value.length());
+	}
+
+	// A dict of the selected outputs, keyed as in rinchi_lib.RInChI.all_from_file_text().
+	PyObject* result_dict(const rinchi::ReactionResult& result, int outputs)
+	{
+		struct {
+			int output;
+			const char* key;
+			const std::string& value;
+		} items[] = {
+			{ OUTPUT_RINCHI_STRING, "rinchi_string", result.rinchi_string },
+			{ OUTPUT_RAUXINFO, "rinchi_auxinfo", result.rinchi_auxinfo },
+			{ OUTPUT_LONG_KEY, "long_key", result.long_key },
+			{ OUTPUT_SHORT_KEY, "short_key", result.short_key },
+			{ OUTPUT_WEB_KEY, "web_key", result.web_key },
+		};
+
+		PyObject* dict = PyDict_New();
+		if (!dict)
+			return NULL;
+		for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); i++) {
+			if ((outputs & items[i].output) == 0)
+				continue;
+			PyObject* value = new_str(items[i].value);
+			if (!value || PyDict_SetItemString(dict, items[i].key, value) != 0) {
+				Py_XDECREF(value);
+				Py_DECREF(dict);
+				return NULL;
+			}
+			Py_DECREF(value);
+		}
+		return dict;
+	}
+
+	bool check_outputs(int outputs)
+	{
+		if (outputs <= 0 || (outputs & ~OUTPUT_ALL) != 0) {
+			set_rinchi_error("Invalid output selection. 'outputs' must be a combination of OUTPUT_* values.");
+			return false;
+		}
+		return true;
+	}
+
+	bool parse_errors_mode(const char* errors, bool& raise_errors)
+	{
+		if (strcmp(errors, "raise") == 0)
+			raise_errors = true;
+		else if (strcmp(errors, "return") == 0)
+			raise_errors = false;
+		else {
+			PyErr_SetString(PyExc_ValueError, "'errors' must be 'raise' or 'return'.");
+			return false;
+		}
+		return true;
+	}
+
+	char key_selector(const char* key_type)
+	{
+		if (strcmp(key_type, "L") != 0 && strcmp(key_type, "S") != 0 && strcmp(key_type, "W") != 0)
+			return 0;
+		return *key_type;
+	}
+
+	int key_output(char key_type)
+	{
+		switch (key_type) {
+			case 'L': return OUTPUT_LONG_KEY;
+			case 'S': return OUTPUT_SHORT_KEY;
+			default:  return OUTPUT_WEB_KEY;
+		}
+	}
+
+	const std::string& select_key(const rinchi::ReactionResult& result, char key_type)
+	{
+		switch (key_type) {
+			case 'L': return result.long_key;
+			case 'S': return result.short_key;
+			default:  return result.web_key;
+		}
+	}
+
+	// Reads one file text and calculates 'options.outputs' for it with the GIL released.
+	// Returns false, with a Python exception set, on error.
+	bool calculate_one(PyObject* file_text, const FileTextOptions& options, rinchi::ReactionResult& result)
+	{
+		InputText input;
+		if (!input.acquire(file_text, "file_text"))
+			return false;
+
+		FileTextResult outcome;
+		Py_BEGIN_ALLOW_THREADS
+		calculate(input.data(), input.length(), options, outcome);
+		Py_END_ALLOW_THREADS
+
+		if (outcome.failed) {
+			set_rinchi_error(outcome.error);
+			return false;
+		}
+		result = outcome.result;
+		return true;
+	}
+
+
+	/**
+	  Stream buffer over a Python file object, binary or text, that is read in blocks with its
+	  read() method. The GIL must be held while reading. A Python exception ends the input and is
+	  left set for the caller to check.
+	**/
+	class PyFileStreamBuffer: public std::streambuf {
+		private:
+			PyObject* m_file;
+			std::string m_block;
+			bool m_failed;
+
+		public:
+			// Borrows 'file'; the caller keeps it alive.
+			explicit PyFileStreamBuffer(PyObject* file): m_file(file), m_failed(false) {}
+
+		protected:
+			int_type underflow()
+			{
+				if (gptr() < egptr())
+					return traits_type::to_int_type(*gptr());
+				if (m_failed)
+					return traits_type::eof();
+
+				PyObject* block = PyObject_CallMethod(m_file, "read", "n", FILE_BLOCK_SIZE);
+				const char* data = NULL;
+				Py_ssize_t length = 0;
+				if (block && PyUnicode_Check(block))
+					data = PyUnicode_AsUTF8AndSize(block, &length);
+				else if (block && PyBytes_Check(block)) {
+					data = PyBytes_AS_STRING(block);
+					length = PyBytes_GET_SIZE(block);
+				}
+				else if (block)
+					PyErr_Format(PyExc_TypeError, "read() must return str or bytes, not '%.200s'.", Py_TYPE(block)->tp_name);
+				if (data)
+					m_block.assign(data, length);
+				Py_XDECREF(block);
+				if (!data) {
+					m_failed = true;
+					return traits_type::eof();
+				}
+
+				if (m_block.empty())
+					return traits_type::eof();
+				setg(&m_block[0], &m_block[0], &m_block[0] + m_block.size());
+				return traits_type::to_int_type(*gptr());
+			}
+	};
+
+
+	/**
+	  Batch iterator, returned by iall_from_file_texts() and iall_from_file(). Takes 'chunk_size'
+	  file texts at a time from the source iterator, or records from the RD file, and calculates
+	  them on the thread pool with the GIL released.
+	**/
+
+	struct BatchState {
+		FileTextOptions options;
+		unsigned thread_count;
+		size_t chunk_size;
+		bool raise_errors;
+		std::vector<FileTextResult> outcomes;
+		size_t next_outcome;
+		// Position in the source of the first item of 'outcomes'.
+		size_t chunk_start;
+
+		// For iall_from_file(): the RD file the records are read from. The 'source' of the
+		// iterator is then the file object that 'record_buffer' reads, or NULL for a path.
+		std::unique_ptr<std::streambuf> record_buffer;
+		std::unique_ptr<std::istream> record_stream;
+		std::unique_ptr<rinchi::MdlRDfileRecordReader> records;
+		// True if reading records calls into Python.
+		bool records_need_gil;
+		// First line of each record in 'outcomes'.
+		std::vector<int> record_lines;
+
+		BatchState(): thread_count(0), chunk_size(DEFAULT_CHUNK_SIZE), raise_errors(true), next_outcome(0), chunk_start(0), records_need_gil(false) {}
+	};
+
+	struct BatchIterator {
+		PyObject_HEAD
+		PyObject* source;
+		BatchState* state;
+	};
+
+	void batch_iterator_dealloc(PyObject* self)
+	{
+		BatchIterator* it = (BatchIterator*) self;
+		PyObject_GC_UnTrack(self);
+		Py_XDECREF(it->source);
+		delete it->state;
+		PyObject_GC_Del(self);
+	}
+
+	int batch_iterator_traverse(PyObject* self, visitproc visit, void* arg)
+	{
+		Py_VISIT(((BatchIterator*) self)->source);
+		return 0;
+	}
+
+	// Reads up to 'chunk_size' records into 'inputs'. Returns false, with 'error' set, if the
+	// file cannot be split into records.
+	bool read_records(BatchState& state, std::vector<InputText>& inputs, std::string& error)
+	{
+		state.record_lines.clear();
+		try {
+			std::string record_text;
+			while (inputs.size() < state.chunk_size && state.records->next_record(record_text)) {
+				inputs.push_back(InputText());
+				inputs.back().assign(record_text);
+				state.record_lines.push_back(state.records->record_line_number());
+			}
+		}
+		catch (std::exception& e) {
+			error = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what();
+			return false;
+		}
+		return true;
+	}
+
+	// Returns false when the source is exhausted or on error (a Python exception is set then).
+	bool next_chunk(BatchIterator* it)
+	{
+		BatchState& state = *it->state;
+		std::vector<InputText> inputs;
+		inputs.reserve(state.chunk_size);
+
+		if (state.records) {
+			std::string error;
+			bool read_ok;
+			if (state.records_need_gil)
+				read_ok = read_records(state, inputs, error);
+			else {
+				Py_BEGIN_ALLOW_THREADS
+				read_ok = read_records(state, inputs, error);
+				Py_END_ALLOW_THREADS
+			}
+			// An exception from the read() method of a file object.
+			if (PyErr_Occurred())
+				return false;
+			if (!read_ok) {
+				set_rinchi_error(error);
+				return false;
+			}
+		}
+		else {
+			if (!it->source)
+				return false;
+			while (inputs.size() < state.chunk_size) {
+				PyObject* item = PyIter_Next(it->source);
+				if (!item) {
+					if (PyErr_Occurred())
+						return false;
+					Py_CLEAR(it->source);
+					break;
+				}
+				inputs.push_back(InputText());
+				bool acquired = inputs.back().acquire(item, "Each file text");
+				Py_DECREF(item);
+				if (!acquired)
+					return false;
+			}
+		}
+		if (inputs.empty())
+			return false;
+
+		state.chunk_start += state.outcomes.size();
+		Py_BEGIN_ALLOW_THREADS
+		calculate_all(inputs, state.options, state.thread_count, state.outcomes);
+		Py_END_ALLOW_THREADS
+		state.next_outcome = 0;
+		return true;
+	}
+
+	PyObject* batch_iterator_next(PyObject* self)
+	{
+		BatchIterator* it = (BatchIterator*) self;
+		BatchState& state = *it->state;
+		if (state.next_outcome == state.outcomes.size() && !next_chunk(it))
+			return NULL;
+
+		size_t idx = state.next_outcome++;
+		const FileTextResult& outcome = state.outcomes[idx];
+		if (!outcome.failed)
+			return result_dict(outcome.result, state.options.outputs);
+
+		std::string message;
+		if (state.records)
+			message = "Record " + rinchi::int2str((int) (state.chunk_start + idx + 1)) + " (line " + rinchi::int2str(state.record_lines[idx]) + "): " + outcome.error;
+		else
+			message = "File text " + rinchi::int2str((int) (state.chunk_start + idx + 1)) + ": " + outcome.error;
+		if (state.raise_errors)
+			return set_rinchi_error(message);
+		return PyObject_CallFunction(rinchi_error, "s", message.c_str());
+	}
+
+	PyTypeObject BatchIteratorType = {
+		PyVarObject_HEAD_INIT(NULL, 0)
+		"rinchi_ext.BatchIterator",
+	};
+
+	// Takes a new reference to 'source', which may be NULL.
+	PyObject* create_batch_iterator(PyObject* source, std::unique_ptr<BatchState>& state)
+	{
+		BatchIterator* it = PyObject_GC_New(BatchIterator, &BatchIteratorType);
+		if (!it)
+			return NULL;
+		Py_XINCREF(source);
+		it->source = source;
+		// Batches calculate one reaction per thread.
+		state->options.max_inchi_threads = 1;
+		it->state = state.release();
+		PyObject_GC_Track((PyObject*) it);
+		return (PyObject*) it;
+	}
+
+	const char* const batch_kwlist[] = { "file_texts", "outputs", "input_format", "force_equilibrium", "threads", "chunk_size", "errors", NULL };
+
+	PyObject* new_batch_iterator(PyObject* args, PyObject* kwargs)
+	{
+		PyObject* file_texts;
+		int outputs = OUTPUT_ALL;
+		const char* input_format = "AUTO";
+		int force_equilibrium = 0;
+		unsigned int threads = 0;
+		Py_ssize_t chunk_size = DEFAULT_CHUNK_SIZE;
+		const char* errors = "raise";
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|isp$Ins:iall_from_file_texts", const_cast<char**>(batch_kwlist),
+				&file_texts, &outputs, &input_format, &force_equilibrium, &threads, &chunk_size, &errors))
+			return NULL;
+
+		bool raise_errors;
+		if (!check_outputs(outputs) || !parse_errors_mode(errors, raise_errors))
+			return NULL;
+		if (chunk_size < 1) {
+			PyErr_SetString(PyExc_ValueError, "'chunk_size' must be at least 1.");
+			return NULL;
+		}
+
+		PyObject* source = PyObject_GetIter(file_texts);
+		if (!source)
+			return NULL;
+		std::unique_ptr<BatchState> state(new BatchState());
+		state->options.input_format = input_format;
+		state->options.force_equilibrium = force_equilibrium != 0;
+		state->options.outputs = outputs;
+		state->thread_count = threads;
+		state->chunk_size = chunk_size;
+		state->raise_errors = raise_errors;
+		PyObject* it = create_batch_iterator(source, state);
+		Py_DECREF(source);
+		return it;
+	}
+
+	const char* const file_kwlist[] = { "source", "outputs", "force_equilibrium", "threads", "read_ahead", "errors", NULL };
+
+	PyObject* new_file_iterator(PyObject* args, PyObject* kwargs)
+	{
+		PyObject* source;
+		int outputs = OUTPUT_ALL;
+		int force_equilibrium = 0;
+		unsigned int threads = 0;
+		Py_ssize_t read_ahead = DEFAULT_CHUNK_SIZE;
+		const char* errors = "raise";
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|ip$Ins:iall_from_file", const_cast<char**>(file_kwlist),
+				&source, &outputs, &force_equilibrium, &threads, &read_ahead, &errors))
+			return NULL;
+
+		bool raise_errors;
+		if (!check_outputs(outputs) || !parse_errors_mode(errors, raise_errors))
+			return NULL;
+		if (read_ahead < 1) {
+			PyErr_SetString(PyExc_ValueError, "'read_ahead' must be at least 1.");
+			return NULL;
+		}
+
+		std::unique_ptr<BatchState> state(new BatchState());
+		PyObject* file_object = NULL;
+		if (PyObject_HasAttrString(source, "read")) {
+			state->record_buffer.reset(new PyFileStreamBuffer(source));
+			state->records_need_gil = true;
+			file_object = source;
+		}
+		else {
+			PyObject* path;
+			if (!PyUnicode_FSConverter(source, &path))
+				return NULL;
+			std::filebuf* file = new std::filebuf();
+			state->record_buffer.reset(file);
+			bool opened = file->open(PyBytes_AS_STRING(path), std::ios::in | std::ios::binary) != NULL;
+			Py_DECREF(path);
+			if (!opened)
+				return PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, source);
+		}
+		state->record_stream.reset(new std::istream(state->record_buffer.get()));
+		state->records.reset(new rinchi::MdlRDfileRecordReader(*state->record_stream));
+
+		state->options.force_equilibrium = force_equilibrium != 0;
+		state->options.outputs = outputs;
+		state->thread_count = threads;
+		state->chunk_size = read_ahead;
+		state->raise_errors = raise_errors;
+		return create_batch_iterator(file_object, state);
+	}
+
+
+	/**
+	  Module functions.
+	**/
+
+	PyObject* ext_rinchi_from_file_text(PyObject*, PyObject* args, PyObject* kwargs)
+	{
+		static const char* const kwlist[] = { "file_text", "input_format", "force_equilibrium", NULL };
+		PyObject* file_text;
+		const char* input_format = "AUTO";
+		int force_equilibrium = 0;
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|sp:rinchi_from_file_text", const_cast<char**>(kwlist), &file_text, &input_format, &force_equilibrium))
+			return NULL;
+
+		FileTextOptions options;
+		options.input_format = input_format;
+		options.force_equilibrium = force_equilibrium != 0;
+		options.outputs = OUTPUT_RINCHI_STRING | OUTPUT_RAUXINFO;
+		rinchi::ReactionResult result;
+		if (!calculate_one(file_text, options, result))
+			return NULL;
+		return Py_BuildValue("(s#s#)", result.rinchi_string.data(), (Py_ssize_t) result.rinchi_string.length(), result.rinchi_auxinfo.data(), (Py_ssize_t) result.rinchi_auxinfo.length());
+	}
+
+	PyObject* ext_rinchikey_from_file_text(PyObject*, PyObject* args, PyObject* kwargs)
+	{
+		static const char* const kwlist[] = { "file_text", "key_type", "input_format", "force_equilibrium", NULL };
+		PyObject* file_text;
+		const char* key_type;
+		const char* input_format = "AUTO";
+		int force_equilibrium = 0;
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Os|sp:rinchikey_from_file_text", const_cast<char**>(kwlist), &file_text, &key_type, &input_format, &force_equilibrium))
+			return NULL;
+
+		char key = key_selector(key_type);
+		if (!key)
+			return set_rinchi_error("Invalid key selector. 'key_type' parameter must be 'L'(ong), 'S'(hort) or W(eb).");
+
+		FileTextOptions options;
+		options.input_format = input_format;
+		options.force_equilibrium = force_equilibrium != 0;
+		options.outputs = key_output(key);
+		rinchi::ReactionResult result;
+		if (!calculate_one(file_text, options, result))
+			return NULL;
+		return new_str(select_key(result, key));
+	}
+
+	PyObject* ext_all_from_file_text(PyObject*, PyObject* args, PyObject* kwargs)
+	{
+		static const char* const kwlist[] = { "file_text", "outputs", "input_format", "force_equilibrium", NULL };
+		PyObject* file_text;
+		int outputs = OUTPUT_ALL;
+		const char* input_format = "AUTO";
+		int force_equilibrium = 0;
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|isp:all_from_file_text", const_cast<char**>(kwlist), &file_text, &outputs, &input_format, &force_equilibrium))
+			return NULL;
+		if (!check_outputs(outputs))
+			return NULL;
+
+		FileTextOptions options;
+		options.input_format = input_format;
+		options.force_equilibrium = force_equilibrium != 0;
+		options.outputs = outputs;
+		rinchi::ReactionResult result;
+		if (!calculate_one(file_text, options, result))
+			return NULL;
+		return result_dict(result, outputs);
+	}
+
+	PyObject* ext_iall_from_file_texts(PyObject*, PyObject* args, PyObject* kwargs)
+	{
+		return new_batch_iterator(args, kwargs);
+	}
+
+	PyObject* ext_all_from_file_texts(PyObject*, PyObject* args, PyObject* kwargs)
+	{
+		PyObject* it = new_batch_iterator(args, kwargs);
+		if (!it)
+			return NULL;
+		PyObject* result = PySequence_List(it);
+		Py_DECREF(it);
+		return result;
+	}
+
+	PyObject* ext_iall_from_file(PyObject*, PyObject* args, PyObject* kwargs)
+	{
+		return new_file_iterator(args, kwargs);
+	}
+
+	PyObject* ext_file_text_from_rinchi(PyObject*, PyObject* args, PyObject* kwargs)
+	{
+		static const char* const kwlist[] = { "rinchi_string", "rinchi_auxinfo", "output_format", NULL };
+		PyObject* rinchi_object;
+		PyObject* auxinfo_object;
+		const char* output_format = "RXN";
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|s:file_text_from_rinchi", const_cast<char**>(kwlist), &rinchi_object, &auxinfo_object, &output_format))
+			return NULL;
+
+		InputText rinchi_input, auxinfo_input;
+		if (!rinchi_input.acquire(rinchi_object, "rinchi_string") || !auxinfo_input.acquire(auxinfo_object, "rinchi_auxinfo"))
+			return NULL;
+
+		std::string format = output_format;
+		std::string file_text, error;
+		Py_BEGIN_ALLOW_THREADS
+		try {
+			rinchi::Reaction rxn;
+			rinchi::RInChIReader reader;
+			reader.split_into_reaction(
+				std::string(rinchi_input.data(), rinchi_input.length()), std::string(auxinfo_input.data(), auxinfo_input.length()), rxn
+			);
+
+			std::ostringstream file_text_stream;
+			if (format == "RD") {
+				rinchi::MdlRDfileWriter rd_writer;
+				rd_writer.write_reaction(rxn, file_text_stream);
+			}
+			else if (format == "RXN") {
+				rinchi::MdlRxnfileWriter rxn_writer;
+				rxn_writer.write_reaction(rxn, file_text_stream);
+			}
+			else
+				throw rinchi::RInChIError(std::string("Unsupported output file format '") + format + "'.");
+			file_text = file_text_stream.str();
+		}
+		catch (std::exception& e) {
+			error = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what();
+		}
+		Py_END_ALLOW_THREADS
+
+		if (!error.empty())
+			return set_rinchi_error(error);
+		return new_str(file_text);
+	}
+
+	PyObject* ext_rinchikey_from_rinchi(PyObject*, PyObject* args, PyObject* kwargs)
+	{
+		static const char* const kwlist[] = { "rinchi_string", "key_type", NULL };
+		PyObject* rinchi_object;
+		const char* key_type;
+		if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Os:rinchikey_from_rinchi", const_cast<char**>(kwlist), &rinchi_object, &key_type))
+			return NULL;
+
+		char key = key_selector(key_type);
+		if (!key)
+			return set_rinchi_error("Invalid key selector. 'key_type' parameter must be 'L'(ong), 'S'(hort) or W(eb).");
+		InputText rinchi_input;
+		if (!rinchi_input.acquire(rinchi_object, "rinchi_string"))
+			return NULL;
+
+		std::string result, error;
+		Py_BEGIN_ALLOW_THREADS
+		try {
+			// Cut input at first LF or CR/LF, as rinchilib_rinchikey_from_rinchi() does.
+			std::string rinchi_string(rinchi_input.data(), rinchi_input.length());
+			size_t lf_pos = rinchi_string.find('\n');
+			if (lf_pos != std::string::npos)
+				rinchi_string.erase(lf_pos);
+			if (!rinchi_string.empty() && rinchi_string.at(rinchi_string.length() - 1) == '\r')
+				rinchi_string.erase(rinchi_string.length() - 1);
+
+			rinchi::Reaction rxn;
+			rinchi::RInChIReader reader;
+			reader.split_into_reaction(rinchi_string, "", rxn);
+			switch (key) {
+				case 'L': result = rxn.rinchi_long_key(); break;
+				case 'S': result = rxn.rinchi_short_key(); break;
+				default:  result = rxn.rinchi_web_key();
+			}
+		}
+		catch (std::exception& e) {
+			error = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what();
+		}
+		Py_END_ALLOW_THREADS
+
+		if (!error.empty())
+			return set_rinchi_error(error);
+		return new_str(result);
+	}
+
+	PyMethodDef module_methods[] = {
+		{ "rinchi_from_file_text", (PyCFunction) (void(*)(void)) ext_rinchi_from_file_text, METH_VARARGS | METH_KEYWORDS,
+			"rinchi_from_file_text(file_text, input_format='AUTO', force_equilibrium=False) -> (rinchi_string, rinchi_auxinfo)" },
+		{ "rinchikey_from_file_text", (PyCFunction) (void(*)(void)) ext_rinchikey_from_file_text, METH_VARARGS | METH_KEYWORDS,
+			"rinchikey_from_file_text(file_text, key_type, input_format='AUTO', force_equilibrium=False) -> str\n\n"
+			"'key_type' is 'L'(ong), 'S'(hort) or 'W'(eb)." },
+		{ "all_from_file_text", (PyCFunction) (void(*)(void)) ext_all_from_file_text, METH_VARARGS | METH_KEYWORDS,
+			"all_from_file_text(file_text, outputs=OUTPUT_ALL, input_format='AUTO', force_equilibrium=False) -> dict\n\n"
+			"Returns the outputs selected by the OUTPUT_* flags in 'outputs', keyed 'rinchi_string',\n"
+			"'rinchi_auxinfo', 'long_key', 'short_key' and 'web_key'." },
+		{ "all_from_file_texts", (PyCFunction) (void(*)(void)) ext_all_from_file_texts, METH_VARARGS | METH_KEYWORDS,
+			"all_from_file_texts(file_texts, outputs=OUTPUT_ALL, input_format='AUTO', force_equilibrium=False, *,\n"
+			"                    threads=0, chunk_size=256, errors='raise') -> list\n\n"
+			"list(iall_from_file_texts(...))." },
+		{ "iall_from_file_texts", (PyCFunction) (void(*)(void)) ext_iall_from_file_texts, METH_VARARGS | METH_KEYWORDS,
+			"iall_from_file_texts(file_texts, outputs=OUTPUT_ALL, input_format='AUTO', force_equilibrium=False, *,\n"
+			"                     threads=0, chunk_size=256, errors='raise') -> iterator of dict\n\n"
+			"Like all_from_file_text() for every file text of the iterable 'file_texts', in order.\n"
+			"File texts are taken 'chunk_size' at a time and calculated on up to 'threads' threads\n"
+			"(0: one per hardware thread) with the GIL released. With errors='return', a file text\n"
+			"that fails yields an RInChIError instance instead of a dict." },
+		{ "iall_from_file", (PyCFunction) (void(*)(void)) ext_iall_from_file, METH_VARARGS | METH_KEYWORDS,
+			"iall_from_file(source, outputs=OUTPUT_ALL, force_equilibrium=False, *,\n"
+			"               threads=0, read_ahead=256, errors='raise') -> iterator of dict\n\n"
+			"Like all_from_file_text() for every reaction record of an RD file, in order. 'source' is\n"
+			"a path or a file object opened in binary or text mode; an RXN file gives one record.\n"
+			"At most 'read_ahead' records are read ahead of the one yielded, and calculated on up to\n"
+			"'threads' threads with the GIL released, so memory use does not grow with file size.\n"
+			"'errors' is as for iall_from_file_texts(); errors name the record and its first line." },
+		{ "file_text_from_rinchi", (PyCFunction) (void(*)(void)) ext_file_text_from_rinchi, METH_VARARGS | METH_KEYWORDS,
+			"file_text_from_rinchi(rinchi_string, rinchi_auxinfo, output_format='RXN') -> str" },
+		{ "rinchikey_from_rinchi", (PyCFunction) (void(*)(void)) ext_rinchikey_from_rinchi, METH_VARARGS | METH_KEYWORDS,
+			"rinchikey_from_rinchi(rinchi_string, key_type) -> str" },
+		{ NULL, NULL, 0, NULL }
+	};
+
+	PyModuleDef rinchi_ext_module = {
+		PyModuleDef_HEAD_INIT,
+		"rinchi_ext",
+		"RInChI calculation from Python without ctypes; batch functions run on a thread pool.",
+		-1,
+		module_methods,
+	};
+
+}
+
+PyMODINIT_FUNC PyInit_rinchi_ext(void)
+{
+	BatchIteratorType.tp_basicsize = sizeof(BatchIterator);
+	BatchIteratorType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC;
+	BatchIteratorType.tp_dealloc = batch_iterator_dealloc;
+	BatchIteratorType.tp_traverse = batch_iterator_traverse;
+	BatchIteratorType.tp_iter = PyObject_SelfIter;
+	BatchIteratorType.tp_iternext = batch_iterator_next;
+	if (PyType_Ready(&BatchIteratorType) < 0)
+		return NULL;
+
+	PyObject* module = PyModule_Create(&rinchi_ext_module);
+	if (!module)
+		return NULL;
+
+	rinchi_error = PyErr_NewException("rinchi_ext.RInChIError", NULL, NULL);
+	if (!rinchi_error || PyModule_AddObject(module, "RInChIError", rinchi_error) != 0) {
+		Py_XDECREF(rinchi_error);
+		Py_DECREF(module);
+		return NULL;
+	}
+	Py_INCREF(rinchi_error);
+
+	if (PyModule_AddIntConstant(module, "OUTPUT_RINCHI_STRING", OUTPUT_RINCHI_STRING) != 0 ||
+			PyModule_AddIntConstant(module, "OUTPUT_RAUXINFO", OUTPUT_RAUXINFO) != 0 ||
+			PyModule_AddIntConstant(module, "OUTPUT_LONG_KEY", OUTPUT_LONG_KEY) != 0 ||
+			PyModule_AddIntConstant(module, "OUTPUT_SHORT_KEY", OUTPUT_SHORT_KEY) != 0 ||
+			PyModule_AddIntConstant(module, "OUTPUT_WEB_KEY", OUTPUT_WEB_KEY) != 0 ||
+			PyModule_AddIntConstant(module, "OUTPUT_ALL", OUTPUT_ALL) != 0 ||
+			PyModule_AddStringConstant(module, "RINCHI_VERSION", rinchi::RINCHI_VERSION.c_str()) != 0) {
+		Py_DECREF(module);
+		return NULL;
+	}
+
+	return module;
+}
@@ -0,0 +1,117 @@
+#pragma region InChI-Trust Licence
+#/*
+# * Reaction International Chemical Identifier (RInChI)
+# * Version 1
+# * Software version 1.00
+# * 2022-01-14
+# * 
+# * The RInChI library and programs are free software developed under the
+# * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+# * 
+# * IUPAC/InChI-Trust Licence No.1.0 for the 
+# * Reaction International Chemical Identifier (RInChI) Software version 1.0
+# * Copyright (C) IUPAC and InChI Trust Limited
+# * 
+# * This library is free software; you can redistribute it and/or modify it 
+# * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+# * or any later version.
+# * 
+# * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+# * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+# * Licence for the International Chemical Identifier (InChI) Software
+# * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+# * for more details.
+# * 
+# * You should have received a copy of the IUPAC/InChI Trust InChI 
+# * Licence No. 1.0 with this library; if not, please write to:
+# * 
+# *     The InChI Trust
+# *     8 Cavendish Avenue
+# *     Cambridge CB1 7US
+# *     UK
+# *
+# * or email to: alan@inchi-trust.org.
+# *
+# */
+#pragma endregion
+
+# Builds the 'rinchi_ext' extension module from the RInChI and InChI sources, the same sources
+# that the rinchi_lib makefiles compile. Build in place with
+#
+#     python setup.py build_ext --inplace
+#
+# See BUILD.TXT.
+
+import os
+import sys
+
+from setuptools import Extension, setup
+
+INCHI_SRC = "../../../InChI/INCHI-1-SRC"
+INCHI_BASE = INCHI_SRC + "/INCHI_BASE/src"
+INCHI_API = INCHI_SRC + "/INCHI_API/libinchi/src"
+
+inchi_sources = [INCHI_BASE + "/" + name + ".c" for name in [
+    "ichi_bns", "ichi_io", "ichican2", "ichicano", "ichicans", "ichierr", "ichiprt3", "ichiisot",
+    "ichimake", "ichiqueu", "ichiring", "ichimap1", "ichimap2", "ichimap4", "ichimak2", "ichinorm",
+    "ichiparm", "ichiprt1", "ichiprt2", "ichirvr1", "ichirvr2", "ichirvr3", "ichirvr4", "ichirvr5",
+    "ichirvr6", "ichirvr7", "ichisort", "ichister", "ichitaut", "ikey_base26", "ikey_dll",
+    "mol_fmt1", "mol_fmt2", "mol_fmt3", "mol_fmt4", "readinch", "runichi", "runichi2", "runichi3",
+    "runichi4", "sha2", "strutil", "util", "mol2atom", "ichiread",
+]] + [INCHI_API + "/" + name + ".c" for name in [
+    "ichilnct", "inchi_dll", "inchi_dll_a", "inchi_dll_a2", "inchi_dll_b",
+]]
+
+rinchi_sources = [
+    "../lib/rinchi_utils.cpp",
+    "../lib/rinchi_hashing.cpp",
+    "../lib/rinchi_logger.cpp",
+    "../lib/inchi_api_intf.cpp",
+    "../lib/inchi_generator.cpp",
+    "../parsers/mdl_molfile.cpp",
+    "../parsers/mdl_molfile_reader.cpp",
+    "../parsers/mdl_rxnfile_reader.cpp",
+    "../parsers/mdl_rdfile_reader.cpp",
+    "../parsers/rinchi_reader.cpp",
+    "../parsers/inchi_auxinfo_reader.cpp",
+    "../writers/mdl_rxnfile_writer.cpp",
+    "../writers/mdl_rdfile_writer.cpp",
+    "../writers/mdl_molfile_writer.cpp",
+    "../rinchi/rinchi_reaction.cpp",
+    "../rinchi/rinchi_inchi_cache.cpp",
+    "../rinchi/rinchi_molecule.cpp",
+    "../rinchi/rinchi_result_cache.cpp",
+    "../rinchi/rinchi_consts.cpp",
+    "rinchi_ext.cpp",
+]
+
+if not os.path.isdir(INCHI_BASE):
+    sys.exit("InChI source code not found in '" + os.path.abspath(INCHI_SRC) + "'. See README.md.")
+
+if sys.platform == "win32":
+    inchi_cflags = []
+    cxxflags = ["/EHsc"]
+else:
+    inchi_cflags = ["-ansi", "-DCOMPILE_ANSI_ONLY", "-fPIC"]
+    cxxflags = ["-std=c++11", "-pthread", "-fvisibility=hidden"]
+
+setup(
+    name = "rinchi_ext",
+    version = "1.00",
+    # The InChI C sources need other flags than the C++ sources, so they go into a static library.
+    libraries = [("inchi", {
+        "sources": inchi_sources,
+        "include_dirs": [INCHI_BASE],
+        "macros": [("TARGET_API_LIB", None)],
+        "cflags": inchi_cflags,
+    })],
+    ext_modules = [Extension(
+        "rinchi_ext",
+        sources = rinchi_sources,
+        include_dirs = ["../lib", "../parsers", "../rinchi", "../writers", INCHI_BASE],
+        define_macros = [("TARGET_API_LIB", None)],
+        extra_compile_args = cxxflags,
+        extra_link_args = [] if sys.platform == "win32" else ["-pthread"],
+        language = "c++",
+    )],
+)
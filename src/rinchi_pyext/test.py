@@ -0,0 +1,143 @@
+#pragma region InChI-Trust Licence
+#/*
+# * Reaction International Chemical Identifier (RInChI)
+# * Version 1
+# * Software version 1.00
+# * 2022-01-14
+# * 
+# * The RInChI library and programs are free software developed under the
+# * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+# * 
+# * IUPAC/InChI-Trust Licence No.1.0 for the 
+# * Reaction International Chemical Identifier (RInChI) Software version 1.0
+# * Copyright (C) IUPAC and InChI Trust Limited
+# * 
+# * This library is free software; you can redistribute it and/or modify it 
+# * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+# * or any later version.
+# * 
+# * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+# * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+# * Licence for the International Chemical Identifier (InChI) Software
+# * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+# * for more details.
+# * 
+# * You should have received a copy of the IUPAC/InChI Trust InChI 
+# * Licence No. 1.0 with this library; if not, please write to:
+# * 
+# *     The InChI Trust
+# *     8 Cavendish Avenue
+# *     Cambridge CB1 7US
+# *     UK
+# *
+# * or email to: alan@inchi-trust.org.
+# *
+# */
+#pragma endregion
+
+# Run after building the extension in place (see BUILD.TXT):
+#     python setup.py build_ext --inplace
+#     python test.py
+
+import io
+import os
+import tempfile
+
+import rinchi_ext
+
+rxndata = open("../test/rxnfiles/R005a.rxn").read()
+rddata = open("../test/RDfiles/Example 01 CCR.rdf").read()
+
+print ("=== Single file texts ===")
+assert (rinchi_ext.rinchi_from_file_text(rxndata, "RXN") == (
+    'RInChI=1.00.1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1<>C4H9BrO/c1-3(5)4(2)6/h3-4,6H,1-2H3/t3-,4+/m1/s1!Na.H2O/h;1H2/q+1;/p-1/d-',
+    'RAuxInfo=1.00.1/0/N:4,1,3,2,5/E:(1,2)(3,4)/it:im/rA:5nCCCCO/rB:N1;s2;P3;s2s3;/rC:-1.127,-.5635,0;-.4125,-.151,0;.4125,-.151,0;1.127,-.5635,0;0,.5635,0;<>0/N:4,1,3,2,6,5/it:im/rA:6nCCCCOBr/rB:s1;s2;s3;N2;P3;/rC:-.825,-.7557,0;-.4125,-.0412,0;.4125,-.0412,0;.825,.6733,0;-.626,.7557,0;.825,-.7557,0;!1/N:1;2/rA:2nNaO/rB:s1;/rC:-.4125,0,0;.4125,0,0;',
+))
+assert (rinchi_ext.rinchikey_from_file_text(rddata, "L") ==
+    "Long-RInChIKey=SA-BUHFF-OCEYRUMTOAEWEA-UYRXBGFRSA-N--HRQNWWCYHJTAPI-UHFFFAOYSA-N--WEVYAHXRMPXWCK-UHFFFAOYSA-N-WGHUNMFFLAMBJD-UHFFFAOYSA-M")
+assert (rinchi_ext.rinchikey_from_file_text(rddata, "S", "RD") ==
+    "Short-RInChIKey=SA-BUHFF-OCEYRUMTOA-HRQNWWCYHJ-ANFMRDWEKN-NDGAC-NUHFF-MUHFF-ZZZ")
+assert (rinchi_ext.rinchikey_from_file_text(rddata, "W") ==
+    "Web-RInChIKey=YVHOQDQUXJQWHSZQW-MSWCGYDXJTZWXSA")
+
+# bytes, bytearray and memoryview input is read in place; it gives the same results as str.
+all_outputs = rinchi_ext.all_from_file_text(rxndata)
+assert (sorted(all_outputs.keys()) == ["long_key", "rinchi_auxinfo", "rinchi_string", "short_key", "web_key"])
+assert (all_outputs["rinchi_string"] == rinchi_ext.rinchi_from_file_text(rxndata)[0])
+assert (all_outputs["web_key"] == rinchi_ext.rinchikey_from_file_text(rxndata, "W"))
+rxnbytes = rxndata.encode("utf-8")
+for file_text in [rxnbytes, bytearray(rxnbytes), memoryview(rxnbytes)]:
+    assert (rinchi_ext.all_from_file_text(file_text) == all_outputs)
+assert (rinchi_ext.all_from_file_text(rxndata, rinchi_ext.OUTPUT_LONG_KEY | rinchi_ext.OUTPUT_WEB_KEY) == {
+    "long_key": all_outputs["long_key"],
+    "web_key": all_outputs["web_key"],
+})
+
+print ("=== RInChI back to file text ===")
+rxnfile = rinchi_ext.file_text_from_rinchi(all_outputs["rinchi_string"], all_outputs["rinchi_auxinfo"], "RXN")
+assert (rinchi_ext.rinchi_from_file_text(rxnfile)[0] == all_outputs["rinchi_string"])
+assert (rinchi_ext.rinchikey_from_rinchi(all_outputs["rinchi_string"] + "\n", "L") == all_outputs["long_key"])
+
+print ("=== Batches ===")
+file_texts = [rxndata, rddata] * 50
+expected = [rinchi_ext.all_from_file_text(file_text) for file_text in file_texts]
+assert (rinchi_ext.all_from_file_texts(file_texts) == expected)
+assert (rinchi_ext.all_from_file_texts(file_texts, threads=1) == expected)
+# Generators are consumed chunk by chunk.
+assert (list(rinchi_ext.iall_from_file_texts((file_text.encode("utf-8") for file_text in file_texts), chunk_size=7)) == expected)
+assert (rinchi_ext.all_from_file_texts([]) == [])
+
+# Many distinct reactions on several threads give the same keys as one at a time.
+distinct_texts = []
+for directory in ["../test/rxnfiles", "../test/RDfiles"]:
+    for name in sorted(os.listdir(directory)):
+        if name.endswith(".rxn") or name.endswith(".rdf"):
+            text = open(os.path.join(directory, name), "rb").read()
+            distinct_texts += [b"$RFMT" + record for record in text.split(b"$RFMT")[1:]] or [text]
+distinct_expected = []
+for file_text in distinct_texts:
+    try:
+        distinct_expected.append((file_text, rinchi_ext.all_from_file_text(file_text)))
+    except rinchi_ext.RInChIError:
+        pass
+assert (len(set(e["long_key"] for t, e in distinct_expected)) > 10)
+distinct_texts = [t for t, e in distinct_expected] * 10
+distinct_expected = [e for t, e in distinct_expected] * 10
+assert (rinchi_ext.all_from_file_texts(distinct_texts, threads=8) == distinct_expected)
+
+# A file text that fails raises RInChIError, or is returned as one with errors="return".
+try:
+    rinchi_ext.all_from_file_texts([rxndata, "Not a reaction", rxndata])
+    assert False, "No error raised as expected for an invalid file text."
+except rinchi_ext.RInChIError as e:
+    assert (str(e).startswith("File text 2: "))
+results = rinchi_ext.all_from_file_texts([rxndata, "Not a reaction", rxndata], rinchi_ext.OUTPUT_WEB_KEY, errors="return")
+assert (results[0] == results[2] == {"web_key": all_outputs["web_key"]})
+assert (isinstance(results[1], rinchi_ext.RInChIError))
+try:
+    rinchi_ext.all_from_file_texts([rxndata, 42])
+    assert False, "No error raised as expected for a file text that is not a string."
+except TypeError:
+    pass
+
+print ("=== RD files record by record ===")
+# An RD file of many records, the two records of rddata over and over.
+records = ["$RFMT" + record for record in rddata.split("$RFMT")[1:]]
+rdfile = tempfile.NamedTemporaryFile("w", suffix = ".rdf", delete = False)
+rdfile.write(rddata[:rddata.index("$RFMT")] + "".join(records * 25))
+rdfile.close()
+expected = [rinchi_ext.all_from_file_text(record) for record in records * 25]
+assert (list(rinchi_ext.iall_from_file(rdfile.name, read_ahead = 8)) == expected)
+with open(rdfile.name, "rb") as f:
+    assert (list(rinchi_ext.iall_from_file(f, threads = 2)) == expected)
+with open(rdfile.name) as f:
+    assert (list(rinchi_ext.iall_from_file(f, rinchi_ext.OUTPUT_WEB_KEY)) == [{"web_key": e["web_key"]} for e in expected])
+os.remove(rdfile.name)
+# An RXN file is a single record.
+assert (list(rinchi_ext.iall_from_file(io.StringIO(rxndata))) == [all_outputs])
+
+results = list(rinchi_ext.iall_from_file(io.StringIO(rddata.replace("$RXN", "$RXX", 1)), errors = "return"))
+assert (isinstance(results[0], rinchi_ext.RInChIError) and str(results[0]).startswith("Record 1 (line 3): "))
+assert (results[1] == rinchi_ext.all_from_file_text(records[1]))
+
+print ("All tests passed.")
@@ -0,0 +1,867 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+/**
+  Loadable SQLite extension. Registers
+
+    - scalar functions for single reactions, with the function surface of the Oracle cartridge:
+        rinchi_from_rxn(file_text [, input_format [, force_equilibrium]])
+        rinchi_auxinfo_from_rxn(file_text [, input_format [, force_equilibrium]])
+        rinchi_key(file_text, key_type [, input_format [, force_equilibrium]])
+        rinchikey_from_rinchi(rinchi_string, key_type)
+        rinchi_from_inchis(reactant_inchis, product_inchis [, agent_inchis])
+        rinchikey_from_inchis(reactant_inchis, product_inchis, agent_inchis, key_type)
+        file_from_rinchi(rinchi_string [, rinchi_auxinfo [, output_format]])
+        rinchi_version()
+
+    - the table-valued function rinchi_rdfile(path [, force_equilibrium [, threads [, batch_size]]])
+      that reads an RD file record by record and returns one row per reaction:
+        record, line, file_text, rinchi_string, rinchi_auxinfo, long_key, short_key, web_key, error
+
+  rinchi_rdfile() reads and calculates 'batch_size' records at a time on a thread pool of its
+  own, one reaction per thread. The next batch is calculated while SQLite steps through the rows
+  of the current one, so that
+
+      INSERT INTO reactions SELECT file_text, rinchi_string, long_key FROM rinchi_rdfile('big.rdf');
+
+  keeps all cores busy. Only the columns that the statement uses are calculated. A record that
+  fails gives a row with only 'error' set, and does not stop the statement.
+
+  See BUILD.TXT for how to build and load it and test.py for usage.
+**/
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <istream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <typeinfo>
+#include <vector>
+
+#include <sqlite3ext.h>
+SQLITE_EXTENSION_INIT1
+
+#include "rinchi_platform.h"
+#include "rinchi_utils.h"
+#include "rinchi_parallel.h"
+
+#include "rinchi_consts.h"
+#include "rinchi_reaction.h"
+#include "rinchi_result_cache.h"
+
+#include "mdl_rxnfile.h"
+#include "mdl_rxnfile_reader.h"
+#include "mdl_rdfile_reader.h"
+
+#include "rinchi_reader.h"
+#include "mdl_rxnfile_writer.h"
+#include "mdl_rdfile_writer.h"
+
+// Control external symbol export on Linux. NOTE: Requires that all files are compiled
+// with '-fvisibility=hidden' to have an effect.
+// On Windows we don't need to do this as symbols are explicitly exported by the .DEF file.
+#ifdef ON_LINUX
+	#define API_EXPORT __attribute__((visibility("default")))
+#else
+	#define API_EXPORT
+#endif
+
+// Older SQLite versions lack the flag; functions are then just not marked as deterministic.
+#ifndef SQLITE_DETERMINISTIC
+	#define SQLITE_DETERMINISTIC 0
+#endif
+
+namespace {
+
+	// Same values as RINCHI_OUTPUT_* in rinchi_lib.h.
+	const int OUTPUT_RINCHI_STRING = 1;
+	const int OUTPUT_RAUXINFO = 2;
+	const int OUTPUT_LONG_KEY = 4;
+	const int OUTPUT_SHORT_KEY = 8;
+	const int OUTPUT_WEB_KEY = 16;
+	const int OUTPUT_ALL = 31;
+
+	const int DEFAULT_BATCH_SIZE = 256;
+
+	const char* INVALID_KEY_SELECTOR_MESSAGE = "rinchi::RInChIError: Invalid key selector. 'key_type' parameter must be 'L'(ong), 'S'(hort) or W(eb).";
+
+	struct FileTextOptions {
+		std::string input_format;
+		bool force_equilibrium;
+		int outputs;
+		// Passed to Reaction::set_max_inchi_threads(). Batches calculate one reaction per thread.
+		unsigned max_inchi_threads;
+
+		FileTextOptions(): input_format("AUTO"), force_equilibrium(false), outputs(OUTPUT_ALL), max_inchi_threads(0) {}
+	};
+
+	// Outcome of one file text. 'error' is set instead of 'result' if it failed.
+	struct FileTextResult {
+		rinchi::ReactionResult result;
+		std::string error;
+		bool failed;
+
+		FileTextResult(): failed(false) {}
+	};
+
+	void load_reaction(const char* data, size_t length, const FileTextOptions& options, rinchi::Reaction& rxn)
+	{
+		rinchi::MemoryStreamBuffer buffer(data, length);
+		std::istream file_text_stream(&buffer);
+
+		std::string file_format = options.input_format;
+		if (file_format.empty() || file_format == "AUTO") {
+			std::string first_line;
+			rinchi::rinchi_getline(file_text_stream, first_line);
+			file_text_stream.clear();
+			file_text_stream.seekg(0);
+			file_format = first_line == rinchi::MDL_TAG_RXN_BEGIN ? "RXN" : "RD";
+		}
+
+		if (file_format == "RD") {
+			rinchi::MdlRDfileReader rd_reader;
+			rd_reader.read_reaction(file_text_stream, rxn, options.force_equilibrium);
+		}
+		else if (file_format == "RXN") {
+			rinchi::MdlRxnfileReader rxn_reader;
+			rxn_reader.read_reaction(file_text_stream, rxn, options.force_equilibrium);
+		}
+		else
+			throw rinchi::RInChIError(std::string("Unsupported input file format '") + file_format + "'.");
+	}
+
+	// Never throws.
+	void calculate(const char* data, size_t length, const FileTextOptions& options, FileTextResult& outcome)
+	{
+		try {
+			bool need_auxinfo = (options.outputs & OUTPUT_RAUXINFO) != 0;
+			rinchi::Reaction rxn;
+			rxn.set_omit_auxinfo(!need_auxinfo);
+			rxn.set_max_inchi_threads(options.max_inchi_threads);
+			load_reaction(data, length, options, rxn);
+
+			rinchi::ReactionResult& result = outcome.result;
+			if (options.outputs & OUTPUT_RINCHI_STRING)
+				result.rinchi_string = rxn.rinchi_string();
+			if (need_auxinfo)
+				result.rinchi_auxinfo = rxn.rinchi_auxinfo();
+			result.has_auxinfo = need_auxinfo;
+			if (options.outputs & OUTPUT_LONG_KEY)
+				result.long_key = rxn.rinchi_long_key();
+			if (options.outputs & OUTPUT_SHORT_KEY)
+				result.short_key = rxn.rinchi_short_key();
+			if (options.outputs & OUTPUT_WEB_KEY)
+				result.web_key = rxn.rinchi_web_key();
+		}
+		catch (std::exception& e) {
+			outcome.failed = true;
+			outcome.error = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what();
+		}
+	}
+
+	char key_selector(const char* key_type)
+	{
+		if (!key_type || (strcmp(key_type, "L") != 0 && strcmp(key_type, "S") != 0 && strcmp(key_type, "W") != 0))
+			return 0;
+		return *key_type;
+	}
+
+	int key_output(char key_type)
+	{
+		switch (key_type) {
+			case 'L': return OUTPUT_LONG_KEY;
+			case 'S': return OUTPUT_SHORT_KEY;
+			default:  return OUTPUT_WEB_KEY;
+		}
+	}
+
+	const std::string& select_key(const rinchi::ReactionResult& result, char key_type)
+	{
+		switch (key_type) {
+			case 'L': return result.long_key;
+			case 'S': return result.short_key;
+			default:  return result.web_key;
+		}
+	}
+
+	std::string reaction_key(rinchi::Reaction& rxn, char key_type)
+	{
+		switch (key_type) {
+			case 'L': return rxn.rinchi_long_key();
+			case 'S': return rxn.rinchi_short_key();
+			default:  return rxn.rinchi_web_key();
+		}
+	}
+
+
+	/**
+	  Scalar functions.
+	**/
+
+	// Text of an optional argument, or 'default_value' if it is missing or NULL.
+	std::string text_arg(int argc, sqlite3_value** argv, int idx, const char* default_value)
+	{
+		if (idx >= argc || sqlite3_value_type(argv[idx]) == SQLITE_NULL)
+			return default_value;
+		const char* text = (const char*) sqlite3_value_text(argv[idx]);
+		return std::string(text ? text : "", sqlite3_value_bytes(argv[idx]));
+	}
+
+	void set_text_result(sqlite3_context* ctx, const std::string& value)
+	{
+		sqlite3_result_text(ctx, value.data(), (int) value.length(), SQLITE_TRANSIENT);
+	}
+
+	void set_error_result(sqlite3_context* ctx, const std::string& message)
+	{
+		sqlite3_result_error(ctx, message.data(), (int) message.length());
+	}
+
+	// The file text of rinchi_from_rxn() and friends: arguments are (file_text, [key_type,] input_format, force_equilibrium).
+	// Returns false, with the result set to NULL, for a NULL file text.
+	bool calculate_file_text(sqlite3_context* ctx, int argc, sqlite3_value** argv, int options_idx, int outputs, rinchi::ReactionResult& result)
+	{
+		if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+			sqlite3_result_null(ctx);
+			return false;
+		}
+		FileTextOptions options;
+		options.input_format = text_arg(argc, argv, options_idx, "AUTO");
+		options.force_equilibrium = options_idx + 1 < argc && sqlite3_value_int(argv[options_idx + 1]) != 0;
+		options.outputs = outputs;
+
+		// sqlite3_value_text() before sqlite3_value_bytes(), so that the length is that of the text.
+		const char* data = (const char*) sqlite3_value_text(argv[0]);
+		FileTextResult outcome;
+		calculate(data ? data : "", sqlite3_value_bytes(argv[0]), options, outcome);
+		if (outcome.failed) {
+			set_error_result(ctx, outcome.error);
+			return false;
+		}
+		result = outcome.result;
+		return true;
+	}
+
+	void sql_rinchi_from_rxn(sqlite3_context* ctx, int argc, sqlite3_value** argv)
+	{
+		rinchi::ReactionResult result;
+		if (calculate_file_text(ctx, argc, argv, 1, OUTPUT_RINCHI_STRING, result))
+			set_text_result(ctx, result.rinchi_string);
+	}
+
+	void sql_rinchi_auxinfo_from_rxn(sqlite3_context* ctx, int argc, sqlite3_value** argv)
+	{
+		rinchi::ReactionResult result;
+		if (calculate_file_text(ctx, argc, argv, 1, OUTPUT_RAUXINFO, result))
+			set_text_result(ctx, result.rinchi_auxinfo);
+	}
+
+	void sql_rinchi_key(sqlite3_context* ctx, int argc, sqlite3_value** argv)
+	{
+		char key = key_selector((const char*) sqlite3_value_text(argv[1]));
+		if (!key) {
+			sqlite3_result_error(ctx, INVALID_KEY_SELECTOR_MESSAGE, -1);
+			return;
+		}
+		rinchi::ReactionResult result;
+		if (calculate_file_text(ctx, argc, argv, 2, key_output(key), result))
+			set_text_result(ctx, select_key(result, key));
+	}
+
+	void sql_rinchikey_from_rinchi(sqlite3_context* ctx, int, sqlite3_value** argv)
+	{
+		char key = key_selector((const char*) sqlite3_value_text(argv[1]));
+		if (!key) {
+			sqlite3_result_error(ctx, INVALID_KEY_SELECTOR_MESSAGE, -1);
+			return;
+		}
+		if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+			sqlite3_result_null(ctx);
+			return;
+		}
+		try {
+			// Cut input at first LF or CR/LF, as rinchilib_rinchikey_from_rinchi() does.
+			std::string rinchi_string = text_arg(1, argv, 0, "");
+			size_t lf_pos = rinchi_string.find('\n');
+			if (lf_pos != std::string::npos)
+				rinchi_string.erase(lf_pos);
+			if (!rinchi_string.empty() && rinchi_string.at(rinchi_string.length() - 1) == '\r')
+				rinchi_string.erase(rinchi_string.length() - 1);
+
+			rinchi::Reaction rxn;
+			rinchi::RInChIReader reader;
+			reader.split_into_reaction(rinchi_string, "", rxn);
+			set_text_result(ctx, reaction_key(rxn, key));
+		}
+		catch (std::exception& e) {
+			set_error_result(ctx, rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what());
+		}
+	}
+
+	// Reaction from the InChI lists of rinchi_from_inchis() and rinchikey_from_inchis(), see
+	// RInChIReader::add_inchis_to_reaction(). NULL lists are empty.
+	void load_inchis(int argc, sqlite3_value** argv, rinchi::Reaction& rxn)
+	{
+		rinchi::RInChIReader reader;
+		reader.add_inchis_to_reaction(text_arg(argc, argv, 0, ""), text_arg(argc, argv, 1, ""), text_arg(argc, argv, 2, ""), rxn);
+	}
+
+	void sql_rinchi_from_inchis(sqlite3_context* ctx, int argc, sqlite3_value** argv)
+	{
+		try {
+			rinchi::Reaction rxn;
+			rxn.set_omit_auxinfo(true);
+			load_inchis(argc, argv, rxn);
+			set_text_result(ctx, rxn.rinchi_string());
+		}
+		catch (std::exception& e) {
+			set_error_result(ctx, rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what());
+		}
+	}
+
+	void sql_rinchikey_from_inchis(sqlite3_context* ctx, int, sqlite3_value** argv)
+	{
+		char key = key_selector((const char*) sqlite3_value_text(argv[3]));
+		if (!key) {
+			sqlite3_result_error(ctx, INVALID_KEY_SELECTOR_MESSAGE, -1);
+			return;
+		}
+		try {
+			rinchi::Reaction rxn;
+			rxn.set_omit_auxinfo(true);
+			load_inchis(3, argv, rxn);
+			set_text_result(ctx, reaction_key(rxn, key));
+		}
+		catch (std::exception& e) {
+			set_error_result(ctx, rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what());
+		}
+	}
+
+	void sql_file_from_rinchi(sqlite3_context* ctx, int argc, sqlite3_value** argv)
+	{
+		if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+			sqlite3_result_null(ctx);
+			return;
+		}
+		try {
+			rinchi::Reaction rxn;
+			rinchi::RInChIReader reader;
+			reader.split_into_reaction(text_arg(argc, argv, 0, ""), text_arg(argc, argv, 1, ""), rxn);
+
+			std::string output_format = text_arg(argc, argv, 2, "RXN");
+			std::ostringstream file_text_stream;
+			if (output_format == "RD") {
+				rinchi::MdlRDfileWriter rd_writer;
+				rd_writer.write_reaction(rxn, file_text_stream);
+			}
+			else if (output_format == "RXN") {
+				rinchi::MdlRxnfileWriter rxn_writer;
+				rxn_writer.write_reaction(rxn, file_text_stream);
+			}
+			else
+				throw rinchi::RInChIError(std::string("Unsupported output file format '") + output_format + "'.");
+			set_text_result(ctx, file_text_stream.str());
+		}
+		catch (std::exception& e) {
+			set_error_result(ctx, rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what());
+		}
+	}
+
+	void sql_rinchi_version(sqlite3_context* ctx, int, sqlite3_value**)
+	{
+		set_text_result(ctx, rinchi::RINCHI_VERSION);
+	}
+
+	struct ScalarFunction {
+		const char* name;
+		int min_args;
+		int max_args;
+		void (*function)(sqlite3_context*, int, sqlite3_value**);
+	};
+
+	const ScalarFunction SCALAR_FUNCTIONS[] = {
+		{ "rinchi_from_rxn",         1, 3, sql_rinchi_from_rxn },
+		{ "rinchi_auxinfo_from_rxn", 1, 3, sql_rinchi_auxinfo_from_rxn },
+		{ "rinchi_key",              2, 4, sql_rinchi_key },
+		{ "rinchikey_from_rinchi",   2, 2, sql_rinchikey_from_rinchi },
+		{ "rinchi_from_inchis",      2, 3, sql_rinchi_from_inchis },
+		{ "rinchikey_from_inchis",   4, 4, sql_rinchikey_from_inchis },
+		{ "file_from_rinchi",        1, 3, sql_file_from_rinchi },
+		{ "rinchi_version",          0, 0, sql_rinchi_version },
+	};
+
+
+	/**
+	  rinchi_rdfile() table-valued function.
+	**/
+
+	enum RDfileColumn {
+		COLUMN_RECORD,
+		COLUMN_LINE,
+		COLUMN_FILE_TEXT,
+		COLUMN_RINCHI_STRING,
+		COLUMN_RAUXINFO,
+		COLUMN_LONG_KEY,
+		COLUMN_SHORT_KEY,
+		COLUMN_WEB_KEY,
+		COLUMN_ERROR,
+		// Hidden columns: the arguments of rinchi_rdfile(), in order.
+		COLUMN_PATH,
+		COLUMN_FORCE_EQUILIBRIUM,
+		COLUMN_THREADS,
+		COLUMN_BATCH_SIZE,
+	};
+
+	const int FIRST_ARGUMENT_COLUMN = COLUMN_PATH;
+	const int ARGUMENT_COUNT = 4;
+
+	const char* RDFILE_SCHEMA =
+		"CREATE TABLE x(record INTEGER, line INTEGER, file_text TEXT, rinchi_string TEXT, rinchi_auxinfo TEXT, "
+		"long_key TEXT, short_key TEXT, web_key TEXT, error TEXT, "
+		"path HIDDEN, force_equilibrium HIDDEN, threads HIDDEN, batch_size HIDDEN)";
+
+	// The output that each result column needs, if any.
+	int column_output(int column)
+	{
+		switch (column) {
+			case COLUMN_RINCHI_STRING: return OUTPUT_RINCHI_STRING;
+			case COLUMN_RAUXINFO:      return OUTPUT_RAUXINFO;
+			case COLUMN_LONG_KEY:      return OUTPUT_LONG_KEY;
+			case COLUMN_SHORT_KEY:     return OUTPUT_SHORT_KEY;
+			case COLUMN_WEB_KEY:       return OUTPUT_WEB_KEY;
+			default:                   return 0;
+		}
+	}
+
+	struct RDfileRecord {
+		std::string file_text;
+		int line;
+		FileTextResult outcome;
+
+		RDfileRecord(): line(0) {}
+	};
+
+	struct RecordBatch {
+		std::vector<RDfileRecord> records;
+		// Set if the file could not be split into records; the batch is the last one then.
+		std::string error;
+	};
+
+	/**
+	  Reads and calculates the batches of an RD file. While the records of one batch are
+	  returned by take(), the next one is read and calculated in the background.
+	**/
+	class RecordPipeline {
+		private:
+			std::filebuf m_file;
+			std::istream m_stream;
+			rinchi::MdlRDfileRecordReader m_records;
+			FileTextOptions m_options;
+			unsigned m_thread_count;
+			size_t m_batch_size;
+			bool m_at_end;
+			// Stops the batch in the background when the cursor is closed early.
+			std::atomic<bool> m_cancelled;
+
+			RecordBatch m_next;
+			std::future<void> m_pending;
+
+			// Reads up to 'm_batch_size' records into 'm_next' and calculates them.
+			void fill_next()
+			{
+				try {
+					std::string file_text;
+					while (m_next.records.size() < m_batch_size && m_records.next_record(file_text)) {
+						m_next.records.push_back(RDfileRecord());
+						m_next.records.back().file_text.swap(file_text);
+						m_next.records.back().line = m_records.record_line_number();
+					}
+				}
+				catch (std::exception& e) {
+					m_next.error = rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what();
+				}
+				calculate_all(m_next.records);
+			}
+
+			// Calculates all of 'records' on up to 'm_thread_count' threads.
+			void calculate_all(std::vector<RDfileRecord>& records)
+			{
+				rinchi::parallel_for(records.size(), m_thread_count, [&](size_t idx) {
+					if (!m_cancelled)
+						calculate(records[idx].file_text.data(), records[idx].file_text.length(), m_options, records[idx].outcome);
+				});
+			}
+
+			void start_next()
+			{
+				m_next = RecordBatch();
+				try {
+					m_pending = std::async(std::launch::async, [this]() { fill_next(); });
+				}
+				catch (std::system_error&) {
+					// No thread for the background; take() reads the batch itself.
+					m_pending = std::future<void>();
+				}
+			}
+
+		public:
+			RecordPipeline(const FileTextOptions& options, unsigned thread_count, size_t batch_size):
+				m_stream(&m_file), m_records(m_stream), m_options(options), m_thread_count(thread_count), m_batch_size(batch_size), m_at_end(false), m_cancelled(false)
+			{
+				if (m_thread_count == 0)
+					m_thread_count = std::max(1u, std::thread::hardware_concurrency());
+				// Batches calculate one reaction per thread.
+				m_options.max_inchi_threads = 1;
+			}
+
+			~RecordPipeline()
+			{
+				m_cancelled = true;
+				if (m_pending.valid())
+					m_pending.wait();
+			}
+
+			bool open(const std::string& path)
+			{
+				if (!m_file.open(path.c_str(), std::ios::in | std::ios::binary))
+					return false;
+				start_next();
+				return true;
+			}
+
+			// Returns the next batch in 'batch', which is empty at the end of the file.
+			void take(RecordBatch& batch)
+			{
+				if (m_at_end) {
+					batch = RecordBatch();
+					return;
+				}
+				if (m_pending.valid())
+					m_pending.get();
+				else
+					fill_next();
+				batch = std::move(m_next);
+
+				m_at_end = batch.records.size() < m_batch_size || !batch.error.empty();
+				if (!m_at_end)
+					start_next();
+			}
+	};
+
+	struct RDfileTable: sqlite3_vtab {
+	};
+
+	struct RDfileCursor: sqlite3_vtab_cursor {
+		// Arguments of rinchi_rdfile().
+		std::string path;
+		bool force_equilibrium;
+		int threads;
+		int batch_size;
+
+		std::unique_ptr<RecordPipeline> pipeline;
+		RecordBatch batch;
+		size_t batch_idx;
+		// Records before the current batch.
+		sqlite3_int64 batch_start;
+
+		RDfileCursor(): force_equilibrium(false), threads(0), batch_size(DEFAULT_BATCH_SIZE), batch_idx(0), batch_start(0) {}
+
+		bool at_end() const { return batch_idx >= batch.records.size(); }
+		const RDfileRecord& record() const { return batch.records[batch_idx]; }
+	};
+
+	int set_vtab_error(sqlite3_vtab* vtab, const std::string& message)
+	{
+		sqlite3_free(vtab->zErrMsg);
+		vtab->zErrMsg = sqlite3_mprintf("%s", message.c_str());
+		return SQLITE_ERROR;
+	}
+
+	int rdfile_connect(sqlite3* db, void*, int, const char* const*, sqlite3_vtab** out_vtab, char**)
+	{
+		int rc = sqlite3_declare_vtab(db, RDFILE_SCHEMA);
+		if (rc != SQLITE_OK)
+			return rc;
+		RDfileTable* table = new (std::nothrow) RDfileTable();
+		if (!table)
+			return SQLITE_NOMEM;
+		*out_vtab = table;
+		return SQLITE_OK;
+	}
+
+	int rdfile_disconnect(sqlite3_vtab* vtab)
+	{
+		delete static_cast<RDfileTable*>(vtab);
+		return SQLITE_OK;
+	}
+
+	/**
+	  'idxNum' passes on to rdfile_filter() which arguments are given, one bit per argument from
+	  COLUMN_PATH on, and in the bits above those the outputs of the columns that are used.
+	**/
+	int rdfile_best_index(sqlite3_vtab*, sqlite3_index_info* info)
+	{
+		int argument_constraints[ARGUMENT_COUNT];
+		for (int i = 0; i < ARGUMENT_COUNT; i++)
+			argument_constraints[i] = -1;
+
+		for (int i = 0; i < info->nConstraint; i++) {
+			const sqlite3_index_info::sqlite3_index_constraint& constraint = info->aConstraint[i];
+			int argument = constraint.iColumn - FIRST_ARGUMENT_COLUMN;
+			if (argument < 0 || argument >= ARGUMENT_COUNT)
+				continue;
+			// An argument that cannot be used yet, e.g. from a table later in a join, rules out this plan.
+			if (!constraint.usable)
+				return SQLITE_CONSTRAINT;
+			if (constraint.op == SQLITE_INDEX_CONSTRAINT_EQ)
+				argument_constraints[argument] = i;
+		}
+		if (argument_constraints[0] < 0)
+			return SQLITE_CONSTRAINT;
+
+		int arguments = 0;
+		int argv_idx = 0;
+		for (int i = 0; i < ARGUMENT_COUNT; i++) {
+			if (argument_constraints[i] < 0)
+				continue;
+			arguments |= 1 << i;
+			info->aConstraintUsage[argument_constraints[i]].argvIndex = ++argv_idx;
+			info->aConstraintUsage[argument_constraints[i]].omit = 1;
+		}
+
+		int outputs = OUTPUT_ALL;
+		// sqlite3_index_info::colUsed is there from SQLite 3.10.0 on.
+		if (sqlite3_libversion_number() >= 3010000) {
+			outputs = 0;
+			for (int column = COLUMN_RINCHI_STRING; column <= COLUMN_WEB_KEY; column++) {
+				if (info->colUsed & ((sqlite3_uint64) 1 << column))
+					outputs |= column_output(column);
+			}
+		}
+		info->idxNum = arguments | (outputs << ARGUMENT_COUNT);
+		info->estimatedCost = 1e6;
+		return SQLITE_OK;
+	}
+
+	int rdfile_open(sqlite3_vtab*, sqlite3_vtab_cursor** out_cursor)
+	{
+		RDfileCursor* cursor = new (std::nothrow) RDfileCursor();
+		if (!cursor)
+			return SQLITE_NOMEM;
+		*out_cursor = cursor;
+		return SQLITE_OK;
+	}
+
+	int rdfile_close(sqlite3_vtab_cursor* cursor)
+	{
+		delete static_cast<RDfileCursor*>(cursor);
+		return SQLITE_OK;
+	}
+
+	// Moves to the next batch if the current one is done.
+	int rdfile_fill(RDfileCursor* cursor)
+	{
+		if (!cursor->at_end())
+			return SQLITE_OK;
+		if (!cursor->batch.error.empty())
+			return set_vtab_error(cursor->pVtab, "Cannot read RD file '" + cursor->path + "': " + cursor->batch.error);
+
+		cursor->batch_start += cursor->batch.records.size();
+		try {
+			cursor->pipeline->take(cursor->batch);
+		}
+		catch (std::exception& e) {
+			return set_vtab_error(cursor->pVtab, rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what());
+		}
+		cursor->batch_idx = 0;
+		// A batch that ends in an error may still have the records before it.
+		if (cursor->at_end() && !cursor->batch.error.empty())
+			return set_vtab_error(cursor->pVtab, "Cannot read RD file '" + cursor->path + "': " + cursor->batch.error);
+		return SQLITE_OK;
+	}
+
+	int rdfile_filter(sqlite3_vtab_cursor* base, int idx_num, const char*, int, sqlite3_value** argv)
+	{
+		RDfileCursor* cursor = static_cast<RDfileCursor*>(base);
+		cursor->pipeline.reset();
+		cursor->batch = RecordBatch();
+		cursor->batch_idx = 0;
+		cursor->batch_start = 0;
+
+		int argv_idx = 0;
+		sqlite3_value* arguments[ARGUMENT_COUNT] = {};
+		for (int i = 0; i < ARGUMENT_COUNT; i++) {
+			if (idx_num & (1 << i))
+				arguments[i] = argv[argv_idx++];
+		}
+		if (!arguments[0] || sqlite3_value_type(arguments[0]) == SQLITE_NULL)
+			return set_vtab_error(cursor->pVtab, "rinchi_rdfile() needs the path of an RD file.");
+		cursor->path = (const char*) sqlite3_value_text(arguments[0]);
+		cursor->force_equilibrium = arguments[1] && sqlite3_value_int(arguments[1]) != 0;
+		cursor->threads = arguments[2] ? sqlite3_value_int(arguments[2]) : 0;
+		cursor->batch_size = arguments[3] ? sqlite3_value_int(arguments[3]) : DEFAULT_BATCH_SIZE;
+		if (cursor->threads < 0)
+			return set_vtab_error(cursor->pVtab, "rinchi_rdfile(): 'threads' must not be negative.");
+		if (cursor->batch_size < 1)
+			return set_vtab_error(cursor->pVtab, "rinchi_rdfile(): 'batch_size' must be at least 1.");
+
+		FileTextOptions options;
+		options.input_format = "RD";
+		options.force_equilibrium = cursor->force_equilibrium;
+		options.outputs = idx_num >> ARGUMENT_COUNT;
+		try {
+			cursor->pipeline.reset(new RecordPipeline(options, cursor->threads, cursor->batch_size));
+			if (!cursor->pipeline->open(cursor->path))
+				return set_vtab_error(cursor->pVtab, "Cannot open RD file '" + cursor->path + "'.");
+		}
+		catch (std::exception& e) {
+			return set_vtab_error(cursor->pVtab, rinchi::demangled_class_name(typeid(e).name()) + ": " + e.what());
+		}
+		return rdfile_fill(cursor);
+	}
+
+	int rdfile_next(sqlite3_vtab_cursor* base)
+	{
+		RDfileCursor* cursor = static_cast<RDfileCursor*>(base);
+		cursor->batch_idx++;
+		return rdfile_fill(cursor);
+	}
+
+	int rdfile_eof(sqlite3_vtab_cursor* base)
+	{
+		return static_cast<RDfileCursor*>(base)->at_end();
+	}
+
+	int rdfile_column(sqlite3_vtab_cursor* base, sqlite3_context* ctx, int column)
+	{
+		const RDfileCursor* cursor = static_cast<RDfileCursor*>(base);
+		const RDfileRecord& record = cursor->record();
+		const rinchi::ReactionResult& result = record.outcome.result;
+
+		// Outputs are NULL for a record that failed.
+		if (record.outcome.failed && column_output(column) != 0) {
+			sqlite3_result_null(ctx);
+			return SQLITE_OK;
+		}
+		switch (column) {
+			case COLUMN_RECORD:            sqlite3_result_int64(ctx, cursor->batch_start + cursor->batch_idx + 1); break;
+			case COLUMN_LINE:              sqlite3_result_int(ctx, record.line); break;
+			case COLUMN_FILE_TEXT:         set_text_result(ctx, record.file_text); break;
+			case COLUMN_RINCHI_STRING:     set_text_result(ctx, result.rinchi_string); break;
+			case COLUMN_RAUXINFO:          set_text_result(ctx, result.rinchi_auxinfo); break;
+			case COLUMN_LONG_KEY:          set_text_result(ctx, result.long_key); break;
+			case COLUMN_SHORT_KEY:         set_text_result(ctx, result.short_key); break;
+			case COLUMN_WEB_KEY:           set_text_result(ctx, result.web_key); break;
+			case COLUMN_ERROR:
+				if (record.outcome.failed)
+					set_text_result(ctx, record.outcome.error);
+				else
+					sqlite3_result_null(ctx);
+				break;
+			case COLUMN_PATH:              set_text_result(ctx, cursor->path); break;
+			case COLUMN_FORCE_EQUILIBRIUM: sqlite3_result_int(ctx, cursor->force_equilibrium); break;
+			case COLUMN_THREADS:           sqlite3_result_int(ctx, cursor->threads); break;
+			case COLUMN_BATCH_SIZE:        sqlite3_result_int(ctx, cursor->batch_size); break;
+		}
+		return SQLITE_OK;
+	}
+
+	int rdfile_rowid(sqlite3_vtab_cursor* base, sqlite3_int64* out_rowid)
+	{
+		const RDfileCursor* cursor = static_cast<RDfileCursor*>(base);
+		*out_rowid = cursor->batch_start + cursor->batch_idx + 1;
+		return SQLITE_OK;
+	}
+
+	sqlite3_module make_rdfile_module()
+	{
+		sqlite3_module module;
+		memset(&module, 0, sizeof(module));
+		// No xCreate: an eponymous-only virtual table, there is no CREATE VIRTUAL TABLE for it.
+		module.xConnect = rdfile_connect;
+		module.xBestIndex = rdfile_best_index;
+		module.xDisconnect = rdfile_disconnect;
+		module.xOpen = rdfile_open;
+		module.xClose = rdfile_close;
+		module.xFilter = rdfile_filter;
+		module.xNext = rdfile_next;
+		module.xEof = rdfile_eof;
+		module.xColumn = rdfile_column;
+		module.xRowid = rdfile_rowid;
+		return module;
+	}
+
+	const sqlite3_module RDFILE_MODULE = make_rdfile_module();
+
+} // end of anonymous namespace
+
+extern "C" {
+
+	/**
+	  Entry point, found by SQLite from the library name: load it with
+	  ".load ./librinchi_sqlite" in the sqlite3 shell or with sqlite3_load_extension().
+	**/
+	API_EXPORT int sqlite3_rinchisqlite_init(sqlite3* db, char** error_message, const sqlite3_api_routines* api)
+	{
+		SQLITE_EXTENSION_INIT2(api);
+
+		for (size_t i = 0; i < sizeof(SCALAR_FUNCTIONS) / sizeof(SCALAR_FUNCTIONS[0]); i++) {
+			const ScalarFunction& function = SCALAR_FUNCTIONS[i];
+			for (int arg_count = function.min_args; arg_count <= function.max_args; arg_count++) {
+				int rc = sqlite3_create_function(db, function.name, arg_count, SQLITE_UTF8 | SQLITE_DETERMINISTIC, NULL, function.function, NULL, NULL);
+				if (rc != SQLITE_OK) {
+					*error_message = sqlite3_mprintf("Cannot register function %s(): %s", function.name, sqlite3_errmsg(db));
+					return rc;
+				}
+			}
+		}
+
+		int rc = sqlite3_create_module(db, "rinchi_rdfile", &RDFILE_MODULE, NULL);
+		if (rc != SQLITE_OK)
+			*error_message = sqlite3_mprintf("Cannot register rinchi_rdfile(): %s", sqlite3_errmsg(db));
+		return rc;
+	}
+
+}
@@ -0,0 +1,145 @@
+#pragma region InChI-Trust Licence
+#/*
+# * Reaction International Chemical Identifier (RInChI)
+# * Version 1
+# * Software version 1.00
+# * 2022-01-14
+# * 
+# * The RInChI library and programs are free software developed under the
+# * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+# * 
+# * IUPAC/InChI-Trust Licence No.1.0 for the 
+# * Reaction International Chemical Identifier (RInChI) Software version 1.0
+# * Copyright (C) IUPAC and InChI Trust Limited
+# * 
+# * This library is free software; you can redistribute it and/or modify it 
+# * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+# * or any later version.
+# * 
+# * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+# * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+# * Licence for the International Chemical Identifier (InChI) Software
+# * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+# * for more details.
+# * 
+# * You should have received a copy of the IUPAC/InChI Trust InChI 
+# * Licence No. 1.0 with this library; if not, please write to:
+# * 
+# *     The InChI Trust
+# *     8 Cavendish Avenue
+# *     Cambridge CB1 7US
+# *     UK
+# *
+# * or email to: alan@inchi-trust.org.
+# *
+# */
+#pragma endregion
+
+# Run after building the extension (see BUILD.TXT):
+#     qmake rinchi_sqlite_qt.pro && make
+#     python test.py
+
+import os
+import sqlite3
+import tempfile
+
+con = sqlite3.connect(":memory:")
+con.enable_load_extension(True)
+# SQLite adds the file name extension of the platform.
+con.load_extension(os.environ.get("RINCHI_SQLITE", "./librinchi_sqlite" if os.name != "nt" else "rinchi_sqlite"))
+con.enable_load_extension(False)
+
+def value(sql, *args):
+    return con.execute(sql, args).fetchone()[0]
+
+rxndata = open("../test/rxnfiles/R005a.rxn").read()
+rddata = open("../test/RDfiles/Example 01 CCR.rdf").read()
+
+print ("=== Single reactions ===")
+assert (value("SELECT rinchi_from_rxn(?, 'RXN')", rxndata) ==
+    'RInChI=1.00.1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1<>C4H9BrO/c1-3(5)4(2)6/h3-4,6H,1-2H3/t3-,4+/m1/s1!Na.H2O/h;1H2/q+1;/p-1/d-')
+assert (value("SELECT rinchi_auxinfo_from_rxn(?)", rxndata) ==
+    'RAuxInfo=1.00.1/0/N:4,1,3,2,5/E:(1,2)(3,4)/it:im/rA:5nCCCCO/rB:N1;s2;P3;s2s3;/rC:-1.127,-.5635,0;-.4125,-.151,0;.4125,-.151,0;1.127,-.5635,0;0,.5635,0;<>0/N:4,1,3,2,6,5/it:im/rA:6nCCCCOBr/rB:s1;s2;s3;N2;P3;/rC:-.825,-.7557,0;-.4125,-.0412,0;.4125,-.0412,0;.825,.6733,0;-.626,.7557,0;.825,-.7557,0;!1/N:1;2/rA:2nNaO/rB:s1;/rC:-.4125,0,0;.4125,0,0;')
+assert (value("SELECT rinchi_key(?, 'L')", rddata) ==
+    "Long-RInChIKey=SA-BUHFF-OCEYRUMTOAEWEA-UYRXBGFRSA-N--HRQNWWCYHJTAPI-UHFFFAOYSA-N--WEVYAHXRMPXWCK-UHFFFAOYSA-N-WGHUNMFFLAMBJD-UHFFFAOYSA-M")
+assert (value("SELECT rinchi_key(?, 'S', 'RD')", rddata) ==
+    "Short-RInChIKey=SA-BUHFF-OCEYRUMTOA-HRQNWWCYHJ-ANFMRDWEKN-NDGAC-NUHFF-MUHFF-ZZZ")
+assert (value("SELECT rinchi_key(?, 'W')", rddata) ==
+    "Web-RInChIKey=YVHOQDQUXJQWHSZQW-MSWCGYDXJTZWXSA")
+assert (value("SELECT rinchi_key(NULL, 'W')") is None)
+
+print ("=== RInChI and InChIs ===")
+rinchi_string = value("SELECT rinchi_from_rxn(?)", rxndata)
+rinchi_auxinfo = value("SELECT rinchi_auxinfo_from_rxn(?)", rxndata)
+assert (value("SELECT rinchikey_from_rinchi(?, 'L')", rinchi_string + "\n") == value("SELECT rinchi_key(?, 'L')", rxndata))
+rxnfile = value("SELECT file_from_rinchi(?, ?, 'RXN')", rinchi_string, rinchi_auxinfo)
+assert (value("SELECT rinchi_from_rxn(?)", rxnfile) == rinchi_string)
+assert (value("SELECT rinchi_from_rxn(file_from_rinchi(?, '', 'RD'))", rinchi_string) == rinchi_string)
+reactant = "InChI=1S/C4H9BrO/c1-3(5)4(2)6/h3-4,6H,1-2H3/t3-,4+/m1/s1"
+product = "InChI=1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1"
+agent = "InChI=1S/Na.H2O/h;1H2/q+1;/p-1"
+assert (value("SELECT rinchi_from_inchis(?, ?, ?)", reactant, product, agent) == rinchi_string)
+assert (value("SELECT rinchikey_from_inchis(?, ?, ?, 'W')", reactant, product, agent) == value("SELECT rinchi_key(?, 'W')", rxndata))
+
+for sql, args in [("SELECT rinchi_key(?, 'X')", [rxndata]), ("SELECT rinchi_from_rxn('Not a reaction')", []), ("SELECT file_from_rinchi(?, '', 'MOL')", [rinchi_string])]:
+    try:
+        value(sql, *args)
+        assert False, "No error raised as expected for: " + sql
+    except sqlite3.OperationalError as e:
+        assert (str(e).startswith("rinchi::"))
+
+print ("=== RD files record by record ===")
+# An RD file of many records, the two records of rddata over and over.
+records = ["$RFMT" + record for record in rddata.split("$RFMT")[1:]]
+rdfile = tempfile.NamedTemporaryFile("w", suffix = ".rdf", delete = False)
+rdfile.write(rddata[:rddata.index("$RFMT")] + "".join(records * 25))
+rdfile.close()
+expected = [(value("SELECT rinchi_from_rxn(?)", record), value("SELECT rinchi_key(?, 'L')", record), value("SELECT rinchi_key(?, 'W')", record)) for record in records * 25]
+rows = con.execute("SELECT rinchi_string, long_key, web_key FROM rinchi_rdfile(?, 0, 2, 7)", (rdfile.name,)).fetchall()
+assert (rows == expected)
+rows = con.execute("SELECT record, file_text, error FROM rinchi_rdfile(?)", (rdfile.name,)).fetchall()
+assert (rows == [(i + 1, record, None) for i, record in enumerate(records * 25)])
+assert ([value("SELECT rinchi_key(?, 'W')", row[1]) for row in rows] == [row[2] for row in expected])
+con.execute("CREATE TABLE reactions (rxn TEXT, rinchi TEXT, long_key TEXT)")
+con.execute("INSERT INTO reactions SELECT file_text, rinchi_string, long_key FROM rinchi_rdfile(?) WHERE error IS NULL", (rdfile.name,))
+assert (value("SELECT count(*) FROM reactions") == 50)
+assert (value("SELECT count(DISTINCT long_key) FROM reactions") == 2)
+assert (con.execute("SELECT web_key FROM rinchi_rdfile(?) LIMIT 1", (rdfile.name,)).fetchall() == [(expected[0][2],)])
+os.remove(rdfile.name)
+
+# Many distinct reactions calculated on several threads give the same keys as rinchi_key() one at a time.
+# The RXN files of the Cambridge test data, each as a record.
+distinct_records = []
+for name in sorted(os.listdir("../test/Cambridge_rxnfiles")):
+    if name.endswith(".rxn"):
+        distinct_records.append(b"$RFMT\n" + open(os.path.join("../test/Cambridge_rxnfiles", name), "rb").read())
+rdfile = tempfile.NamedTemporaryFile("wb", suffix = ".rdf", delete = False)
+rdfile.write(b"$RDFILE 1\n" + b"".join(distinct_records * 10))
+rdfile.close()
+rows = con.execute("SELECT long_key, web_key FROM rinchi_rdfile(?, 0, 8, 16) WHERE error IS NULL", (rdfile.name,)).fetchall()
+distinct_expected = []
+for record in distinct_records * 10:
+    try:
+        distinct_expected.append((value("SELECT rinchi_key(?, 'L')", record), value("SELECT rinchi_key(?, 'W')", record)))
+    except sqlite3.OperationalError:
+        pass
+assert (rows == distinct_expected)
+assert (len(set(distinct_expected)) > 40)
+os.remove(rdfile.name)
+
+# A record that fails gives a row with only 'error' set.
+bad_rdfile = tempfile.NamedTemporaryFile("w", suffix = ".rdf", delete = False)
+bad_rdfile.write(rddata.replace("$RXN", "$RXX", 1))
+bad_rdfile.close()
+rows = con.execute("SELECT record, line, rinchi_string, error FROM rinchi_rdfile(?)", (bad_rdfile.name,)).fetchall()
+assert (rows[0][:3] == (1, 3, None) and rows[0][3].startswith("rinchi::"))
+assert (rows[1] == (2, 391, expected[1][0], None))
+os.remove(bad_rdfile.name)
+
+try:
+    con.execute("SELECT * FROM rinchi_rdfile('no such file.rdf')").fetchall()
+    assert False, "No error raised as expected for a missing RD file."
+except sqlite3.OperationalError as e:
+    assert (str(e).startswith("Cannot open RD file"))
+
+print ("All tests passed.")
@@ -44,12 +44,20 @@
 
 #include <iostream>
 
+#include "rinchi_platform.h"
+
 #include "molfile_reader_tests.h"
 #include "reaction_tests.h"
 #include "rxnfile_tests.h"
 #include "rdfile_tests.h"
 #include "special_atoms_tests.h"
 #include "rinchi_reader_tests.h"
+#include "result_cache_tests.h"
+#include "lane_scheduler_tests.h"
+#include "inchi_cache_tests.h"
+#ifdef ON_LINUX
+#include "daemon_tests.h"
+#endif
 
 #include "Cambridge_data_tests.h"
 #include "USPTO_patent_data_tests.h"
@@ -73,6 +81,12 @@ int main(int argc, char* argv[])
 		rinchi_tests::RDfileTests().run_tests();
 		rinchi_tests::SpecialAtomsTests().run_tests();
 		rinchi_tests::RInChIReaderTests().run_tests();
+		rinchi_tests::ResultCacheTests().run_tests();
+		rinchi_tests::LaneSchedulerTests().run_tests();
+		rinchi_tests::InChICacheTests().run_tests();
+	#ifdef ON_LINUX
+		rinchi_tests::DaemonTests().run_tests();
+	#endif
 		rinchi_tests::CambridgeRxnfileTests().run_tests();
         rinchi_tests::USPTOPatentDataTests().run_tests();
 
@@ -8,6 +8,9 @@ DEFINES  += IN_RINCHI_TEST_SUITE
 DEFINES  += TARGET_API_LIB
 QMAKE_CFLAGS += -ansi -DCOMPILE_ANSI_ONLY
 QMAKE_CXXFLAGS += -std=c++11
+# Older glibc versions need -pthread for std::thread.
+unix:!macx: QMAKE_CXXFLAGS += -pthread
+unix:!macx: QMAKE_LFLAGS += -pthread
 
 TEMPLATE = app
 
@@ -17,6 +20,7 @@ DEPENDPATH += \
 	./../../rinchi/ \
 	./../../writers/ \
 	./tests/ \
+	./../../example_apps/rinchi_cmdline/ \
 
 INCLUDEPATH += \
 	./../../lib/ \
@@ -24,6 +28,7 @@ INCLUDEPATH += \
 	./../../rinchi/ \
 	./../../writers/ \
 	./tests/ \
+	./../../example_apps/rinchi_cmdline/ \
 	./../../../../InChI/INCHI-1-SRC/INCHI_BASE/src/ \
 
 SOURCES += \
@@ -37,15 +42,27 @@ SOURCES += \
 	./../../parsers/mdl_rxnfile_reader.cpp \
 	./../../parsers/mdl_rdfile_reader.cpp \
 	./../../parsers/rinchi_reader.cpp \
+	./../../parsers/inchi_auxinfo_reader.cpp \
 	./../../writers/mdl_rxnfile_writer.cpp \
 	./../../writers/mdl_rdfile_writer.cpp \
+	./../../writers/mdl_molfile_writer.cpp \
 	./../../rinchi/rinchi_reaction.cpp \
+	./../../rinchi/rinchi_inchi_cache.cpp \
+	./../../rinchi/rinchi_molecule.cpp \
+	./../../rinchi/rinchi_result_cache.cpp \
+	./../../rinchi/rinchi_lane_scheduler.cpp \
+	./../../example_apps/rinchi_cmdline/rinchi_daemon.cpp \
+	./../../example_apps/rinchi_cmdline/rinchi_cmdline_run.cpp \
 	./../../rinchi/rinchi_consts.cpp \
 	./../../lib/unit_test.cpp \
 	./rinchi_test_suite.cpp \
 	./tests/molfile_reader_tests.cpp \
 	./tests/reaction_tests.cpp \
 	./tests/rinchi_reader_tests.cpp \
+	./tests/result_cache_tests.cpp \
+	./tests/lane_scheduler_tests.cpp \
+	./tests/inchi_cache_tests.cpp \
+	./tests/daemon_tests.cpp \
 	./tests/rxnfile_tests.cpp \
 	./tests/rdfile_tests.cpp \
 	./tests/special_atoms_tests.cpp \
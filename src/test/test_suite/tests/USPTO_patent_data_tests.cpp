@@ -37,6 +37,7 @@
 #pragma endregion
 #endif
 
+#include <cstring>
 #include <fstream>
 
 #include <boost/filesystem.hpp>
@@ -47,6 +48,9 @@
 
 #include "rinchi_reaction.h"
 #include "mdl_rxnfile_reader.h"
+#include "rinchi_reader.h"
+#include "inchi_generator.h"
+#include "inchi_auxinfo_reader.h"
 
 #include "USPTO_patent_data_tests.h"
 
@@ -91,4 +95,96 @@ void USPTOPatentDataTests::rxnfiles_subset()
 	std::cout << " [" << test_count << " files tested]";
 }
 
+namespace {
+
+	void check_auxinfo_reader(rinchi::InChIToStructureConverter& sc, const rinchi::ReactionComponentList& components, const std::string& test_name)
+	{
+		for (rinchi::ReactionComponentList::const_iterator rc = components.begin(); rc != components.end(); rc++) {
+			// to_molfile() rebuilds the structure with InChIAuxInfoReader, the reference goes
+			// through lib_Get_inchi_Input_FromAuxInfo(); both share the molfile writer otherwise.
+			rinchi::unit_test::check_is_equal(
+				sc.to_molfile((*rc)->inchi_string(), (*rc)->inchi_auxinfo()),
+				sc.to_molfile_using_inchi_lib((*rc)->inchi_string(), (*rc)->inchi_auxinfo()),
+				test_name + ": " + (*rc)->inchi_auxinfo()
+			);
+		}
+	}
+
+}
+
+void USPTOPatentDataTests::auxinfo_reader()
+{
+	boost::filesystem::path current_dir(".");
+	boost::filesystem::directory_iterator end_itr;
+
+	int test_count = 0;
+	rinchi::InChIToStructureConverter sc;
+	for (boost::filesystem::directory_iterator testfile(current_dir); testfile != end_itr; testfile++) {
+		if (!boost::filesystem::is_regular_file(testfile->path()))
+			continue;
+		std::string test_filename = testfile->path().string();
+		if (test_filename.substr(test_filename.length() - 4, 4) != ".txt")
+			continue;
+
+		std::string rinchi_string;
+		std::string rinchi_auxinfo;
+		std::ifstream rinchi_file ( test_filename.c_str() );
+		rinchi::rinchi_getline(rinchi_file, rinchi_string);
+		rinchi::rinchi_getline(rinchi_file, rinchi_auxinfo);
+		// Some of the rxnfiles have no RInChI (and an empty .txt file).
+		if (rinchi_string.empty())
+			continue;
+
+		test_count++;
+
+		rinchi::Reaction rxn;
+		rinchi::RInChIReader().split_into_reaction(rinchi_string, rinchi_auxinfo, rxn);
+		check_auxinfo_reader(sc, rxn.reactants(), test_filename);
+		check_auxinfo_reader(sc, rxn.products(), test_filename);
+		check_auxinfo_reader(sc, rxn.agents(), test_filename);
+	}
+	std::cout << " [" << test_count << " files tested]";
+}
+
+void USPTOPatentDataTests::auxinfo_reader_0D_stereo()
+{
+	// CHBrClF without coordinates; the implicit hydrogen is given as the central atom.
+	inchi_Atom atoms[4];
+	memset(atoms, 0, sizeof(atoms));
+	const char* elements[] = { "C", "F", "Cl", "Br" };
+	for (int i = 0; i < 4; i++) {
+		strcpy(atoms[i].elname, elements[i]);
+		atoms[i].num_iso_H[0] = -1;
+	}
+	for (int i = 1; i < 4; i++) {
+		atoms[0].neighbor[atoms[0].num_bonds] = (AT_NUM) i;
+		atoms[0].bond_type[atoms[0].num_bonds] = INCHI_BOND_TYPE_SINGLE;
+		atoms[0].num_bonds++;
+	}
+	inchi_Stereo0D stereo;
+	memset(&stereo, 0, sizeof(stereo));
+	stereo.central_atom = 0;
+	for (int i = 0; i < 4; i++)
+		stereo.neighbor[i] = (AT_NUM) i;
+	stereo.type = INCHI_StereoType_Tetrahedral;
+	stereo.parity = INCHI_PARITY_EVEN;
+
+	inchi_Input input;
+	memset(&input, 0, sizeof(input));
+	input.atom = atoms;
+	input.num_atoms = 4;
+	input.stereo0D = &stereo;
+	input.num_stereo0D = 1;
+	input.szOptions = (char*) "";
+
+	std::string inchi_string;
+	std::string auxinfo;
+	rinchi::InChIGenerator().calculate_inchi(input, inchi_string, auxinfo);
+	rinchi::unit_test::check_is_equal(auxinfo.find("/rT:") != std::string::npos, true, "0D stereo layer in " + auxinfo);
+	rinchi::unit_test::check_is_equal(rinchi::InChIAuxInfoReader::has_structure_layers(auxinfo), false, "AuxInfo with 0D stereo left to the InChI library");
+
+	rinchi::InChIToStructureConverter sc;
+	rinchi::unit_test::check_is_equal(sc.to_molfile(inchi_string, auxinfo), sc.to_molfile_using_inchi_lib(inchi_string, auxinfo), "Molfile from " + auxinfo);
+}
+
 } // end of namespace
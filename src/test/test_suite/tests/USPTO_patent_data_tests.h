@@ -47,10 +47,16 @@ namespace rinchi_tests {
 class USPTOPatentDataTests: public rinchi::unit_test::TestCase {
 	public:
 		void rxnfiles_subset();
+		// Checks structures rebuilt by InChIAuxInfoReader against the InChI library's AuxInfo parser.
+		void auxinfo_reader();
+		// AuxInfo with 0D stereo layers goes through the InChI library.
+		void auxinfo_reader_0D_stereo();
 
 		USPTOPatentDataTests()
 		{
 			REGISTER_TEST(USPTOPatentDataTests, rxnfiles_subset);
+			REGISTER_TEST(USPTOPatentDataTests, auxinfo_reader);
+			REGISTER_TEST(USPTOPatentDataTests, auxinfo_reader_0D_stereo);
 
 			goto_subdir("USPTO_patent_data");
 		}
@@ -0,0 +1,299 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include "rinchi_platform.h"
+
+#ifdef ON_LINUX
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "daemon_tests.h"
+
+#include "rinchi_utils.h"
+#include "rinchi_reaction.h"
+#include "rinchi_result_cache.h"
+#include "mdl_rxnfile_reader.h"
+#include "rinchi_daemon.h"
+#include "rinchi_cmdline_run.h"
+
+namespace rinchi_tests {
+
+namespace {
+
+	// A connected pair of Unix domain sockets, closed when it goes out of scope.
+	class SocketPair {
+		public:
+			int fds[2];
+
+			SocketPair()
+			{
+				if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+					throw std::runtime_error("socketpair() failed.");
+			}
+
+			~SocketPair()
+			{
+				close_end(0);
+				close_end(1);
+			}
+
+			void close_end(int end)
+			{
+				if (fds[end] >= 0)
+					close(fds[end]);
+				fds[end] = -1;
+			}
+	};
+
+	void write_uint32s(int fd, const std::vector<uint32_t>& values)
+	{
+		std::string buffer;
+		for (std::vector<uint32_t>::const_iterator value = values.begin(); value != values.end(); value++)
+			rinchi_daemon::append_uint32(buffer, *value);
+		rinchi_daemon::write_all(fd, buffer.data(), buffer.length());
+	}
+
+	std::string read_file(const std::string& file_name)
+	{
+		std::ifstream file (file_name.c_str(), std::ios::in | std::ios::binary);
+		std::ostringstream contents;
+		contents << file.rdbuf();
+		return contents.str();
+	}
+
+	// Exit code, standard output and standard error of run_cmdline(), one per line.
+	std::string run(const std::vector<std::string>& args, const std::string* file_text, rinchi::ReactionResultCache* cache = NULL)
+	{
+		std::ostringstream out;
+		std::ostringstream err;
+		int exit_code = run_cmdline(args, file_text, cache, out, err);
+		return rinchi::int2str(exit_code) + "\n" + out.str() + "\n" + err.str();
+	}
+
+	const char* RXNFILES[] = {
+		"R005a.rxn", "R005a_with_agents.rxn", "no_reactants_one_product.rxn", "nostruct_one_in_products.rxn",
+		"nostruct_one_in_reactants.rxn", "nostruct_two_in_reactants.rxn", "two_reactants_no_products.rxn"
+	};
+	const size_t RXNFILE_COUNT = sizeof(RXNFILES) / sizeof(RXNFILES[0]);
+
+}
+
+void DaemonTests::framing()
+{
+	std::vector<std::string> request;
+	request.push_back(rinchi_daemon::REQUEST_RUN);
+	request.push_back("");
+	request.push_back(std::string("a\0\r\n\xff", 5));
+	// More than fits into the socket buffer at once.
+	request.push_back(std::string(1000000, 'x'));
+
+	SocketPair sockets;
+	std::thread writer ([&]() {
+		rinchi_daemon::write_message(sockets.fds[0], request);
+		rinchi_daemon::write_message(sockets.fds[0], std::vector<std::string>());
+		sockets.close_end(0);
+	});
+	std::vector<std::string> first, second, third;
+	bool first_read = rinchi_daemon::read_message(sockets.fds[1], first);
+	bool second_read = rinchi_daemon::read_message(sockets.fds[1], second);
+	bool third_read = rinchi_daemon::read_message(sockets.fds[1], third);
+	writer.join();
+
+	rinchi::unit_test::check_is_equal(first_read, true, "First message read");
+	rinchi::unit_test::check_is_equal(first.size(), request.size(), "Field count");
+	for (size_t i = 0; i < request.size(); i++)
+		rinchi::unit_test::check_is_equal(first[i] == request[i], true, "Field " + rinchi::int2str((int) i));
+	rinchi::unit_test::check_is_equal(second_read, true, "Empty message read");
+	rinchi::unit_test::check_is_equal(second.size(), 0u, "Fields of empty message");
+	rinchi::unit_test::check_is_equal(third_read, false, "Read at end of input");
+}
+
+void DaemonTests::message_limits()
+{
+	std::vector<std::string> fields;
+	{
+		SocketPair sockets;
+		std::vector<uint32_t> header (1, rinchi_daemon::MAX_FIELD_COUNT);
+		header.resize(1 + rinchi_daemon::MAX_FIELD_COUNT, 0);
+		write_uint32s(sockets.fds[0], header);
+		rinchi::unit_test::check_is_equal(rinchi_daemon::read_message(sockets.fds[1], fields), true, "MAX_FIELD_COUNT empty fields");
+		rinchi::unit_test::check_is_equal(fields.size(), (size_t) rinchi_daemon::MAX_FIELD_COUNT, "Field count");
+	}
+	{
+		SocketPair sockets;
+		write_uint32s(sockets.fds[0], std::vector<uint32_t>(1, rinchi_daemon::MAX_FIELD_COUNT + 1));
+		rinchi::unit_test::check_is_equal(rinchi_daemon::read_message(sockets.fds[1], fields), false, "Too many fields");
+	}
+	// Refused from the lengths alone, before anything is allocated or read.
+	{
+		SocketPair sockets;
+		std::vector<uint32_t> header;
+		header.push_back(1);
+		header.push_back(rinchi_daemon::MAX_MESSAGE_SIZE + 1);
+		write_uint32s(sockets.fds[0], header);
+		rinchi::unit_test::check_is_equal(rinchi_daemon::read_message(sockets.fds[1], fields), false, "Field larger than MAX_MESSAGE_SIZE");
+	}
+	{
+		SocketPair sockets;
+		std::vector<uint32_t> header;
+		header.push_back(2);
+		header.push_back(4);
+		write_uint32s(sockets.fds[0], header);
+		rinchi_daemon::write_all(sockets.fds[0], "abcd", 4);
+		write_uint32s(sockets.fds[0], std::vector<uint32_t>(1, rinchi_daemon::MAX_MESSAGE_SIZE - 3));
+		rinchi::unit_test::check_is_equal(rinchi_daemon::read_message(sockets.fds[1], fields), false, "Fields larger than MAX_MESSAGE_SIZE together");
+	}
+	{
+		SocketPair sockets;
+		std::vector<uint32_t> header;
+		header.push_back(1);
+		header.push_back(10);
+		write_uint32s(sockets.fds[0], header);
+		rinchi_daemon::write_all(sockets.fds[0], "abc", 3);
+		sockets.close_end(0);
+		rinchi::unit_test::check_is_equal(rinchi_daemon::read_message(sockets.fds[1], fields), false, "Message cut short");
+	}
+}
+
+void DaemonTests::percentiles()
+{
+	rinchi_daemon::DurationStats stats;
+	rinchi::unit_test::check_is_equal(stats.report(), "no requests", "Report without requests");
+
+	// Nearest rank: of 1000 samples, p99.9 is the 999th.
+	for (int ms = 1000; ms >= 1; ms--)
+		stats.add(std::chrono::milliseconds(ms));
+	rinchi::unit_test::check_is_equal(stats.report(), "p50 500.00  p90 900.00  p99 990.00  p99.9 999.00  max 1000.00", "Report of 1..1000 ms");
+	rinchi::unit_test::check_is_equal(stats.count(), 1000ul, "Count");
+
+	rinchi_daemon::DurationStats single;
+	single.add(std::chrono::microseconds(1500));
+	rinchi::unit_test::check_is_equal(single.report(), "p50 1.50  p90 1.50  p99 1.50  p99.9 1.50  max 1.50", "Report of one request");
+
+	// Percentiles are of the latest SAMPLE_COUNT requests; the count and maximum of all.
+	rinchi_daemon::DurationStats ring;
+	ring.add(std::chrono::seconds(10));
+	for (size_t i = 0; i < rinchi_daemon::DurationStats::SAMPLE_COUNT; i++)
+		ring.add(std::chrono::milliseconds(2));
+	rinchi::unit_test::check_is_equal(ring.report(), "p50 2.00  p90 2.00  p99 2.00  p99.9 2.00  max 10000.00", "Report after the oldest sample is replaced");
+	rinchi::unit_test::check_is_equal(ring.sample_count(), rinchi_daemon::DurationStats::SAMPLE_COUNT, "Sample count");
+	rinchi::unit_test::check_is_equal(ring.count(), (unsigned long) rinchi_daemon::DurationStats::SAMPLE_COUNT + 1, "Count of all requests");
+}
+
+void DaemonTests::run_cmdline_outputs()
+{
+	std::string file_text = read_file("R005a.rxn");
+	rinchi::Reaction rxn;
+	rinchi::MdlRxnfileReader().read_reaction("R005a.rxn", rxn);
+	std::string keys = rxn.rinchi_long_key() + "\n" + rxn.rinchi_short_key() + "\n" + rxn.rinchi_web_key() + "\n";
+
+	std::vector<std::string> args (1, "R005a.rxn");
+	rinchi::unit_test::check_is_equal(run(args, &file_text), "0\n" + rxn.rinchi_string() + "\n" + rxn.rinchi_auxinfo() + "\n" + keys + "\n", "RXN file");
+	args.push_back("/No-AuxInfo");
+	rinchi::unit_test::check_is_equal(run(args, &file_text), "0\n" + rxn.rinchi_string() + "\n" + keys + "\n", "RXN file without RAuxInfo");
+
+	// Back from the RInChI; with agents, an RD file is written unless /rxn is given.
+	rinchi::Reaction with_agents;
+	rinchi::MdlRxnfileReader().read_reaction("R005a_with_agents.rxn", with_agents);
+	std::string rinchi_text = with_agents.rinchi_string() + "\n" + with_agents.rinchi_auxinfo() + "\n";
+	args.assign(1, "R005a_with_agents.rinchi");
+	rinchi::unit_test::check_is_equal(run(args, &rinchi_text).substr(0, 10), "0\n$RDFILE ", "RD file from RInChI");
+	args.push_back("/rxn");
+	rinchi::unit_test::check_is_equal(run(args, &rinchi_text).substr(0, 6), "0\n$RXN", "RXN file from RInChI");
+	args.push_back("/rd");
+	rinchi::unit_test::check_errmsg_has_substr(run(args, &rinchi_text), "Only one of /rd and /rxn", "/rd and /rxn");
+
+	args.assign(1, "no such file.rxn");
+	std::string output = run(args, NULL);
+	rinchi::unit_test::check_is_equal(output.substr(0, 2), "2\n", "Exit code for a missing file");
+	rinchi::unit_test::check_errmsg_has_substr(output, "'no such file.rxn' does not exist", "Missing file");
+	output = run(std::vector<std::string>(), NULL);
+	rinchi::unit_test::check_is_equal(output.substr(0, 2), "1\n", "Exit code without arguments");
+	rinchi::unit_test::check_errmsg_has_substr(output, "Usage: rinchi_cmdline", "Usage");
+
+	// The cache gives the same output; it keeps RAuxInfo apart.
+	rinchi::ReactionResultCache cache (100);
+	args.assign(1, "R005a.rxn");
+	std::string expected = run(args, &file_text);
+	rinchi::unit_test::check_is_equal(run(args, &file_text, &cache), expected, "Result added to cache");
+	rinchi::unit_test::check_is_equal(run(args, &file_text, &cache), expected, "Result from cache");
+	rinchi::unit_test::check_is_equal(cache.stats().hits, 1ul, "Cache hits");
+}
+
+void DaemonTests::concurrent_run_cmdline()
+{
+	std::vector<std::string> file_texts;
+	std::vector<std::string> expected;
+	for (size_t i = 0; i < RXNFILE_COUNT; i++) {
+		file_texts.push_back(read_file(RXNFILES[i]));
+		expected.push_back(run(std::vector<std::string>(1, RXNFILES[i]), &file_texts.back()));
+	}
+
+	// As in the daemon: requests for different reactions at once, sharing one result cache.
+	rinchi::ReactionResultCache cache (100);
+	std::atomic<int> mismatches (0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 8; t++) {
+		threads.push_back(std::thread([&, t]() {
+			for (int repetition = 0; repetition < 10; repetition++) {
+				for (size_t i = 0; i < RXNFILE_COUNT; i++) {
+					size_t idx = (i + t) % RXNFILE_COUNT;
+					if (run(std::vector<std::string>(1, RXNFILES[idx]), &file_texts[idx], &cache) != expected[idx])
+						mismatches++;
+				}
+			}
+		}));
+	}
+	for (std::vector<std::thread>::iterator thread = threads.begin(); thread != threads.end(); thread++)
+		thread->join();
+	rinchi::unit_test::check_is_equal(mismatches.load(), 0, "Outputs that differ from those of one request at a time");
+}
+
+} // end of namespace
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef IUPAC_RINCHI_DAEMON_TESTS_HEADER_GUARD
+#define IUPAC_RINCHI_DAEMON_TESTS_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include "unit_test.h"
+
+namespace rinchi_tests {
+
+// Tests of "rinchi_cmdline /daemon" (example_apps/rinchi_cmdline); Linux and Mac only.
+class DaemonTests: public rinchi::unit_test::TestCase {
+	public:
+		void framing();
+		void message_limits();
+		void percentiles();
+		void run_cmdline_outputs();
+		void concurrent_run_cmdline();
+
+		DaemonTests()
+		{
+			REGISTER_TEST(DaemonTests, framing);
+			REGISTER_TEST(DaemonTests, message_limits);
+			REGISTER_TEST(DaemonTests, percentiles);
+			REGISTER_TEST(DaemonTests, run_cmdline_outputs);
+			REGISTER_TEST(DaemonTests, concurrent_run_cmdline);
+
+			goto_subdir("rxnfiles");
+		}
+
+};
+
+} // end of namespace
+
+#endif
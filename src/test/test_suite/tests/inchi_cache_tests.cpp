@@ -0,0 +1,298 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "inchi_cache_tests.h"
+
+#include "inchi_api_intf.h"
+#include "rinchi_inchi_cache.h"
+#include "rinchi_molecule.h"
+#include "rinchi_reaction.h"
+#include "mdl_rxnfile_reader.h"
+
+namespace rinchi_tests {
+
+namespace {
+
+	const char* CACHE_FILE_NAME = "inchi_cache_test.tmp";
+
+	// Removes the cache file before and after a test.
+	class TempCacheFile {
+		public:
+			TempCacheFile() { std::remove(CACHE_FILE_NAME); }
+			~TempCacheFile() { std::remove(CACHE_FILE_NAME); }
+	};
+
+	long file_size(const char* file_name)
+	{
+		std::ifstream input (file_name, std::ios::binary | std::ios::ate);
+		return (long) input.tellg();
+	}
+
+	void append_to_file(const char* file_name, const std::string& bytes)
+	{
+		std::ofstream output (file_name, std::ios::binary | std::ios::app);
+		output << bytes;
+	}
+
+	rinchi::InChICache::Digest digest_of(const std::string& text)
+	{
+		rinchi::InChICache::Digest result;
+		for (size_t i = 0; i < sizeof(result.bytes); i++)
+			result.bytes[i] = (unsigned char) text[i % text.length()];
+		return result;
+	}
+
+	rinchi::InChICacheValue value_of(const std::string& inchi)
+	{
+		rinchi::InChICacheValue result;
+		result.inchi_string = "InChI=1S/" + inchi;
+		result.inchi_auxinfo = "AuxInfo=1/0/N:1";
+		result.inchi_key = "KEY-" + inchi;
+		return result;
+	}
+
+	void read_rxnfile(const std::string& file_name, rinchi::Reaction& rxn)
+	{
+		rinchi::MdlRxnfileReader().read_reaction(file_name, rxn);
+	}
+
+	// The components of several RXN files in one reaction, their InChIs calculated on up to
+	// 'max_inchi_threads' threads.
+	void read_distinct_components(unsigned max_inchi_threads, rinchi::Reaction& rxn)
+	{
+		const char* rxnfiles[] = { "R005a_with_agents.rxn", "no_reactants_one_product.rxn", "two_reactants_no_products.rxn" };
+		rxn.set_max_inchi_threads(max_inchi_threads);
+		for (int i = 0; i < 3; i++)
+			read_rxnfile(rxnfiles[i], rxn);
+	}
+
+	// The InChIKey of every reactant and product, one per line.
+	std::string component_keys(rinchi::Reaction& rxn)
+	{
+		std::string result;
+		for (int i = 0; i < 2; i++) {
+			const rinchi::ReactionComponentList& components = i == 0 ? rxn.reactants() : rxn.products();
+			for (rinchi::ReactionComponentList::const_iterator rc = components.begin(); rc != components.end(); rc++)
+				result += (*rc)->inchi_key() + "\n";
+		}
+		return result;
+	}
+
+}
+
+void InChICacheTests::digests()
+{
+	rinchi::Molecule molecule;
+	molecule.add_atom("C", 0, 0, 0, 0, 0, 0);
+	molecule.add_atom("O", 0, 0, 0, 0, 0, 0);
+	molecule.add_bond(0, 1, 2, rinchi::RINCHI_BOND_STEREO_NONE);
+	std::vector<inchi_Atom> atoms;
+	inchi_Input input;
+	molecule.to_inchi_input(atoms, input);
+	char options[] = "-ChiralFlagOFF";
+	input.szOptions = options;
+	rinchi::InChICache::Digest digest = rinchi::InChICache::digest(input);
+
+	rinchi::unit_test::check_is_equal(memcmp(rinchi::InChICache::digest(input).bytes, digest.bytes, sizeof(digest.bytes)) == 0, true, "Digest of same input");
+	atoms[1].x = 1.5;
+	rinchi::unit_test::check_is_equal(memcmp(rinchi::InChICache::digest(input).bytes, digest.bytes, sizeof(digest.bytes)) != 0, true, "Digest with other coordinates");
+	atoms[1].x = 0;
+	char other_options[] = "-ChiralFlagON";
+	input.szOptions = other_options;
+	rinchi::unit_test::check_is_equal(memcmp(rinchi::InChICache::digest(input).bytes, digest.bytes, sizeof(digest.bytes)) != 0, true, "Digest with other options");
+}
+
+void InChICacheTests::persistence()
+{
+	TempCacheFile temp_file;
+	rinchi::InChICacheValue value;
+	{
+		rinchi::InChICache cache (CACHE_FILE_NAME);
+		rinchi::unit_test::check_is_equal(cache.find(digest_of("CO"), value), false, "Lookup in new file");
+		cache.insert(digest_of("CO"), value_of("CO"));
+		cache.insert(digest_of("CCO"), value_of("CCO"));
+		// Already there.
+		cache.insert(digest_of("CO"), value_of("CO"));
+		rinchi::unit_test::check_is_equal(cache.find(digest_of("CO"), value), true, "Lookup of own record");
+		rinchi::unit_test::check_is_equal(cache.stats().appends, 2ul, "Appends");
+	}
+
+	rinchi::InChICache cache (CACHE_FILE_NAME);
+	rinchi::unit_test::check_is_equal(cache.stats().entries, (size_t) 2, "Entries after reopening");
+	rinchi::unit_test::check_is_equal(cache.find(digest_of("CCO"), value), true, "Lookup after reopening");
+	rinchi::unit_test::check_is_equal(value.inchi_string, "InChI=1S/CCO", "InChI string");
+	rinchi::unit_test::check_is_equal(value.inchi_auxinfo, "AuxInfo=1/0/N:1", "AuxInfo");
+	rinchi::unit_test::check_is_equal(value.inchi_key, "KEY-CCO", "InChIKey");
+	rinchi::unit_test::check_is_equal(cache.find(digest_of("CCCO"), value), false, "Lookup of missing record");
+}
+
+void InChICacheTests::shared_file()
+{
+	TempCacheFile temp_file;
+	rinchi::InChICache writer (CACHE_FILE_NAME);
+	rinchi::InChICache reader (CACHE_FILE_NAME);
+	rinchi::InChICacheValue value;
+
+	// The reader picks up records appended after it was opened.
+	writer.insert(digest_of("CO"), value_of("CO"));
+	rinchi::unit_test::check_is_equal(reader.find(digest_of("CO"), value), true, "Record of other writer");
+	rinchi::unit_test::check_is_equal(value.inchi_key, "KEY-CO", "InChIKey of other writer");
+
+	// Neither appends what the other has already written.
+	reader.insert(digest_of("CO"), value_of("CO"));
+	rinchi::unit_test::check_is_equal(reader.stats().appends, 0ul, "Appends of record already written");
+	reader.insert(digest_of("CCO"), value_of("CCO"));
+	rinchi::unit_test::check_is_equal(writer.find(digest_of("CCO"), value), true, "Record of second writer");
+	rinchi::unit_test::check_is_equal(writer.stats().entries, (size_t) 2, "Entries");
+}
+
+void InChICacheTests::torn_record()
+{
+	TempCacheFile temp_file;
+	rinchi::InChICacheValue value;
+	{
+		rinchi::InChICache cache (CACHE_FILE_NAME);
+		cache.insert(digest_of("CO"), value_of("CO"));
+	}
+	long intact_size = file_size(CACHE_FILE_NAME);
+	// The start of a record, as left by a writer that crashed.
+	append_to_file(CACHE_FILE_NAME, std::string("RCH1\x40\0\0\0garbage", 15));
+
+	rinchi::InChICache cache (CACHE_FILE_NAME);
+	rinchi::unit_test::check_is_equal(cache.stats().entries, (size_t) 1, "Entries before torn record");
+	cache.insert(digest_of("CCO"), value_of("CCO"));
+	rinchi::unit_test::check_is_equal(file_size(CACHE_FILE_NAME) > intact_size, true, "Record written over torn record");
+
+	rinchi::InChICache other (CACHE_FILE_NAME);
+	rinchi::unit_test::check_is_equal(other.find(digest_of("CO"), value), true, "Record before torn record");
+	rinchi::unit_test::check_is_equal(other.find(digest_of("CCO"), value), true, "Record written over torn record");
+}
+
+void InChICacheTests::version_change()
+{
+	TempCacheFile temp_file;
+	{
+		rinchi::InChICache cache (CACHE_FILE_NAME);
+		cache.insert(digest_of("CO"), value_of("CO"));
+	}
+	{
+		std::fstream file (CACHE_FILE_NAME, std::ios::binary | std::ios::in | std::ios::out);
+		// The InChI library version at the end of the 64 byte header.
+		char version[24];
+		file.seekg(40);
+		file.read(version, sizeof(version));
+		rinchi::unit_test::check_is_equal(std::string(version, strnlen(version, sizeof(version))), rinchi::inchi_lib_version(), "InChI library version in header");
+		rinchi::unit_test::check_is_equal(rinchi::inchi_lib_version().substr(0, 2), std::string("1."), "InChI library major version");
+		file.seekp(40);
+		file.write("0.99", 4);
+	}
+
+	rinchi::InChICache cache (CACHE_FILE_NAME);
+	rinchi::InChICacheValue value;
+	rinchi::unit_test::check_is_equal(cache.find(digest_of("CO"), value), false, "Record of other version");
+	rinchi::unit_test::check_is_equal(cache.stats().entries, (size_t) 0, "Entries of replaced file");
+	rinchi::unit_test::check_is_equal(file_size(CACHE_FILE_NAME), 64l, "Size of replaced file");
+}
+
+void InChICacheTests::reaction_components()
+{
+	TempCacheFile temp_file;
+	rinchi::Reaction uncached;
+	read_rxnfile("R005a.rxn", uncached);
+
+	rinchi::set_inchi_cache_file(CACHE_FILE_NAME);
+	try {
+		rinchi::Reaction first, second;
+		read_rxnfile("R005a.rxn", first);
+		read_rxnfile("R005a.rxn", second);
+		rinchi::unit_test::check_is_equal(first.rinchi_string(), uncached.rinchi_string(), "RInChI calculated with cache");
+		unsigned long misses = rinchi::inchi_cache()->stats().misses;
+		rinchi::unit_test::check_is_equal(second.rinchi_string(), uncached.rinchi_string(), "RInChI from cache");
+		rinchi::unit_test::check_is_equal(second.rinchi_auxinfo(), uncached.rinchi_auxinfo(), "RAuxInfo from cache");
+		rinchi::unit_test::check_is_equal(second.rinchi_long_key(), uncached.rinchi_long_key(), "Long key from cache");
+
+		rinchi::InChICacheStats stats = rinchi::inchi_cache()->stats();
+		rinchi::unit_test::check_is_equal(stats.misses, misses, "Misses for second reaction");
+		rinchi::unit_test::check_is_equal(stats.hits > 0, true, "Hits for second reaction");
+		// Components calculated in parallel may miss the same structure at the same time.
+		rinchi::unit_test::check_is_equal(stats.appends > 0 && stats.appends <= misses, true, "Appends");
+	}
+	catch (...) {
+		rinchi::set_inchi_cache_file("");
+		throw;
+	}
+	rinchi::set_inchi_cache_file("");
+	rinchi::unit_test::check_is_equal(rinchi::inchi_cache() == NULL, true, "Cache turned off");
+}
+
+void InChICacheTests::parallel_keys()
+{
+	TempCacheFile temp_file;
+	rinchi::Reaction serial;
+	read_distinct_components(1, serial);
+	std::string expected_keys = component_keys(serial);
+
+	// Keys of cache misses are generated on the InChI threads and stored for good.
+	rinchi::set_inchi_cache_file(CACHE_FILE_NAME);
+	try {
+		for (int pass = 0; pass < 2; pass++) {
+			rinchi::Reaction parallel;
+			read_distinct_components(4, parallel);
+			std::string context = pass == 0 ? " calculated in parallel" : " from reopened cache";
+			rinchi::unit_test::check_is_equal(parallel.rinchi_long_key(), serial.rinchi_long_key(), "Long key" + context);
+			rinchi::unit_test::check_is_equal(component_keys(parallel), expected_keys, "InChIKeys" + context);
+			if (pass == 1)
+				rinchi::unit_test::check_is_equal(rinchi::inchi_cache()->stats().misses, 0ul, "Misses" + context);
+			rinchi::set_inchi_cache_file("");
+			rinchi::set_inchi_cache_file(CACHE_FILE_NAME);
+		}
+	}
+	catch (...) {
+		rinchi::set_inchi_cache_file("");
+		throw;
+	}
+	rinchi::set_inchi_cache_file("");
+}
+
+} // end of namespace
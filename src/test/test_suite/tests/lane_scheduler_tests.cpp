@@ -0,0 +1,235 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lane_scheduler_tests.h"
+
+#include "rinchi_lane_scheduler.h"
+
+namespace rinchi_tests {
+
+namespace {
+
+	const std::chrono::seconds TIMEOUT (10);
+
+	// Holds up the tasks that wait for it until opened.
+	class Gate {
+		private:
+			std::mutex m_mutex;
+			std::condition_variable m_opened;
+			bool m_open;
+		public:
+			Gate(): m_open(false) {}
+
+			void open()
+			{
+				{
+					std::lock_guard<std::mutex> lock (m_mutex);
+					m_open = true;
+				}
+				m_opened.notify_all();
+			}
+
+			void wait()
+			{
+				std::unique_lock<std::mutex> lock (m_mutex);
+				m_opened.wait(lock, [this]() { return m_open; });
+			}
+	};
+
+	// Names of the tasks that started, in order.
+	class TaskLog {
+		private:
+			std::mutex m_mutex;
+			std::condition_variable m_changed;
+			std::vector<std::string> m_names;
+		public:
+			void add(const std::string& name)
+			{
+				{
+					std::lock_guard<std::mutex> lock (m_mutex);
+					m_names.push_back(name);
+				}
+				m_changed.notify_all();
+			}
+
+			void wait_for(size_t count)
+			{
+				std::unique_lock<std::mutex> lock (m_mutex);
+				if (!m_changed.wait_for(lock, TIMEOUT, [&]() { return m_names.size() >= count; }))
+					throw rinchi::unit_test::TestFailure("Timed out waiting for " + std::to_string(count) + " tasks to start.");
+			}
+
+			std::string names()
+			{
+				std::lock_guard<std::mutex> lock (m_mutex);
+				std::string result;
+				for (std::vector<std::string>::const_iterator name = m_names.begin(); name != m_names.end(); name++)
+					result += (result.empty() ? "" : " ") + *name;
+				return result;
+			}
+	};
+
+	rinchi::LaneScheduler::Task logged(TaskLog& log, const std::string& name)
+	{
+		return [&log, name](std::chrono::steady_clock::duration) { log.add(name); };
+	}
+
+	rinchi::LaneScheduler::Task blocked(TaskLog& log, const std::string& name, Gate& gate)
+	{
+		return [&log, name, &gate](std::chrono::steady_clock::duration) { log.add(name); gate.wait(); };
+	}
+
+}
+
+void LaneSchedulerTests::runs_all_tasks()
+{
+	TaskLog log;
+	rinchi::LaneScheduler scheduler (3, 1);
+	rinchi::unit_test::check_is_equal(scheduler.worker_count(), 3u, "Workers");
+	rinchi::unit_test::check_is_equal(scheduler.reserved_workers(), 1u, "Reserved workers");
+	for (int i = 0; i < 20; i++)
+		scheduler.submit(rinchi::LANE_INTERACTIVE, logged(log, "I"));
+	for (int i = 0; i < 30; i++)
+		scheduler.submit(rinchi::LANE_BULK, logged(log, "B"));
+	scheduler.shutdown();
+
+	rinchi::LaneStats interactive = scheduler.stats(rinchi::LANE_INTERACTIVE);
+	rinchi::LaneStats bulk = scheduler.stats(rinchi::LANE_BULK);
+	rinchi::unit_test::check_is_equal(interactive.submitted, 20ul, "Interactive tasks submitted");
+	rinchi::unit_test::check_is_equal(interactive.completed, 20ul, "Interactive tasks completed");
+	rinchi::unit_test::check_is_equal(bulk.submitted, 30ul, "Bulk tasks submitted");
+	rinchi::unit_test::check_is_equal(bulk.completed, 30ul, "Bulk tasks completed");
+	rinchi::unit_test::check_is_equal(bulk.queue_depth, (size_t) 0, "Bulk queue depth after shutdown");
+	rinchi::unit_test::check_is_equal(bulk.running, (size_t) 0, "Bulk tasks running after shutdown");
+
+	rinchi::unit_test::check_is_equal(scheduler.submit(rinchi::LANE_INTERACTIVE, logged(log, "late")), false, "Task submitted after shutdown");
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_INTERACTIVE).submitted, 20ul, "Interactive tasks submitted after shutdown");
+
+	// All workers would be reserved, so one is added.
+	rinchi::LaneScheduler all_reserved (2, 2);
+	rinchi::unit_test::check_is_equal(all_reserved.worker_count(), 3u, "Workers if all would be reserved");
+}
+
+void LaneSchedulerTests::interactive_first()
+{
+	TaskLog log;
+	Gate gate;
+	// The only worker belongs to the bulk lane.
+	rinchi::LaneScheduler scheduler (1, 0);
+	scheduler.submit(rinchi::LANE_BULK, blocked(log, "blocker", gate));
+	log.wait_for(1);
+	scheduler.submit(rinchi::LANE_BULK, logged(log, "B1"));
+	scheduler.submit(rinchi::LANE_BULK, logged(log, "B2"));
+	scheduler.submit(rinchi::LANE_INTERACTIVE, logged(log, "I1"));
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_BULK).queue_depth, (size_t) 2, "Bulk queue depth");
+	gate.open();
+	scheduler.shutdown();
+
+	rinchi::unit_test::check_is_equal(log.names(), "blocker I1 B1 B2", "Task order");
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_INTERACTIVE).stolen, 1ul, "Interactive tasks taken by the bulk worker");
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_BULK).peak_queue_depth, (size_t) 2, "Peak bulk queue depth");
+}
+
+void LaneSchedulerTests::reserved_worker()
+{
+	TaskLog log;
+	Gate gate;
+	rinchi::LaneScheduler scheduler (2, 1);
+	// Only the bulk worker takes it: the reserved one would leave no interactive worker idle.
+	scheduler.submit(rinchi::LANE_BULK, blocked(log, "blocker", gate));
+	log.wait_for(1);
+	scheduler.submit(rinchi::LANE_BULK, logged(log, "B1"));
+	scheduler.submit(rinchi::LANE_INTERACTIVE, logged(log, "I1"));
+	log.wait_for(2);
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_BULK).queue_depth, (size_t) 1, "Bulk task waiting for the bulk worker");
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_BULK).stolen, 0ul, "Bulk tasks taken by the reserved worker");
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_INTERACTIVE).stolen, 0ul, "Interactive tasks taken by the bulk worker");
+	// On shutdown, any worker may take the rest.
+	gate.open();
+	scheduler.shutdown();
+
+	rinchi::unit_test::check_is_equal(log.names(), "blocker I1 B1", "Task order");
+}
+
+void LaneSchedulerTests::stealing()
+{
+	TaskLog log;
+	Gate gate;
+	rinchi::LaneScheduler scheduler (3, 2);
+	// The bulk worker and one of the reserved workers take these.
+	scheduler.submit(rinchi::LANE_BULK, blocked(log, "blocker1", gate));
+	log.wait_for(1);
+	scheduler.submit(rinchi::LANE_BULK, blocked(log, "blocker2", gate));
+	log.wait_for(2);
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_BULK).stolen, 1ul, "Bulk tasks taken by a reserved worker");
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_BULK).running, (size_t) 2, "Bulk tasks running");
+
+	// The last idle reserved worker is kept for interactive tasks.
+	scheduler.submit(rinchi::LANE_BULK, logged(log, "B3"));
+	scheduler.submit(rinchi::LANE_INTERACTIVE, logged(log, "I1"));
+	log.wait_for(3);
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_BULK).queue_depth, (size_t) 1, "Bulk task waiting");
+	gate.open();
+	scheduler.shutdown();
+
+	rinchi::unit_test::check_is_equal(log.names(), "blocker1 blocker2 I1 B3", "Task order");
+	rinchi::unit_test::check_is_equal(scheduler.stats(rinchi::LANE_BULK).completed, 3ul, "Bulk tasks completed");
+}
+
+void LaneSchedulerTests::failed_tasks()
+{
+	rinchi::LaneScheduler scheduler (1, 0);
+	scheduler.submit(rinchi::LANE_BULK, [](std::chrono::steady_clock::duration) { throw std::runtime_error("Task failure"); });
+	scheduler.submit(rinchi::LANE_BULK, [](std::chrono::steady_clock::duration) {});
+	scheduler.shutdown();
+
+	rinchi::LaneStats stats = scheduler.stats(rinchi::LANE_BULK);
+	rinchi::unit_test::check_is_equal(stats.failed, 1ul, "Failed tasks");
+	rinchi::unit_test::check_is_equal(stats.completed, 1ul, "Completed tasks");
+	rinchi::unit_test::check_is_equal(std::string(rinchi::lane_name(rinchi::LANE_BULK)), "bulk", "Lane name");
+}
+
+} // end of namespace
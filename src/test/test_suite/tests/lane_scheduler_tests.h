@@ -0,0 +1,68 @@
+#ifndef IUPAC_RINCHI_LANE_SCHEDULER_TESTS_HEADER_GUARD
+#define IUPAC_RINCHI_LANE_SCHEDULER_TESTS_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include "unit_test.h"
+
+namespace rinchi_tests {
+
+class LaneSchedulerTests: public rinchi::unit_test::TestCase {
+	public:
+		void runs_all_tasks();
+		void interactive_first();
+		void reserved_worker();
+		void stealing();
+		void failed_tasks();
+
+		LaneSchedulerTests()
+		{
+			REGISTER_TEST(LaneSchedulerTests, runs_all_tasks);
+			REGISTER_TEST(LaneSchedulerTests, interactive_first);
+			REGISTER_TEST(LaneSchedulerTests, reserved_worker);
+			REGISTER_TEST(LaneSchedulerTests, stealing);
+			REGISTER_TEST(LaneSchedulerTests, failed_tasks);
+		}
+
+};
+
+} // end of namespace
+
+#endif
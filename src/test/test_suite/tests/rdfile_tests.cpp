@@ -38,6 +38,7 @@
 #endif
 
 #include <fstream>
+#include <sstream>
 
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string/replace.hpp>
@@ -124,4 +125,39 @@ void RDfileTests::equilibrium_override()
 		"Short-RInChIKey=SA-EUHFF-OPNPQXLQER-JIOUJVPLJO-ZZLLQJHRMH-NUHFF-NUHFF-KUHFF-ZZZ");
 }
 
+void RDfileTests::record_reader()
+{
+	std::ifstream rdfile ("Example 04 simple.rdf", std::ios::binary);
+	rinchi::MdlRDfileRecordReader records (rdfile);
+
+	std::string record_text;
+	rinchi::unit_test::check_is_equal(records.next_record(record_text), true, "First record");
+	rinchi::unit_test::check_is_equal(records.record_line_number(), 3, "First record line");
+	rinchi::unit_test::check_is_equal(record_text.substr(0, 6), std::string("$RFMT "), "First record start");
+
+	// The first record gives the same reaction as the file.
+	rinchi::Reaction expected, rxn;
+	rinchi::MdlRDfileReader rd_reader;
+	rd_reader.read_reaction("Example 04 simple.rdf", expected);
+	std::istringstream record_stream (record_text);
+	rd_reader.read_reaction(record_stream, rxn);
+	rinchi::unit_test::check_is_equal(rxn.rinchi_string(), expected.rinchi_string(), "First record RInChI string");
+
+	rinchi::unit_test::check_is_equal(records.next_record(record_text), true, "Second record");
+	rinchi::unit_test::check_is_equal(records.record_line_number(), 145, "Second record line");
+	rinchi::unit_test::check_is_equal(record_text.substr(0, 6), std::string("$RFMT "), "Second record start");
+	rinchi::unit_test::check_is_equal(records.next_record(record_text), false, "End of file");
+
+	// Input without $RFMT lines, e.g. an RXN file, is a single record.
+	std::istringstream rxnfile ("$RXN\n\n\n\n  0  0\n");
+	rinchi::MdlRDfileRecordReader rxn_records (rxnfile);
+	rinchi::unit_test::check_is_equal(rxn_records.next_record(record_text), true, "RXN file record");
+	rinchi::unit_test::check_is_equal(record_text, std::string("$RXN\n\n\n\n  0  0\n"), "RXN file record text");
+	rinchi::unit_test::check_is_equal(rxn_records.next_record(record_text), false, "RXN file end");
+
+	std::istringstream empty ("\n\n");
+	rinchi::MdlRDfileRecordReader empty_records (empty);
+	rinchi::unit_test::check_is_equal(empty_records.next_record(record_text), false, "Empty input");
+}
+
 } // end of namespace
@@ -48,11 +48,14 @@ class RDfileTests: public rinchi::unit_test::TestCase {
 	public:
 		void standard_files();
 		void equilibrium_override();
+		// MdlRDfileRecordReader must split RD files into records that read as the whole file does.
+		void record_reader();
 
 		RDfileTests()
 		{
 			REGISTER_TEST(RDfileTests, standard_files);
 			REGISTER_TEST(RDfileTests, equilibrium_override);
+			REGISTER_TEST(RDfileTests, record_reader);
 
 			goto_subdir("RDfiles");
 		}
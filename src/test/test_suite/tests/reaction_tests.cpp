@@ -37,7 +37,12 @@
 #pragma endregion
 #endif
 
+#include <atomic>
 #include <fstream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "rinchi_consts.h"
 #include "rinchi_utils.h"
@@ -385,4 +390,316 @@ void ReactionTests::web_key()
 	}
 }
 
+void ReactionTests::auxinfo_free_mode()
+{
+	rinchi::MdlMolfileReader mr;
+	rinchi::Reaction rxn;
+	mr.read_molecule("CH4S.mol", *rxn.add_reactant());
+	mr.read_molecule("WithStereo.mol", *rxn.add_product());
+	std::string expected_rinchi = rxn.rinchi_string();
+	std::string expected_rauxinfo = rxn.rinchi_auxinfo();
+	std::string expected_long_key = rxn.rinchi_long_key();
+
+	rinchi::Reaction rxn_no_aux;
+	rxn_no_aux.set_omit_auxinfo(true);
+	mr.read_molecule("CH4S.mol", *rxn_no_aux.add_reactant());
+	mr.read_molecule("WithStereo.mol", *rxn_no_aux.add_product());
+	rinchi::unit_test::check_is_equal(rxn_no_aux.rinchi_string(), expected_rinchi, "RInChI without AuxInfo");
+	rinchi::unit_test::check_is_equal(rxn_no_aux.rinchi_long_key(), expected_long_key, "Long key without AuxInfo");
+	rinchi::unit_test::check_is_equal(rxn_no_aux.reactant(0)->inchi_auxinfo(), "", "Component AuxInfo");
+	try {
+		rxn_no_aux.rinchi_auxinfo();
+		throw rinchi::unit_test::TestFailure("RAuxInfo did not fail in AuxInfo-free mode.");
+	} catch (rinchi::RInChIError& e) {
+		rinchi::unit_test::check_errmsg_has_substr(e.what(), "AuxInfo-free mode");
+	}
+
+	// Switching the mode off calculates the AuxInfo on demand.
+	rxn_no_aux.set_omit_auxinfo(false);
+	rinchi::unit_test::check_is_equal(rxn_no_aux.rinchi_auxinfo(), expected_rauxinfo, "RAuxInfo after leaving AuxInfo-free mode");
+}
+
+void ReactionTests::parallel_inchi_calculation()
+{
+	const char* molfiles[] = { "CH4S.mol", "F2.mol", "H3NO.mol", "WithStereo.mol" };
+	const unsigned thread_counts[] = { 1, 4, 0 };
+
+	rinchi::MdlMolfileReader mr;
+	std::string expected_rinchi;
+	std::string expected_rauxinfo;
+	for (int t = 0; t < 3; t++) {
+		rinchi::Reaction rxn;
+		rxn.set_max_inchi_threads(thread_counts[t]);
+		for (int i = 0; i < 4; i++) {
+			mr.read_molecule(molfiles[i], *rxn.add_reactant());
+			mr.read_molecule(molfiles[3 - i], *rxn.add_product());
+			mr.read_molecule(molfiles[i], *rxn.add_agent());
+		}
+		if (t == 0) {
+			expected_rinchi = rxn.rinchi_string();
+			expected_rauxinfo = rxn.rinchi_auxinfo();
+			continue;
+		}
+		std::string context = "with max. " + rinchi::int2str(thread_counts[t]) + " InChI threads";
+		rinchi::unit_test::check_is_equal(rxn.rinchi_string(), expected_rinchi, "RInChI " + context);
+		rinchi::unit_test::check_is_equal(rxn.rinchi_auxinfo(), expected_rauxinfo, "RAuxInfo " + context);
+	}
+}
+
+namespace {
+
+	// The keys of a reaction of each pair of the molfiles in 'molfiles', separated by newlines.
+	std::string keys_of_molfile_pairs(const std::vector<std::string>& molfiles)
+	{
+		rinchi::MdlMolfileReader mr;
+		std::string result;
+		for (std::vector<std::string>::const_iterator reactant = molfiles.begin(); reactant != molfiles.end(); reactant++) {
+			for (std::vector<std::string>::const_iterator product = molfiles.begin(); product != molfiles.end(); product++) {
+				rinchi::Reaction rxn;
+				mr.read_molecule(*reactant, *rxn.add_reactant());
+				mr.read_molecule(*product, *rxn.add_product());
+				result += rxn.rinchi_long_key() + " " + rxn.rinchi_short_key() + " " + rxn.rinchi_web_key() + "\n";
+			}
+		}
+		return result;
+	}
+
+}
+
+void ReactionTests::concurrent_keys()
+{
+	std::vector<std::string> molfiles;
+	molfiles.push_back("CH4S.mol");
+	molfiles.push_back("F2.mol");
+	molfiles.push_back("H3NO.mol");
+	molfiles.push_back("WithStereo.mol");
+	molfiles.push_back("NoStructure.mol");
+	std::string expected = keys_of_molfile_pairs(molfiles);
+
+	// InChIKeys used to be generated into buffers shared by all threads.
+	const int THREAD_COUNT = 8;
+	std::vector<std::string> results (THREAD_COUNT);
+	std::atomic<int> errors (0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < THREAD_COUNT; t++)
+		threads.push_back(std::thread([&, t]() {
+			try {
+				for (int i = 0; i < 20; i++)
+					results[t] += keys_of_molfile_pairs(molfiles);
+			}
+			catch (std::exception&) {
+				errors++;
+			}
+		}));
+	for (std::vector<std::thread>::iterator thread = threads.begin(); thread != threads.end(); thread++)
+		thread->join();
+
+	std::string expected_per_thread;
+	for (int i = 0; i < 20; i++)
+		expected_per_thread += expected;
+	rinchi::unit_test::check_is_equal(errors.load(), 0, "Errors in threads");
+	for (int t = 0; t < THREAD_COUNT; t++)
+		rinchi::unit_test::check_is_equal(results[t], expected_per_thread, "Keys of thread " + rinchi::int2str(t));
+}
+
+namespace {
+
+	void check_same_rinchis(rinchi::Reaction& rxn, const char* reactant, const char* product, const char* agent, const std::string& context)
+	{
+		rinchi::MdlMolfileReader mr;
+		rinchi::Reaction expected;
+		mr.read_molecule(reactant, *expected.add_reactant());
+		mr.read_molecule(product, *expected.add_product());
+		if (agent != NULL)
+			mr.read_molecule(agent, *expected.add_agent());
+
+		rinchi::unit_test::check_is_equal(rxn.rinchi_string(), expected.rinchi_string(), "RInChI " + context);
+		rinchi::unit_test::check_is_equal(rxn.rinchi_auxinfo(), expected.rinchi_auxinfo(), "RAuxInfo " + context);
+		rinchi::unit_test::check_is_equal(rxn.rinchi_long_key(), expected.rinchi_long_key(), "Long key " + context);
+		rinchi::unit_test::check_is_equal(rxn.rinchi_short_key(), expected.rinchi_short_key(), "Short key " + context);
+		rinchi::unit_test::check_is_equal(rxn.rinchi_web_key(), expected.rinchi_web_key(), "Web key " + context);
+	}
+
+}
+
+void ReactionTests::incremental_updates()
+{
+	rinchi::MdlMolfileReader mr;
+	rinchi::Reaction rxn;
+	rinchi::ReactionComponent* reactant = rxn.add_reactant();
+	mr.read_molecule("CH4S.mol", *reactant);
+	mr.read_molecule("F2.mol", *rxn.add_product());
+	rinchi::ReactionComponent* agent = rxn.add_agent();
+	mr.read_molecule("H3NO.mol", *agent);
+	check_same_rinchis(rxn, "CH4S.mol", "F2.mol", "H3NO.mol", "before changes");
+
+	// Moves the reactants group behind the products group.
+	mr.read_molecule("WithStereo.mol", *reactant);
+	rxn.reset_component(reactant);
+	check_same_rinchis(rxn, "WithStereo.mol", "F2.mol", "H3NO.mol", "after changing a reactant");
+
+	mr.read_molecule("NoStructure.mol", *agent);
+	rxn.reset_component(agent);
+	check_same_rinchis(rxn, "WithStereo.mol", "F2.mol", "NoStructure.mol", "after changing the agent to a No-Structure");
+
+	rxn.delete_agent(agent);
+	check_same_rinchis(rxn, "WithStereo.mol", "F2.mol", NULL, "after deleting the agent");
+
+	rxn.reset_rinchis();
+	check_same_rinchis(rxn, "WithStereo.mol", "F2.mol", NULL, "after reset_rinchis()");
+}
+
+void ReactionTests::derived_variants()
+{
+	// Group of each molfile: 0 = reactants, 1 = products, 2 = agents.
+	const char* molfiles[] = { "CH4S.mol", "NoStructure.mol", "F2.mol", "WithStereo.mol", "H3NO.mol", "NoStructure.mol" };
+	const int groups[] = { 0, 0, 1, 1, 2, 2 };
+
+	rinchi::MdlMolfileReader mr;
+	rinchi::Reaction rxn;
+	for (int i = 0; i < 6; i++) {
+		rinchi::ReactionComponent* rc = groups[i] == 0 ? rxn.add_reactant() : (groups[i] == 1 ? rxn.add_product() : rxn.add_agent());
+		mr.read_molecule(molfiles[i], *rc);
+	}
+
+	for (int flags = 0; flags < 16; flags++) {
+		// The variant built the long way round.
+		rinchi::Reaction expected;
+		if (flags & rinchi::rvEquilibrium)
+			expected.set_directionality(rinchi::rdEquilibrium);
+		for (int i = 0; i < 6; i++) {
+			if ((flags & rinchi::rvWithoutAgents) && groups[i] == 2)
+				continue;
+			if ((flags & rinchi::rvWithoutNoStructures) && std::string(molfiles[i]) == "NoStructure.mol")
+				continue;
+			int group = groups[i];
+			if ((flags & rinchi::rvReversed) && group != 2)
+				group = 1 - group;
+			rinchi::ReactionComponent* rc = group == 0 ? expected.add_reactant() : (group == 1 ? expected.add_product() : expected.add_agent());
+			mr.read_molecule(molfiles[i], *rc);
+		}
+
+		rinchi::RInChIVariant variant = rxn.variant(flags);
+		std::string context = "of variant " + rinchi::int2str(flags);
+		rinchi::unit_test::check_is_equal(variant.rinchi_string, expected.rinchi_string(), "RInChI " + context);
+		rinchi::unit_test::check_is_equal(variant.long_key, expected.rinchi_long_key(), "Long key " + context);
+		rinchi::unit_test::check_is_equal(variant.short_key, expected.rinchi_short_key(), "Short key " + context);
+		rinchi::unit_test::check_is_equal(variant.web_key, expected.rinchi_web_key(), "Web key " + context);
+	}
+}
+
+void ReactionTests::move_semantics()
+{
+	static_assert(!std::is_copy_constructible<rinchi::Reaction>::value, "Reaction must not be copyable.");
+	static_assert(std::is_nothrow_move_constructible<rinchi::Reaction>::value, "Reaction must be nothrow movable.");
+	static_assert(std::is_nothrow_move_constructible<rinchi::ReactionComponent>::value, "ReactionComponent must be nothrow movable.");
+
+	rinchi::MdlMolfileReader mr;
+	rinchi::Reaction rxn;
+	mr.read_molecule("CH4S.mol", *rxn.add_reactant());
+	mr.read_molecule("WithStereo.mol", *rxn.add_product());
+	std::string expected_rinchi = rxn.rinchi_string();
+	std::string expected_rauxinfo = rxn.rinchi_auxinfo();
+	std::string empty_rinchi = rinchi::Reaction().rinchi_string();
+
+	// Through a container that reallocates, with the cache already filled.
+	std::vector<rinchi::Reaction> reactions;
+	reactions.push_back(std::move(rxn));
+	for (int i = 0; i < 10; i++)
+		reactions.push_back(rinchi::Reaction());
+	rinchi::unit_test::check_is_equal(reactions[0].rinchi_string(), expected_rinchi, "RInChI after move");
+	rinchi::unit_test::check_is_equal(reactions[0].rinchi_auxinfo(), expected_rauxinfo, "RAuxInfo after move");
+	rinchi::unit_test::check_is_equal(rxn.empty(), true, "Moved-from reaction is empty");
+	rinchi::unit_test::check_is_equal(rxn.rinchi_string(), empty_rinchi, "RInChI of moved-from reaction");
+
+	// Move assignment replaces the old content; the moved-from reaction can be reused.
+	rxn = std::move(reactions[0]);
+	rinchi::unit_test::check_is_equal(rxn.rinchi_string(), expected_rinchi, "RInChI after move assignment");
+	rinchi::unit_test::check_is_equal(reactions[0].empty(), true, "Moved-from reaction is empty after move assignment");
+	mr.read_molecule("F2.mol", *reactions[0].add_reactant());
+	rinchi::unit_test::check_is_equal(reactions[0].reactants().size(), (size_t) 1, "Reactants of reused reaction");
+
+	// A component moved out of a reaction takes its structure along.
+	rinchi::ReactionComponent component (std::move(*rxn.reactant(0)));
+	rinchi::unit_test::check_is_equal(rxn.reactant(0)->molecule().atom_count(), 0, "Moved-from component has no atoms");
+	rinchi::Reaction single;
+	*single.add_reactant() = std::move(component);
+	mr.read_molecule("WithStereo.mol", *single.add_product());
+	rinchi::unit_test::check_is_equal(single.rinchi_string(), expected_rinchi, "RInChI with moved component");
+}
+
+void ReactionTests::compact_structures()
+{
+	rinchi::MdlMolfileReader mr;
+	rinchi::Reaction rxn;
+	mr.read_molecule("CH4S.mol", *rxn.add_reactant());
+	mr.read_molecule("WithStereo.mol", *rxn.add_product());
+
+	// The structures take less room than the inchi_Atom arrays the InChI library is handed.
+	int atom_count = rxn.reactant(0)->molecule().atom_count() + rxn.product(0)->molecule().atom_count();
+	size_t memory_usage = rxn.structure_memory_usage();
+	rinchi::unit_test::check_is_equal(memory_usage > 0, true, "Structure memory is counted");
+	rinchi::unit_test::check_is_equal(memory_usage < atom_count * sizeof(inchi_Atom), true, "Structures smaller than inchi_Atom arrays");
+
+	// inchi_Input is only built for the InChI calls; the structures are left as they were.
+	rxn.rinchi_string();
+	rinchi::unit_test::check_is_equal(rxn.structure_memory_usage(), memory_usage, "Structure memory after calculating RInChI");
+}
+
+void ReactionTests::compaction()
+{
+	rinchi::MdlMolfileReader mr;
+	rinchi::Reaction rxn;
+	mr.read_molecule("CH4S.mol", *rxn.add_reactant());
+	mr.read_molecule("NoStructure.mol", *rxn.add_reactant());
+	mr.read_molecule("WithStereo.mol", *rxn.add_product());
+	size_t memory_usage = rxn.structure_memory_usage();
+
+	// Compacting calculates the RInChI itself; nothing has been requested yet.
+	size_t saved = rxn.compact();
+	rinchi::unit_test::check_is_equal(saved, memory_usage, "Bytes saved by compact()");
+	rinchi::unit_test::check_is_equal(rxn.structure_memory_usage(), (size_t) 0, "Structure memory after compact()");
+	rinchi::unit_test::check_is_equal(rxn.reactant(0)->has_structure(), false, "Compacted component is string-backed");
+	rinchi::unit_test::check_is_equal(rxn.reactant(1)->is_no_structure(), true, "Compacted No-Structure");
+	rinchi::unit_test::check_is_equal(rxn.compact(), (size_t) 0, "Bytes saved by second compact()");
+
+	rinchi::Reaction expected;
+	mr.read_molecule("CH4S.mol", *expected.add_reactant());
+	mr.read_molecule("NoStructure.mol", *expected.add_reactant());
+	mr.read_molecule("WithStereo.mol", *expected.add_product());
+	rinchi::unit_test::check_is_equal(rxn.rinchi_string(), expected.rinchi_string(), "RInChI of compacted reaction");
+	rinchi::unit_test::check_is_equal(rxn.rinchi_auxinfo(), expected.rinchi_auxinfo(), "RAuxInfo of compacted reaction");
+	rinchi::unit_test::check_is_equal(rxn.rinchi_long_key(), expected.rinchi_long_key(), "Long-RInChIKey of compacted reaction");
+
+	// Sorting again only needs the InChI strings.
+	rxn.reset_rinchis();
+	rinchi::unit_test::check_is_equal(rxn.rinchi_string(), expected.rinchi_string(), "RInChI of compacted reaction after reset_rinchis()");
+
+	// Resetting a compacted component keeps its InChI, the only structure it has left.
+	rxn.reset_component(rxn.reactant(0));
+	rinchi::unit_test::check_is_equal(rxn.reactant(0)->inchi_string(), expected.reactant(0)->inchi_string(), "InChI of reset compacted component");
+	rinchi::unit_test::check_is_equal(rxn.rinchi_string(), expected.rinchi_string(), "RInChI after resetting compacted component");
+	rinchi::unit_test::check_is_equal(rxn.rinchi_auxinfo(), expected.rinchi_auxinfo(), "RAuxInfo after resetting compacted component");
+
+	// Compacted without AuxInfo, there is none to return to.
+	rinchi::Reaction rxn_no_aux;
+	rxn_no_aux.set_omit_auxinfo(true);
+	mr.read_molecule("CH4S.mol", *rxn_no_aux.add_reactant());
+	mr.read_molecule("WithStereo.mol", *rxn_no_aux.add_product());
+	rxn_no_aux.compact();
+	try {
+		rxn_no_aux.set_omit_auxinfo(false);
+		throw rinchi::unit_test::TestFailure("Leaving AuxInfo-free mode after compact() did not fail.");
+	} catch (rinchi::RInChIError& e) {
+		rinchi::unit_test::check_errmsg_has_substr(e.what(), "compacted in AuxInfo-free mode");
+	}
+	rinchi::unit_test::check_is_equal(rxn_no_aux.omit_auxinfo(), true, "AuxInfo-free mode kept after failed switch");
+	try {
+		rxn_no_aux.reactant(0)->set_omit_auxinfo(false);
+		throw rinchi::unit_test::TestFailure("Leaving AuxInfo-free mode on a compacted component did not fail.");
+	} catch (rinchi::RInChIError& e) {
+		rinchi::unit_test::check_errmsg_has_substr(e.what(), "released without it");
+	}
+}
+
 } // end of namespace
@@ -51,6 +51,14 @@ class ReactionTests: public rinchi::unit_test::TestCase {
 		void no_structure_handling_from_rxn();
 		void no_structure_handling_from_rinchi();
 		void web_key();
+		void auxinfo_free_mode();
+		void parallel_inchi_calculation();
+		void concurrent_keys();
+		void incremental_updates();
+		void derived_variants();
+		void move_semantics();
+		void compact_structures();
+		void compaction();
 
 		ReactionTests()
 		{
@@ -59,6 +67,14 @@ class ReactionTests: public rinchi::unit_test::TestCase {
 			REGISTER_TEST(ReactionTests, no_structure_handling_from_rxn);
 			REGISTER_TEST(ReactionTests, no_structure_handling_from_rinchi);
 			REGISTER_TEST(ReactionTests, web_key);
+			REGISTER_TEST(ReactionTests, auxinfo_free_mode);
+			REGISTER_TEST(ReactionTests, parallel_inchi_calculation);
+			REGISTER_TEST(ReactionTests, concurrent_keys);
+			REGISTER_TEST(ReactionTests, incremental_updates);
+			REGISTER_TEST(ReactionTests, derived_variants);
+			REGISTER_TEST(ReactionTests, move_semantics);
+			REGISTER_TEST(ReactionTests, compact_structures);
+			REGISTER_TEST(ReactionTests, compaction);
 
 			goto_subdir("ReactionTest");
 		}
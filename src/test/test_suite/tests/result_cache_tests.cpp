@@ -0,0 +1,190 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "result_cache_tests.h"
+
+#include "rinchi_result_cache.h"
+#include "rinchi_reaction.h"
+#include "mdl_rxnfile_reader.h"
+#include "mdl_rdfile_reader.h"
+
+namespace rinchi_tests {
+
+namespace {
+
+	std::string file_text(const std::string& file_name)
+	{
+		std::ifstream input (file_name.c_str(), std::ios::binary);
+		if (!input)
+			throw rinchi::unit_test::TestFailure("Can't open '" + file_name + "'.");
+		std::ostringstream result;
+		result << input.rdbuf();
+		return result.str();
+	}
+
+	// Replaces line 'line_idx' (0-based) of 'text'.
+	std::string with_line(const std::string& text, int line_idx, const std::string& line)
+	{
+		size_t start = 0;
+		for (int i = 0; i < line_idx; i++)
+			start = text.find('\n', start) + 1;
+		size_t end = text.find_first_of("\r\n", start);
+		return text.substr(0, start) + line + text.substr(end);
+	}
+
+	std::string with_lf_line_endings(const std::string& text)
+	{
+		std::string result;
+		for (std::string::const_iterator c = text.begin(); c != text.end(); c++)
+			if (*c != '\r')
+				result += *c;
+		return result;
+	}
+
+	std::string rinchi_of_rxnfile_text(const std::string& text)
+	{
+		std::istringstream input (text);
+		rinchi::Reaction rxn;
+		rinchi::MdlRxnfileReader().read_reaction(input, rxn);
+		return rxn.rinchi_string();
+	}
+
+	rinchi::ReactionResult result_with_rinchi(const std::string& rinchi_string)
+	{
+		rinchi::ReactionResult result;
+		result.rinchi_string = rinchi_string;
+		result.has_auxinfo = true;
+		return result;
+	}
+
+}
+
+void ResultCacheTests::rxnfile_keys()
+{
+	std::string text = file_text("R005a.rxn");
+	std::string key = rinchi::ReactionResultCache::cache_key("RXN", false, text);
+
+	// Line 3 is the program/timestamp line, line 7 the name line of the first molfile.
+	std::string other_header = with_line(with_line(text, 2, "  Other   0101261200"), 6, "Named");
+	rinchi::unit_test::check_is_equal(rinchi::ReactionResultCache::cache_key("RXN", false, with_lf_line_endings(text)), key, "Key with LF line endings");
+	rinchi::unit_test::check_is_equal(rinchi::ReactionResultCache::cache_key("RXN", false, other_header), key, "Key with other header lines");
+	rinchi::unit_test::check_is_equal(rinchi_of_rxnfile_text(other_header), rinchi_of_rxnfile_text(text), "RInChI with other header lines");
+
+	rinchi::unit_test::check_is_equal(rinchi::ReactionResultCache::cache_key("RXN", true, text) != key, true, "Key with forced equilibrium");
+	rinchi::unit_test::check_is_equal(rinchi::ReactionResultCache::cache_key("RD", false, text) != key, true, "Key for other format");
+	// The component count line.
+	rinchi::unit_test::check_is_equal(rinchi::ReactionResultCache::cache_key("RXN", false, with_line(text, 4, "  1  1")) != key, true, "Key with other count line");
+}
+
+void ResultCacheTests::rdfile_keys()
+{
+	std::string text = file_text("../RDfiles/Example 01 CCR.rdf");
+	std::string key = rinchi::ReactionResultCache::cache_key("RD", false, text);
+
+	// "$DATM" line.
+	rinchi::unit_test::check_is_equal(rinchi::ReactionResultCache::cache_key("RD", false, with_line(text, 1, "$DATM    01/01/26 12:00")), key, "Key with other $DATM line");
+	rinchi::unit_test::check_is_equal(rinchi::ReactionResultCache::cache_key("RD", false, with_line(text, 2, "$RFMT $RIREG 2")) != key, true, "Key with other $RFMT line");
+}
+
+void ResultCacheTests::eviction()
+{
+	rinchi::ReactionResultCache cache (2);
+	rinchi::ReactionResult result;
+	cache.insert("a", result_with_rinchi("A"));
+	cache.insert("b", result_with_rinchi("B"));
+	// "a" is now the most recently used, so "b" goes.
+	cache.find("a", true, result);
+	cache.insert("c", result_with_rinchi("C"));
+
+	rinchi::unit_test::check_is_equal(cache.find("b", true, result), false, "Evicted entry");
+	rinchi::unit_test::check_is_equal(cache.find("c", true, result), true, "Newest entry");
+	rinchi::unit_test::check_is_equal(result.rinchi_string, "C", "Newest entry result");
+	rinchi::unit_test::check_is_equal(cache.find("a", true, result), true, "Recently used entry");
+	rinchi::unit_test::check_is_equal(result.rinchi_string, "A", "Recently used entry result");
+
+	rinchi::ReactionResultCacheStats stats = cache.stats();
+	rinchi::unit_test::check_is_equal(stats.hits, 3ul, "Hits");
+	rinchi::unit_test::check_is_equal(stats.misses, 1ul, "Misses");
+	rinchi::unit_test::check_is_equal(stats.evictions, 1ul, "Evictions");
+	rinchi::unit_test::check_is_equal(stats.entries, (size_t) 2, "Entries");
+	rinchi::unit_test::check_is_equal(stats.hit_rate(), 0.75, "Hit rate");
+
+	cache.set_limits(1, std::chrono::milliseconds(0));
+	rinchi::unit_test::check_is_equal(cache.stats().entries, (size_t) 1, "Entries after shrinking");
+	cache.set_limits(0, std::chrono::milliseconds(0));
+	rinchi::unit_test::check_is_equal(cache.enabled(), false, "Cache with no entries is disabled");
+	cache.insert("d", result_with_rinchi("D"));
+	rinchi::unit_test::check_is_equal(cache.stats().entries, (size_t) 0, "Entries of disabled cache");
+}
+
+void ResultCacheTests::time_to_live()
+{
+	rinchi::ReactionResultCache cache (10, std::chrono::milliseconds(50));
+	rinchi::ReactionResult result;
+	cache.insert("a", result_with_rinchi("A"));
+	rinchi::unit_test::check_is_equal(cache.find("a", true, result), true, "Fresh entry");
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	rinchi::unit_test::check_is_equal(cache.find("a", true, result), false, "Expired entry");
+	rinchi::unit_test::check_is_equal(cache.stats().expirations, 1ul, "Expirations");
+	rinchi::unit_test::check_is_equal(cache.stats().entries, (size_t) 0, "Entries after expiry");
+}
+
+void ResultCacheTests::auxinfo_entries()
+{
+	rinchi::ReactionResultCache cache (10);
+	rinchi::ReactionResult result = result_with_rinchi("A");
+	result.has_auxinfo = false;
+	cache.insert("a", result);
+
+	rinchi::unit_test::check_is_equal(cache.find("a", false, result), true, "Entry without AuxInfo when none is needed");
+	rinchi::unit_test::check_is_equal(cache.find("a", true, result), false, "Entry without AuxInfo when it is needed");
+
+	// The entry with AuxInfo replaces it and serves both.
+	cache.insert("a", result_with_rinchi("A"));
+	rinchi::unit_test::check_is_equal(cache.find("a", true, result), true, "Entry with AuxInfo");
+	rinchi::unit_test::check_is_equal(cache.find("a", false, result), true, "Entry with AuxInfo when none is needed");
+	rinchi::unit_test::check_is_equal(cache.stats().entries, (size_t) 1, "Entries");
+}
+
+} // end of namespace
@@ -37,7 +37,9 @@
 #pragma endregion
 #endif
 
+#include <atomic>
 #include <fstream>
+#include <sstream>
 
 #include "rinchi_consts.h"
 #include "rinchi_utils.h"
@@ -45,6 +47,8 @@
 
 #include "rinchi_reaction.h"
 #include "rinchi_reader.h"
+#include "inchi_generator.h"
+#include "mdl_rxnfile_writer.h"
 
 namespace rinchi_tests {
 
@@ -111,6 +115,19 @@ void RInChIReaderTests::error_cases()
 		"05",
 		"RInChI=1.00.1S/<>H3NO/c1-2/h2H,1H2/d-", "RAuxInfo=1.00.1/<>invaliddata/", "Invalid AuxInfo 'AuxInfo=1/invaliddata/' for a reaction component."
 	);
+	// Invalid reversibility layers, as caught by InChIAuxInfoReader.
+	check_rinchi_parsing_error(
+		"06",
+		"RInChI=1.00.1S/<>H3NO/c1-2/h2H,1H2/d-", "RAuxInfo=1.00.1/<>0/N:1,2/rA:3nNO/rB:s1;/rC:;;", "Invalid AuxInfo 'AuxInfo=1/0/N:1,2/rA:3nNO/rB:s1;/rC:;;' for a reaction component."
+	);
+	check_rinchi_parsing_error(
+		"07",
+		"RInChI=1.00.1S/<>H3NO/c1-2/h2H,1H2/d-", "RAuxInfo=1.00.1/<>0/N:1,2/rA:2nNO/rB:s2;/rC:;;", "Invalid AuxInfo 'AuxInfo=1/0/N:1,2/rA:2nNO/rB:s2;/rC:;;' for a reaction component."
+	);
+	check_rinchi_parsing_error(
+		"08",
+		"RInChI=1.00.1S/<>H3NO/c1-2/h2H,1H2/d-", "RAuxInfo=1.00.1/<>0/N:1,2/rA:2nNO/rB:s1;/rC:0,x,0;;", "Invalid AuxInfo 'AuxInfo=1/0/N:1,2/rA:2nNO/rB:s1;/rC:0,x,0;;' for a reaction component."
+	);
 }
 
 void RInChIReaderTests::trivial_cases()
@@ -345,4 +362,126 @@ void RInChIReaderTests::load_inchis_from_text()
     );
 }
 
+namespace {
+
+	const std::string MOLFILE_REUSE_RINCHI =
+		"RInChI=1.00.1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1<>C4H9BrO/c1-3(5)4(2)6/h3-4,6H,1-2H3/t3-,4+/m1/s1!Na.H2O/h;1H2/q+1;/p-1/d-";
+	const std::string MOLFILE_REUSE_RAUXINFO =
+		"RAuxInfo=1.00.1/0/N:4,1,3,2,5/E:(1,2)(3,4)/it:im/rA:5nCCCCO/rB:N1;s2;P3;s2s3;/rC:-1.127,-.5635,0;-.4125,-.151,0;.4125,-.151,0;1.127,-.5635,0;0,.5635,0;<>0/N:4,1,3,2,6,5/it:im/rA:6nCCCCOBr/rB:s1;s2;s3;N2;P3;/rC:-.825,-.7557,0;-.4125,-.0412,0;.4125,-.0412,0;.825,.6733,0;-.626,.7557,0;.825,-.7557,0;!1/N:1;2/rA:2nNaO/rB:s1;/rC:-.4125,0,0;.4125,0,0;";
+
+	void check_component_molfiles(const rinchi::ReactionComponentList& components, const std::string& case_no)
+	{
+		for (rinchi::ReactionComponentList::const_iterator rc = components.begin(); rc != components.end(); rc++) {
+			std::string expected = rinchi::InChIToStructureConverter().to_molfile((*rc)->inchi_string(), (*rc)->inchi_auxinfo());
+			rinchi::unit_test::check_is_equal((*rc)->to_molfile(), expected, case_no + " (to_molfile): " + (*rc)->inchi_string());
+			rinchi::unit_test::check_is_equal((*rc)->molfile(), expected, case_no + ": " + (*rc)->inchi_string());
+			(*rc)->release_molfile();
+			rinchi::unit_test::check_is_equal((*rc)->molfile(), expected, case_no + " (rebuilt): " + (*rc)->inchi_string());
+		}
+	}
+
+} // end of anon. namespace.
+
+void RInChIReaderTests::molfile_reuse()
+{
+	for (int keep_molfiles = 1; keep_molfiles >= 0; keep_molfiles--) {
+		rinchi::RInChIReader rdr;
+		rdr.set_keep_molfiles(keep_molfiles == 1);
+		std::string case_no = keep_molfiles == 1 ? "Kept" : "Not kept";
+
+		rinchi::Reaction rxn;
+		rdr.split_into_reaction(MOLFILE_REUSE_RINCHI, MOLFILE_REUSE_RAUXINFO, rxn);
+		std::ostringstream rxnfile;
+		rinchi::MdlRxnfileWriter().write_reaction(rxn, rxnfile);
+		// Writers take the reaction as const: they use the molfiles kept, but do not keep any.
+		for (rinchi::ReactionComponentList::const_iterator rc = rxn.reactants().begin(); rc != rxn.reactants().end(); rc++)
+			rinchi::unit_test::check_is_equal((*rc)->has_molfile(), keep_molfiles == 1, case_no + ": molfile kept after writing");
+		check_component_molfiles(rxn.reactants(), case_no);
+		check_component_molfiles(rxn.products(), case_no);
+	}
+}
+
+namespace {
+
+	// R005a.rxn with the standard InChIKeys of its components.
+	const std::string INCHI_KEYS_REACTANTS =
+		"InChI=1S/C4H9BrO/c1-3(5)4(2)6/h3-4,6H,1-2H3/t3-,4+/m1/s1" "\n"
+		"InChIKey=JCYSVJNMXBWPHS-DMTCNVIQSA-N" "\n"
+		"InChI=1S/Na.H2O/h;1H2/q+1;/p-1" "\n"
+		"AuxInfo=1/1/N:1;2/rA:2nNaO/rB:s1;/rC:-.4125,0,0;.4125,0,0;" "\n"
+		"InChIKey=HEMHJVSKTPXQMS-UHFFFAOYSA-M" "\n";
+	const std::string INCHI_KEYS_PRODUCTS =
+		"InChI=1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1" "\n"
+		"InChIKey=PQXKWPLDPFFDJP-WUCPZUCCSA-N" "\n";
+	const std::string INCHI_KEYS_LONG_KEY =
+		"Long-RInChIKey=SA-BUHFF-PQXKWPLDPFFDJP-WUCPZUCCSA-N--JCYSVJNMXBWPHS-DMTCNVIQSA-N-HEMHJVSKTPXQMS-UHFFFAOYSA-M";
+
+	std::string long_key_from_text(const std::string& reactant_inchis, const std::string& product_inchis, unsigned check_interval, std::atomic<unsigned long>* key_counter = NULL)
+	{
+		rinchi::RInChIReader rdr;
+		rdr.set_inchi_key_check_interval(check_interval);
+		rdr.set_inchi_key_counter(key_counter);
+		rinchi::Reaction rxn;
+		rdr.add_inchis_to_reaction(reactant_inchis, product_inchis, "", rxn);
+		return rxn.rinchi_long_key();
+	}
+
+	std::string replaced(const std::string& text, const std::string& from, const std::string& to)
+	{
+		std::string result = text;
+		result.replace(result.find(from), from.length(), to);
+		return result;
+	}
+
+} // end of anon. namespace.
+
+void RInChIReaderTests::load_inchi_keys_from_text()
+{
+	rinchi::unit_test::check_is_equal(long_key_from_text(INCHI_KEYS_REACTANTS, INCHI_KEYS_PRODUCTS, 1), INCHI_KEYS_LONG_KEY, "Checked keys");
+	rinchi::unit_test::check_is_equal(long_key_from_text(INCHI_KEYS_REACTANTS, INCHI_KEYS_PRODUCTS, 0), INCHI_KEYS_LONG_KEY, "Trusted keys");
+
+	// A trusted key is used as given.
+	std::string wrong_products = replaced(INCHI_KEYS_PRODUCTS, "PQXKWPLDPFFDJP-WUCPZUCCSA-N", "PQXKWPLDPFFDJP-UHFFFAOYSA-N");
+	rinchi::unit_test::check_is_equal(
+		long_key_from_text(INCHI_KEYS_REACTANTS, wrong_products, 0),
+		replaced(INCHI_KEYS_LONG_KEY, "WUCPZUCCSA", "UHFFFAOYSA"), "Trusted wrong key"
+	);
+	// The product key is the third one read, so it is spot checked with an interval of 2 but not 3.
+	rinchi::unit_test::check_is_equal(
+		long_key_from_text(INCHI_KEYS_REACTANTS, wrong_products, 3),
+		replaced(INCHI_KEYS_LONG_KEY, "WUCPZUCCSA", "UHFFFAOYSA"), "Wrong key not spot checked"
+	);
+	check_rinchi_text_load_error("21", INCHI_KEYS_REACTANTS, wrong_products, "",
+		"Line 2: InChIKey 'PQXKWPLDPFFDJP-UHFFFAOYSA-N' does not match InChI string 'InChI=1S/C4H8O/c1-3-4(2)5-3/h3-4H,1-2H3/t3-,4?/m0/s1'.");
+	try {
+		long_key_from_text(INCHI_KEYS_REACTANTS, wrong_products, 2);
+		rinchi::unit_test::check_is_equal(true, false, "Wrong key spot checked: No error raised as expected.");
+	} catch (rinchi::RInChIReaderError& e) {
+		rinchi::unit_test::check_errmsg_has_substr(e.what(), "does not match InChI string");
+	}
+
+	// Readers that each read one key, sharing a counter as rinchi_lib does over its calls:
+	// with an interval of 2, every other one checks its key.
+	std::atomic<unsigned long> key_counter (0);
+	for (int call = 0; call < 4; call++) {
+		std::string context = "Shared key counter, call " + rinchi::int2str(call + 1);
+		try {
+			long_key_from_text("", wrong_products, 2, &key_counter);
+			rinchi::unit_test::check_is_equal(call % 2, 1, context + ": No error raised as expected");
+		} catch (rinchi::RInChIReaderError& e) {
+			rinchi::unit_test::check_is_equal(call % 2, 0, context + ": Unexpected error");
+			rinchi::unit_test::check_errmsg_has_substr(e.what(), "does not match InChI string", context);
+		}
+	}
+	rinchi::unit_test::check_is_equal(key_counter.load(), 4ul, "Shared key counter");
+
+	// Even trusted keys must look like InChIKeys.
+	check_rinchi_text_load_error("22", INCHI_KEYS_REACTANTS, replaced(INCHI_KEYS_PRODUCTS, "-WUCPZUCCSA-N", "-WUCPZUCCSA"), "",
+		"Line 2: Invalid InChIKey 'PQXKWPLDPFFDJP-WUCPZUCCSA'.");
+	check_rinchi_text_load_error("23", "InChIKey=JCYSVJNMXBWPHS-DMTCNVIQSA-N", "", "",
+		"Line 1: InChIKey without preceeding InChI string.");
+	check_rinchi_text_load_error("24", INCHI_KEYS_PRODUCTS + "InChIKey=PQXKWPLDPFFDJP-WUCPZUCCSA-N", "", "",
+		"Line 3: Duplicate InChIKey for a reaction component.");
+}
+
 } // end of namespace
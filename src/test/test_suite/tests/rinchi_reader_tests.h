@@ -57,6 +57,12 @@ class RInChIReaderTests: public rinchi::unit_test::TestCase {
 		// Test direct load of component InChI strings via text input.
 		void load_inchis_from_text();
 
+		// Molfiles built while validating AuxInfo are kept for the writers.
+		void molfile_reuse();
+
+		// InChIKey lines in the text input.
+		void load_inchi_keys_from_text();
+
 		RInChIReaderTests()
 		{
 			REGISTER_TEST(RInChIReaderTests, error_cases);
@@ -68,6 +74,8 @@ class RInChIReaderTests: public rinchi::unit_test::TestCase {
 			REGISTER_TEST(RInChIReaderTests, no_structures);
 
 			REGISTER_TEST(RInChIReaderTests, load_inchis_from_text);
+			REGISTER_TEST(RInChIReaderTests, molfile_reuse);
+			REGISTER_TEST(RInChIReaderTests, load_inchi_keys_from_text);
 		}
 
 };
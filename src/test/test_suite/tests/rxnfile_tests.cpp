@@ -48,8 +48,10 @@
 
 #include "rinchi_reaction.h"
 #include "rinchi_reader.h"
+#include "mdl_rxnfile.h"
 #include "mdl_rxnfile_reader.h"
 #include "mdl_rxnfile_writer.h"
+#include "inchi_generator.h"
 
 namespace rinchi_tests {
 
@@ -278,4 +280,133 @@ void RxnfileTests::agent_support_in_writer()
         "Round-trip failure: Unexpected RInChI string produced when reading back output (with suppressed agents).");
 }
 
+namespace {
+
+	void check_molfiles_identical(rinchi::InChIToStructureConverter& sc, const rinchi::ReactionComponentList& components, bool use_auxinfo, const std::string& test_name)
+	{
+		for (rinchi::ReactionComponentList::const_iterator rc = components.begin(); rc != components.end(); rc++) {
+			std::string auxinfo = use_auxinfo ? (*rc)->inchi_auxinfo() : "";
+			rinchi::unit_test::check_is_equal(
+				sc.to_molfile((*rc)->inchi_string(), auxinfo),
+				sc.to_molfile_using_inchi_lib((*rc)->inchi_string(), auxinfo),
+				test_name + ": " + (*rc)->inchi_string() + (use_auxinfo ? " (with AuxInfo)" : " (without AuxInfo)")
+			);
+		}
+	}
+
+	void check_native_molfile_writer(const std::string& test_filename)
+	{
+		rinchi::Reaction rxn;
+		rinchi::MdlRxnfileReader rxn_reader;
+		rxn_reader.read_reaction(test_filename, rxn);
+
+		rinchi::InChIToStructureConverter sc;
+		for (int use_auxinfo = 1; use_auxinfo >= 0; use_auxinfo--) {
+			check_molfiles_identical(sc, rxn.reactants(), use_auxinfo == 1, test_filename);
+			check_molfiles_identical(sc, rxn.products(), use_auxinfo == 1, test_filename);
+			check_molfiles_identical(sc, rxn.agents(), use_auxinfo == 1, test_filename);
+		}
+	}
+
+}
+
+void RxnfileTests::native_molfile_writer()
+{
+	int test_count = 0;
+	const char* test_dirs[] = { ".", "../rxnfiles_chiral", "../Cambridge_rxnfiles" };
+	for (size_t d = 0; d < sizeof(test_dirs) / sizeof(test_dirs[0]); d++) {
+		boost::filesystem::directory_iterator end_itr;
+		for (boost::filesystem::directory_iterator testfile(test_dirs[d]); testfile != end_itr; testfile++) {
+			if (!boost::filesystem::is_regular_file(testfile->path()))
+				continue;
+			std::string test_filename = testfile->path().string();
+			if (test_filename.substr(test_filename.length() - 4, 4) != ".rxn")
+				continue;
+
+			test_count++;
+			check_native_molfile_writer(test_filename);
+		}
+	}
+	std::cout << " [" << test_count << " files tested]";
+
+	// Without AuxInfo the InChI library rebuilds stereo as 0D stereo, which is left to its own writer.
+	const char* stereo_inchis[] = {
+		"InChI=1S/C4H9BrO/c1-3(5)4(2)6/h3-4,6H,1-2H3/t3-,4+/m1/s1",
+		"InChI=1S/C4H8/c1-3-4-2/h3-4H,1-2H3/b4-3+"
+	};
+	rinchi::InChIToStructureConverter sc;
+	for (size_t i = 0; i < sizeof(stereo_inchis) / sizeof(stereo_inchis[0]); i++)
+		rinchi::unit_test::check_is_equal(sc.to_molfile(stereo_inchis[i], ""), sc.to_molfile_using_inchi_lib(stereo_inchis[i], ""), std::string("0D stereo: ") + stereo_inchis[i]);
+}
+
+void RxnfileTests::memory_stream()
+{
+	std::ifstream rxnfile ("R005a.rxn", std::ios::binary);
+	std::string file_text ((std::istreambuf_iterator<char>(rxnfile)), std::istreambuf_iterator<char>());
+
+	rinchi::Reaction expected;
+	rinchi::MdlRxnfileReader rxn_reader;
+	rxn_reader.read_reaction("R005a.rxn", expected);
+
+	rinchi::MemoryStreamBuffer buffer (file_text.data(), file_text.length());
+	std::istream input (&buffer);
+	// Readers seek back after peeking at lines.
+	std::string first_line;
+	rinchi::rinchi_getline(input, first_line);
+	rinchi::unit_test::check_is_equal(first_line, rinchi::MDL_TAG_RXN_BEGIN, "First line");
+	input.seekg(0);
+
+	rinchi::Reaction rxn;
+	rxn_reader.read_reaction(input, rxn);
+	rinchi::unit_test::check_is_equal(rxn.rinchi_string(), expected.rinchi_string(), "RInChI string");
+	rinchi::unit_test::check_is_equal(rxn.rinchi_auxinfo(), expected.rinchi_auxinfo(), "RAuxInfo");
+
+	// Seeks outside the text fail and leave the position alone.
+	input.clear();
+	input.seekg(0, std::ios::end);
+	rinchi::unit_test::check_is_equal((int) input.tellg(), (int) file_text.length(), "Position at end");
+	input.seekg(1, std::ios::end);
+	rinchi::unit_test::check_is_equal(input.fail(), true, "Seek past end must fail");
+	input.clear();
+	rinchi::unit_test::check_is_equal((int) input.tellg(), (int) file_text.length(), "Position after failed seek");
+}
+
+void RxnfileTests::chunk_list_stream()
+{
+	std::ifstream rxnfile ("R005a.rxn", std::ios::binary);
+	std::string file_text ((std::istreambuf_iterator<char>(rxnfile)), std::istreambuf_iterator<char>());
+
+	rinchi::Reaction expected;
+	rinchi::MdlRxnfileReader rxn_reader;
+	rxn_reader.read_reaction("R005a.rxn", expected);
+
+	// Odd chunk sizes put line ends and the readers' seek positions at chunk boundaries.
+	rinchi::ChunkListStreamBuffer buffer;
+	for (size_t pos = 0, chunk_length = 1; pos < file_text.length(); pos += chunk_length, chunk_length = chunk_length % 97 + 7)
+		buffer.add_chunk(file_text.data() + pos, std::min(chunk_length, file_text.length() - pos));
+	buffer.add_chunk("", 0);
+	std::istream input (&buffer);
+
+	rinchi::Reaction rxn;
+	rxn_reader.read_reaction(input, rxn);
+	rinchi::unit_test::check_is_equal(rxn.rinchi_string(), expected.rinchi_string(), "RInChI string");
+	rinchi::unit_test::check_is_equal(rxn.rinchi_auxinfo(), expected.rinchi_auxinfo(), "RAuxInfo");
+
+	input.clear();
+	input.seekg(0);
+	std::string text_read ((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+	rinchi::unit_test::check_is_equal(text_read, file_text, "Text read after seek to start");
+
+	input.clear();
+	input.seekg(-3, std::ios::end);
+	rinchi::unit_test::check_is_equal((int) input.tellg(), (int) file_text.length() - 3, "Position near end");
+	input.seekg(1, std::ios::end);
+	rinchi::unit_test::check_is_equal(input.fail(), true, "Seek past end must fail");
+
+	rinchi::ChunkListStreamBuffer empty_buffer;
+	std::istream empty_input (&empty_buffer);
+	std::string line;
+	rinchi::unit_test::check_is_equal((bool) std::getline(empty_input, line), false, "Empty chunk list");
+}
+
 } // end of namespace
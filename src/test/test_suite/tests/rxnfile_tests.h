@@ -52,6 +52,11 @@ class RxnfileTests: public rinchi::unit_test::TestCase {
 		void chiral_flag_preservation();
 		// MdlRxnfileWriter should optionally write out agents.
 		void agent_support_in_writer();
+		// Native molfile writer must reproduce the molfiles written by the InChI library.
+		void native_molfile_writer();
+		// Reading through MemoryStreamBuffer must give the same reaction as reading the file.
+		void memory_stream();
+		void chunk_list_stream();
 
 		RxnfileTests()
 		{
@@ -60,6 +65,9 @@ class RxnfileTests: public rinchi::unit_test::TestCase {
 
 			REGISTER_TEST(RxnfileTests, chiral_flag_preservation);
 			REGISTER_TEST(RxnfileTests, agent_support_in_writer);
+			REGISTER_TEST(RxnfileTests, native_molfile_writer);
+			REGISTER_TEST(RxnfileTests, memory_stream);
+			REGISTER_TEST(RxnfileTests, chunk_list_stream);
 
 			goto_subdir("rxnfiles");
 		}
@@ -0,0 +1,414 @@
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <rinchi_utils.h>
+
+#include <mdl_molfile.h>
+#include <mdl_molfile_writer.h>
+
+using namespace std;
+
+namespace rinchi {
+
+namespace {
+
+	const int MDL_MAX_V2000_COUNT = 999;
+	const int MDL_MAX_PROPERTY_ENTRIES_PER_LINE = 8;
+
+	// Header lines as written by the InChI library; the name line is always blank.
+	const std::string MOLFILE_HEADER =
+		"\n"
+		"  InChIV10\n"
+		"\n";
+
+	struct MolfileBond {
+		int from_atom;
+		int to_atom;
+		int bond_type;
+		// MDL stereo code, to be interpreted with 'from_atom' as the narrow end.
+		int stereo;
+	};
+
+	typedef std::vector<MolfileBond> MolfileBondList;
+
+	MolfileBond make_bond(int owner_atom, int neighbor_atom, int bond_type, int inchi_stereo)
+	{
+		MolfileBond result;
+		result.bond_type = bond_type;
+		result.stereo = 0;
+		result.from_atom = owner_atom < neighbor_atom ? owner_atom : neighbor_atom;
+		result.to_atom   = owner_atom < neighbor_atom ? neighbor_atom : owner_atom;
+		if (inchi_stereo == INCHI_BOND_STEREO_DOUBLE_EITHER || inchi_stereo == -INCHI_BOND_STEREO_DOUBLE_EITHER)
+			result.stereo = INCHI_BOND_STEREO_DOUBLE_EITHER;
+		else if (inchi_stereo != INCHI_BOND_STEREO_NONE) {
+			// A positive InChI stereo value puts the narrow end on the atom that lists the bond, a
+			// negative value on the neighbor. Values otherwise coincide with the V2000 codes.
+			result.stereo = abs(inchi_stereo);
+			result.from_atom = inchi_stereo > 0 ? owner_atom : neighbor_atom;
+			result.to_atom   = inchi_stereo > 0 ? neighbor_atom : owner_atom;
+		}
+		return result;
+	}
+
+	bool atom_lists_neighbor(const inchi_Atom& atom, int neighbor_idx)
+	{
+		for (int i = 0; i < atom.num_bonds; i++)
+			if (atom.neighbor[i] == neighbor_idx)
+				return true;
+		return false;
+	}
+
+	/**
+	  inchi_Input may hold a bond at either end or at both. Collect every bond once, ordered by
+	  its lower-numbered atom - own neighbors first, then bonds only listed by higher-numbered atoms.
+	**/
+	void collect_bonds(const inchi_Input& inchi_input, MolfileBondList& result)
+	{
+		std::vector<MolfileBondList> one_sided_bonds (inchi_input.num_atoms);
+		for (int a = 0; a < inchi_input.num_atoms; a++) {
+			const inchi_Atom& atom = inchi_input.atom[a];
+			for (int i = 0; i < atom.num_bonds; i++) {
+				int n = atom.neighbor[i];
+				if (n < a && !atom_lists_neighbor(inchi_input.atom[n], a))
+					one_sided_bonds[n].push_back(make_bond(a, n, atom.bond_type[i], atom.bond_stereo[i]));
+			}
+		}
+
+		result.clear();
+		for (int a = 0; a < inchi_input.num_atoms; a++) {
+			const inchi_Atom& atom = inchi_input.atom[a];
+			for (int i = 0; i < atom.num_bonds; i++) {
+				if (atom.neighbor[i] > a)
+					result.push_back(make_bond(a, atom.neighbor[i], atom.bond_type[i], atom.bond_stereo[i]));
+			}
+			result.insert(result.end(), one_sided_bonds[a].begin(), one_sided_bonds[a].end());
+		}
+	}
+
+	/** Valences **/
+
+	struct MainGroupElement {
+		const char* symbol;
+		int valence_electrons;
+		bool is_period_2;
+	};
+
+	const MainGroupElement MAIN_GROUP_ELEMENTS[] = {
+		{ "H",  1, true  },
+		{ "B",  3, true  }, { "C",  4, true  }, { "N",  5, true  }, { "O",  6, true  }, { "F",  7, true  },
+		{ "Al", 3, false }, { "Si", 4, false }, { "P",  5, false }, { "S",  6, false }, { "Cl", 7, false },
+		{ "Ga", 3, false }, { "Ge", 4, false }, { "As", 5, false }, { "Se", 6, false }, { "Br", 7, false },
+		{ "In", 3, false }, { "Sn", 4, false }, { "Sb", 5, false }, { "Te", 6, false }, { "I",  7, false },
+		{ "Tl", 3, false }, { "Pb", 4, false }, { "Bi", 5, false }, { "Po", 6, false }, { "At", 7, false }
+	};
+
+	// Sum of bond orders per atom. Alternating bonds (type 4) count as single; InChI never hands them back to us.
+	void bond_order_sums(int atom_count, const MolfileBondList& bonds, std::vector<int>& result)
+	{
+		result.assign(atom_count, 0);
+		for (MolfileBondList::const_iterator b = bonds.begin(); b != bonds.end(); b++) {
+			int order = b->bond_type <= INCHI_BOND_TYPE_TRIPLE ? b->bond_type : 1;
+			result[b->from_atom] += order;
+			result[b->to_atom] += order;
+		}
+	}
+
+	/**
+	  Number of hydrogens an MDL reader will add to an atom with no valence field set: enough to
+	  reach the lowest standard valence of the element's isoelectronic main-group counterpart.
+	**/
+	int default_implicit_hydrogens(const inchi_Atom& atom, int bonds_used)
+	{
+		const MainGroupElement* element = NULL;
+		for (size_t i = 0; i < sizeof(MAIN_GROUP_ELEMENTS) / sizeof(MAIN_GROUP_ELEMENTS[0]); i++) {
+			if (strcmp(MAIN_GROUP_ELEMENTS[i].symbol, atom.elname) == 0) {
+				element = &MAIN_GROUP_ELEMENTS[i];
+				break;
+			}
+		}
+		if (element == NULL)
+			return 0;
+
+		int electrons = element->valence_electrons - atom.charge;
+		if (element->valence_electrons == 1 && electrons != 1)
+			return 0;
+		if (electrons < 1 || electrons > 7)
+			return 0;
+
+		int radical_penalty = 0;
+		if (atom.radical == INCHI_RADICAL_DOUBLET)
+			radical_penalty = 1;
+		else if (atom.radical == INCHI_RADICAL_SINGLET || atom.radical == INCHI_RADICAL_TRIPLET)
+			radical_penalty = 2;
+
+		int valence = electrons <= 4 ? electrons : 8 - electrons;
+		int max_valence = (electrons <= 4 || element->is_period_2) ? valence : electrons;
+		for (; valence <= max_valence; valence += 2) {
+			if (valence - radical_penalty >= bonds_used)
+				return valence - radical_penalty - bonds_used;
+		}
+		return 0;
+	}
+
+	// Returns the MDL valence to write for an atom, or 0 if the default valence model gets it right.
+	int explicit_valence(const inchi_Atom& atom, int bonds_used)
+	{
+		// A negative count means "let InChI add implicit hydrogens" - the default model, by definition.
+		if (atom.num_iso_H[0] < 0)
+			return 0;
+
+		int hydrogen_count = atom.num_iso_H[0] + atom.num_iso_H[1] + atom.num_iso_H[2] + atom.num_iso_H[3];
+		if (hydrogen_count == default_implicit_hydrogens(atom, bonds_used))
+			return 0;
+
+		int valence = bonds_used + hydrogen_count;
+		// MDL code 15 is "zero valence".
+		return valence == 0 ? 15 : valence;
+	}
+
+	/** Isotopes, charges and radicals **/
+
+	bool is_relative_isotopic_mass(int isotopic_mass)
+	{
+		return isotopic_mass >= ISOTOPIC_SHIFT_FLAG - ISOTOPIC_SHIFT_MAX && isotopic_mass <= ISOTOPIC_SHIFT_FLAG + ISOTOPIC_SHIFT_MAX;
+	}
+
+	int inline_mass_difference(const inchi_Atom& atom)
+	{
+		if (!is_relative_isotopic_mass(atom.isotopic_mass))
+			return 0;
+		int mass_diff = atom.isotopic_mass - ISOTOPIC_SHIFT_FLAG;
+		if (mass_diff < -3 || mass_diff > 4)
+			throw MdlMolfileWriterError("Isotopic mass difference on " + std::string(atom.elname) + " atom is out of range for a molfile.");
+		return mass_diff;
+	}
+
+	int inline_charge_code(const inchi_Atom& atom)
+	{
+		if (atom.charge >= -3 && atom.charge <= 3 && atom.charge != 0)
+			return 4 - atom.charge;
+		if (atom.charge == 0 && atom.radical == INCHI_RADICAL_DOUBLET)
+			return 4;
+		return 0;
+	}
+
+	typedef std::vector< std::pair<int, int> > PropertyList;
+
+	// Writes "M  CHG", "M  RAD" or "M  ISO" lines for 'entries', 8 atoms per line.
+	void write_property_lines(const std::string& tag, const PropertyList& entries, std::ostream& output_stream)
+	{
+		char buf[16];
+		for (size_t first = 0; first < entries.size(); first += MDL_MAX_PROPERTY_ENTRIES_PER_LINE) {
+			size_t count = entries.size() - first;
+			if (count > (size_t) MDL_MAX_PROPERTY_ENTRIES_PER_LINE)
+				count = MDL_MAX_PROPERTY_ENTRIES_PER_LINE;
+			snprintf(buf, sizeof(buf), "%3d", (int) count);
+			output_stream << tag << buf;
+			for (size_t i = first; i < first + count; i++) {
+				snprintf(buf, sizeof(buf), " %3d %3d", entries[i].first, entries[i].second);
+				output_stream << buf;
+			}
+			output_stream << '\n';
+		}
+	}
+
+	int property_line_count(const PropertyList& entries)
+	{
+		return (int) (entries.size() + MDL_MAX_PROPERTY_ENTRIES_PER_LINE - 1) / MDL_MAX_PROPERTY_ENTRIES_PER_LINE;
+	}
+
+	/** V3000 **/
+
+	// Writes a V3000 line, splitting it with "-" continuation marks if it exceeds 80 characters.
+	void write_V30_line(const std::string& content, std::ostream& output_stream)
+	{
+		const size_t max_content_length = MDL_MAX_V3000_LINE_LENGTH - MDL_TAG_V30_LINE_LENGTH - 1;
+		size_t pos = 0;
+		while (content.length() - pos > max_content_length + 1) {
+			output_stream << MDL_TAG_V30_LINE << content.substr(pos, max_content_length) << "-\n";
+			pos += max_content_length;
+		}
+		output_stream << MDL_TAG_V30_LINE << content.substr(pos) << '\n';
+	}
+
+	int V3000_stereo_code(int V2000_stereo_code)
+	{
+		switch (V2000_stereo_code) {
+			case INCHI_BOND_STEREO_SINGLE_1UP: return 1;
+			case INCHI_BOND_STEREO_SINGLE_1EITHER: return 2;
+			case INCHI_BOND_STEREO_SINGLE_1DOWN: return 3;
+			case INCHI_BOND_STEREO_DOUBLE_EITHER: return 2;
+			default: return 0;
+		}
+	}
+
+} // end of anonymous namespace
+
+void MdlMolfileWriter::write_V2000_molecule(const inchi_Input& inchi_input, int chiral_flag, std::ostream& output_stream)
+{
+	MolfileBondList bonds;
+	collect_bonds(inchi_input, bonds);
+	std::vector<int> bonds_used;
+	bond_order_sums(inchi_input.num_atoms, bonds, bonds_used);
+
+	PropertyList charges;
+	PropertyList radicals;
+	PropertyList isotopes;
+	for (int a = 0; a < inchi_input.num_atoms; a++) {
+		const inchi_Atom& atom = inchi_input.atom[a];
+		if (atom.charge != 0)
+			charges.push_back(std::make_pair(a + 1, (int) atom.charge));
+		if (atom.radical != INCHI_RADICAL_NONE)
+			radicals.push_back(std::make_pair(a + 1, (int) atom.radical));
+		if (atom.isotopic_mass > 0 && !is_relative_isotopic_mass(atom.isotopic_mass))
+			isotopes.push_back(std::make_pair(a + 1, (int) atom.isotopic_mass));
+	}
+	// The InChI library counts all property lines including "M  END" in the count line.
+	int prop_line_count = property_line_count(charges) + property_line_count(radicals) + property_line_count(isotopes) + 1;
+
+	char buf[128];
+	output_stream << MOLFILE_HEADER;
+	snprintf(buf, sizeof(buf), "%3d%3d  0  0%3d  0  0  0  0  0%3d ",
+		(int) inchi_input.num_atoms, (int) bonds.size(), chiral_flag == 1 ? 1 : 0, prop_line_count);
+	output_stream << buf << MDL_TAG_V2000 << '\n';
+
+	for (int a = 0; a < inchi_input.num_atoms; a++) {
+		const inchi_Atom& atom = inchi_input.atom[a];
+		snprintf(buf, sizeof(buf), "%10.4f%10.4f%10.4f %-3s%2d%3d  0  0  0%3d  0  0  0  0  0  0\n",
+			atom.x, atom.y, atom.z, atom.elname, inline_mass_difference(atom), inline_charge_code(atom), explicit_valence(atom, bonds_used[a]));
+		output_stream << buf;
+	}
+
+	for (MolfileBondList::const_iterator b = bonds.begin(); b != bonds.end(); b++) {
+		snprintf(buf, sizeof(buf), "%3d%3d%3d%3d  0  0  0\n", b->from_atom + 1, b->to_atom + 1, b->bond_type, b->stereo);
+		output_stream << buf;
+	}
+
+	write_property_lines(MDL_TAG_CHARGE, charges, output_stream);
+	write_property_lines(MDL_TAG_RADICAL, radicals, output_stream);
+	write_property_lines(MDL_TAG_ISOTOPE, isotopes, output_stream);
+	output_stream << MDL_TAG_MOLFILE_END << '\n';
+}
+
+void MdlMolfileWriter::write_V3000_molecule(const inchi_Input& inchi_input, int chiral_flag, std::ostream& output_stream)
+{
+	MolfileBondList bonds;
+	collect_bonds(inchi_input, bonds);
+	std::vector<int> bonds_used;
+	bond_order_sums(inchi_input.num_atoms, bonds, bonds_used);
+
+	output_stream << MOLFILE_HEADER;
+	output_stream << "  0  0  0     0  0            999 " << MDL_TAG_V3000 << '\n';
+
+	write_V30_line(MDL_TAG_V30_BLOCK_CTAB_BEGIN, output_stream);
+	write_V30_line(MDL_TAG_V30_COUNTS + " " + int2str(inchi_input.num_atoms) + " " + int2str((int) bonds.size()) + " 0 0 " + (chiral_flag == 1 ? "1" : "0"), output_stream);
+
+	write_V30_line(MDL_TAG_V30_BLOCK_ATOM_BEGIN, output_stream);
+	char buf[128];
+	for (int a = 0; a < inchi_input.num_atoms; a++) {
+		const inchi_Atom& atom = inchi_input.atom[a];
+		snprintf(buf, sizeof(buf), "%d %s %.4f %.4f %.4f 0", a + 1, atom.elname, atom.x, atom.y, atom.z);
+		std::string line = buf;
+		if (atom.charge != 0)
+			line += " " + MDL_TAG_V30_ATOM_KEY_CHARGE + int2str(atom.charge);
+		if (atom.radical != INCHI_RADICAL_NONE)
+			line += " " + MDL_TAG_V30_ATOM_KEY_RADICAL + int2str(atom.radical);
+		if (atom.isotopic_mass > 0 && !is_relative_isotopic_mass(atom.isotopic_mass))
+			line += " " + MDL_TAG_V30_ATOM_KEY_ISOTOPE + int2str(atom.isotopic_mass);
+		int valence = explicit_valence(atom, bonds_used[a]);
+		if (valence != 0)
+			// V3000 uses -1 rather than 15 for "zero valence".
+			line += " " + MDL_TAG_V30_ATOM_KEY_VALENCE + int2str(valence == 15 ? -1 : valence);
+		write_V30_line(line, output_stream);
+	}
+	write_V30_line(MDL_TAG_V30_BLOCK_ATOM_END, output_stream);
+
+	if (!bonds.empty()) {
+		write_V30_line(MDL_TAG_V30_BLOCK_BOND_BEGIN, output_stream);
+		for (MolfileBondList::const_iterator b = bonds.begin(); b != bonds.end(); b++) {
+			std::string line = int2str((int) (b - bonds.begin() + 1)) + " " + int2str(b->bond_type) + " " + int2str(b->from_atom + 1) + " " + int2str(b->to_atom + 1);
+			if (V3000_stereo_code(b->stereo) != 0)
+				line += " " + MDL_TAG_V30_STEREO_CFG_KEY + int2str(V3000_stereo_code(b->stereo));
+			write_V30_line(line, output_stream);
+		}
+		write_V30_line(MDL_TAG_V30_BLOCK_BOND_END, output_stream);
+	}
+
+	write_V30_line(MDL_TAG_V30_BLOCK_CTAB_END, output_stream);
+	output_stream << MDL_TAG_MOLFILE_END << '\n';
+}
+
+void MdlMolfileWriter::write_molecule(const inchi_Input& inchi_input, int chiral_flag, std::ostream& output_stream)
+{
+	if (inchi_input.num_atoms > 0 && inchi_input.atom == NULL)
+		throw MdlMolfileWriterError("Structure has atom count but no atoms.");
+
+	bool use_V3000 = m_force_V3000 || inchi_input.num_atoms > MDL_MAX_V2000_COUNT;
+	if (!use_V3000) {
+		// Bond count is only known after de-duplication; an upper bound is good enough here.
+		int max_bond_count = 0;
+		for (int a = 0; a < inchi_input.num_atoms; a++)
+			max_bond_count += inchi_input.atom[a].num_bonds;
+		if (max_bond_count > MDL_MAX_V2000_COUNT) {
+			MolfileBondList bonds;
+			collect_bonds(inchi_input, bonds);
+			use_V3000 = (int) bonds.size() > MDL_MAX_V2000_COUNT;
+		}
+	}
+
+	if (use_V3000)
+		write_V3000_molecule(inchi_input, chiral_flag, output_stream);
+	else
+		write_V2000_molecule(inchi_input, chiral_flag, output_stream);
+}
+
+std::string MdlMolfileWriter::to_molfile(const inchi_Input& inchi_input, int chiral_flag)
+{
+	std::ostringstream result;
+	write_molecule(inchi_input, chiral_flag, result);
+	return result.str();
+}
+
+} // end of namespace
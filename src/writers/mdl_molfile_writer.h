@@ -0,0 +1,85 @@
+#ifndef IUPAC_RINCHI_MDLMOLFILEWRITER_HEADER_GUARD
+#define IUPAC_RINCHI_MDLMOLFILEWRITER_HEADER_GUARD
+
+#ifdef MSVC
+#pragma region InChI-Trust Licence
+/*
+ * Reaction International Chemical Identifier (RInChI)
+ * Version 1
+ * Software version 1.00
+ * 2022-01-14
+ * 
+ * The RInChI library and programs are free software developed under the
+ * auspices of the International Union of Pure and Applied Chemistry (IUPAC).
+ * 
+ * IUPAC/InChI-Trust Licence No.1.0 for the 
+ * Reaction International Chemical Identifier (RInChI) Software version 1.0
+ * Copyright (C) IUPAC and InChI Trust Limited
+ * 
+ * This library is free software; you can redistribute it and/or modify it 
+ * under the terms of the IUPAC/InChI Trust InChI Licence No.1.0, 
+ * or any later version.
+ * 
+ * Please note that this library is distributed WITHOUT ANY WARRANTIES 
+ * whatsoever, whether expressed or implied.  See the IUPAC/InChI Trust
+ * Licence for the International Chemical Identifier (InChI) Software
+ * ("IUPAC/InChI-Trust InChI Licence No. 1.0" in "LICENCE.TXT")
+ * for more details.
+ * 
+ * You should have received a copy of the IUPAC/InChI Trust InChI 
+ * Licence No. 1.0 with this library; if not, please write to:
+ * 
+ *     The InChI Trust
+ *     8 Cavendish Avenue
+ *     Cambridge CB1 7US
+ *     UK
+ *
+ * or email to: alan@inchi-trust.org.
+ *
+ */
+#pragma endregion
+#endif
+
+#include <string>
+#include <ostream>
+#include <stdexcept>
+#include <inchi_api.h>
+
+namespace rinchi {
+
+class MdlMolfileWriterError: public std::runtime_error {
+	public:
+		explicit MdlMolfileWriterError(const std::string& what) : std::runtime_error(what) { }
+};
+
+/**
+  Writes an inchi_Input structure as an MDL molfile.
+
+  The layout is the one the InChI library produces for GetINCHI() with "/OutputSDF", minus the
+  name line and the trailing "$$$$" - i.e. exactly what InChIToStructureConverter used to cut out
+  of the SD record. Molecules with more than 999 atoms or bonds do not fit a V2000 connection
+  table and are always written as V3000.
+
+  0D stereo ('stereo0D') is not written: a molfile carries stereo as wedges on coordinates.
+  InChIToStructureConverter leaves structures that have it to the InChI library.
+**/
+class MdlMolfileWriter {
+	private:
+		bool m_force_V3000;
+		void write_V2000_molecule(const inchi_Input& inchi_input, int chiral_flag, std::ostream& output_stream);
+		void write_V3000_molecule(const inchi_Input& inchi_input, int chiral_flag, std::ostream& output_stream);
+	public:
+		MdlMolfileWriter(): m_force_V3000(false) {}
+
+		bool force_V3000() const { return m_force_V3000; }
+		void set_force_V3000(bool value) { m_force_V3000 = value; }
+
+		// 'chiral_flag' uses the InchiInpData.bChiral convention: 1 = chiral flag set, 2 = chiral flag
+		// explicitly cleared, 0 = no information. Only 1 sets the flag in the output.
+		void write_molecule(const inchi_Input& inchi_input, int chiral_flag, std::ostream& output_stream);
+		std::string to_molfile(const inchi_Input& inchi_input, int chiral_flag);
+};
+
+} // end of namespace
+
+#endif
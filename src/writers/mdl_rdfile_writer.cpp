@@ -48,7 +48,6 @@
 #include <mdl_rdfile_writer.h>
 
 #include <mdl_rxnfile_writer.h>
-#include <inchi_generator.h>
 
 #include <ctime>
 
@@ -93,13 +92,12 @@ void MdlRDfileWriter::write_reaction(const Reaction& reaction, std::ostream& out
 		rxn_writer.write_reaction(reaction, output_stream);
 
 		// Output agents as molfiles, each one prefixed with two lines: An MDL_RDTAG_DTYPE data line and an MDL_RDLINE_MFMT line.
-		InChIToStructureConverter sc;
 		for (ReactionComponentList::const_iterator rc = reaction.agents().begin(); rc != reaction.agents().end(); rc++) {
 			int agent_number = (int) (rc - reaction.agents().begin() + 1);
 			// TODO: Output more reasonable data line ?
 			output_stream << MDL_RDTAG_DTYPE << " RXN:AGENTS(1):MOLECULES(" << agent_number << "):MOLSTRUCTURE" << '\n';
 			output_stream << MDL_RDLINE_MFMT << '\n';
-			output_stream << "Agent" << agent_number << sc.to_molfile((*rc)->inchi_string(), (*rc)->inchi_auxinfo());
+			output_stream << "Agent" << agent_number << (*rc)->to_molfile();
 		}
 	}
 	catch (std::exception& e) {
@@ -47,7 +47,6 @@
 
 #include <mdl_rxnfile.h>
 #include <mdl_rxnfile_writer.h>
-#include <inchi_generator.h>
 
 using namespace std;
 
@@ -69,20 +68,19 @@ void MdlRxnfileWriter::write_reaction(const Reaction& reaction, std::ostream& ou
             output_stream << setw(3) << reaction.agents().size();
         output_stream << '\n';
 		// Reactants and products as molfiles, each one prefixed with an MDL_TAG_RXN_COMPONENT_START line.
-		InChIToStructureConverter sc;
 		for (ReactionComponentList::const_iterator rc = reaction.reactants().begin(); rc != reaction.reactants().end(); rc++) {
 			output_stream << MDL_TAG_RXN_COMPONENT_START << '\n';
-			output_stream << "Reactant" << (int) (rc - reaction.reactants().begin() + 1) << sc.to_molfile((*rc)->inchi_string(), (*rc)->inchi_auxinfo());
+			output_stream << "Reactant" << (int) (rc - reaction.reactants().begin() + 1) << (*rc)->to_molfile();
 		}
 		for (ReactionComponentList::const_iterator rc = reaction.products().begin(); rc != reaction.products().end(); rc++) {
 			output_stream << MDL_TAG_RXN_COMPONENT_START << '\n';
-			output_stream << "Product" << (int) (rc - reaction.products().begin() + 1) << sc.to_molfile((*rc)->inchi_string(), (*rc)->inchi_auxinfo());
+			output_stream << "Product" << (int) (rc - reaction.products().begin() + 1) << (*rc)->to_molfile();
 		}
         // ... and agents, if any.
         if (do_write_agents) {
             for (ReactionComponentList::const_iterator rc = reaction.agents().begin(); rc != reaction.agents().end(); rc++) {
                 output_stream << MDL_TAG_RXN_COMPONENT_START << '\n';
-                output_stream << "Agent" << (int) (rc - reaction.agents().begin() + 1) << sc.to_molfile((*rc)->inchi_string(), (*rc)->inchi_auxinfo());
+                output_stream << "Agent" << (int) (rc - reaction.agents().begin() + 1) << (*rc)->to_molfile();
             }
         }
 	}